@@ -0,0 +1,239 @@
+#ifndef AFINIDADE_H
+#define AFINIDADE_H
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <sched.h>
+#include <string>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Afinidade de CPU e política NUMA para os trabalhadores (threads ou processos).
+ *
+ * --pin=compact  preenche um nó/soquete antes de passar ao próximo;
+ * --pin=scatter  alterna entre os nós, espalhando os trabalhadores;
+ * --pin=0,2,4-7  lista explícita de CPUs (o trabalhador i usa a i-ésima).
+ *
+ * --numa=interleave  intercala as páginas das matrizes entre todos os nós
+ *                    (set_mempolicy no processo principal, antes das alocações);
+ * --numa=local       cada trabalhador aloca no próprio nó. Nesse caso o
+ *                    resultado e os buffers de empacotamento são tocados pela
+ *                    primeira vez pelo trabalhador que os usa (first touch).
+ *
+ * A topologia é lida de /sys; set_mempolicy é chamado diretamente pela
+ * syscall, sem depender da libnuma.
+ */
+
+struct CpuLogica {
+    int id;
+    int no;
+    int pacote;
+    int nucleo;
+};
+
+inline int lerInteiroArquivo(const std::string& caminho, int padrao) {
+    std::ifstream arquivo(caminho);
+    int valor;
+    return (arquivo >> valor) ? valor : padrao;
+}
+
+// Interpreta listas no formato do kernel ("0-3,8,10-11")
+inline bool interpretarListaCpus(const std::string& texto, std::vector<int>& cpus) {
+    size_t pos = 0;
+    while (pos < texto.size()) {
+        size_t fim = texto.find(',', pos);
+        if (fim == std::string::npos) {
+            fim = texto.size();
+        }
+        std::string item = texto.substr(pos, fim - pos);
+        size_t traco = item.find('-');
+        char* resto;
+        long inicio = strtol(item.c_str(), &resto, 10);
+        if (resto == item.c_str() || inicio < 0) {
+            return false;
+        }
+        long ultimo = traco == std::string::npos ? inicio : strtol(item.c_str() + traco + 1, &resto, 10);
+        if (ultimo < inicio) {
+            return false;
+        }
+        for (long c = inicio; c <= ultimo; c++) {
+            cpus.push_back((int)c);
+        }
+        pos = fim + 1;
+    }
+    return !cpus.empty();
+}
+
+// Nó NUMA de cada CPU, a partir de /sys/devices/system/node/node*/cpulist
+inline std::vector<int> lerNosDasCpus(int maxCpu) {
+    std::vector<int> nos(maxCpu + 1, 0);
+    DIR* dir = opendir("/sys/devices/system/node");
+    if (dir == nullptr) {
+        return nos;
+    }
+    struct dirent* entrada;
+    while ((entrada = readdir(dir)) != nullptr) {
+        int no;
+        if (sscanf(entrada->d_name, "node%d", &no) != 1) {
+            continue;
+        }
+        std::ifstream arquivo(std::string("/sys/devices/system/node/") + entrada->d_name + "/cpulist");
+        std::string lista;
+        std::vector<int> cpus;
+        if (std::getline(arquivo, lista) && interpretarListaCpus(lista, cpus)) {
+            for (int c : cpus) {
+                if (c <= maxCpu) {
+                    nos[c] = no;
+                }
+            }
+        }
+    }
+    closedir(dir);
+    return nos;
+}
+
+// CPUs em que o processo pode rodar, com nó, pacote e núcleo de cada uma
+inline std::vector<CpuLogica> lerTopologia() {
+    std::vector<CpuLogica> topologia;
+    cpu_set_t mascara;
+    CPU_ZERO(&mascara);
+    if (sched_getaffinity(0, sizeof(mascara), &mascara) != 0) {
+        return topologia;
+    }
+
+    int maxCpu = 0;
+    for (int c = 0; c < CPU_SETSIZE; c++) {
+        if (CPU_ISSET(c, &mascara)) {
+            maxCpu = c;
+        }
+    }
+    std::vector<int> nos = lerNosDasCpus(maxCpu);
+
+    for (int c = 0; c <= maxCpu; c++) {
+        if (!CPU_ISSET(c, &mascara)) {
+            continue;
+        }
+        std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(c) + "/topology/";
+        CpuLogica cpu = { c, nos[c], lerInteiroArquivo(base + "physical_package_id", 0),
+                          lerInteiroArquivo(base + "core_id", c) };
+        topologia.push_back(cpu);
+    }
+    return topologia;
+}
+
+// Calcula a CPU de cada trabalhador. `modo` vazio ou "nenhum" deixa `cpus` vazio.
+inline bool planejarAfinidade(const std::string& modo, int numTrabalhadores, std::vector<int>& cpus) {
+    cpus.clear();
+    if (modo.empty() || modo == "nenhum") {
+        return true;
+    }
+
+    std::vector<int> ordem;
+    if (modo == "compact" || modo == "scatter") {
+        std::vector<CpuLogica> topologia = lerTopologia();
+        if (topologia.empty()) {
+            std::cerr << "Erro: Não foi possível ler a topologia de CPUs" << std::endl;
+            return false;
+        }
+        std::sort(topologia.begin(), topologia.end(), [](const CpuLogica& x, const CpuLogica& y) {
+            if (x.no != y.no) return x.no < y.no;
+            if (x.pacote != y.pacote) return x.pacote < y.pacote;
+            if (x.nucleo != y.nucleo) return x.nucleo < y.nucleo;
+            return x.id < y.id;
+        });
+
+        if (modo == "compact") {
+            for (const CpuLogica& c : topologia) {
+                ordem.push_back(c.id);
+            }
+        } else {
+            // Agrupa por nó e alterna entre os grupos
+            std::vector<std::vector<int>> porNo;
+            int noAnterior = -1;
+            for (const CpuLogica& c : topologia) {
+                if (c.no != noAnterior) {
+                    porNo.push_back(std::vector<int>());
+                    noAnterior = c.no;
+                }
+                porNo.back().push_back(c.id);
+            }
+            for (size_t i = 0; ordem.size() < topologia.size(); i++) {
+                for (const std::vector<int>& grupo : porNo) {
+                    if (i < grupo.size()) {
+                        ordem.push_back(grupo[i]);
+                    }
+                }
+            }
+        }
+    } else if (!interpretarListaCpus(modo, ordem)) {
+        std::cerr << "Erro: Valor inválido para --pin: " << modo
+                  << " (use compact, scatter ou uma lista como 0,2,4-7)" << std::endl;
+        return false;
+    }
+
+    for (int t = 0; t < numTrabalhadores; t++) {
+        cpus.push_back(ordem[t % ordem.size()]);
+    }
+    return true;
+}
+
+// Fixa a thread chamadora em uma CPU
+inline bool fixarNaCpu(int cpu) {
+    cpu_set_t mascara;
+    CPU_ZERO(&mascara);
+    CPU_SET(cpu, &mascara);
+    return sched_setaffinity(0, sizeof(mascara), &mascara) == 0;
+}
+
+const int POLITICA_NUMA_INTERCALAR = 3;  // MPOL_INTERLEAVE de <numaif.h>
+
+// Aplica --numa ao processo (e às threads/filhos criados depois).
+// Em máquinas sem NUMA a política é aceita, mas não tem efeito.
+inline bool aplicarPoliticaNuma(const std::string& modo) {
+    if (modo.empty() || modo == "local") {
+        // A política padrão já aloca no nó de quem toca a página primeiro
+        return true;
+    }
+    if (modo != "interleave") {
+        std::cerr << "Erro: Valor inválido para --numa: " << modo
+                  << " (use interleave ou local)" << std::endl;
+        return false;
+    }
+
+    unsigned long mascaraNos = 0;
+    int maiorNo = 0;
+    std::vector<CpuLogica> topologia = lerTopologia();
+    for (const CpuLogica& c : topologia) {
+        if (c.no < (int)(8 * sizeof(mascaraNos))) {
+            mascaraNos |= 1UL << c.no;
+            maiorNo = std::max(maiorNo, c.no);
+        }
+    }
+    if (mascaraNos == 0) {
+        mascaraNos = 1;
+    }
+
+    if (syscall(SYS_set_mempolicy, POLITICA_NUMA_INTERCALAR, &mascaraNos, maiorNo + 2) != 0) {
+        std::cerr << "Aviso: set_mempolicy(MPOL_INTERLEAVE) falhou; usando a política padrão" << std::endl;
+    }
+    return true;
+}
+
+inline int noDaCpu(int cpu) {
+    std::vector<int> nos = lerNosDasCpus(cpu);
+    return nos[cpu];
+}
+
+inline void imprimirAfinidade(const std::vector<int>& cpus, const char* rotulo) {
+    for (size_t t = 0; t < cpus.size(); t++) {
+        std::printf("%s %d -> CPU %d (nó %d)\n", rotulo, (int)t, cpus[t], noDaCpu(cpus[t]));
+    }
+}
+
+#endif
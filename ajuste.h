@@ -0,0 +1,238 @@
+#ifndef AJUSTE_H
+#define AJUSTE_H
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "gemm.h"
+#include "opcoes.h"
+
+/**
+ * Cache de ajuste automático (ver benchmark_multiplicacao --autotune).
+ *
+ * O --autotune mede, para cada tamanho, os tamanhos de bloco (--mc, --kc,
+ * --nc, --tile), o número de trabalhadores P e o backend (sequencial,
+ * threads ou processos) e guarda a melhor configuração de cada backend em
+ * um arquivo texto, uma linha por entrada, separada por tabulações. A chave
+ * é o modelo da CPU (com o número de CPUs disponíveis) e a classe do
+ * tamanho: a menor potência de dois >= N, a partir de 64. A entrada do
+ * backend mais rápido da classe é marcada como a melhor.
+ *
+ * Os três programas de multiplicação consultam o cache (--ajuste=ARQUIVO,
+ * padrão ajuste_multiplicacao.cache no diretório atual; --ajuste=nao o
+ * desliga). Threads e processos o usam quando P é omitido, e o sequencial
+ * sempre, para os tamanhos de bloco. Opções dadas na linha de comando têm
+ * precedência sobre o cache. Sem entrada para a CPU e a classe, P é o
+ * número de CPUs e os blocos ficam nos padrões.
+ */
+
+const char* const ARQUIVO_AJUSTE_PADRAO = "ajuste_multiplicacao.cache";
+
+struct EntradaAjuste {
+    std::string cpu;
+    int classe;
+    std::string backend;
+    int p;
+    ParametrosBloco blocos;
+    double gflops;
+    bool melhor;  // backend mais rápido desta CPU e classe
+};
+
+// Modelo da CPU (/proc/cpuinfo) e número de CPUs disponíveis, chave do cache
+inline std::string identificacaoCpu() {
+    std::string modelo = "desconhecida";
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string linha;
+    while (std::getline(cpuinfo, linha)) {
+        if (linha.compare(0, 10, "model name") == 0 && linha.find(':') != std::string::npos) {
+            modelo = linha.substr(linha.find(':') + 1);
+            modelo.erase(0, modelo.find_first_not_of(" \t"));
+            break;
+        }
+    }
+    return modelo + " (" + std::to_string(sysconf(_SC_NPROCESSORS_ONLN)) + " CPUs)";
+}
+
+// Menor potência de dois >= n, a partir de 64
+inline int classeTamanho(int n) {
+    int classe = 64;
+    while (classe < n) {
+        classe *= 2;
+    }
+    return classe;
+}
+
+inline std::string descreverBlocos(const ParametrosBloco& b) {
+    return "--mc=" + std::to_string(b.mc) + " --kc=" + std::to_string(b.kc) + " --nc=" + std::to_string(b.nc) +
+           " --tile=" + std::to_string(b.tileLinhas) + "x" + std::to_string(b.tileColunas);
+}
+
+class CacheAjuste {
+private:
+    std::vector<EntradaAjuste> entradas;
+
+    static bool interpretar(const std::string& linha, EntradaAjuste& e) {
+        std::vector<std::string> campos;
+        std::stringstream ss(linha);
+        std::string campo;
+        while (std::getline(ss, campo, '\t')) {
+            campos.push_back(campo);
+        }
+        if (campos.size() != 10) {
+            return false;
+        }
+        e.cpu = campos[0];
+        e.classe = atoi(campos[1].c_str());
+        e.backend = campos[2];
+        e.p = atoi(campos[3].c_str());
+        e.blocos.mc = atoi(campos[4].c_str());
+        e.blocos.kc = atoi(campos[5].c_str());
+        e.blocos.nc = atoi(campos[6].c_str());
+        e.blocos.tileLinhas = atoi(campos[7].c_str());
+        size_t x = campos[7].find('x');
+        e.blocos.tileColunas = x == std::string::npos ? 0 : atoi(campos[7].c_str() + x + 1);
+        e.gflops = atof(campos[8].c_str());
+        e.melhor = campos[9] == "sim";
+        return e.classe > 0 && e.p > 0 && e.blocos.mc > 0 && e.blocos.kc > 0 && e.blocos.nc > 0 &&
+               e.blocos.tileLinhas > 0 && e.blocos.tileColunas > 0;
+    }
+
+public:
+    // Um arquivo inexistente é um cache vazio; linhas inválidas são ignoradas com aviso
+    bool carregar(const std::string& nomeArquivo) {
+        entradas.clear();
+        std::ifstream arquivo(nomeArquivo);
+        if (!arquivo.is_open()) {
+            return false;
+        }
+        std::string linha;
+        int numero = 0;
+        while (std::getline(arquivo, linha)) {
+            numero++;
+            if (linha.empty() || linha[0] == '#') {
+                continue;
+            }
+            EntradaAjuste e;
+            if (interpretar(linha, e)) {
+                entradas.push_back(e);
+            } else {
+                std::cerr << "Aviso: Linha " << numero << " inválida em " << nomeArquivo << " (ignorada)" << std::endl;
+            }
+        }
+        return true;
+    }
+
+    bool salvar(const std::string& nomeArquivo) const {
+        std::ofstream arquivo(nomeArquivo);
+        if (!arquivo.is_open()) {
+            std::cerr << "Erro ao criar arquivo: " << nomeArquivo << std::endl;
+            return false;
+        }
+        arquivo << "# cpu\tclasse\tbackend\tp\tmc\tkc\tnc\ttile\tgflops\tmelhor\n";
+        for (const EntradaAjuste& e : entradas) {
+            char gflops[32];
+            std::snprintf(gflops, sizeof(gflops), "%.2f", e.gflops);
+            arquivo << e.cpu << "\t" << e.classe << "\t" << e.backend << "\t" << e.p << "\t" << e.blocos.mc << "\t"
+                    << e.blocos.kc << "\t" << e.blocos.nc << "\t" << e.blocos.tileLinhas << "x"
+                    << e.blocos.tileColunas << "\t" << gflops << "\t" << (e.melhor ? "sim" : "nao") << "\n";
+        }
+        return arquivo.good();
+    }
+
+    const EntradaAjuste* buscar(const std::string& cpu, int classe, const std::string& backend) const {
+        for (const EntradaAjuste& e : entradas) {
+            if (e.cpu == cpu && e.classe == classe && e.backend == backend) {
+                return &e;
+            }
+        }
+        return nullptr;
+    }
+
+    // Melhor backend desta CPU e classe, se houver
+    const EntradaAjuste* melhor(const std::string& cpu, int classe) const {
+        for (const EntradaAjuste& e : entradas) {
+            if (e.cpu == cpu && e.classe == classe && e.melhor) {
+                return &e;
+            }
+        }
+        return nullptr;
+    }
+
+    // Substitui as entradas da mesma CPU e classe pelas novas (uma por backend)
+    void registrar(const std::vector<EntradaAjuste>& novas) {
+        for (const EntradaAjuste& n : novas) {
+            for (size_t i = 0; i < entradas.size();) {
+                if (entradas[i].cpu == n.cpu && entradas[i].classe == n.classe) {
+                    entradas.erase(entradas.begin() + i);
+                } else {
+                    i++;
+                }
+            }
+        }
+        entradas.insert(entradas.end(), novas.begin(), novas.end());
+    }
+};
+
+// Arquivo do cache de --ajuste=ARQUIVO|nao; vazio se desligado
+inline std::string arquivoAjuste(const Opcoes& opcoes) {
+    std::string arquivo = opcoes.texto("ajuste", ARQUIVO_AJUSTE_PADRAO);
+    return arquivo == "nao" ? "" : arquivo;
+}
+
+// Aplica o cache a um programa de multiplicação. `p` é o número de
+// trabalhadores dado na linha de comando, ou 0 se omitido (o sequencial
+// passa 0 e ignora o valor devolvido). Os blocos dados com --mc, --kc,
+// --nc e --tile são mantidos.
+inline void aplicarAjuste(const Opcoes& opcoes, const std::string& backend, int dimensao, int& p,
+                          ParametrosBloco& blocos) {
+    bool omitido = p <= 0;
+    std::string arquivo = arquivoAjuste(opcoes);
+    CacheAjuste cache;
+    const EntradaAjuste* e = nullptr;
+    if (dimensao > 0 && !arquivo.empty() && (omitido || backend == "sequencial") && cache.carregar(arquivo)) {
+        e = cache.buscar(identificacaoCpu(), classeTamanho(dimensao), backend);
+    }
+    if (e == nullptr) {
+        if (omitido && backend != "sequencial") {
+            p = std::max(1, (int)sysconf(_SC_NPROCESSORS_ONLN));
+            std::cout << "Sem ajuste em cache para esta CPU e tamanho; usando P = " << p
+                      << " (ver benchmark_multiplicacao --autotune)" << std::endl;
+        }
+        return;
+    }
+
+    if (omitido) {
+        p = e->p;
+    }
+    if (!opcoes.tem("mc")) {
+        blocos.mc = e->blocos.mc;
+    }
+    if (!opcoes.tem("kc")) {
+        blocos.kc = e->blocos.kc;
+    }
+    if (!opcoes.tem("nc")) {
+        blocos.nc = e->blocos.nc;
+    }
+    if (!opcoes.tem("tile")) {
+        blocos.tileLinhas = e->blocos.tileLinhas;
+        blocos.tileColunas = e->blocos.tileColunas;
+    }
+    std::cout << "Ajuste em cache (" << arquivo << ", N <= " << e->classe << "): ";
+    if (backend != "sequencial") {
+        std::cout << "P = " << p << ", ";
+    }
+    std::cout << descreverBlocos(blocos) << std::endl;
+    const EntradaAjuste* m = cache.melhor(e->cpu, e->classe);
+    if (m != nullptr && m->backend != backend) {
+        std::printf("Nesta classe, o backend mais rápido medido foi %s com P = %d (%.2f contra %.2f GFLOP/s)\n",
+                    m->backend.c_str(), m->p, m->gflops, e->gflops);
+    }
+}
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef ALEATORIO_H
+#define ALEATORIO_H
+
+#include <cstdint>
+#include <random>
+
+/**
+ * Números aleatórios baseados em contador (Philox4x32-10, de Salmon et al.,
+ * "Parallel Random Numbers: As Easy as 1, 2, 3", SC 2011).
+ *
+ * Cada bloco de quatro palavras de 32 bits é uma função pura de um contador
+ * de 128 bits e de uma chave de 64 bits (a semente). O gerador de matrizes
+ * usa como contador o índice do elemento (i * colunas + j) e o número da
+ * matriz, de modo que qualquer bloco de linhas pode ser gerado sozinho, por
+ * qualquer thread e em qualquer ordem, sempre com os mesmos valores para a
+ * mesma semente.
+ */
+
+struct BlocoPhilox {
+    uint32_t x[4];
+};
+
+inline void multiplicarAltoBaixo(uint32_t a, uint32_t b, uint32_t& alto, uint32_t& baixo) {
+    uint64_t produto = (uint64_t)a * b;
+    alto = (uint32_t)(produto >> 32);
+    baixo = (uint32_t)produto;
+}
+
+// Philox4x32 com 10 rodadas
+inline BlocoPhilox philox4x32(const uint32_t contador[4], const uint32_t chave[2]) {
+    uint32_t x0 = contador[0], x1 = contador[1], x2 = contador[2], x3 = contador[3];
+    uint32_t k0 = chave[0], k1 = chave[1];
+    for (int rodada = 0; rodada < 10; rodada++) {
+        uint32_t alto0, baixo0, alto1, baixo1;
+        multiplicarAltoBaixo(0xD2511F53u, x0, alto0, baixo0);
+        multiplicarAltoBaixo(0xCD9E8D57u, x2, alto1, baixo1);
+        x0 = alto1 ^ x1 ^ k0;
+        x1 = baixo1;
+        x2 = alto0 ^ x3 ^ k1;
+        x3 = baixo0;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    BlocoPhilox bloco = { { x0, x1, x2, x3 } };
+    return bloco;
+}
+
+// Sequência de uma matriz (ou de outro uso) identificada por `fluxo`, para uma semente
+class FluxoAleatorio {
+private:
+    uint32_t chave[2];
+    uint32_t fluxo;
+
+    // Inteiro uniforme em [0, n) a partir de 32 bits aleatórios
+    static uint32_t reduzir(uint32_t palavra, uint32_t n) {
+        return (uint32_t)(((uint64_t)palavra * n) >> 32);
+    }
+
+public:
+    FluxoAleatorio(uint64_t semente, uint32_t numeroFluxo) : fluxo(numeroFluxo) {
+        chave[0] = (uint32_t)semente;
+        chave[1] = (uint32_t)(semente >> 32);
+    }
+
+    BlocoPhilox bloco(uint64_t indice) const {
+        uint32_t contador[4] = { (uint32_t)indice, (uint32_t)(indice >> 32), fluxo, 0 };
+        return philox4x32(contador, chave);
+    }
+
+    // Valor do elemento `indice` em centésimos, uniforme em [100, 10000)
+    // (de 1,00 a 99,99), ou 0 com probabilidade 1 - densidade
+    int centesimos(uint64_t indice, double densidade = 1.0) const {
+        BlocoPhilox b = bloco(indice);
+        if (densidade < 1.0 && b.x[1] >= (uint32_t)(densidade * 4294967296.0)) {
+            return 0;
+        }
+        return 100 + (int)reduzir(b.x[0], 9900);
+    }
+
+    // Inteiro uniforme em [minimo, maximo] para o elemento `indice`
+    int inteiro(uint64_t indice, int minimo, int maximo) const {
+        return minimo + (int)reduzir(bloco(indice).x[0], (uint32_t)(maximo - minimo + 1));
+    }
+};
+
+// Semente para quando --seed não é dada (impressa pelo gerador, para repetir a execução)
+inline uint64_t sementeAleatoria() {
+    std::random_device rd;
+    return ((uint64_t)rd() << 32) | rd();
+}
+
+#endif
@@ -1,3 +1,4 @@
+import os
 import pandas as pd
 import matplotlib.pyplot as plt
 import numpy as np
@@ -32,6 +33,74 @@ def carregar_dados():
         print(f"Erro ao carregar dados: {e}")
         return None, None
 
+def carregar_bench(arquivo='resultados_bench.csv'):
+    """Carrega os resultados do benchmark_multiplicacao (make bench), se existirem"""
+    if not os.path.exists(arquivo):
+        return None
+    df = pd.read_csv(arquivo)
+    print("Dados do benchmark:")
+    print(df)
+    print()
+    return df
+
+def gerar_grafico_bench(df):
+    """Gera gráficos do benchmark: mediana com barra até o p95 e speedup por P"""
+    
+    paralelos = df[df['Backend'] != 'sequencial']
+    tamanhos = sorted(paralelos['Tamanho'].unique())
+    if len(tamanhos) == 0:
+        return
+    
+    fig, (ax1, ax2) = plt.subplots(1, 2, figsize=(15, 6))
+    
+    for (tamanho, backend), grupo in paralelos.groupby(['Tamanho', 'Backend']):
+        grupo = grupo.sort_values('P')
+        marcador = 'o-' if backend == 'threads' else 's-'
+        rotulo = f'{backend} N={tamanho}'
+        # Barra de erro assimétrica: do mínimo ao p95
+        erro = [grupo['Mediana_ms'] - grupo['Min_ms'], grupo['P95_ms'] - grupo['Mediana_ms']]
+        ax1.errorbar(grupo['P'], grupo['Mediana_ms'], yerr=erro, fmt=marcador, label=rotulo,
+                     linewidth=2, markersize=6, capsize=3)
+        if grupo['Speedup'].notna().any():
+            ax2.plot(grupo['P'], grupo['Speedup'], marcador, label=rotulo, linewidth=2, markersize=6)
+    
+    valores_p = sorted(paralelos['P'].unique())
+    ax2.plot(valores_p, valores_p, 'r--', alpha=0.7, label='Speedup Linear Ideal')
+    
+    ax1.set_xlabel('Número de Threads/Processos (P)')
+    ax1.set_ylabel('Mediana (ms), barra do mínimo ao p95')
+    ax1.set_title('Benchmark: Tempo por Multiplicação')
+    ax1.set_yscale('log')
+    ax1.legend()
+    ax1.grid(True, alpha=0.3)
+    
+    ax2.set_xlabel('Número de Threads/Processos (P)')
+    ax2.set_ylabel('Speedup sobre a mediana sequencial (x)')
+    ax2.set_title('Benchmark: Speedup vs Número de P')
+    ax2.legend()
+    ax2.grid(True, alpha=0.3)
+    
+    plt.tight_layout()
+    plt.savefig('grafico_benchmark.png', dpi=300, bbox_inches='tight')
+    plt.close()
+    
+    print("Gráfico do benchmark salvo como: grafico_benchmark.png")
+
+def gerar_tabela_bench(df):
+    """Imprime o resumo do benchmark: melhor P por tamanho e backend"""
+    
+    print("\n" + "="*80)
+    print("BENCHMARK (mediana de várias repetições no mesmo processo)")
+    print("="*80)
+    
+    for (tamanho, backend), grupo in df.groupby(['Tamanho', 'Backend']):
+        melhor = grupo.loc[grupo['Mediana_ms'].idxmin()]
+        linha = (f"N={tamanho:5d} {backend:10s} melhor P={int(melhor['P']):3d}: "
+                 f"{melhor['Mediana_ms']:10.3f} ms ± {melhor['Desvio_ms']:.3f}, {melhor['GFLOPs']:7.2f} GFLOP/s")
+        if pd.notna(melhor['Speedup']):
+            linha += f", speedup {melhor['Speedup']:.2f}x, eficiência {melhor['Eficiencia']:.2f}"
+        print(linha)
+
 def gerar_grafico_e1(df_e1):
     """Gera gráfico do Experimento E1: Sequencial vs Paralelo"""
     
@@ -162,22 +231,30 @@ def main():
     print()
     
     # Carregar dados
+    df_bench = carregar_bench()
     df_e1, df_e2 = carregar_dados()
     
-    if df_e1 is None or df_e2 is None:
+    if df_bench is None and (df_e1 is None or df_e2 is None):
         print("Erro: Não foi possível carregar os dados dos experimentos.")
         return
     
     print("Gerando gráficos...")
-    gerar_grafico_e1(df_e1)
-    gerar_grafico_e2(df_e2)
-
-    gerar_tabela_comparativa(df_e1, df_e2)
+    arquivos = []
+    if df_bench is not None:
+        gerar_grafico_bench(df_bench)
+        gerar_tabela_bench(df_bench)
+        arquivos.append("grafico_benchmark.png")
+    
+    if df_e1 is not None and df_e2 is not None:
+        gerar_grafico_e1(df_e1)
+        gerar_grafico_e2(df_e2)
+        gerar_tabela_comparativa(df_e1, df_e2)
+        arquivos += ["grafico_experimento_e1.png", "grafico_experimento_e2.png"]
     
     print("\nAnálise concluída!")
     print("Arquivos gerados:")
-    print("- grafico_experimento_e1.png")
-    print("- grafico_experimento_e2.png")
+    for arquivo in arquivos:
+        print(f"- {arquivo}")
 
 if __name__ == "__main__":
     main()
@@ -0,0 +1,533 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "afinidade.h"
+#include "ajuste.h"
+#include "aleatorio.h"
+#include "matriz.h"
+#include "multiplicacao.h"
+#include "opcoes.h"
+
+using namespace std;
+
+/**
+ * Benchmark dos três programas de multiplicação em um único processo.
+ *
+ * Para cada tamanho, A e B são carregadas uma única vez (em memória
+ * compartilhada, para que o pool de processos também as use). Para cada
+ * backend e valor de P, o pool é criado uma vez, executa as multiplicações
+ * de aquecimento e depois as repetições medidas com relógio em nanossegundos.
+ * O resultado (mínimo, mediana, p95, média, desvio padrão, GFLOP/s, speedup e
+ * eficiência em relação à mediana sequencial) vai para CSV e JSON.
+ *
+ * Com --autotune, em vez do benchmark, busca para cada tamanho a melhor
+ * configuração de cada backend e grava no cache de ajuste (ver ajuste.h).
+ * A busca é por coordenadas: primeiro P com os blocos padrão, depois kc,
+ * mc, nc e o tile, um de cada vez, e por fim P de novo com os blocos
+ * escolhidos. Cada configuração é medida pela mediana das repetições, e um
+ * candidato só substitui o atual se for pelo menos MARGEM_AJUSTE mais
+ * rápido, para que o ruído das medições não decida a escolha. A
+ * configuração atual é medida de novo no início de cada varredura e no
+ * fim, e o GFLOP/s gravado vem dessa última medição.
+ */
+
+struct Estatisticas {
+    double minimo;
+    double mediana;
+    double p95;
+    double media;
+    double desvio;
+};
+
+struct Medicao {
+    int tamanho;
+    string backend;
+    int p;
+    Estatisticas ms;
+    double gflops;
+    double speedup;     // < 0 se não houver referência sequencial
+    double eficiencia;
+};
+
+// Estatísticas de amostras em nanossegundos, convertidas para milissegundos
+Estatisticas calcularEstatisticas(vector<double> amostras) {
+    sort(amostras.begin(), amostras.end());
+    size_t n = amostras.size();
+    Estatisticas e;
+    e.minimo = amostras.front();
+    e.mediana = n % 2 ? amostras[n / 2] : (amostras[n / 2 - 1] + amostras[n / 2]) / 2.0;
+    // p95 pelo método do posto mais próximo
+    e.p95 = amostras[(size_t)ceil(0.95 * n) - 1];
+    double soma = 0.0;
+    for (double a : amostras) {
+        soma += a;
+    }
+    e.media = soma / n;
+    double quadrados = 0.0;
+    for (double a : amostras) {
+        quadrados += (a - e.media) * (a - e.media);
+    }
+    e.desvio = n > 1 ? sqrt(quadrados / (n - 1)) : 0.0;
+
+    e.minimo /= 1e6;
+    e.mediana /= 1e6;
+    e.p95 /= 1e6;
+    e.media /= 1e6;
+    e.desvio /= 1e6;
+    return e;
+}
+
+// Executa `aquecimento` chamadas descartadas e devolve o tempo (ns) de cada repetição
+vector<double> medir(int aquecimento, int repeticoes, const function<bool()>& executar) {
+    vector<double> amostras;
+    for (int r = 0; r < aquecimento; r++) {
+        if (!executar()) {
+            return vector<double>();
+        }
+    }
+    for (int r = 0; r < repeticoes; r++) {
+        auto inicio = chrono::steady_clock::now();
+        bool ok = executar();
+        auto fim = chrono::steady_clock::now();
+        if (!ok) {
+            return vector<double>();
+        }
+        amostras.push_back((double)chrono::duration_cast<chrono::nanoseconds>(fim - inicio).count());
+    }
+    return amostras;
+}
+
+// Amostras de um backend com P trabalhadores; o pool é criado uma vez para todas
+vector<double> amostrarBackend(const string& backend, int p, const vector<int>& cpus, const ParametrosBloco& blocos,
+                               const ParametrosStrassen& algo, const MatrizDensa& a, const MatrizDensa& b,
+                               MatrizDensa& c, int aquecimento, int repeticoes) {
+    if (backend == "sequencial") {
+        BuffersGemm buffers;
+        return medir(aquecimento, repeticoes, [&]() {
+            multiplicarSequencial(a, b, c, blocos, algo, buffers);
+            return true;
+        });
+    }
+    if (backend == "threads") {
+        PoolThreads pool(p, cpus);
+        MultiplicadorThreads multiplicador(pool);
+        return medir(aquecimento, repeticoes, [&]() {
+            multiplicador.multiplicar(a, b, c, blocos, algo, false);
+            return true;
+        });
+    }
+    PoolProcessos pool(p, cpus);
+    return medir(aquecimento, repeticoes, [&]() {
+        return pool.ok() && multiplicarComProcessos(a, b, c, pool, blocos, algo, false);
+    });
+}
+
+// Ganho mínimo para o --autotune trocar de configuração
+const double MARGEM_AJUSTE = 0.03;
+
+// Estado da busca do --autotune para um backend e um tamanho
+struct BuscaAjuste {
+    const Opcoes& opcoes;
+    const MatrizDensa& a;
+    const MatrizDensa& b;
+    MatrizDensa& c;
+    string backend;
+    int aquecimento;
+    int repeticoes;
+    int p;
+    ParametrosBloco blocos;
+    double mediana;  // ms da configuração atual; < 0 antes da primeira medição
+    int medidas;
+
+    BuscaAjuste(const Opcoes& o, const MatrizDensa& ma, const MatrizDensa& mb, MatrizDensa& mc, const string& nome,
+                int aq, int rep)
+        : opcoes(o), a(ma), b(mb), c(mc), backend(nome), aquecimento(aq), repeticoes(rep), p(1), mediana(-1.0),
+          medidas(0) {}
+
+    // Mede a configuração candidata e a adota se for mais rápida (ou, com
+    // `referencia`, apenas atualiza a mediana da atual); false em caso de erro
+    bool tentar(int candidatoP, const ParametrosBloco& candidatos, bool referencia = false) {
+        vector<int> cpus;
+        if (!planejarAfinidade(opcoes.texto("pin", ""), candidatoP, cpus)) {
+            return false;
+        }
+        vector<double> amostras = amostrarBackend(backend, candidatoP, cpus, candidatos, ParametrosStrassen(), a, b,
+                                                  c, aquecimento, repeticoes);
+        if (amostras.empty()) {
+            cerr << "Erro: Falha ao medir " << backend << " com P = " << candidatoP << endl;
+            return false;
+        }
+        double ms = calcularEstatisticas(amostras).mediana;
+        medidas++;
+        bool adotar = referencia || mediana < 0.0 || ms < mediana * (1.0 - MARGEM_AJUSTE);
+        printf("  %s P=%d %s: mediana %.3f ms%s\n", backend.c_str(), candidatoP, descreverBlocos(candidatos).c_str(),
+               ms, referencia ? " (atual)" : adotar ? " *" : "");
+        fflush(stdout);
+        if (adotar) {
+            p = candidatoP;
+            blocos = candidatos;
+            mediana = ms;
+        }
+        return true;
+    }
+
+    // Remede a configuração atual antes de cada varredura: a máquina muda ao
+    // longo da busca, e uma medição antiga com sorte barraria bons candidatos
+    bool remedir() {
+        return tentar(p, blocos, true);
+    }
+
+    bool buscarP(const vector<int>& valoresP) {
+        if (mediana >= 0.0 && !remedir()) {
+            return false;
+        }
+        int atual = p;
+        for (int candidato : valoresP) {
+            if ((candidato != atual || mediana < 0.0) && candidato <= a.getLinhas() && !tentar(candidato, blocos)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Varre um dos tamanhos de bloco; valores que dão o mesmo bloco efetivo
+    // que o atual (maiores que a matriz) não são medidos
+    bool buscarBloco(int ParametrosBloco::*campo, const vector<int>& valores) {
+        if (!remedir()) {
+            return false;
+        }
+        int n = a.getLinhas();
+        int atual = blocos.*campo;
+        for (int v : valores) {
+            if (min(v, n) == min(atual, n)) {
+                continue;
+            }
+            ParametrosBloco candidatos = blocos;
+            candidatos.*campo = v;
+            if (!tentar(p, candidatos)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool buscarTile() {
+        static const int tiles[][2] = { { 64, 256 }, { 96, 256 }, { 192, 512 }, { 384, 512 }, { 192, 1024 } };
+        if (!remedir()) {
+            return false;
+        }
+        int n = a.getLinhas();
+        ParametrosBloco atual = blocos;
+        for (const int* t : tiles) {
+            if (min(t[0], n) == min(atual.tileLinhas, n) && min(t[1], n) == min(atual.tileColunas, n)) {
+                continue;
+            }
+            ParametrosBloco candidatos = blocos;
+            candidatos.tileLinhas = t[0];
+            candidatos.tileColunas = t[1];
+            if (!tentar(p, candidatos)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// --autotune: ajusta cada backend para cada tamanho e grava o cache
+bool autoajustar(const Opcoes& opcoes, const vector<int>& tamanhos, const vector<string>& backends,
+                 int aquecimento, int repeticoes) {
+    string arquivo = arquivoAjuste(opcoes);
+    if (arquivo.empty()) {
+        cerr << "Erro: --autotune precisa de um arquivo de cache (--ajuste=ARQUIVO)" << endl;
+        return false;
+    }
+
+    // P: potências de dois até o dobro das CPUs, e o número de CPUs
+    int numCpus = max(1, (int)sysconf(_SC_NPROCESSORS_ONLN));
+    vector<int> valoresP;
+    if (opcoes.tem("p")) {
+        valoresP = opcoes.listaInteiros("p", "");
+    } else {
+        for (int p = 1; p <= 2 * numCpus; p *= 2) {
+            valoresP.push_back(p);
+        }
+        if (find(valoresP.begin(), valoresP.end(), numCpus) == valoresP.end()) {
+            valoresP.push_back(numCpus);
+        }
+        sort(valoresP.begin(), valoresP.end());
+    }
+    const vector<int> valoresKc = { 128, 192, 256, 384, 512 };
+    const vector<int> valoresMc = { 48, 96, 144, 192, 288 };
+    const vector<int> valoresNc = { 512, 1024, 2048, 4096 };
+
+    string cpu = identificacaoCpu();
+    CacheAjuste cache;
+    cache.carregar(arquivo);
+    cout << "Ajuste automático para " << cpu << ": " << aquecimento << " aquecimento(s) e " << repeticoes
+         << " repetição(ões) por configuração" << endl;
+
+    for (int n : tamanhos) {
+        // Os valores não influem no tempo; as matrizes são geradas na memória
+        MatrizDensa a(n, n, true, nomeCompartilhadoUnico("ajuste"));
+        MatrizDensa b(n, n, true, nomeCompartilhadoUnico("ajuste"));
+        MatrizDensa c(n, n, true, nomeCompartilhadoUnico("ajuste"));
+        FluxoAleatorio fluxoA(1, 0), fluxoB(1, 1);
+        for (int i = 0; i < n; i++) {
+            double* linhaA = a.linha(i);
+            double* linhaB = b.linha(i);
+            for (int j = 0; j < n; j++) {
+                linhaA[j] = fluxoA.centesimos((uint64_t)i * n + j) / 100.0;
+                linhaB[j] = fluxoB.centesimos((uint64_t)i * n + j) / 100.0;
+            }
+        }
+
+        cout << "N=" << n << " (classe N <= " << classeTamanho(n) << ")" << endl;
+        vector<EntradaAjuste> entradas;
+        for (const string& backend : backends) {
+            BuscaAjuste busca(opcoes, a, b, c, backend, aquecimento, repeticoes);
+            bool paralelo = backend != "sequencial";
+            bool ok = busca.buscarP(paralelo ? valoresP : vector<int>(1, 1)) &&
+                      busca.buscarBloco(&ParametrosBloco::kc, valoresKc) &&
+                      busca.buscarBloco(&ParametrosBloco::mc, valoresMc) &&
+                      busca.buscarBloco(&ParametrosBloco::nc, valoresNc) && (!paralelo || busca.buscarTile()) &&
+                      (!paralelo || busca.buscarP(valoresP)) && busca.remedir();
+            if (!ok) {
+                return false;
+            }
+
+            EntradaAjuste e;
+            e.cpu = cpu;
+            e.classe = classeTamanho(n);
+            e.backend = backend;
+            e.p = busca.p;
+            e.blocos = busca.blocos;
+            e.gflops = 2.0 * n * n * n / (busca.mediana * 1e6);
+            e.melhor = false;
+            entradas.push_back(e);
+            printf("N=%d %s: P=%d %s, mediana %.3f ms, %.2f GFLOP/s (%d configurações)\n", n, backend.c_str(), e.p,
+                   descreverBlocos(e.blocos).c_str(), busca.mediana, e.gflops, busca.medidas);
+        }
+
+        size_t melhor = 0;
+        for (size_t i = 1; i < entradas.size(); i++) {
+            if (entradas[i].gflops > entradas[melhor].gflops) {
+                melhor = i;
+            }
+        }
+        entradas[melhor].melhor = true;
+        printf("N=%d: melhor backend %s com P = %d\n", n, entradas[melhor].backend.c_str(), entradas[melhor].p);
+        cache.registrar(entradas);
+    }
+
+    if (!cache.salvar(arquivo)) {
+        return false;
+    }
+    cout << "Cache de ajuste salvo em: " << arquivo << endl;
+    return true;
+}
+
+bool salvarCsv(const string& nomeArquivo, const vector<Medicao>& medicoes) {
+    ofstream arquivo(nomeArquivo);
+    if (!arquivo.is_open()) {
+        cerr << "Erro ao criar arquivo: " << nomeArquivo << endl;
+        return false;
+    }
+    arquivo << "Tamanho,Backend,P,Min_ms,Mediana_ms,P95_ms,Media_ms,Desvio_ms,GFLOPs,Speedup,Eficiencia\n";
+    arquivo << fixed << setprecision(6);
+    for (const Medicao& m : medicoes) {
+        arquivo << m.tamanho << "," << m.backend << "," << m.p << ","
+                << m.ms.minimo << "," << m.ms.mediana << "," << m.ms.p95 << ","
+                << m.ms.media << "," << m.ms.desvio << "," << m.gflops << ",";
+        if (m.speedup >= 0.0) {
+            arquivo << m.speedup << "," << m.eficiencia;
+        } else {
+            arquivo << ",";
+        }
+        arquivo << "\n";
+    }
+    return true;
+}
+
+bool salvarJson(const string& nomeArquivo, const vector<Medicao>& medicoes, const Opcoes& opcoes,
+                int aquecimento, int repeticoes, const ParametrosStrassen& algo) {
+    ofstream arquivo(nomeArquivo);
+    if (!arquivo.is_open()) {
+        cerr << "Erro ao criar arquivo: " << nomeArquivo << endl;
+        return false;
+    }
+    arquivo << fixed << setprecision(6);
+    arquivo << "{\n  \"configuracao\": {\"kernel\": \"" << microKernel().nome << "\", "
+            << "\"algoritmo\": \"" << algo.nome() << "\", \"crossover\": " << algo.crossover << ", "
+            << "\"aquecimento\": " << aquecimento << ", \"repeticoes\": " << repeticoes << ", "
+            << "\"cpus\": " << sysconf(_SC_NPROCESSORS_ONLN) << ", "
+            << "\"pin\": \"" << opcoes.texto("pin", "") << "\", \"numa\": \"" << opcoes.texto("numa", "") << "\"},\n"
+            << "  \"resultados\": [\n";
+    for (size_t i = 0; i < medicoes.size(); i++) {
+        const Medicao& m = medicoes[i];
+        arquivo << "    {\"tamanho\": " << m.tamanho << ", \"backend\": \"" << m.backend << "\", \"p\": " << m.p
+                << ", \"min_ms\": " << m.ms.minimo << ", \"mediana_ms\": " << m.ms.mediana
+                << ", \"p95_ms\": " << m.ms.p95 << ", \"media_ms\": " << m.ms.media
+                << ", \"desvio_ms\": " << m.ms.desvio << ", \"gflops\": " << m.gflops;
+        if (m.speedup >= 0.0) {
+            arquivo << ", \"speedup\": " << m.speedup << ", \"eficiencia\": " << m.eficiencia;
+        } else {
+            arquivo << ", \"speedup\": null, \"eficiencia\": null";
+        }
+        arquivo << "}" << (i + 1 < medicoes.size() ? "," : "") << "\n";
+    }
+    arquivo << "  ]\n}\n";
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    Opcoes opcoes(argc, argv);
+    if (!opcoes.aceitarApenas({ParametrosBloco::nomesOpcoes(), ParametrosStrassen::nomesOpcoes(),
+                               "ajuda,ajuste,aquecimento,autotune,backends,csv,fixos,formato,json,kernel",
+                               "numa,p,paginas-grandes,pin,repeticoes,tamanhos"})) {
+        return 1;
+    }
+
+    if (opcoes.numPosicionais() != 0 || opcoes.tem("ajuda")) {
+        cout << "Uso: " << argv[0] << " [opções]" << endl;
+        cout << "Opções: --tamanhos=N1,N2,...             tamanhos das matrizes (padrão 100,200,400,800,1600)" << endl;
+        cout << "        --backends=sequencial,threads,processos" << endl;
+        cout << "        --p=P1,P2,...                  threads/processos (padrão 1,2,4,8)" << endl;
+        cout << "        --aquecimento=N --repeticoes=M   execuções descartadas e medidas (padrão 2 e 10)" << endl;
+        cout << "        --csv=ARQUIVO --json=ARQUIVO     saídas (padrão resultados_bench.csv/.json)" << endl;
+        cout << "        --mc=N --kc=N --nc=N --tile=LxC --kernel=... --fixos=auto|nao --algo=... --crossover=N" << endl;
+        cout << "        --paginas-grandes=auto|thp|hugetlb|nao  páginas grandes para matrizes e buffers" << endl;
+        cout << "        --formato=texto|binario|auto --pin=... --numa=..." << endl;
+        cout << "        --autotune --ajuste=ARQUIVO       busca blocos, P e backend por tamanho e grava o cache" << endl;
+        cout << "                                       (padrão ajuste_multiplicacao.cache; 1 aquecimento e 5 repetições)" << endl;
+        cout << "Exemplo: " << argv[0] << " --tamanhos=400,800 --p=1,2,4 --repeticoes=20" << endl;
+        return 1;
+    }
+
+    vector<int> tamanhos = opcoes.listaInteiros("tamanhos", "100,200,400,800,1600");
+    vector<string> backends = opcoes.lista("backends", "sequencial,threads,processos");
+    vector<int> valoresP = opcoes.listaInteiros("p", "1,2,4,8");
+    bool autotune = opcoes.tem("autotune");
+    int aquecimento = opcoes.inteiro("aquecimento", autotune ? 1 : 2);
+    int repeticoes = opcoes.inteiro("repeticoes", autotune ? 5 : 10);
+    string arquivoCsv = opcoes.texto("csv", "resultados_bench.csv");
+    string arquivoJson = opcoes.texto("json", "resultados_bench.json");
+    ParametrosBloco blocos = ParametrosBloco::deOpcoes(opcoes);
+    ParametrosStrassen algo;
+
+    if (aquecimento < 0 || repeticoes <= 0) {
+        cerr << "Erro: Use --aquecimento >= 0 e --repeticoes > 0." << endl;
+        return 1;
+    }
+    for (int n : tamanhos) {
+        if (n <= 0) {
+            cerr << "Erro: Os tamanhos devem ser positivos." << endl;
+            return 1;
+        }
+    }
+    for (int p : valoresP) {
+        if (p <= 0) {
+            cerr << "Erro: Os valores de P devem ser positivos." << endl;
+            return 1;
+        }
+    }
+    for (const string& b : backends) {
+        if (b != "sequencial" && b != "threads" && b != "processos") {
+            cerr << "Erro: Backend desconhecido: " << b << " (use sequencial, threads ou processos)" << endl;
+            return 1;
+        }
+    }
+    // O sequencial roda primeiro: sua mediana é a referência de speedup
+    stable_partition(backends.begin(), backends.end(), [](const string& b) { return b == "sequencial"; });
+
+    if (!blocos.validar() || !selecionarMicroKernel(opcoes.texto("kernel", "auto")) ||
+        !selecionarKernelsFixos(opcoes.texto("fixos", "auto")) ||
+        !selecionarPaginasGrandes(opcoes.texto("paginas-grandes", "auto")) ||
+        !ParametrosStrassen::deOpcoes(opcoes, algo) || !aplicarPoliticaNuma(opcoes.texto("numa", ""))) {
+        return 1;
+    }
+
+    if (autotune) {
+        return autoajustar(opcoes, tamanhos, backends, aquecimento, repeticoes) ? 0 : 1;
+    }
+
+    cout << "Benchmark: " << aquecimento << " aquecimento(s) e " << repeticoes << " repetição(ões) por configuração" << endl;
+    cout << "Kernel: " << microKernel().nome << endl;
+    imprimirAlgoritmo(algo);
+
+    vector<Medicao> medicoes;
+    for (int n : tamanhos) {
+        string extensao;
+        if (!escolherExtensao(opcoes.texto("formato", "texto"), "matriz_a_" + to_string(n), extensao)) {
+            return 1;
+        }
+
+        // Entradas e saída em memória compartilhada, carregadas uma única vez
+        MatrizDensa a(n, n, true, nomeCompartilhadoUnico("bench"));
+        MatrizDensa b(n, n, true, nomeCompartilhadoUnico("bench"));
+        MatrizDensa c(n, n, true, nomeCompartilhadoUnico("bench"));
+        string arquivoA = "matriz_a_" + to_string(n) + extensao;
+        string arquivoB = "matriz_b_" + to_string(n) + extensao;
+        cout << "Carregando " << arquivoA << " e " << arquivoB << endl;
+        if (!a.carregar(arquivoA) || !b.carregar(arquivoB)) {
+            cerr << "Gere as matrizes com: ./gerador_matrizes " << n << endl;
+            return 1;
+        }
+
+        double flops = 2.0 * n * n * n;
+        double medianaSequencial = -1.0;
+
+        for (const string& backend : backends) {
+            vector<int> ps = backend == "sequencial" ? vector<int>(1, 1) : valoresP;
+            for (int p : ps) {
+                vector<int> cpus;
+                if (!planejarAfinidade(opcoes.texto("pin", ""), p, cpus)) {
+                    return 1;
+                }
+
+                vector<double> amostras = amostrarBackend(backend, p, cpus, blocos, algo, a, b, c, aquecimento,
+                                                          repeticoes);
+                if (amostras.empty()) {
+                    cerr << "Erro: Falha ao medir " << backend << " com P = " << p << endl;
+                    return 1;
+                }
+
+                Medicao m;
+                m.tamanho = n;
+                m.backend = backend;
+                m.p = p;
+                m.ms = calcularEstatisticas(amostras);
+                m.gflops = flops / (m.ms.mediana * 1e6);
+                if (backend == "sequencial") {
+                    medianaSequencial = m.ms.mediana;
+                }
+                m.speedup = medianaSequencial > 0.0 ? medianaSequencial / m.ms.mediana : -1.0;
+                m.eficiencia = m.speedup >= 0.0 ? m.speedup / p : -1.0;
+                medicoes.push_back(m);
+
+                printf("N=%d %s P=%d: mediana %.3f ms (mín %.3f, p95 %.3f, desvio %.3f), %.2f GFLOP/s",
+                       n, backend.c_str(), p, m.ms.mediana, m.ms.minimo, m.ms.p95, m.ms.desvio, m.gflops);
+                if (m.speedup >= 0.0) {
+                    printf(", speedup %.2fx, eficiência %.2f", m.speedup, m.eficiencia);
+                }
+                printf("\n");
+                fflush(stdout);
+            }
+        }
+    }
+
+    if (!salvarCsv(arquivoCsv, medicoes) || !salvarJson(arquivoJson, medicoes, opcoes, aquecimento, repeticoes, algo)) {
+        return 1;
+    }
+    cout << "Resultados salvos em: " << arquivoCsv << " e " << arquivoJson << endl;
+    return 0;
+}
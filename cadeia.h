@@ -0,0 +1,410 @@
+#ifndef CADEIA_H
+#define CADEIA_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "formato_binario.h"
+#include "lote.h"
+#include "matriz.h"
+#include "memoria.h"
+#include "memoria_compartilhada.h"
+#include "microkernel.h"
+#include "opcoes.h"
+#include "rastreamento.h"
+#include "verificacao.h"
+
+/**
+ * Modo em cadeia (--cadeia=LISTA): C = A1 A2 ... An em uma execução.
+ *
+ * LISTA tem os arquivos das matrizes, em ordem e separados por vírgula:
+ * .txt e .bin de qualquer formato (ver formato_texto.h) ou arquivos de lote,
+ * que entram com todas as suas matrizes. A ordem dos produtos é livre, e o
+ * custo varia muito com ela: com 10x100, 100x5 e 5x50, ((A1 A2) A3) custa
+ * 7.500 multiplicações-adições e (A1 (A2 A3)), 75.000. PlanoCadeia escolhe a
+ * parentização de menor custo por programação dinâmica, em O(n³) no número
+ * de matrizes.
+ *
+ * A árvore de produtos é avaliada em etapas: a etapa h tem os produtos de
+ * altura h, que só dependem de etapas anteriores e são independentes entre
+ * si. Cada etapa é entregue ao mesmo KernelLote do modo em lote (ver lote.h
+ * e multiplicacao.h), que divide em tiles os produtos grandes e distribui
+ * os pequenos inteiros entre os trabalhadores. Os intermediários ficam na
+ * memória (compartilhada, no pool de processos) e são alocados uma vez,
+ * antes da medição; só o resultado final é gravado.
+ */
+
+struct ParametrosCadeia {
+    bool ativo;
+    std::vector<std::string> arquivos;
+    std::string formato;  // do resultado: auto (o da primeira matriz), texto ou binario
+
+    ParametrosCadeia() : ativo(false), formato("auto") {}
+
+    // Opções deste grupo, para Opcoes::aceitarApenas
+    static const char* nomesOpcoes() { return "cadeia"; }
+
+    // Lê --cadeia=LISTA e --formato
+    static bool deOpcoes(const Opcoes& opcoes, ParametrosCadeia& p) {
+        p.ativo = opcoes.tem("cadeia");
+        if (!p.ativo) {
+            return true;
+        }
+        p.arquivos = opcoes.lista("cadeia", "");
+        p.formato = opcoes.texto("formato", "auto");
+        if (p.arquivos.empty()) {
+            std::cerr << "Erro: --cadeia precisa da lista de arquivos das matrizes (ex.: --cadeia=a.bin,b.bin,c.bin)"
+                      << std::endl;
+            return false;
+        }
+        if (p.formato != "auto" && p.formato != "texto" && p.formato != "binario") {
+            std::cerr << "Erro: Formato desconhecido: " << p.formato << " (use auto, texto ou binario)" << std::endl;
+            return false;
+        }
+        if (opcoes.tem("lote") || opcoes.tem("fluxo") || opcoes.tem("pipeline") || opcoes.tem("cannon") ||
+            opcoes.texto("algo", "classico") != "classico" || opcoes.texto("dtype", "float64") != "float64" ||
+            opcoes.texto("esparsa", "auto") == "sim") {
+            std::cerr << "Erro: O modo em cadeia usa o algoritmo clássico em float64 e não se combina com --lote, "
+                         "--fluxo, --pipeline, --cannon nem --esparsa=sim"
+                      << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    std::string extensao() const {
+        if (formato == "texto") {
+            return ".txt";
+        }
+        if (formato == "binario") {
+            return ".bin";
+        }
+        return ehArquivoBinario(arquivos[0]) || terminaCom(arquivos[0], ".lote") ? ".bin" : ".txt";
+    }
+};
+
+// Parentização ótima de A1 ... An, com Ai de dims[i - 1] x dims[i]
+class PlanoCadeia {
+private:
+    std::vector<int> dims;
+    int n;
+    std::vector<double> custo;  // multiplicações-adições de Ai..Aj (base 0), em [i * n + j]
+    std::vector<int> corte;     // k do melhor produto (Ai..Ak)(Ak+1..Aj)
+
+    void escrever(int i, int j, std::string& s) const {
+        if (i == j) {
+            s += "A" + std::to_string(i + 1);
+            return;
+        }
+        int k = pontoDeCorte(i, j);
+        s += "(";
+        escrever(i, k, s);
+        s += " ";
+        escrever(k + 1, j, s);
+        s += ")";
+    }
+
+public:
+    // Subcadeias em ordem crescente de comprimento; no empate, o primeiro corte
+    explicit PlanoCadeia(const std::vector<int>& dimensoes)
+        : dims(dimensoes), n((int)dimensoes.size() - 1), custo((size_t)n * n, 0.0), corte((size_t)n * n, -1) {
+        for (int comprimento = 2; comprimento <= n; comprimento++) {
+            for (int i = 0; i + comprimento <= n; i++) {
+                int j = i + comprimento - 1;
+                double& melhor = custo[(size_t)i * n + j];
+                for (int k = i; k < j; k++) {
+                    double c = custo[(size_t)i * n + k] + custo[(size_t)(k + 1) * n + j] +
+                               (double)dims[i] * dims[k + 1] * dims[j + 1];
+                    if (corte[(size_t)i * n + j] < 0 || c < melhor) {
+                        melhor = c;
+                        corte[(size_t)i * n + j] = k;
+                    }
+                }
+            }
+        }
+    }
+
+    int tamanho() const { return n; }
+    int pontoDeCorte(int i, int j) const { return corte[(size_t)i * n + j]; }
+    double custoOtimo() const { return custo[n - 1]; }
+
+    // Custo de ((A1 A2) A3) ..., a ordem de uma sequência de execuções isoladas
+    double custoEsquerdaParaDireita() const {
+        double c = 0.0;
+        for (int j = 1; j < n; j++) {
+            c += (double)dims[0] * dims[j] * dims[j + 1];
+        }
+        return c;
+    }
+
+    std::string parentizacao() const {
+        std::string s;
+        escrever(0, n - 1, s);
+        return s;
+    }
+};
+
+// Fatores, intermediários e resultado de uma cadeia, e os produtos de cada etapa
+class CadeiaMatrizes {
+private:
+    bool compartilhada;  // matrizes descritíveis para o pool de processos
+    std::vector<std::unique_ptr<ArquivoLote>> lotes;
+    std::vector<std::unique_ptr<MatrizDensa>> matrizes;  // lidas de .txt/.bin, intermediárias e o resultado
+    // Nós da árvore: os n fatores e, depois deles, os produtos na ordem em que são montados
+    std::vector<VisaoMatriz> nos;
+    std::vector<DescritorMatriz> descritores;
+    std::vector<std::vector<ProdutoLote>> etapasProdutos;
+    int numFatores;
+    size_t bytesIntermediarios;
+
+    bool adicionarNo(VisaoMatriz v, const DescritorMatriz* d) {
+        nos.push_back(v);
+        descritores.push_back(DescritorMatriz());
+        if (compartilhada) {
+            if (d == nullptr) {
+                std::cerr << "Erro: Matriz fora de memória compartilhada" << std::endl;
+                return false;
+            }
+            descritores.back() = *d;
+        }
+        return true;
+    }
+
+    // Matriz nova de linhas x colunas, em memória compartilhada se preciso
+    MatrizDensa* novaMatriz(int linhas, int colunas, bool sobrescrita) {
+        MatrizDensa* m = compartilhada ? new MatrizDensa(linhas, colunas, true, nomeCompartilhadoUnico("cadeia"))
+                         : sobrescrita ? new MatrizDensa(linhas, colunas, true, SemInicializar())
+                                       : new MatrizDensa(linhas, colunas, true);
+        matrizes.emplace_back(m);
+        return m;
+    }
+
+    bool adicionarMatriz(MatrizDensa& m) {
+        DescritorMatriz d;
+        return adicionarNo(m.visao(), compartilhada && m.descrever(d) ? &d : nullptr);
+    }
+
+    // Monta o produto de Ai..Aj (e os de suas partes); retorna o nó e a altura
+    bool montar(const PlanoCadeia& plano, int i, int j, int& no, int& altura) {
+        if (i == j) {
+            no = i;
+            altura = 0;
+            return true;
+        }
+        int k = plano.pontoDeCorte(i, j);
+        int esquerda, direita, alturaEsquerda, alturaDireita;
+        if (!montar(plano, i, k, esquerda, alturaEsquerda) || !montar(plano, k + 1, j, direita, alturaDireita)) {
+            return false;
+        }
+        altura = std::max(alturaEsquerda, alturaDireita) + 1;
+
+        MatrizDensa& c = *novaMatriz(nos[i].linhas, nos[j].colunas, true);
+        if (i > 0 || j < numFatores - 1) {
+            bytesIntermediarios += (size_t)c.getLinhas() * c.getPasso() * sizeof(double);
+        }
+        if (!adicionarMatriz(c)) {
+            return false;
+        }
+        no = (int)nos.size() - 1;
+
+        ProdutoLote produto;
+        produto.a = nos[esquerda];
+        produto.b = nos[direita];
+        produto.c = nos[no];
+        produto.descA = descritores[esquerda];
+        produto.descB = descritores[direita];
+        produto.descC = descritores[no];
+        if ((int)etapasProdutos.size() < altura) {
+            etapasProdutos.resize(altura);
+        }
+        etapasProdutos[altura - 1].push_back(produto);
+        return true;
+    }
+
+public:
+    explicit CadeiaMatrizes(bool emMemoriaCompartilhada)
+        : compartilhada(emMemoriaCompartilhada), numFatores(0), bytesIntermediarios(0) {}
+
+    CadeiaMatrizes(const CadeiaMatrizes&) = delete;
+    CadeiaMatrizes& operator=(const CadeiaMatrizes&) = delete;
+
+    // Carrega os fatores na ordem da lista e confere se são multiplicáveis
+    bool carregar(const std::vector<std::string>& arquivos) {
+        for (const std::string& arquivo : arquivos) {
+            if (terminaCom(arquivo, ".lote")) {
+                lotes.emplace_back(new ArquivoLote());
+                ArquivoLote& lote = *lotes.back();
+                std::cout << "Carregando lote de: " << arquivo << std::endl;
+                if (!lote.abrir(arquivo)) {
+                    return false;
+                }
+                for (int i = 0; i < lote.tamanhoLote(); i++) {
+                    DescritorMatriz d;
+                    if (!adicionarNo(lote.matriz(i), lote.descrever(i, d) ? &d : nullptr)) {
+                        return false;
+                    }
+                }
+                continue;
+            }
+
+            int linhas, colunas;
+            std::cout << "Carregando matriz A" << nos.size() + 1 << " de: " << arquivo << std::endl;
+            if (!lerFormatoArquivo(arquivo, linhas, colunas)) {
+                return false;
+            }
+            MatrizDensa& m = *novaMatriz(linhas, colunas, false);
+            if (!m.carregar(arquivo) || !adicionarMatriz(m)) {
+                return false;
+            }
+        }
+
+        numFatores = (int)nos.size();
+        if (numFatores < 2) {
+            std::cerr << "Erro: A cadeia precisa de pelo menos duas matrizes" << std::endl;
+            return false;
+        }
+        for (int i = 0; i + 1 < numFatores; i++) {
+            if (nos[i].colunas != nos[i + 1].linhas) {
+                std::cerr << "Erro: Dimensões incompatíveis na cadeia: A" << i + 1 << " é " << nos[i].linhas << "x"
+                          << nos[i].colunas << " e A" << i + 2 << " é " << nos[i + 1].linhas << "x"
+                          << nos[i + 1].colunas << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // dims[0] x dims[1], dims[1] x dims[2], ...
+    std::vector<int> dimensoes() const {
+        std::vector<int> dims;
+        for (int i = 0; i < numFatores; i++) {
+            dims.push_back(nos[i].linhas);
+        }
+        dims.push_back(nos[numFatores - 1].colunas);
+        return dims;
+    }
+
+    // Aloca intermediários e resultado e agrupa os produtos do plano em etapas
+    bool montar(const PlanoCadeia& plano) {
+        int raiz, altura;
+        return montar(plano, 0, numFatores - 1, raiz, altura);
+    }
+
+    const std::vector<std::vector<ProdutoLote>>& etapas() const { return etapasProdutos; }
+    size_t memoriaIntermediarios() const { return bytesIntermediarios; }
+    int tamanho() const { return numFatores; }
+
+    std::vector<VisaoMatrizConst> fatores() const {
+        return std::vector<VisaoMatrizConst>(nos.begin(), nos.begin() + numFatores);
+    }
+
+    // O último produto montado é a raiz da árvore
+    const MatrizDensa& resultado() const { return *matrizes.back(); }
+};
+
+// Verifica C = A1 ... An com Freivalds (ver verificacao.h) e imprime o resultado
+inline bool verificarCadeia(const std::vector<VisaoMatrizConst>& fatores, VisaoMatrizConst c,
+                            const ParametrosVerificacao& p) {
+    auto inicio = std::chrono::steady_clock::now();
+    ResultadoVerificacao r = freivaldsCadeia(fatores, c, p, sementeAleatoria());
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+    std::printf("Verificação (Freivalds, %d vetores, cadeia de %zu matrizes): %s, erro relativo máximo %.2e "
+                "na linha %d (tolerância %.2e), %.1f ms\n",
+                p.vetores, fatores.size(), r.aprovado ? "OK" : "FALHOU", r.erroMaximo, r.linhaErroMaximo,
+                p.toleranciaPara<double>(), ms);
+    return r.aprovado;
+}
+
+// Executa e relata a multiplicação de uma cadeia, `repeticoes` vezes (o
+// tempo relatado é a média). O resultado vai para
+// <prefixo>cadeia_<n><sufixo>.txt (ou .bin)
+inline bool executarCadeia(const ParametrosCadeia& parametros, const std::string& prefixo,
+                           const std::string& sufixo, bool compartilhada, int repeticoes, const KernelLote& kernel,
+                           int numTrabalhadores, const ParametrosVerificacao& verificacao) {
+    auto inicioTotal = std::chrono::steady_clock::now();
+    CadeiaMatrizes cadeia(compartilhada);
+    long long inicioCarga = agoraNs();
+    if (!cadeia.carregar(parametros.arquivos)) {
+        return false;
+    }
+    registrarTrecho("carregar cadeia", inicioCarga, agoraNs());
+
+    std::vector<int> dims = cadeia.dimensoes();
+    PlanoCadeia plano(dims);
+    std::cout << "Cadeia de " << cadeia.tamanho() << " matrizes:";
+    for (int i = 0; i < cadeia.tamanho(); i++) {
+        std::cout << " " << dims[i] << "x" << dims[i + 1];
+    }
+    std::cout << std::endl;
+    std::cout << "Parentização ótima: " << plano.parentizacao() << std::endl;
+    std::printf("Custo: %.4g GFLOP (da esquerda para a direita: %.4g GFLOP, %.2fx)\n", 2e-9 * plano.custoOtimo(),
+                2e-9 * plano.custoEsquerdaParaDireita(), plano.custoEsquerdaParaDireita() / plano.custoOtimo());
+
+    if (!cadeia.montar(plano)) {
+        return false;
+    }
+    const std::vector<std::vector<ProdutoLote>>& etapas = cadeia.etapas();
+    for (size_t e = 0; e < etapas.size(); e++) {
+        std::cout << "Etapa " << e + 1 << ": " << etapas[e].size()
+                  << (etapas[e].size() > 1 ? " produtos independentes (" : " produto (");
+        for (size_t p = 0; p < etapas[e].size(); p++) {
+            const ProdutoLote& produto = etapas[e][p];
+            std::cout << (p > 0 ? ", " : "") << produto.c.linhas << "x" << produto.a.colunas << "x"
+                      << produto.c.colunas;
+        }
+        std::cout << ")" << std::endl;
+    }
+    std::printf("Intermediários na memória: %.1f MiB\n", cadeia.memoriaIntermediarios() / (1024.0 * 1024.0));
+
+    std::cout << "Iniciando multiplicação em cadeia..." << std::endl;
+    std::chrono::duration<double> total(0);
+    long alocacoesAntesUltima = 0;
+    for (int r = 0; r < repeticoes; r++) {
+        if (r == repeticoes - 1) {
+            alocacoesAntesUltima = alocacoesRealizadas();
+        }
+        auto inicioRep = std::chrono::steady_clock::now();
+        {
+            TrechoRastro trecho("multiplicação", r);
+            for (const std::vector<ProdutoLote>& etapa : etapas) {
+                if (!kernel(etapa)) {
+                    return false;
+                }
+            }
+        }
+        auto fimRep = std::chrono::steady_clock::now();
+        total += fimRep - inicioRep;
+        if (repeticoes > 1) {
+            std::printf("Repetição %d: %.3f ms\n", r + 1,
+                        std::chrono::duration<double, std::milli>(fimRep - inicioRep).count());
+        }
+    }
+    double segundos = total.count() / repeticoes;
+
+    const MatrizDensa& resultado = cadeia.resultado();
+    std::string arquivoResultado = prefixo + "cadeia_" + std::to_string(cadeia.tamanho()) + sufixo +
+                                   parametros.extensao();
+    std::cout << "Salvando resultado (" << resultado.getLinhas() << "x" << resultado.getColunas()
+              << ") em: " << arquivoResultado << std::endl;
+    long long inicioSalvar = agoraNs();
+    if (!resultado.salvar(arquivoResultado)) {
+        return false;
+    }
+    registrarTrecho("salvar resultado", inicioSalvar, agoraNs());
+
+    std::cout << "Multiplicação em cadeia concluída!" << std::endl;
+    std::printf("Tempo de execução: %.3f ms\n", segundos * 1000.0);
+    std::printf("Tempo total: %.0f ms (incluindo carregar as matrizes e salvar o resultado)\n",
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicioTotal).count());
+    relatarDesempenho(2.0 * plano.custoOtimo(), segundos, numTrabalhadores);
+    relatarMemoria(repeticoes > 1 ? alocacoesRealizadas() - alocacoesAntesUltima : -1);
+
+    // Verificação de Freivalds, sem produtos de matrizes (fora da medição)
+    return !verificacao.ativa() || verificarCadeia(cadeia.fatores(), resultado.visao(), verificacao);
+}
+
+#endif
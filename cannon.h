@@ -0,0 +1,435 @@
+#ifndef CANNON_H
+#define CANNON_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "afinidade.h"
+#include "gemm.h"
+#include "matriz.h"
+#include "opcoes.h"
+#include "rastreamento.h"
+#include "servico.h"
+
+/**
+ * Algoritmo de Cannon com troca de mensagens entre processos locais
+ * (multiplicacao_processos --cannon).
+ *
+ * No pool de processos, cada filho enxerga A, B e C inteiras em memória
+ * compartilhada, o que só funciona em uma máquina. Aqui, os P = q x q
+ * processos (ranks) formam uma grade q x q em toro e cada um guarda apenas
+ * os seus blocos: o rank (i, j) recebe do coordenador os blocos
+ * A(i, (i+j) mod q) e B((i+j) mod q, j) (o alinhamento inicial de Cannon),
+ * acumula C(i, j) += A * B e, a cada um dos q passos, passa o bloco de A ao
+ * vizinho da esquerda e o de B ao vizinho de cima, recebendo os próximos da
+ * direita e de baixo. No fim, C(i, j) volta ao coordenador. Os blocos vão
+ * por sockets Unix (socketpair), um canal por vizinho; nada é compartilhado
+ * além deles.
+ *
+ * A comunicação de cada passo é sobreposta ao cálculo: uma thread envia os
+ * blocos atuais e outra recebe os próximos em buffers separados (buffer
+ * duplo) enquanto o kernel multiplica os atuais. Com --cannon=sincrono, a
+ * troca só começa depois do cálculo, para medir o que a sobreposição
+ * esconde. Cada rank relata o tempo de cálculo, a espera pela comunicação,
+ * os bytes trocados e a memória dos seus blocos, o que permite estimar a
+ * memória por rank e o volume de comunicação antes de levar a grade a
+ * várias máquinas.
+ *
+ * N não precisa ser múltiplo de q: a parte i tem as linhas
+ * [i N / q, (i + 1) N / q). Só float64 e o algoritmo clássico.
+ */
+
+struct ParametrosCannon {
+    bool ativo;
+    bool sincrono;  // troca depois do cálculo, sem sobreposição
+
+    ParametrosCannon() : ativo(false), sincrono(false) {}
+
+    // Opções deste grupo, para Opcoes::aceitarApenas
+    static const char* nomesOpcoes() { return "cannon"; }
+
+    // Lê --cannon[=sobreposto|sincrono]
+    static bool deOpcoes(const Opcoes& opcoes, ParametrosCannon& p) {
+        p.ativo = opcoes.tem("cannon");
+        if (!p.ativo) {
+            return true;
+        }
+        std::string modo = opcoes.texto("cannon", "");
+        if (modo != "" && modo != "sobreposto" && modo != "sincrono") {
+            std::cerr << "Erro: Modo de --cannon inválido: " << modo << " (use sobreposto ou sincrono)"
+                      << std::endl;
+            return false;
+        }
+        p.sincrono = modo == "sincrono";
+        if (opcoes.tem("fluxo") || opcoes.tem("pipeline") || opcoes.tem("lote") ||
+            opcoes.texto("algo", "classico") != "classico" || opcoes.texto("dtype", "float64") != "float64" ||
+            opcoes.texto("esparsa", "auto") == "sim") {
+            std::cerr << "Erro: --cannon usa o algoritmo clássico em float64 e não se combina com --fluxo, "
+                         "--pipeline, --lote nem --esparsa=sim"
+                      << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Lado q da grade: o maior q com q * q <= P e q <= N
+    static int ladoGrade(int numProcessos, int dimensao) {
+        int q = std::max(1, (int)std::sqrt((double)numProcessos));
+        while ((q + 1) * (q + 1) <= numProcessos) {
+            q++;
+        }
+        while (q * q > numProcessos) {
+            q--;
+        }
+        return std::min(q, dimensao);
+    }
+};
+
+// Estatísticas de um rank na última multiplicação
+struct EstatisticasRank {
+    double segundosCalculo;
+    double segundosEspera;     // esperando a troca de blocos depois do cálculo
+    long long bytesEnviados;   // aos vizinhos
+    long long bytesRecebidos;  // dos vizinhos
+    long long bytesBlocos;     // blocos de A, B e C, com os buffers de recepção
+    long long picoResidenteKiB;
+};
+
+// Comando do coordenador a um rank; seguido dos blocos iniciais de A e B
+struct CabecalhoCannon {
+    int32_t comando;  // 'M' = multiplicar, 'S' = sair
+    int32_t dimensao;
+    int32_t sincrono;
+    ParametrosBloco blocos;
+};
+
+class GradeCannon {
+private:
+    int q;
+    std::vector<pid_t> ranks;
+    std::vector<int> canais;  // socket do coordenador com cada rank
+    std::vector<EstatisticasRank> estatisticas;
+    std::vector<double> bloco;  // um bloco contíguo a enviar ou recebido, reaproveitado entre chamadas
+    long long bytesDistribuidos;
+    long long bytesRecolhidos;
+    double segundosDistribuicao;
+    double segundosColeta;
+    bool valido;
+
+    // Início da parte `i` de N linhas (ou colunas) divididas em q
+    static int inicioParte(int i, int n, int q) { return (int)((long long)i * n / q); }
+    static int tamanhoParte(int i, int n, int q) { return inicioParte(i + 1, n, q) - inicioParte(i, n, q); }
+
+    static bool enviarBloco(int fd, const double* dados, int linhas, int colunas) {
+        return enviarTudo(fd, dados, (size_t)linhas * colunas * sizeof(double));
+    }
+
+    static bool receberBloco(int fd, double* dados, int linhas, int colunas) {
+        return receberTudo(fd, dados, (size_t)linhas * colunas * sizeof(double));
+    }
+
+    // Laço de um rank: `esquerda` e `acima` enviam, `direita` e `abaixo` recebem
+    void lacoRank(int id, int cpu, int coordenador, int esquerda, int direita, int acima, int abaixo) {
+        faixaAtual() = id + 1;
+        if (cpu >= 0 && !fixarNaCpu(cpu)) {
+            std::fprintf(stderr, "Aviso: Não foi possível fixar o rank %d na CPU %d\n", id, cpu);
+        }
+        const int i = id / q;
+        const int j = id % q;
+        BuffersGemm buffers;
+        std::vector<double> a[2], b[2], c;
+        CabecalhoCannon cab;
+
+        while (receberTudo(coordenador, &cab, sizeof(cab)) && cab.comando == 'M') {
+            const int n = cab.dimensao;
+            const int maior = tamanhoParte(q - 1, n, q);  // a última parte é a maior
+            const size_t elementos = (size_t)maior * maior;
+            for (int x = 0; x < 2; x++) {
+                a[x].resize(elementos);
+                b[x].resize(elementos);
+            }
+            c.assign((size_t)tamanhoParte(i, n, q) * tamanhoParte(j, n, q), 0.0);
+
+            EstatisticasRank estat;
+            memset(&estat, 0, sizeof(estat));
+            estat.bytesBlocos = (long long)(4 * elementos + c.size()) * sizeof(double);
+
+            const int linhas = tamanhoParte(i, n, q);
+            const int colunas = tamanhoParte(j, n, q);
+            int k = (i + j) % q;
+            bool ok = receberBloco(coordenador, a[0].data(), linhas, tamanhoParte(k, n, q)) &&
+                      receberBloco(coordenador, b[0].data(), tamanhoParte(k, n, q), colunas);
+
+            for (int passo = 0; passo < q && ok; passo++) {
+                const int atual = passo % 2;
+                const int proximo = 1 - atual;
+                const int interna = tamanhoParte(k, n, q);
+                const int kProximo = (k + 1) % q;
+                const bool deslocar = passo < q - 1;
+                bool enviou = true;
+                bool recebeu = true;
+
+                // Threads de envio e recepção separadas: como todo rank envia
+                // e recebe ao mesmo tempo, um envio bloqueado sempre tem quem o leia
+                std::thread emissor, receptor;
+                auto iniciarTroca = [&]() {
+                    emissor = std::thread([&]() {
+                        enviou = enviarBloco(esquerda, a[atual].data(), linhas, interna) &&
+                                 enviarBloco(acima, b[atual].data(), interna, colunas);
+                    });
+                    receptor = std::thread([&]() {
+                        recebeu = receberBloco(direita, a[proximo].data(), linhas, tamanhoParte(kProximo, n, q)) &&
+                                  receberBloco(abaixo, b[proximo].data(), tamanhoParte(kProximo, n, q), colunas);
+                    });
+                };
+                if (deslocar && !cab.sincrono) {
+                    iniciarTroca();
+                }
+
+                long long inicioCalculo = agoraNs();
+                gemmAcumular(VisaoMatrizConst(a[atual].data(), linhas, interna, interna),
+                             VisaoMatrizConst(b[atual].data(), interna, colunas, colunas),
+                             VisaoMatriz{ c.data(), linhas, colunas, colunas }, cab.blocos, buffers);
+                long long fimCalculo = agoraNs();
+                registrarTrecho("passo", inicioCalculo, fimCalculo, passo);
+                estat.segundosCalculo += (fimCalculo - inicioCalculo) / 1e9;
+
+                if (deslocar) {
+                    if (cab.sincrono) {
+                        iniciarTroca();
+                    }
+                    emissor.join();
+                    receptor.join();
+                    long long fimTroca = agoraNs();
+                    registrarTrecho("espera", fimCalculo, fimTroca, passo);
+                    estat.segundosEspera += (fimTroca - fimCalculo) / 1e9;
+                    estat.bytesEnviados += (long long)(linhas + colunas) * interna * sizeof(double);
+                    estat.bytesRecebidos +=
+                        (long long)(linhas + colunas) * tamanhoParte(kProximo, n, q) * sizeof(double);
+                    ok = enviou && recebeu;
+                }
+                k = kProximo;
+            }
+
+            struct rusage uso;
+            getrusage(RUSAGE_SELF, &uso);
+            estat.picoResidenteKiB = uso.ru_maxrss;
+            if (!ok || !enviarBloco(coordenador, c.data(), linhas, colunas) ||
+                !enviarTudo(coordenador, &estat, sizeof(estat))) {
+                break;
+            }
+        }
+        _exit(0);
+    }
+
+public:
+    // `lado` é q (P = q * q ranks); `cpus`, se não estiver vazio, tem a CPU de cada rank
+    explicit GradeCannon(int lado, const std::vector<int>& cpus = std::vector<int>())
+        : q(lado), estatisticas(lado * lado), bytesDistribuidos(0), bytesRecolhidos(0), segundosDistribuicao(0.0),
+          segundosColeta(0.0), valido(false) {
+        const int p = q * q;
+        // Canal horizontal h[r]: o rank r envia ao vizinho da esquerda; vertical v[r]: ao de cima
+        std::vector<int> horizontal(2 * p, -1), vertical(2 * p, -1), coordenacao(2 * p, -1);
+        for (int r = 0; r < p; r++) {
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, &horizontal[2 * r]) != 0 ||
+                socketpair(AF_UNIX, SOCK_STREAM, 0, &vertical[2 * r]) != 0 ||
+                socketpair(AF_UNIX, SOCK_STREAM, 0, &coordenacao[2 * r]) != 0) {
+                std::cerr << "Erro ao criar os canais da grade" << std::endl;
+                fecharTodos(horizontal);
+                fecharTodos(vertical);
+                fecharTodos(coordenacao);
+                return;
+            }
+        }
+
+        std::cout.flush();
+        for (int r = 0; r < p; r++) {
+            int i = r / q;
+            int j = r % q;
+            int direita = i * q + (j + 1) % q;
+            int abaixo = ((i + 1) % q) * q + j;
+            long long inicioFork = agoraNs();
+            pid_t pid = fork();
+            if (pid == 0) {
+                // O rank fica só com os seus quatro canais e o do coordenador
+                int proprios[5] = { coordenacao[2 * r + 1], horizontal[2 * r], horizontal[2 * direita + 1],
+                                    vertical[2 * r], vertical[2 * abaixo + 1] };
+                for (const std::vector<int>* fds : { &horizontal, &vertical, &coordenacao }) {
+                    for (int fd : *fds) {
+                        if (std::find(proprios, proprios + 5, fd) == proprios + 5) {
+                            close(fd);
+                        }
+                    }
+                }
+                for (int fd : canais) {
+                    close(fd);
+                }
+                registrarTrecho("criação", inicioFork, agoraNs());
+                lacoRank(r, cpus.empty() ? -1 : cpus[r], proprios[0], proprios[1], proprios[2], proprios[3],
+                         proprios[4]);
+            } else if (pid > 0) {
+                if (rastreadorAtivo() != nullptr) {
+                    rastreadorAtivo()->nomear(r + 1, "Rank " + std::to_string(r) + " (" + std::to_string(i) + ", " +
+                                                         std::to_string(j) + ", pid " + std::to_string(pid) + ")");
+                }
+                ranks.push_back(pid);
+                canais.push_back(coordenacao[2 * r]);
+                close(coordenacao[2 * r + 1]);
+            } else {
+                std::cerr << "Erro ao criar processo filho" << std::endl;
+                for (int s = r; s < p; s++) {
+                    close(coordenacao[2 * s]);
+                    close(coordenacao[2 * s + 1]);
+                }
+                break;
+            }
+        }
+        // Os canais entre vizinhos são só dos ranks
+        fecharTodos(horizontal);
+        fecharTodos(vertical);
+        valido = (int)ranks.size() == p;
+    }
+
+    ~GradeCannon() {
+        CabecalhoCannon sair;
+        sair.comando = 'S';
+        sair.dimensao = 0;
+        sair.sincrono = 0;
+        for (int fd : canais) {
+            if (!enviarTudo(fd, &sair, sizeof(sair))) {
+                // o rank já terminou; nada a fazer
+            }
+            close(fd);
+        }
+        for (pid_t pid : ranks) {
+            int status;
+            waitpid(pid, &status, 0);
+        }
+    }
+
+    GradeCannon(const GradeCannon&) = delete;
+    GradeCannon& operator=(const GradeCannon&) = delete;
+
+    static void fecharTodos(std::vector<int>& fds) {
+        for (int& fd : fds) {
+            if (fd >= 0) {
+                close(fd);
+                fd = -1;
+            }
+        }
+    }
+
+    bool ok() const { return valido; }
+    int lado() const { return q; }
+    int tamanho() const { return q * q; }
+
+    // C = A * B na grade: distribui os blocos alinhados, espera os q passos e recolhe C
+    bool multiplicar(const MatrizDensa& a, const MatrizDensa& b, MatrizDensa& c, const ParametrosBloco& blocos,
+                     bool sincrono) {
+        if (!valido) {
+            return false;
+        }
+        const int n = c.getLinhas();
+        CabecalhoCannon cab;
+        cab.comando = 'M';
+        cab.dimensao = n;
+        cab.sincrono = sincrono;
+        cab.blocos = blocos;
+
+        // Cada bloco é copiado para um buffer contíguo e enviado de uma vez
+        const int maior = tamanhoParte(q - 1, n, q);
+        bloco.resize((size_t)maior * maior);
+        auto empacotar = [&](VisaoMatrizConst v) {
+            for (int l = 0; l < v.linhas; l++) {
+                std::copy(v.linha(l), v.linha(l) + v.colunas, bloco.data() + (size_t)l * v.colunas);
+            }
+        };
+        VisaoMatrizConst va = a.visao();
+        VisaoMatrizConst vb = b.visao();
+        VisaoMatriz vc = c.visao();
+
+        long long inicio = agoraNs();
+        bytesDistribuidos = 0;
+        for (int r = 0; r < tamanho(); r++) {
+            int i = r / q;
+            int j = r % q;
+            int k = (i + j) % q;
+            VisaoMatrizConst blocoA = va.sub(inicioParte(i, n, q), inicioParte(k, n, q), tamanhoParte(i, n, q),
+                                             tamanhoParte(k, n, q));
+            VisaoMatrizConst blocoB = vb.sub(inicioParte(k, n, q), inicioParte(j, n, q), tamanhoParte(k, n, q),
+                                             tamanhoParte(j, n, q));
+            if (!enviarTudo(canais[r], &cab, sizeof(cab))) {
+                std::cerr << "Erro: Rank " << r << " (pid " << ranks[r] << ") não respondeu" << std::endl;
+                return false;
+            }
+            empacotar(blocoA);
+            bool enviou = enviarBloco(canais[r], bloco.data(), blocoA.linhas, blocoA.colunas);
+            empacotar(blocoB);
+            enviou = enviou && enviarBloco(canais[r], bloco.data(), blocoB.linhas, blocoB.colunas);
+            if (!enviou) {
+                std::cerr << "Erro: Rank " << r << " (pid " << ranks[r] << ") não respondeu" << std::endl;
+                return false;
+            }
+            bytesDistribuidos += (long long)(blocoA.linhas * blocoA.colunas + blocoB.linhas * blocoB.colunas) *
+                                 sizeof(double);
+        }
+        long long fimDistribuicao = agoraNs();
+        registrarTrecho("distribuir blocos", inicio, fimDistribuicao);
+
+        bytesRecolhidos = 0;
+        for (int r = 0; r < tamanho(); r++) {
+            VisaoMatriz blocoC = vc.sub(inicioParte(r / q, n, q), inicioParte(r % q, n, q), tamanhoParte(r / q, n, q),
+                                        tamanhoParte(r % q, n, q));
+            if (!receberBloco(canais[r], bloco.data(), blocoC.linhas, blocoC.colunas) ||
+                !receberTudo(canais[r], &estatisticas[r], sizeof(EstatisticasRank))) {
+                std::cerr << "Erro: Rank " << r << " (pid " << ranks[r] << ") terminou inesperadamente" << std::endl;
+                return false;
+            }
+            for (int l = 0; l < blocoC.linhas; l++) {
+                std::copy(bloco.data() + (size_t)l * blocoC.colunas, bloco.data() + (size_t)(l + 1) * blocoC.colunas,
+                          blocoC.linha(l));
+            }
+            bytesRecolhidos += (long long)blocoC.linhas * blocoC.colunas * sizeof(double);
+        }
+        long long fim = agoraNs();
+        registrarTrecho("recolher C", fimDistribuicao, fim);
+        segundosDistribuicao = (fimDistribuicao - inicio) / 1e9;
+        segundosColeta = (fim - fimDistribuicao) / 1e9;
+        return true;
+    }
+
+    // Uma linha por rank e o volume total, da última multiplicação
+    void imprimirEstatisticas() const {
+        const double mib = 1024.0 * 1024.0;
+        long long trocados = 0;
+        long long maiorBlocos = 0;
+        for (int r = 0; r < tamanho(); r++) {
+            const EstatisticasRank& e = estatisticas[r];
+            std::printf("Rank %d (%d, %d), pid %d: cálculo %.1f ms, espera %.1f ms; enviados %.2f MiB, "
+                        "recebidos %.2f MiB; blocos %.2f MiB, pico residente %.1f MiB\n",
+                        r, r / q, r % q, (int)ranks[r], e.segundosCalculo * 1000.0, e.segundosEspera * 1000.0,
+                        e.bytesEnviados / mib, e.bytesRecebidos / mib, e.bytesBlocos / mib,
+                        e.picoResidenteKiB / 1024.0);
+            trocados += e.bytesEnviados;
+            maiorBlocos = std::max(maiorBlocos, e.bytesBlocos);
+        }
+        std::printf("Comunicação entre ranks: %.2f MiB em %d passos (%.2f MiB por rank); maior conjunto de "
+                    "blocos por rank: %.2f MiB\n",
+                    trocados / mib, q - 1, trocados / mib / tamanho(), maiorBlocos / mib);
+        std::printf("Coordenador: distribuiu %.2f MiB em %.1f ms, recolheu %.2f MiB em %.1f ms\n",
+                    bytesDistribuidos / mib, segundosDistribuicao * 1000.0, bytesRecolhidos / mib,
+                    segundosColeta * 1000.0);
+    }
+};
+
+#endif
@@ -0,0 +1,170 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "matriz.h"
+#include "opcoes.h"
+#include "servico.h"
+
+using namespace std;
+
+/**
+ * Cliente do servidor de multiplicação (ver servidor_multiplicacao.cpp).
+ *
+ * Uso: ./cliente_multiplicacao <entrada_a> <entrada_b> [--saida=ARQUIVO]
+ *      [--repeticoes=N] [--verify[=K]] [--socket=CAMINHO]
+ *      ./cliente_multiplicacao --estatisticas | --encerrar [--socket=CAMINHO]
+ *
+ * As entradas são arquivos (.txt ou .bin, vistos pelo servidor) ou
+ * "shm:/NOME" (ex.: depois de cp matriz_a_1000.bin /dev/shm/a). Com
+ * --saida, o servidor grava C no arquivo; sem ela, C é mapeado da memória
+ * compartilhada do servidor, sem cópia, e o cliente imprime a dimensão e a
+ * soma dos elementos. Com --repeticoes, o mesmo pedido é repetido na mesma
+ * conexão e, no fim, são impressas a latência (ida e volta) e a vazão.
+ */
+
+// Conecta ao servidor; -1 em caso de erro
+int conectar(const string& caminho) {
+    sockaddr_un endereco;
+    if (!enderecoServico(caminho, endereco)) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (sockaddr*)&endereco, sizeof(endereco)) != 0) {
+        cerr << "Erro: Não foi possível conectar a " << caminho << " (o servidor está rodando?)" << endl;
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+bool trocar(int fd, const PedidoServico& pedido, RespostaServico& resposta) {
+    if (!enviarTudo(fd, &pedido, sizeof(pedido)) || !receberTudo(fd, &resposta, sizeof(resposta)) ||
+        resposta.magica != MAGICA_SERVICO) {
+        cerr << "Erro: Conexão com o servidor interrompida" << endl;
+        return false;
+    }
+    resposta.texto[sizeof(resposta.texto) - 1] = '\0';
+    return true;
+}
+
+// Mapeia C, sem cópia, e imprime a dimensão e a soma dos elementos
+bool resumirResultado(const DescritorMatriz& d) {
+    size_t tamanho = 0;
+    void* base = mapearDescritor(d, false, tamanho);
+    if (base == nullptr) {
+        return false;
+    }
+    VisaoMatrizConst c(reinterpret_cast<const double*>(static_cast<const char*>(base) + d.deslocamento), d.linhas,
+                       d.colunas, d.passo);
+    double soma = 0.0;
+    for (int i = 0; i < c.linhas; i++) {
+        const double* linha = c.linha(i);
+        for (int j = 0; j < c.colunas; j++) {
+            soma += linha[j];
+        }
+    }
+    printf("Resultado %dx%d em memória compartilhada (%s), soma dos elementos %.6e\n", c.linhas, c.colunas,
+           d.caminho, soma);
+    munmap(base, tamanho);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    Opcoes opcoes(argc, argv);
+    if (!opcoes.aceitarApenas({"encerrar,estatisticas,repeticoes,saida,socket,verify"})) {
+        return 1;
+    }
+    bool controle = opcoes.tem("estatisticas") || opcoes.tem("encerrar");
+    if (opcoes.numPosicionais() != (controle ? 0 : 2)) {
+        cout << "Uso: " << argv[0] << " <entrada_a> <entrada_b> [opções]" << endl;
+        cout << "     " << argv[0] << " --estatisticas | --encerrar [--socket=CAMINHO]" << endl;
+        cout << "Entradas: arquivos .txt ou .bin, ou shm:/NOME (matriz .bin em memória compartilhada)" << endl;
+        cout << "Opções: --saida=ARQUIVO                o servidor grava C no arquivo (sem ela, C vem sem cópia)" << endl;
+        cout << "        --repeticoes=N                 repete o pedido e relata latência e vazão" << endl;
+        cout << "        --verify[=K]                   o servidor confere C com Freivalds (K vetores, padrão 2)" << endl;
+        cout << "        --socket=CAMINHO               socket do servidor (padrão multiplicacao.sock)" << endl;
+        cout << "Exemplo: " << argv[0] << " matriz_a_1000.bin matriz_b_1000.bin --repeticoes=10" << endl;
+        return 1;
+    }
+
+    int repeticoes = opcoes.inteiro("repeticoes", 1);
+    int vetores = opcoes.tem("verify") ? opcoes.inteiro("verify", 2) : 0;
+    if (repeticoes <= 0 || vetores < 0) {
+        cerr << "Erro: Use --repeticoes e --verify com valores positivos." << endl;
+        return 1;
+    }
+
+    PedidoServico pedido;
+    memset(&pedido, 0, sizeof(pedido));
+    pedido.magica = MAGICA_SERVICO;
+    pedido.operacao = opcoes.tem("encerrar") ? OP_ENCERRAR : opcoes.tem("estatisticas") ? OP_ESTATISTICAS : OP_MULTIPLICAR;
+    pedido.vetoresVerificacao = vetores;
+    if (!controle && (!copiarCampo(pedido.entradaA, sizeof(pedido.entradaA), opcoes.posicional(0)) ||
+                      !copiarCampo(pedido.entradaB, sizeof(pedido.entradaB), opcoes.posicional(1)) ||
+                      !copiarCampo(pedido.saida, sizeof(pedido.saida), opcoes.texto("saida", "")))) {
+        cerr << "Erro: Caminho longo demais (máximo de 255 caracteres)" << endl;
+        return 1;
+    }
+
+    int fd = conectar(opcoes.texto("socket", SOCKET_SERVICO_PADRAO));
+    if (fd < 0) {
+        return 1;
+    }
+
+    RespostaServico resposta;
+    if (controle) {
+        bool ok = trocar(fd, pedido, resposta) && resposta.ok;
+        cout << (pedido.operacao == OP_ENCERRAR ? "Servidor encerrando." : resposta.texto);
+        if (pedido.operacao == OP_ENCERRAR) {
+            cout << endl;
+        }
+        close(fd);
+        return ok ? 0 : 1;
+    }
+
+    vector<double> latencias;
+    auto inicio = chrono::steady_clock::now();
+    bool ok = true;
+    for (int r = 0; r < repeticoes && ok; r++) {
+        auto inicioPedido = chrono::steady_clock::now();
+        ok = trocar(fd, pedido, resposta);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - inicioPedido).count();
+        if (!ok) {
+            break;
+        }
+        if (!resposta.ok) {
+            cerr << "Erro no pedido " << resposta.numeroPedido << ": " << resposta.texto << endl;
+            ok = false;
+            break;
+        }
+        latencias.push_back(ms);
+        printf("Pedido %llu: %.3f ms ida e volta (servidor: carga %.3f, cálculo %.3f, verificação %.3f, "
+               "gravação %.3f, total %.3f ms; %d/2 entradas em memória)\n",
+               (unsigned long long)resposta.numeroPedido, ms, resposta.msCarga, resposta.msCalculo,
+               resposta.msVerificacao, resposta.msGravacao, resposta.msTotal, resposta.entradasEmCache);
+    }
+    double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+
+    // O resultado do último pedido vale até o próximo pedido desta conexão
+    if (ok && pedido.saida[0] == '\0') {
+        ok = resumirResultado(resposta.resultado);
+    } else if (ok) {
+        cout << "Resultado gravado pelo servidor em: " << pedido.saida << endl;
+    }
+    close(fd);
+
+    if (ok && repeticoes > 1) {
+        sort(latencias.begin(), latencias.end());
+        printf("Latência (ms): mín %.3f, mediana %.3f, p95 %.3f, máx %.3f\n", latencias.front(),
+               latencias[latencias.size() / 2], latencias[(size_t)ceil(0.95 * latencias.size()) - 1],
+               latencias.back());
+        printf("Vazão: %.2f pedidos/s\n", repeticoes / segundos);
+    }
+    return ok ? 0 : 1;
+}
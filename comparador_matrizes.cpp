@@ -0,0 +1,162 @@
+#include <iostream>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "matriz.h"
+#include "opcoes.h"
+
+using namespace std;
+
+/**
+ * Programa Auxiliar - Comparador de Matrizes
+ *
+ * Compara duas matrizes (por exemplo, resultados de programas ou opções
+ * diferentes) elemento a elemento, com tolerância. Arquivos .bin são
+ * mapeados sem cópia e podem ter qualquer tipo de elemento (ver
+ * tipo_elemento.h); arquivos texto são lidos como float64.
+ *
+ * Uso: ./comparador_matrizes <arquivo1> <arquivo2> [--tolerancia=T]
+ *
+ * O erro relativo de um elemento é |x - y| / max(|x|, |y|) (zero quando
+ * ambos são zero). São relatados o maior erro absoluto, o maior erro
+ * relativo (e onde ocorre), o erro relativo médio e quantos elementos passam
+ * da tolerância (padrão 1e-9, ou 1,2e-4 se um dos arquivos for float32, como
+ * em --verify). O código de saída é 0 se nenhum passar.
+ *
+ * Exemplo: ./comparador_matrizes resultado_sequencial_1000.bin resultado_threads_1000_4.bin
+ */
+
+// Matriz lida de um arquivo, acessada linha a linha como double
+class FonteMatriz {
+private:
+    CabecalhoMatrizBinaria cab;
+    MapeamentoArquivo mapa;
+    unique_ptr<MatrizDensa> texto;  // arquivos texto são carregados inteiros
+
+    template <typename T>
+    void converterLinha(int i, double* destino) const {
+        const T* origem = reinterpret_cast<const T*>(static_cast<const char*>(mapa.base) + cab.tamanhoCabecalho +
+                                                     (size_t)i * cab.passo * sizeof(T));
+        for (int j = 0; j < colunas; j++) {
+            destino[j] = (double)origem[j];
+        }
+    }
+
+public:
+    int linhas;
+    int colunas;
+
+    FonteMatriz() : linhas(0), colunas(0) {
+        mapa.base = nullptr;
+        mapa.tamanho = 0;
+    }
+
+    ~FonteMatriz() {
+        if (mapa.base != nullptr) {
+            munmap(mapa.base, mapa.tamanho);
+        }
+    }
+
+    bool abrir(const string& nome) {
+        if (ehArquivoBinario(nome)) {
+            if (!mapearMatrizBinaria(nome, cab, mapa, TIPO_QUALQUER)) {
+                return false;
+            }
+            linhas = (int)cab.linhas;
+            colunas = (int)cab.colunas;
+            return true;
+        }
+        if (!lerFormatoArquivo(nome, linhas, colunas)) {
+            cerr << "Erro: Não foi possível determinar a dimensão de " << nome << endl;
+            return false;
+        }
+        texto.reset(new MatrizDensa(linhas, colunas, true));
+        return texto->carregar(nome);
+    }
+
+    TipoDado tipoDado() const { return texto ? TIPO_FLOAT64 : (TipoDado)cab.tipoDado; }
+
+    const char* tipo() const {
+        return texto ? "float64 (texto)" : nomeTipoDado((TipoDado)cab.tipoDado);
+    }
+
+    void linha(int i, double* destino) const {
+        if (texto) {
+            const double* origem = texto->linha(i);
+            copy(origem, origem + colunas, destino);
+            return;
+        }
+        switch ((TipoDado)cab.tipoDado) {
+            case TIPO_FLOAT32: converterLinha<float>(i, destino); break;
+            case TIPO_INT32: converterLinha<int32_t>(i, destino); break;
+            case TIPO_INT8: converterLinha<int8_t>(i, destino); break;
+            case TIPO_INT64: converterLinha<int64_t>(i, destino); break;
+            default: converterLinha<double>(i, destino); break;
+        }
+    }
+};
+
+int main(int argc, char* argv[]) {
+    Opcoes opcoes(argc, argv);
+    if (!opcoes.aceitarApenas({"tolerancia"})) {
+        return 2;
+    }
+    if (opcoes.numPosicionais() != 2) {
+        cout << "Uso: " << argv[0] << " <arquivo1> <arquivo2> [--tolerancia=T]" << endl;
+        cout << "Exemplo: " << argv[0] << " resultado_sequencial_1000.bin resultado_threads_1000_4.bin" << endl;
+        return 2;
+    }
+
+    FonteMatriz x, y;
+    if (!x.abrir(opcoes.posicional(0)) || !y.abrir(opcoes.posicional(1))) {
+        return 2;
+    }
+    bool float32 = x.tipoDado() == TIPO_FLOAT32 || y.tipoDado() == TIPO_FLOAT32;
+    double tolerancia = opcoes.real("tolerancia", float32 ? 1000.0 * numeric_limits<float>::epsilon() : 1e-9);
+    if (tolerancia < 0.0) {
+        cerr << "Erro: A tolerância não pode ser negativa." << endl;
+        return 2;
+    }
+    if (x.linhas != y.linhas || x.colunas != y.colunas) {
+        cerr << "Erro: Dimensões diferentes: " << x.linhas << "x" << x.colunas << " e "
+             << y.linhas << "x" << y.colunas << endl;
+        return 2;
+    }
+
+    vector<double> linhaX(x.colunas), linhaY(y.colunas);
+    double maiorAbsoluto = 0.0, maiorRelativo = 0.0, somaRelativo = 0.0;
+    int linhaMaior = 0, colunaMaior = 0;
+    long long acimaTolerancia = 0;
+    for (int i = 0; i < x.linhas; i++) {
+        x.linha(i, linhaX.data());
+        y.linha(i, linhaY.data());
+        for (int j = 0; j < x.colunas; j++) {
+            double absoluto = fabs(linhaX[j] - linhaY[j]);
+            double escala = max(fabs(linhaX[j]), fabs(linhaY[j]));
+            double relativo = absoluto == 0.0 ? 0.0 : absoluto / escala;
+            // NaN conta como diferença infinita
+            if (std::isnan(relativo)) {
+                relativo = absoluto = INFINITY;
+            }
+            maiorAbsoluto = max(maiorAbsoluto, absoluto);
+            if (relativo > maiorRelativo) {
+                maiorRelativo = relativo;
+                linhaMaior = i;
+                colunaMaior = j;
+            }
+            somaRelativo += relativo;
+            acimaTolerancia += relativo > tolerancia;
+        }
+    }
+
+    double elementos = (double)x.linhas * x.colunas;
+    printf("Matrizes %dx%d (%s e %s)\n", x.linhas, x.colunas, x.tipo(), y.tipo());
+    printf("Maior erro absoluto: %.3e\n", maiorAbsoluto);
+    printf("Maior erro relativo: %.3e em (%d, %d)\n", maiorRelativo, linhaMaior, colunaMaior);
+    printf("Erro relativo médio: %.3e\n", elementos > 0 ? somaRelativo / elementos : 0.0);
+    printf("Elementos acima da tolerância (%.2e): %lld\n", tolerancia, acimaTolerancia);
+    cout << (acimaTolerancia == 0 ? "Resultado: IGUAIS dentro da tolerância" : "Resultado: DIFERENTES") << endl;
+    return acimaTolerancia == 0 ? 0 : 1;
+}
@@ -0,0 +1,253 @@
+#ifndef CONTADORES_H
+#define CONTADORES_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Contadores de desempenho do processador (--counters), lidos com
+ * perf_event_open.
+ *
+ * Cada trabalhador (thread ou processo filho) abre os próprios contadores,
+ * que contam apenas a thread que os abriu, e os liga somente enquanto executa
+ * tarefas de multiplicação. Os eventos de hardware formam um grupo liderado
+ * pelos ciclos, para serem medidos juntos; os que o processador não aceita
+ * no grupo são abertos sozinhos. Se o kernel multiplexar os contadores, as
+ * contagens são extrapoladas pelo tempo em que cada um ficou ativo.
+ *
+ * Em máquinas virtuais ou com perf_event_paranoid restritivo, parte dos
+ * eventos (ou todos) pode não existir: eles aparecem como "n/d" e a
+ * multiplicação continua normalmente.
+ */
+
+enum EventoContador {
+    EVENTO_CICLOS,
+    EVENTO_INSTRUCOES,
+    EVENTO_FALHAS_L1D,
+    EVENTO_FALHAS_LLC,
+    EVENTO_FALHAS_DTLB,
+    EVENTO_TROCAS_CONTEXTO,
+    NUM_EVENTOS
+};
+
+struct DefinicaoEvento {
+    const char* nome;
+    unsigned tipo;
+    unsigned long long config;
+};
+
+inline unsigned long long configCache(unsigned cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+inline const DefinicaoEvento& definicaoEvento(int evento) {
+    static const DefinicaoEvento eventos[NUM_EVENTOS] = {
+        { "Ciclos", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { "Instruções", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { "Falhas L1d", PERF_TYPE_HW_CACHE, configCache(PERF_COUNT_HW_CACHE_L1D) },
+        { "Falhas LLC", PERF_TYPE_HW_CACHE, configCache(PERF_COUNT_HW_CACHE_LL) },
+        { "Falhas dTLB", PERF_TYPE_HW_CACHE, configCache(PERF_COUNT_HW_CACHE_DTLB) },
+        { "Trocas ctx", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+    };
+    return eventos[evento];
+}
+
+// Contagens de um trabalhador. Agregado simples (zerado com ContagemEventos()
+// ou memset), para poder ficar em memória compartilhada com os processos filhos.
+struct ContagemEventos {
+    long long valores[NUM_EVENTOS];
+    unsigned validos;  // bit i ligado = evento i foi medido
+
+    bool valido(int evento) const { return (validos >> evento) & 1u; }
+
+    void somar(const ContagemEventos& outra) {
+        for (int e = 0; e < NUM_EVENTOS; e++) {
+            valores[e] += outra.valores[e];
+        }
+        validos |= outra.validos;
+    }
+};
+
+class ContadoresHardware {
+private:
+    int fds[NUM_EVENTOS];
+    bool lider[NUM_EVENTOS];  // abriu sozinho ou como líder de grupo
+    int erros[NUM_EVENTOS];   // errno da abertura que falhou
+
+    static int abrirEvento(int evento, int fdGrupo, bool somenteUsuario) {
+        const DefinicaoEvento& def = definicaoEvento(evento);
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = def.tipo;
+        attr.config = def.config;
+        attr.disabled = 1;
+        attr.exclude_kernel = somenteUsuario ? 1 : 0;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // pid = 0, cpu = -1: a thread chamadora, em qualquer CPU
+        return (int)syscall(SYS_perf_event_open, &attr, 0, -1, fdGrupo, 0);
+    }
+
+    // Eventos de hardware contam só o espaço de usuário (permitido com
+    // perf_event_paranoid até 2). Trocas de contexto acontecem no kernel:
+    // tenta contá-las inteiras e, se não for permitido, só as do usuário.
+    static int abrirEvento(int evento, int fdGrupo) {
+        if (definicaoEvento(evento).tipo == PERF_TYPE_SOFTWARE) {
+            int fd = abrirEvento(evento, fdGrupo, false);
+            if (fd >= 0 || (errno != EACCES && errno != EPERM)) {
+                return fd;
+            }
+        }
+        return abrirEvento(evento, fdGrupo, true);
+    }
+
+public:
+    // Abre os eventos para a thread chamadora
+    ContadoresHardware() {
+        int fdLider = -1;
+        for (int e = 0; e < NUM_EVENTOS; e++) {
+            bool hardware = definicaoEvento(e).tipo != PERF_TYPE_SOFTWARE;
+            fds[e] = -1;
+            lider[e] = true;
+            if (hardware && fdLider >= 0) {
+                fds[e] = abrirEvento(e, fdLider);
+                lider[e] = fds[e] < 0;
+            }
+            if (fds[e] < 0) {
+                fds[e] = abrirEvento(e, -1);
+            }
+            erros[e] = fds[e] < 0 ? errno : 0;
+            if (hardware && fdLider < 0 && fds[e] >= 0) {
+                fdLider = fds[e];
+            }
+        }
+    }
+
+    ~ContadoresHardware() {
+        for (int e = 0; e < NUM_EVENTOS; e++) {
+            if (fds[e] >= 0) {
+                close(fds[e]);
+            }
+        }
+    }
+
+    ContadoresHardware(const ContadoresHardware&) = delete;
+    ContadoresHardware& operator=(const ContadoresHardware&) = delete;
+
+    bool disponivel(int evento) const { return fds[evento] >= 0; }
+    int erro(int evento) const { return erros[evento]; }
+
+    void iniciar() {
+        for (int e = 0; e < NUM_EVENTOS; e++) {
+            if (fds[e] >= 0 && lider[e]) {
+                ioctl(fds[e], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                ioctl(fds[e], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            }
+        }
+    }
+
+    // Desliga os contadores e soma o que foi contado desde iniciar() em `contagem`
+    void parar(ContagemEventos& contagem) {
+        for (int e = 0; e < NUM_EVENTOS; e++) {
+            if (fds[e] >= 0 && lider[e]) {
+                ioctl(fds[e], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            }
+        }
+        for (int e = 0; e < NUM_EVENTOS; e++) {
+            unsigned long long leitura[3];  // valor, tempo habilitado, tempo rodando
+            if (fds[e] < 0 || read(fds[e], leitura, sizeof(leitura)) != (ssize_t)sizeof(leitura)) {
+                continue;
+            }
+            if (leitura[2] == 0 && leitura[1] > 0) {
+                continue;  // habilitado, mas nunca agendado no processador
+            }
+            double escala = leitura[2] < leitura[1] ? (double)leitura[1] / leitura[2] : 1.0;
+            contagem.valores[e] += (long long)(leitura[0] * escala);
+            contagem.validos |= 1u << e;
+        }
+    }
+};
+
+// Abre os contadores na thread chamadora e avisa (uma vez) sobre os eventos
+// indisponíveis. Retorna false se nenhum evento puder ser medido.
+inline bool verificarContadores() {
+    ContadoresHardware teste;
+    std::string faltando;
+    int disponiveis = 0;
+    for (int e = 0; e < NUM_EVENTOS; e++) {
+        if (teste.disponivel(e)) {
+            disponiveis++;
+        } else {
+            faltando += std::string(faltando.empty() ? "" : ", ") + definicaoEvento(e).nome +
+                        " (" + strerror(teste.erro(e)) + ")";
+        }
+    }
+    if (!faltando.empty()) {
+        std::fprintf(stderr, "Aviso: Contadores indisponíveis: %s\n", faltando.c_str());
+        if (disponiveis == 0) {
+            std::fprintf(stderr, "Aviso: Verifique /proc/sys/kernel/perf_event_paranoid; "
+                                 "continuando sem contadores\n");
+        }
+    }
+    return disponiveis > 0;
+}
+
+// printf("%*s") conta bytes; os nomes em UTF-8 precisam de espaços extras
+inline void imprimirColuna(const std::string& texto, int largura) {
+    int caracteres = 0;
+    for (char ch : texto) {
+        caracteres += (ch & 0xC0) != 0x80;
+    }
+    std::printf(" %*s%s", std::max(0, largura - caracteres), "", texto.c_str());
+}
+
+inline void imprimirLinhaContadores(const std::string& rotulo, const ContagemEventos& c) {
+    std::printf("%-14s", rotulo.c_str());
+    for (int e = 0; e < NUM_EVENTOS; e++) {
+        if (c.valido(e)) {
+            std::printf(" %13lld", c.valores[e]);
+        } else {
+            std::printf(" %13s", "n/d");
+        }
+        if (e == EVENTO_INSTRUCOES) {
+            if (c.valido(EVENTO_CICLOS) && c.valido(EVENTO_INSTRUCOES) && c.valores[EVENTO_CICLOS] > 0) {
+                std::printf(" %6.2f", (double)c.valores[EVENTO_INSTRUCOES] / c.valores[EVENTO_CICLOS]);
+            } else {
+                std::printf(" %6s", "n/d");
+            }
+        }
+    }
+    std::printf("\n");
+}
+
+// Tabela com uma linha por trabalhador e o total
+inline void imprimirContadores(const std::vector<ContagemEventos>& contagens, const char* rotulo) {
+    std::printf("Contadores de hardware (fase de multiplicação):\n%-14s", "");
+    for (int e = 0; e < NUM_EVENTOS; e++) {
+        imprimirColuna(definicaoEvento(e).nome, 13);
+        if (e == EVENTO_INSTRUCOES) {
+            std::printf(" %6s", "IPC");
+        }
+    }
+    std::printf("\n");
+
+    ContagemEventos total = ContagemEventos();
+    for (size_t t = 0; t < contagens.size(); t++) {
+        imprimirLinhaContadores(std::string(rotulo) + " " + std::to_string(t), contagens[t]);
+        total.somar(contagens[t]);
+    }
+    if (contagens.size() > 1) {
+        imprimirLinhaContadores("Total", total);
+    }
+}
+
+#endif
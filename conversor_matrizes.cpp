@@ -0,0 +1,73 @@
+#include <iostream>
+#include <chrono>
+#include "matriz.h"
+#include "opcoes.h"
+
+using namespace std;
+
+/**
+ * Programa Auxiliar - Conversor de Matrizes
+ * 
+ * Converte uma matriz entre o formato texto (.txt) e o formato binário
+ * (.bin), quadrada ou retangular. O formato de cada arquivo é determinado
+ * pela extensão.
+ * 
+ * Uso: ./conversor_matrizes <entrada> <saida> [--dtype=TIPO]
+ * 
+ * Com --dtype (float64 por padrão) converte matrizes de outro tipo de
+ * elemento; um .bin de tipo diferente do indicado é rejeitado.
+ * 
+ * Exemplo: ./conversor_matrizes matriz_a_100.txt matriz_a_100.bin
+ */
+
+template <typename T>
+bool converter(const string& entrada, const string& saida, int linhas, int colunas) {
+    MatrizDensaT<T> matriz(linhas, colunas, true);
+    return matriz.carregar(entrada) && matriz.salvar(saida);
+}
+
+int main(int argc, char* argv[]) {
+    Opcoes opcoes(argc, argv);
+    if (!opcoes.aceitarApenas({"dtype"})) {
+        return 1;
+    }
+    if (opcoes.numPosicionais() != 2) {
+        cout << "Uso: " << argv[0] << " <entrada> <saida> [--dtype=float64|float32|int32|int8]" << endl;
+        cout << "Exemplo: " << argv[0] << " matriz_a_100.txt matriz_a_100.bin" << endl;
+        return 1;
+    }
+    
+    string entrada = opcoes.posicional(0);
+    string saida = opcoes.posicional(1);
+    TipoDado tipo = TIPO_FLOAT64;
+    if (!interpretarTipoDado(opcoes.texto("dtype", "float64"), tipo)) {
+        return 1;
+    }
+    
+    int linhas, colunas;
+    if (!lerFormatoArquivo(entrada, linhas, colunas, tipo)) {
+        cerr << "Erro: Não foi possível determinar a dimensão de " << entrada << endl;
+        return 1;
+    }
+    
+    auto inicio = chrono::high_resolution_clock::now();
+    
+    bool ok;
+    switch (tipo) {
+        case TIPO_FLOAT32: ok = converter<float>(entrada, saida, linhas, colunas); break;
+        case TIPO_INT32: ok = converter<int32_t>(entrada, saida, linhas, colunas); break;
+        case TIPO_INT8: ok = converter<int8_t>(entrada, saida, linhas, colunas); break;
+        default: ok = converter<double>(entrada, saida, linhas, colunas); break;
+    }
+    if (!ok) {
+        return 1;
+    }
+    
+    auto fim = chrono::high_resolution_clock::now();
+    auto duracao = chrono::duration_cast<chrono::milliseconds>(fim - inicio);
+    
+    cout << "Matriz " << linhas << "x" << colunas << " convertida de " << entrada
+         << " para " << saida << " em " << duracao.count() << " ms" << endl;
+    
+    return 0;
+}
@@ -0,0 +1,531 @@
+#ifndef ESPARSA_H
+#define ESPARSA_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+#include <vector>
+#include "matriz.h"
+#include "memoria_compartilhada.h"
+#include "microkernel.h"
+#include "opcoes.h"
+#include "rastreamento.h"
+
+/**
+ * Multiplicação com operandos esparsos (float64, algoritmo clássico).
+ *
+ * Depois de carregadas, A e B têm a densidade (fração de elementos não nulos)
+ * medida. Se a estimativa de custo indicar que compensa, A é convertida para
+ * CSR (linhas comprimidas) e/ou B para CSC (colunas comprimidas) ou CSR, e
+ * uma das três formas é usada:
+ *  - CSR x densa: cada não nulo a_ik soma a_ik * B[k,:] à linha i de C;
+ *  - densa x CSC: C[i,j] é o produto da linha i de A pelos não nulos da coluna j;
+ *  - CSR x CSR (SpGEMM de Gustavson): a linha i de C acumula a_ik * B[k,:]
+ *    percorrendo só os não nulos da linha k de B.
+ * C continua densa (é o que os programas gravam), e cada linha de C é
+ * calculada inteira por um único trabalhador, sempre na mesma ordem: o
+ * resultado é o mesmo no programa sequencial, com threads ou com processos.
+ * Ele não é bit a bit igual ao do kernel denso, que soma em outra ordem.
+ *
+ * Uma matriz esparsa ocupa um único buffer (no heap ou em um objeto
+ * shm_open, para o pool de processos):
+ *   [CabecalhoEsparsa][inicio: int64 x (n+1)][indices: int32 x nnz][valores: double x nnz]
+ * e é descrita aos filhos por um DescritorMatriz que cobre o objeto inteiro.
+ *
+ * A escolha (--esparsa=auto) compara o custo estimado de cada forma com o do
+ * kernel denso usando densidades de cruzamento medidas nesta máquina (ver
+ * relatorio.md): CSR x densa custa dA / CRUZAMENTO_CSR_DENSA do denso, densa
+ * x CSC dB / CRUZAMENTO_DENSA_CSC e CSR x CSR dA * dB / CRUZAMENTO_CSR_CSR.
+ */
+
+// Densidades de cruzamento medidas com N = 1024, uma thread e o kernel
+// AVX-512 (ver a seção "Matrizes esparsas" de relatorio.md)
+const double CRUZAMENTO_CSR_DENSA = 0.12;
+const double CRUZAMENTO_DENSA_CSC = 0.10;
+const double CRUZAMENTO_CSR_CSR = 0.012; // comparado com dA * dB
+
+// Linhas de C por tarefa distribuída às threads ou aos processos
+const int LINHAS_TAREFA_ESPARSA = 32;
+
+enum FormaEsparsa {
+    ESPARSA_NENHUMA,    // kernel denso
+    ESPARSA_CSR_DENSA,  // A em CSR, B densa
+    ESPARSA_DENSA_CSC,  // A densa, B em CSC
+    ESPARSA_CSR_CSR     // A e B em CSR
+};
+
+inline const char* nomeFormaEsparsa(FormaEsparsa forma) {
+    switch (forma) {
+        case ESPARSA_CSR_DENSA: return "CSR x densa";
+        case ESPARSA_DENSA_CSC: return "densa x CSC";
+        case ESPARSA_CSR_CSR: return "CSR x CSR (SpGEMM)";
+        default: return "densa x densa";
+    }
+}
+
+// Cabeçalho no início do buffer de uma matriz esparsa
+struct CabecalhoEsparsa {
+    int32_t porColunas;  // 0 = CSR, 1 = CSC
+    int32_t linhas;
+    int32_t colunas;
+    int32_t reservado;
+    int64_t naoNulos;
+};
+
+// Visão somente leitura de uma matriz esparsa. `inicio` tem uma entrada por
+// linha (CSR) ou coluna (CSC) mais uma; `indices` guarda a coluna (CSR) ou a
+// linha (CSC) de cada não nulo, em ordem crescente dentro de cada linha/coluna.
+struct VisaoEsparsa {
+    bool porColunas;
+    int linhas;
+    int colunas;
+    int64_t naoNulos;
+    const int64_t* inicio;
+    const int32_t* indices;
+    const double* valores;
+};
+
+inline size_t arredondar8(size_t bytes) {
+    return (bytes + 7) / 8 * 8;
+}
+
+// Bytes do buffer de uma matriz esparsa
+inline size_t bytesEsparsa(bool porColunas, int linhas, int colunas, int64_t naoNulos) {
+    int comprimidas = porColunas ? colunas : linhas;
+    return sizeof(CabecalhoEsparsa) + ((size_t)comprimidas + 1) * sizeof(int64_t) +
+           arredondar8((size_t)naoNulos * sizeof(int32_t)) + (size_t)naoNulos * sizeof(double);
+}
+
+// Interpreta um buffer no formato acima (por exemplo, mapeado por um filho do pool)
+inline VisaoEsparsa visaoEsparsa(const void* base) {
+    const CabecalhoEsparsa* cab = static_cast<const CabecalhoEsparsa*>(base);
+    VisaoEsparsa v;
+    v.porColunas = cab->porColunas != 0;
+    v.linhas = cab->linhas;
+    v.colunas = cab->colunas;
+    v.naoNulos = cab->naoNulos;
+    const char* p = reinterpret_cast<const char*>(cab + 1);
+    v.inicio = reinterpret_cast<const int64_t*>(p);
+    p += ((size_t)(v.porColunas ? v.colunas : v.linhas) + 1) * sizeof(int64_t);
+    v.indices = reinterpret_cast<const int32_t*>(p);
+    p += arredondar8((size_t)v.naoNulos * sizeof(int32_t));
+    v.valores = reinterpret_cast<const double*>(p);
+    return v;
+}
+
+// Número de elementos não nulos de `m`
+inline int64_t contarNaoNulos(VisaoMatrizConst m) {
+    int64_t total = 0;
+    for (int i = 0; i < m.linhas; i++) {
+        const double* linha = m.linha(i);
+        for (int j = 0; j < m.colunas; j++) {
+            total += linha[j] != 0.0;
+        }
+    }
+    return total;
+}
+
+class MatrizEsparsa {
+private:
+    void* base;
+    size_t tamanho;
+    std::string nomeCompartilhado;  // objeto shm_open que contém o buffer, se houver
+
+    void liberar() {
+        if (base != nullptr) {
+            if (!nomeCompartilhado.empty()) {
+                munmap(base, tamanho);
+                shm_unlink(nomeCompartilhado.c_str());
+                nomeCompartilhado.clear();
+            } else {
+                liberarAlinhado(base);
+            }
+            base = nullptr;
+        }
+    }
+
+public:
+    MatrizEsparsa() : base(nullptr), tamanho(0) {}
+    ~MatrizEsparsa() {
+        liberar();
+    }
+
+    MatrizEsparsa(const MatrizEsparsa&) = delete;
+    MatrizEsparsa& operator=(const MatrizEsparsa&) = delete;
+
+    // Converte `m` para CSR (ou CSC, com `porColunas`), descartando zeros. Com
+    // `nomeShm` não vazio, o buffer fica em memória compartilhada POSIX.
+    bool converter(VisaoMatrizConst m, bool porColunas, const std::string& nomeShm = "") {
+        liberar();
+        int comprimidas = porColunas ? m.colunas : m.linhas;
+        std::vector<int64_t> inicio(comprimidas + 1, 0);
+        for (int i = 0; i < m.linhas; i++) {
+            const double* linha = m.linha(i);
+            for (int j = 0; j < m.colunas; j++) {
+                if (linha[j] != 0.0) {
+                    inicio[(porColunas ? j : i) + 1]++;
+                }
+            }
+        }
+        for (int r = 0; r < comprimidas; r++) {
+            inicio[r + 1] += inicio[r];
+        }
+        int64_t naoNulos = inicio[comprimidas];
+
+        tamanho = bytesEsparsa(porColunas, m.linhas, m.colunas, naoNulos);
+        if (!nomeShm.empty()) {
+            base = criarRegiaoCompartilhada(nomeShm, tamanho);
+            if (base == nullptr) {
+                return false;
+            }
+            nomeCompartilhado = nomeShm;
+        } else {
+            base = alocarAlinhado(tamanho);
+            if (base == nullptr) {
+                std::cerr << "Erro: Memória insuficiente para a matriz esparsa" << std::endl;
+                return false;
+            }
+        }
+
+        CabecalhoEsparsa* cab = static_cast<CabecalhoEsparsa*>(base);
+        memset(cab, 0, sizeof(*cab));
+        cab->porColunas = porColunas;
+        cab->linhas = m.linhas;
+        cab->colunas = m.colunas;
+        cab->naoNulos = naoNulos;
+        VisaoEsparsa v = visaoEsparsa(base);
+        int64_t* destinoInicio = const_cast<int64_t*>(v.inicio);
+        int32_t* indices = const_cast<int32_t*>(v.indices);
+        double* valores = const_cast<double*>(v.valores);
+        std::copy(inicio.begin(), inicio.end(), destinoInicio);
+
+        // Percorrendo A por linhas, os índices de cada linha/coluna saem em ordem crescente
+        for (int i = 0; i < m.linhas; i++) {
+            const double* linha = m.linha(i);
+            for (int j = 0; j < m.colunas; j++) {
+                if (linha[j] != 0.0) {
+                    int64_t p = inicio[porColunas ? j : i]++;
+                    indices[p] = porColunas ? i : j;
+                    valores[p] = linha[j];
+                }
+            }
+        }
+        return true;
+    }
+
+    VisaoEsparsa visao() const { return visaoEsparsa(base); }
+
+    // Descreve o objeto inteiro (visto como uma linha de bytes) para os filhos do pool
+    bool descrever(DescritorMatriz& d) const {
+        if (nomeCompartilhado.empty() || nomeCompartilhado.size() >= sizeof(d.caminho) || tamanho > INT32_MAX) {
+            return false;
+        }
+        memset(&d, 0, sizeof(d));
+        strcpy(d.caminho, nomeCompartilhado.c_str());
+        d.ehShm = 1;
+        d.linhas = 1;
+        d.colunas = (int32_t)tamanho;
+        d.passo = (int32_t)tamanho;
+        d.bytesElemento = 1;
+        return true;
+    }
+};
+
+// Operando de um produto esparso: usa-se a visão densa ou a esparsa, conforme a forma
+struct OperandoEsparso {
+    VisaoMatrizConst densa;
+    VisaoEsparsa esparsa;
+};
+
+// Linhas [linha0, linha1) de C = A * B na forma indicada. Cada linha de C é
+// zerada e somada sempre na mesma ordem, qualquer que seja a divisão das linhas.
+template <FormaEsparsa FORMA>
+__attribute__((always_inline))
+inline void corpoLinhasEsparsas(const OperandoEsparso& a, const OperandoEsparso& b, VisaoMatriz c,
+                                int linha0, int linha1) {
+    for (int i = linha0; i < linha1; i++) {
+        double* __restrict__ ci = c.linha(i);
+        if (FORMA == ESPARSA_DENSA_CSC) {
+            // Quatro linhas de A por vez reaproveitam cada não nulo da coluna de B
+            const VisaoEsparsa& e = b.esparsa;
+            if (i + 4 <= linha1) {
+                const double* a0 = a.densa.linha(i);
+                const double* a1 = a.densa.linha(i + 1);
+                const double* a2 = a.densa.linha(i + 2);
+                const double* a3 = a.densa.linha(i + 3);
+                for (int j = 0; j < c.colunas; j++) {
+                    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+                    for (int64_t p = e.inicio[j]; p < e.inicio[j + 1]; p++) {
+                        const int k = e.indices[p];
+                        const double v = e.valores[p];
+                        s0 += a0[k] * v;
+                        s1 += a1[k] * v;
+                        s2 += a2[k] * v;
+                        s3 += a3[k] * v;
+                    }
+                    c(i, j) = s0;
+                    c(i + 1, j) = s1;
+                    c(i + 2, j) = s2;
+                    c(i + 3, j) = s3;
+                }
+                i += 3;
+                continue;
+            }
+            const double* __restrict__ ai = a.densa.linha(i);
+            for (int j = 0; j < c.colunas; j++) {
+                double soma = 0.0;
+                for (int64_t p = e.inicio[j]; p < e.inicio[j + 1]; p++) {
+                    soma += ai[e.indices[p]] * e.valores[p];
+                }
+                ci[j] = soma;
+            }
+            continue;
+        }
+
+        for (int j = 0; j < c.colunas; j++) {
+            ci[j] = 0.0;
+        }
+        const VisaoEsparsa& ea = a.esparsa;
+        for (int64_t p = ea.inicio[i]; p < ea.inicio[i + 1]; p++) {
+            const double v = ea.valores[p];
+            const int k = ea.indices[p];
+            if (FORMA == ESPARSA_CSR_DENSA) {
+                const double* __restrict__ bk = b.densa.linha(k);
+#pragma omp simd
+                for (int j = 0; j < c.colunas; j++) {
+                    ci[j] += v * bk[j];
+                }
+            } else {
+                // Os índices de uma linha de B são distintos: não há conflito no scatter
+                const VisaoEsparsa& eb = b.esparsa;
+                const int32_t* __restrict__ indicesB = eb.indices;
+                const double* __restrict__ valoresB = eb.valores;
+#pragma omp simd
+                for (int64_t q = eb.inicio[k]; q < eb.inicio[k + 1]; q++) {
+                    ci[indicesB[q]] += v * valoresB[q];
+                }
+            }
+        }
+    }
+}
+
+template <FormaEsparsa FORMA>
+__attribute__((target("avx512f")))
+void linhasEsparsasAvx512(const OperandoEsparso& a, const OperandoEsparso& b, VisaoMatriz c, int linha0, int linha1) {
+    corpoLinhasEsparsas<FORMA>(a, b, c, linha0, linha1);
+}
+
+template <FormaEsparsa FORMA>
+__attribute__((target("avx2,fma")))
+void linhasEsparsasAvx2(const OperandoEsparso& a, const OperandoEsparso& b, VisaoMatriz c, int linha0, int linha1) {
+    corpoLinhasEsparsas<FORMA>(a, b, c, linha0, linha1);
+}
+
+template <FormaEsparsa FORMA>
+void linhasEsparsasEscalar(const OperandoEsparso& a, const OperandoEsparso& b, VisaoMatriz c, int linha0, int linha1) {
+    corpoLinhasEsparsas<FORMA>(a, b, c, linha0, linha1);
+}
+
+// Escolhe a versão do conjunto de instruções do micro-kernel em uso (--kernel)
+template <FormaEsparsa FORMA>
+inline void linhasEsparsasDaForma(const OperandoEsparso& a, const OperandoEsparso& b, VisaoMatriz c,
+                                  int linha0, int linha1) {
+    const MicroKernel* uk = &microKernel();
+    if (uk == &kernelAvx512()) {
+        linhasEsparsasAvx512<FORMA>(a, b, c, linha0, linha1);
+    } else if (uk == &kernelAvx2()) {
+        linhasEsparsasAvx2<FORMA>(a, b, c, linha0, linha1);
+    } else {
+        linhasEsparsasEscalar<FORMA>(a, b, c, linha0, linha1);
+    }
+}
+
+inline void calcularLinhasEsparsas(FormaEsparsa forma, const OperandoEsparso& a, const OperandoEsparso& b,
+                                   VisaoMatriz c, int linha0, int linha1) {
+    switch (forma) {
+        case ESPARSA_CSR_DENSA: linhasEsparsasDaForma<ESPARSA_CSR_DENSA>(a, b, c, linha0, linha1); break;
+        case ESPARSA_DENSA_CSC: linhasEsparsasDaForma<ESPARSA_DENSA_CSC>(a, b, c, linha0, linha1); break;
+        case ESPARSA_CSR_CSR: linhasEsparsasDaForma<ESPARSA_CSR_CSR>(a, b, c, linha0, linha1); break;
+        default: break;
+    }
+}
+
+struct ParametrosEsparsa {
+    std::string modo;  // auto, sim ou nao
+    double limiar;     // > 0: substitui as densidades de cruzamento medidas
+
+    ParametrosEsparsa() : modo("auto"), limiar(0.0) {}
+
+    // Opções deste grupo, para Opcoes::aceitarApenas
+    static const char* nomesOpcoes() { return "esparsa,limiar-esparsa"; }
+
+    // Lê --esparsa=auto|sim|nao e --limiar-esparsa=D
+    static bool deOpcoes(const Opcoes& opcoes, ParametrosEsparsa& p) {
+        p.modo = opcoes.texto("esparsa", p.modo);
+        if (p.modo != "auto" && p.modo != "sim" && p.modo != "nao") {
+            std::cerr << "Erro: Valor inválido para --esparsa: " << p.modo << " (use auto, sim ou nao)" << std::endl;
+            return false;
+        }
+        p.limiar = std::atof(opcoes.texto("limiar-esparsa", "0").c_str());
+        if (p.limiar < 0.0 || p.limiar > 1.0) {
+            std::cerr << "Erro: O limiar de densidade (--limiar-esparsa) deve estar entre 0 e 1." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // O caminho esparso só existe para float64 com o algoritmo clássico, fora dos modos em fluxo e em lote
+    bool validar(bool tipoDiferente, bool strassen, bool fluxo, bool lote) const {
+        if (modo == "sim" && (tipoDiferente || strassen || fluxo || lote)) {
+            std::cerr << "Erro: --esparsa=sim só vale para float64 com --algo=classico, sem --fluxo ou --lote"
+                      << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Forma mais barata para as densidades dadas. Com --esparsa=auto, só é
+    // esparsa se o custo estimado for menor que o do kernel denso.
+    FormaEsparsa escolher(double densidadeA, double densidadeB) const {
+        if (modo == "nao") {
+            return ESPARSA_NENHUMA;
+        }
+        double cruzamentoCsrDensa = limiar > 0.0 ? limiar : CRUZAMENTO_CSR_DENSA;
+        double cruzamentoDensaCsc = limiar > 0.0 ? limiar : CRUZAMENTO_DENSA_CSC;
+        double cruzamentoCsrCsr = limiar > 0.0 ? limiar * limiar : CRUZAMENTO_CSR_CSR;
+
+        FormaEsparsa forma = ESPARSA_CSR_DENSA;
+        double custo = densidadeA / cruzamentoCsrDensa;
+        if (densidadeB / cruzamentoDensaCsc < custo) {
+            forma = ESPARSA_DENSA_CSC;
+            custo = densidadeB / cruzamentoDensaCsc;
+        }
+        if (densidadeA * densidadeB / cruzamentoCsrCsr < custo) {
+            forma = ESPARSA_CSR_CSR;
+            custo = densidadeA * densidadeB / cruzamentoCsrCsr;
+        }
+        return modo == "sim" || custo < 1.0 ? forma : ESPARSA_NENHUMA;
+    }
+};
+
+// Produto C = A * B com a forma esparsa escolhida para as densidades de A e B
+class ProdutoEsparso {
+private:
+    FormaEsparsa forma;
+    MatrizEsparsa esparsaA;
+    MatrizEsparsa esparsaB;
+    double operacoes;  // multiplicações e somas efetivamente feitas
+
+public:
+    ProdutoEsparso() : forma(ESPARSA_NENHUMA), operacoes(0.0) {}
+
+    ProdutoEsparso(const ProdutoEsparso&) = delete;
+    ProdutoEsparso& operator=(const ProdutoEsparso&) = delete;
+
+    // Mede as densidades, escolhe a forma e converte os operandos esparsos
+    // (em memória compartilhada, com `compartilhada`). Fora da medição do produto.
+    bool preparar(const MatrizDensa& a, const MatrizDensa& b, const ParametrosEsparsa& parametros,
+                  bool compartilhada) {
+        double elementosA = (double)a.getLinhas() * a.getColunas();
+        double elementosB = (double)b.getLinhas() * b.getColunas();
+        double densidadeA = contarNaoNulos(a.visao()) / elementosA;
+        double densidadeB = contarNaoNulos(b.visao()) / elementosB;
+        forma = parametros.escolher(densidadeA, densidadeB);
+        if (forma == ESPARSA_NENHUMA && parametros.modo == "auto") {
+            return true;
+        }
+        std::printf("Densidade: A %.2f%%, B %.2f%% -> %s\n", 100.0 * densidadeA, 100.0 * densidadeB,
+                    nomeFormaEsparsa(forma));
+        if (forma == ESPARSA_NENHUMA) {
+            return true;
+        }
+
+        long long inicio = agoraNs();
+        bool ok = true;
+        if (forma != ESPARSA_DENSA_CSC) {
+            ok = esparsaA.converter(a.visao(), false, compartilhada ? nomeCompartilhadoUnico("esparsa") : "");
+        }
+        if (ok && forma != ESPARSA_CSR_DENSA) {
+            ok = esparsaB.converter(b.visao(), forma == ESPARSA_DENSA_CSC,
+                                    compartilhada ? nomeCompartilhadoUnico("esparsa") : "");
+        }
+        if (!ok) {
+            return false;
+        }
+        long long fim = agoraNs();
+        registrarTrecho("converter para CSR/CSC", inicio, fim);
+        std::printf("Conversão para %s: %.3f ms\n", nomeFormaEsparsa(forma), (fim - inicio) * 1e-6);
+
+        int m = a.getLinhas();
+        int n = b.getColunas();
+        if (forma == ESPARSA_CSR_DENSA) {
+            operacoes = 2.0 * esparsaA.visao().naoNulos * n;
+        } else if (forma == ESPARSA_DENSA_CSC) {
+            operacoes = 2.0 * m * esparsaB.visao().naoNulos;
+        } else {
+            // Cada não nulo a_ik encontra os não nulos da linha k de B
+            VisaoEsparsa ea = esparsaA.visao();
+            VisaoEsparsa eb = esparsaB.visao();
+            operacoes = 0.0;
+            for (int64_t p = 0; p < ea.naoNulos; p++) {
+                int k = ea.indices[p];
+                operacoes += 2.0 * (eb.inicio[k + 1] - eb.inicio[k]);
+            }
+        }
+        return true;
+    }
+
+    bool ativo() const { return forma != ESPARSA_NENHUMA; }
+    FormaEsparsa getForma() const { return forma; }
+    double getOperacoes() const { return operacoes; }
+
+    // Operandos na representação usada pela forma escolhida
+    OperandoEsparso operandoA(const MatrizDensa& a) const {
+        OperandoEsparso op;
+        op.densa = a.visao();
+        op.esparsa = forma == ESPARSA_DENSA_CSC ? VisaoEsparsa() : esparsaA.visao();
+        return op;
+    }
+
+    OperandoEsparso operandoB(const MatrizDensa& b) const {
+        OperandoEsparso op;
+        op.densa = b.visao();
+        op.esparsa = forma == ESPARSA_CSR_DENSA ? VisaoEsparsa() : esparsaB.visao();
+        return op;
+    }
+
+    // Descritores de A e B para os filhos do pool: o objeto esparso ou a matriz densa
+    bool descrever(const MatrizDensa& a, const MatrizDensa& b, DescritorMatriz& descA,
+                   DescritorMatriz& descB) const {
+        bool okA = forma == ESPARSA_DENSA_CSC ? a.descrever(descA) : esparsaA.descrever(descA);
+        bool okB = forma == ESPARSA_CSR_DENSA ? b.descrever(descB) : esparsaB.descrever(descB);
+        return okA && okB;
+    }
+
+    // Nos mesmos blocos de linhas das threads e dos processos, para dar o mesmo resultado
+    void multiplicarSequencial(const MatrizDensa& a, const MatrizDensa& b, MatrizDensa& c) const {
+        OperandoEsparso opA = operandoA(a);
+        OperandoEsparso opB = operandoB(b);
+        for (int linha0 = 0; linha0 < c.getLinhas(); linha0 += LINHAS_TAREFA_ESPARSA) {
+            calcularLinhasEsparsas(forma, opA, opB, c.visao(), linha0,
+                                   std::min(c.getLinhas(), linha0 + LINHAS_TAREFA_ESPARSA));
+        }
+    }
+};
+
+// Desempenho do produto esparso: as operações feitas e o equivalente denso (2n³)
+inline void relatarDesempenhoEsparso(const ProdutoEsparso& produto, int dimensao, double segundos,
+                                     int numTrabalhadores) {
+    relatarDesempenho(produto.getOperacoes(), segundos, numTrabalhadores);
+    double denso = 2.0 * dimensao * dimensao * dimensao;
+    std::printf("Equivalente denso: %.2f GFLOP/s (%s, %.2f%% das operações do kernel denso)\n",
+                segundos > 0.0 ? denso / segundos / 1e9 : 0.0, nomeFormaEsparsa(produto.getForma()),
+                100.0 * produto.getOperacoes() / denso);
+}
+
+#endif
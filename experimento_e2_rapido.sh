@@ -21,6 +21,16 @@ echo
 # Valores de P para testar
 VALORES_P=(1 2 4 6 8)
 
+# Em máquinas com mais de um soquete, P passa do tamanho de um soquete: inclui
+# também o número de CPUs da máquina. Os trabalhadores são fixados em CPUs
+# (preenchendo um soquete antes do próximo) e as matrizes intercaladas entre os
+# nós NUMA; defina OPCOES_PARALELO="" para medir sem afinidade.
+NUM_CPUS=$(nproc)
+if [[ ! " ${VALORES_P[*]} " =~ " ${NUM_CPUS} " ]] && [ "$NUM_CPUS" -gt "${VALORES_P[-1]}" ]; then
+    VALORES_P+=($NUM_CPUS)
+fi
+OPCOES_PARALELO=${OPCOES_PARALELO---pin=compact --numa=interleave}
+
 # Criar cabeçalho do arquivo CSV
 echo "P,Threads_ms,Processos_ms,Speedup_Threads,Speedup_Processos" > $ARQUIVO_RESULTADOS_E2
 
@@ -31,12 +41,12 @@ for p in "${VALORES_P[@]}"; do
     
     # Teste com Threads
     echo "Executando versão com $p threads..."
-    tempo_threads=$(./multiplicacao_threads $TAMANHO_TESTE $p | grep "Tempo de execução:" | head -1 | awk '{print $4}')
+    tempo_threads=$(./multiplicacao_threads $TAMANHO_TESTE $p $OPCOES_PARALELO | grep "Tempo de execução:" | head -1 | awk '{print $4}')
     echo "Tempo threads: ${tempo_threads} ms"
     
     # Teste com Processos
     echo "Executando versão com $p processos..."
-    tempo_processos=$(./multiplicacao_processos $TAMANHO_TESTE $p | grep "Tempo de execução:" | head -1 | awk '{print $4}')
+    tempo_processos=$(./multiplicacao_processos $TAMANHO_TESTE $p $OPCOES_PARALELO | grep "Tempo de execução:" | head -1 | awk '{print $4}')
     echo "Tempo processos: ${tempo_processos} ms"
     
     # Calcular speedup em relação ao sequencial
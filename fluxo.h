@@ -0,0 +1,428 @@
+#ifndef FLUXO_H
+#define FLUXO_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include "formato_binario.h"
+#include "matriz.h"
+#include "memoria_compartilhada.h"
+#include "microkernel.h"
+#include "opcoes.h"
+#include "rastreamento.h"
+#include "strassen.h"
+#include "verificacao.h"
+
+/**
+ * Multiplicação em fluxo (--fluxo), para matrizes maiores que a memória.
+ *
+ * A, B e C ficam em arquivos binários; na memória só existem painéis:
+ * A e C em painéis de linhas inteiras, B em painéis de colunas. Para cada
+ * painel de A são percorridos todos os painéis de B, e cada par calcula um
+ * bloco do painel de C, que é gravado no arquivo ao terminar.
+ *
+ * O tamanho dos painéis sai do orçamento de memória (--memoria, padrão 256M),
+ * que cobre todos os buffers: dois de A, dois de C e dois de B (um só, se B
+ * inteiro couber e puder ficar residente). Como B é relido uma vez por
+ * painel de A, os painéis de B ficam estreitos (até um quarto do orçamento,
+ * ou --painel-b=N colunas) para que os de A sejam altos. Com dois buffers de
+ * cada, a leitura do próximo painel e a gravação do painel anterior de C
+ * correm em segundo plano (std::async) enquanto o kernel calcula o atual. O
+ * pico de memória residente fica limitado ao orçamento, seja qual for N.
+ *
+ * O cálculo de cada bloco é delegado a um KernelFluxo, o que permite usar a
+ * mesma rotina com uma thread, com o pool de threads ou com o pool de
+ * processos (buffers em memória compartilhada).
+ */
+
+struct ParametrosFluxo {
+    bool ativo;
+    size_t orcamento;   // bytes para todos os buffers de painéis
+    int colunasPainelB; // largura dos painéis de B quando B não cabe inteiro (0 = automática)
+
+    ParametrosFluxo() : ativo(false), orcamento(256u << 20), colunasPainelB(0) {}
+
+    // Aceita "512M", "2G", "65536K" ou um número de bytes
+    static bool interpretarTamanho(const std::string& texto, size_t& bytes) {
+        char* resto;
+        double valor = strtod(texto.c_str(), &resto);
+        std::string sufixo(resto);
+        double fator = 1.0;
+        if (sufixo == "K" || sufixo == "k") {
+            fator = 1024.0;
+        } else if (sufixo == "M" || sufixo == "m") {
+            fator = 1024.0 * 1024.0;
+        } else if (sufixo == "G" || sufixo == "g") {
+            fator = 1024.0 * 1024.0 * 1024.0;
+        } else if (!sufixo.empty()) {
+            return false;
+        }
+        if (resto == texto.c_str() || valor <= 0) {
+            return false;
+        }
+        bytes = (size_t)(valor * fator);
+        return true;
+    }
+
+    // Opções deste grupo, para Opcoes::aceitarApenas
+    static const char* nomesOpcoes() { return "fluxo,memoria,painel-b"; }
+
+    // Lê --fluxo, --memoria=TAMANHO e --painel-b=N
+    static bool deOpcoes(const Opcoes& opcoes, ParametrosFluxo& p) {
+        p.ativo = opcoes.tem("fluxo");
+        if (opcoes.tem("memoria") && !interpretarTamanho(opcoes.texto("memoria", ""), p.orcamento)) {
+            std::cerr << "Erro: Valor inválido para --memoria: " << opcoes.texto("memoria", "")
+                      << " (use, por exemplo, 512M ou 2G)" << std::endl;
+            return false;
+        }
+        p.colunasPainelB = opcoes.inteiro("painel-b", p.colunasPainelB);
+        if (p.colunasPainelB < 0) {
+            std::cerr << "Erro: A largura dos painéis de B (--painel-b) não pode ser negativa." << std::endl;
+            return false;
+        }
+        if (p.ativo && opcoes.texto("algo", "classico") != "classico") {
+            std::cerr << "Erro: O modo em fluxo usa apenas o algoritmo clássico." << std::endl;
+            return false;
+        }
+        return true;
+    }
+};
+
+// Calcula o bloco C = A * B; as regiões apontam para os buffers de painéis
+typedef std::function<bool(const RegiaoMatriz&, const RegiaoMatriz&, const RegiaoMatriz&)> KernelFluxo;
+
+// Bytes de um buffer de `linhas` x `colunas` com o passo de MatrizDensa
+inline size_t bytesPainel(int linhas, int colunas) {
+    return (size_t)linhas * calcularPasso(colunas, true) * sizeof(double);
+}
+
+struct PlanoFluxo {
+    int linhasPainelA;
+    int colunasPainelB;
+    bool bResidente;
+    size_t bytesBuffers;
+};
+
+// Escolhe os painéis para C (m x n) = A (m x k) * B (k x n) dentro do orçamento
+inline bool planejarFluxo(int m, int k, int n, const ParametrosFluxo& pf, PlanoFluxo& plano) {
+    // Dois buffers de A e dois de C por linha de painel
+    size_t porLinha = 2 * (bytesPainel(1, k) + bytesPainel(1, n));
+    int linhasMinimas = std::min(m, 8);
+
+    // B inteiro residente, se ainda sobrar espaço para painéis de A razoáveis
+    size_t bytesB = bytesPainel(k, n);
+    if (bytesB < pf.orcamento && (pf.orcamento - bytesB) / porLinha >= (size_t)std::min(m, 64)) {
+        plano.bResidente = true;
+        plano.colunasPainelB = n;
+    } else {
+        // B é relido uma vez por painel de A: painéis de B estreitos (até um
+        // quarto do orçamento) deixam os de A mais altos e reduzem a releitura
+        plano.bResidente = false;
+        int largura = pf.colunasPainelB;
+        if (largura == 0) {
+            largura = (int)(pf.orcamento / 4 / (2 * bytesPainel(k, 1)));
+            largura = std::max(64, largura - largura % 64);
+        }
+        plano.colunasPainelB = std::min(largura, n);
+        bytesB = 2 * bytesPainel(k, plano.colunasPainelB);
+    }
+
+    size_t linhas = bytesB < pf.orcamento ? (pf.orcamento - bytesB) / porLinha : 0;
+    if (linhas < (size_t)linhasMinimas) {
+        size_t minimo = bytesB + linhasMinimas * porLinha;
+        std::cerr << "Erro: Orçamento de memória insuficiente; são necessários pelo menos "
+                  << (minimo + (1 << 20) - 1) / (1 << 20) << " MiB (ou painéis de B mais estreitos)"
+                  << std::endl;
+        return false;
+    }
+    int mr = (int)std::min(linhas, (size_t)m);
+    if (mr < m && mr > 8) {
+        mr -= mr % 8;  // múltiplo da altura dos micro-kernels
+    }
+    // Com um único painel de A, um buffer de A e um de C bastam
+    bool duplo = mr < m;
+    plano.linhasPainelA = mr;
+    plano.bytesBuffers = bytesB + (duplo ? 2 : 1) * mr * porLinha / 2;
+    return true;
+}
+
+// pread/pwrite completos a partir de `deslocamento`
+inline bool lerTudoEm(int fd, void* destino, size_t bytes, off_t deslocamento) {
+    char* p = static_cast<char*>(destino);
+    while (bytes > 0) {
+        ssize_t lidos = pread(fd, p, bytes, deslocamento);
+        if (lidos <= 0) {
+            return false;
+        }
+        p += lidos;
+        bytes -= lidos;
+        deslocamento += lidos;
+    }
+    return true;
+}
+
+inline bool escreverTudoEm(int fd, const void* dados, size_t bytes, off_t deslocamento) {
+    const char* p = static_cast<const char*>(dados);
+    while (bytes > 0) {
+        ssize_t escritos = pwrite(fd, p, bytes, deslocamento);
+        if (escritos <= 0) {
+            return false;
+        }
+        p += escritos;
+        bytes -= escritos;
+        deslocamento += escritos;
+    }
+    return true;
+}
+
+// Arquivo binário de matriz aberto para acesso por regiões
+struct ArquivoMatriz {
+    int fd;
+    CabecalhoMatrizBinaria cab;
+
+    ArquivoMatriz() : fd(-1) {}
+    ~ArquivoMatriz() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    ArquivoMatriz(const ArquivoMatriz&) = delete;
+    ArquivoMatriz& operator=(const ArquivoMatriz&) = delete;
+
+    bool abrir(const std::string& nomeArquivo) {
+        if (!lerCabecalhoBinario(nomeArquivo, cab)) {
+            return false;
+        }
+        fd = open(nomeArquivo.c_str(), O_RDONLY);
+        return fd >= 0;
+    }
+
+    // Cria o arquivo com o cabeçalho e o tamanho final; as linhas são gravadas depois
+    bool criar(const std::string& nomeArquivo, int linhas, int colunas) {
+        fd = open(nomeArquivo.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::cerr << "Erro ao criar arquivo: " << nomeArquivo << std::endl;
+            return false;
+        }
+        cab = criarCabecalho(linhas, colunas, calcularPasso(colunas, true));
+        off_t tamanho = cab.tamanhoCabecalho + (off_t)linhas * cab.passo * sizeof(double);
+        if (!escreverTudoEm(fd, &cab, sizeof(cab), 0) || ftruncate(fd, tamanho) != 0) {
+            std::cerr << "Erro ao escrever arquivo: " << nomeArquivo << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    off_t deslocamento(int linha, int coluna) const {
+        return cab.tamanhoCabecalho + ((off_t)linha * cab.passo + coluna) * sizeof(double);
+    }
+
+    // Linhas inteiras com o mesmo passo do arquivo viram uma única operação
+    bool contiguo(int coluna0, int colunas, int passo) const {
+        return coluna0 == 0 && (uint64_t)colunas == cab.colunas && (uint64_t)passo == cab.passo;
+    }
+
+    // Lê a região que começa em (linha0, coluna0) com o tamanho de `destino`
+    bool ler(int linha0, int coluna0, VisaoMatriz destino) const {
+        if (contiguo(coluna0, destino.colunas, destino.passo)) {
+            return lerTudoEm(fd, destino.dados, (size_t)destino.linhas * destino.passo * sizeof(double),
+                             deslocamento(linha0, 0));
+        }
+        for (int i = 0; i < destino.linhas; i++) {
+            if (!lerTudoEm(fd, destino.linha(i), destino.colunas * sizeof(double),
+                           deslocamento(linha0 + i, coluna0))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool escrever(int linha0, VisaoMatrizConst origem) const {
+        if (contiguo(0, origem.colunas, origem.passo)) {
+            return escreverTudoEm(fd, origem.dados, (size_t)origem.linhas * origem.passo * sizeof(double),
+                                  deslocamento(linha0, 0));
+        }
+        for (int i = 0; i < origem.linhas; i++) {
+            if (!escreverTudoEm(fd, origem.linha(i), origem.colunas * sizeof(double),
+                                deslocamento(linha0 + i, 0))) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+struct EstatisticasFluxo {
+    PlanoFluxo plano;
+    int paineisA;
+    int paineisB;
+    double bytesLidos;
+    double bytesEscritos;
+    double segundosEsperandoES;  // tempo em que o cálculo ficou parado esperando leitura/gravação
+};
+
+// Espera uma leitura ou gravação em segundo plano, contabilizando a espera
+inline bool aguardarES(std::future<bool>& operacao, EstatisticasFluxo& estat) {
+    if (!operacao.valid()) {
+        return true;
+    }
+    long long inicio = agoraNs();
+    bool ok = operacao.get();
+    long long fim = agoraNs();
+    estat.segundosEsperandoES += (fim - inicio) * 1e-9;
+    registrarTrecho("esperar E/S", inicio, fim);
+    return ok;
+}
+
+// C = A * B lendo A e B de arquivos binários e gravando C em `arquivoC`.
+// Com `compartilhada`, os buffers ficam em memória compartilhada (pool de processos).
+inline bool multiplicarEmFluxo(const std::string& arquivoA, const std::string& arquivoB,
+                               const std::string& arquivoC, const ParametrosFluxo& pf, bool compartilhada,
+                               const KernelFluxo& kernel, EstatisticasFluxo& estat) {
+    ArquivoMatriz a, b, c;
+    if (!a.abrir(arquivoA) || !b.abrir(arquivoB)) {
+        return false;
+    }
+    int m = (int)a.cab.linhas, k = (int)a.cab.colunas, n = (int)b.cab.colunas;
+    if ((int)b.cab.linhas != k) {
+        std::cerr << "Erro: Dimensões incompatíveis para multiplicação" << std::endl;
+        return false;
+    }
+
+    PlanoFluxo& plano = estat.plano;
+    if (!planejarFluxo(m, k, n, pf, plano) || !c.criar(arquivoC, m, n)) {
+        return false;
+    }
+    int mr = plano.linhasPainelA, nc = plano.colunasPainelB;
+    estat.paineisA = (m + mr - 1) / mr;
+    estat.paineisB = (n + nc - 1) / nc;
+    estat.bytesLidos = estat.bytesEscritos = estat.segundosEsperandoES = 0.0;
+
+    auto novoBuffer = [&](int linhas, int colunas) {
+        return std::unique_ptr<MatrizDensa>(
+            compartilhada ? new MatrizDensa(linhas, colunas, true, nomeCompartilhadoUnico("fluxo"))
+                          : new MatrizDensa(linhas, colunas, true, SemInicializar()));
+    };
+    int numDuplos = estat.paineisA > 1 ? 2 : 1;
+    std::unique_ptr<MatrizDensa> buffersA[2], buffersC[2], buffersB[2];
+    for (int x = 0; x < numDuplos; x++) {
+        buffersA[x] = novoBuffer(mr, k);
+        buffersC[x] = novoBuffer(mr, n);
+    }
+    for (int x = 0; x < (plano.bResidente ? 1 : 2); x++) {
+        buffersB[x] = novoBuffer(k, nc);
+    }
+
+    // Painel i de A (ou de C): linhas [i * mr, i * mr + linhasPainel(i))
+    auto linhasPainel = [&](int i) { return std::min(mr, m - i * mr); };
+    auto colunasPainel = [&](int j) { return std::min(nc, n - j * nc); };
+
+    auto lerA = [&](int i) {
+        VisaoMatriz destino = buffersA[i % 2]->visao().sub(0, 0, linhasPainel(i), k);
+        estat.bytesLidos += (double)destino.linhas * k * sizeof(double);
+        const ArquivoMatriz* arq = &a;
+        int linha0 = i * mr;
+        return std::async(std::launch::async, [arq, linha0, destino] { return arq->ler(linha0, 0, destino); });
+    };
+    // t = i * paineisB + j percorre todos os pares (painel de A, painel de B)
+    auto lerB = [&](int t) {
+        int j = t % estat.paineisB;
+        VisaoMatriz destino = buffersB[plano.bResidente ? 0 : t % 2]->visao().sub(0, 0, k, colunasPainel(j));
+        estat.bytesLidos += (double)k * destino.colunas * sizeof(double);
+        const ArquivoMatriz* arq = &b;
+        int coluna0 = j * nc;
+        return std::async(std::launch::async, [arq, coluna0, destino] { return arq->ler(0, coluna0, destino); });
+    };
+
+    std::future<bool> leiturasA[2], leiturasB[2], gravacoesC[2];
+    bool ok = true;
+    int totalPares = estat.paineisA * estat.paineisB;
+    leiturasA[0] = lerA(0);
+    leiturasB[0] = lerB(0);
+
+    for (int i = 0; ok && i < estat.paineisA; i++) {
+        int x = i % 2;
+        if (i + 1 < estat.paineisA) {
+            leiturasA[(i + 1) % 2] = lerA(i + 1);
+        }
+        // O buffer de C deste painel pode ainda estar sendo gravado (painel i - 2)
+        ok = aguardarES(leiturasA[x], estat) && aguardarES(gravacoesC[x], estat);
+
+        RegiaoMatriz regiaoA = RegiaoMatriz(*buffersA[x]).sub(0, 0, linhasPainel(i), k);
+        RegiaoMatriz regiaoC = RegiaoMatriz(*buffersC[x]).sub(0, 0, linhasPainel(i), n);
+        for (int j = 0; ok && j < estat.paineisB; j++) {
+            int t = i * estat.paineisB + j;
+            int y = plano.bResidente ? 0 : t % 2;
+            if (!plano.bResidente && t + 1 < totalPares) {
+                leiturasB[(t + 1) % 2] = lerB(t + 1);
+            }
+            ok = aguardarES(leiturasB[y], estat);
+
+            RegiaoMatriz regiaoB = RegiaoMatriz(*buffersB[y]).sub(0, 0, k, colunasPainel(j));
+            TrechoRastro trecho("bloco em fluxo", t);
+            ok = ok && kernel(regiaoA, regiaoB, regiaoC.sub(0, j * nc, regiaoC.linhas, regiaoB.colunas));
+        }
+
+        if (ok) {
+            VisaoMatrizConst origem = regiaoC.visao();
+            estat.bytesEscritos += (double)origem.linhas * n * sizeof(double);
+            const ArquivoMatriz* arq = &c;
+            int linha0 = i * mr;
+            gravacoesC[x] = std::async(std::launch::async, [arq, linha0, origem] { return arq->escrever(linha0, origem); });
+        }
+    }
+
+    // Espera tudo o que ainda estiver em segundo plano antes de liberar os buffers
+    for (int x = 0; x < 2; x++) {
+        ok = aguardarES(leiturasA[x], estat) && ok;
+        ok = aguardarES(leiturasB[x], estat) && ok;
+        ok = aguardarES(gravacoesC[x], estat) && ok;
+    }
+    if (!ok) {
+        std::cerr << "Erro na leitura ou gravação dos painéis" << std::endl;
+    }
+    return ok;
+}
+
+// Executa e relata a multiplicação em fluxo de matriz_a_N.bin por matriz_b_N.bin
+// e, com --verify, confere o resultado nos arquivos
+inline bool executarEmFluxo(int dimensao, const std::string& arquivoResultado, const ParametrosFluxo& pf,
+                            bool compartilhada, const KernelFluxo& kernel, int numTrabalhadores,
+                            const ParametrosVerificacao& verificacao) {
+    std::string arquivoA = "matriz_a_" + std::to_string(dimensao) + ".bin";
+    std::string arquivoB = "matriz_b_" + std::to_string(dimensao) + ".bin";
+    std::cout << "Multiplicação em fluxo de " << arquivoA << " e " << arquivoB << " para "
+              << arquivoResultado << " (orçamento de " << pf.orcamento / (1024.0 * 1024.0) << " MiB)"
+              << std::endl;
+
+    EstatisticasFluxo estat;
+    auto inicio = std::chrono::steady_clock::now();
+    if (!multiplicarEmFluxo(arquivoA, arquivoB, arquivoResultado, pf, compartilhada, kernel, estat)) {
+        return false;
+    }
+    double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+    const PlanoFluxo& plano = estat.plano;
+    std::printf("Painéis: %d de A com %d linhas, %d de B com %d colunas%s; buffers %.1f MiB\n",
+                estat.paineisA, plano.linhasPainelA, estat.paineisB, plano.colunasPainelB,
+                plano.bResidente ? " (B residente)" : "", plano.bytesBuffers / (1024.0 * 1024.0));
+    std::printf("E/S: %.1f MiB lidos, %.1f MiB gravados; cálculo esperou %.1f ms por E/S\n",
+                estat.bytesLidos / (1024.0 * 1024.0), estat.bytesEscritos / (1024.0 * 1024.0),
+                estat.segundosEsperandoES * 1000.0);
+    std::printf("Pico de memória residente: %.1f MiB\n", picoMemoriaResidenteMiB());
+    std::cout << "Multiplicação em fluxo concluída!" << std::endl;
+    std::printf("Tempo de execução: %.0f ms (incluindo leitura e gravação)\n", segundos * 1000.0);
+    relatarDesempenho(2.0 * dimensao * dimensao * dimensao, segundos, numTrabalhadores);
+    return !verificacao.ativa() || verificarArquivosBinarios(arquivoA, arquivoB, arquivoResultado, verificacao);
+}
+
+#endif
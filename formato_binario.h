@@ -0,0 +1,226 @@
+#ifndef FORMATO_BINARIO_H
+#define FORMATO_BINARIO_H
+
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "tipo_elemento.h"
+
+/**
+ * Formato binário de matrizes (.bin).
+ *
+ * O arquivo começa com um cabeçalho de 64 bytes seguido dos dados em
+ * little-endian, armazenados por linhas com `passo` elementos por linha.
+ * Como o cabeçalho tem o tamanho de uma linha de cache e o passo é o mesmo
+ * usado por MatrizDensa, o arquivo pode ser mapeado com mmap e usado
+ * diretamente como matriz, sem cópia nem conversão. O campo tipoDado diz o
+ * tipo dos elementos (ver tipo_elemento.h); quem lê informa o tipo esperado.
+ */
+
+const char MAGICA_MATRIZ_BINARIA[8] = { 'M', 'A', 'T', 'R', 'I', 'Z', 'B', '\0' };
+const uint32_t VERSAO_MATRIZ_BINARIA = 1;
+
+struct CabecalhoMatrizBinaria {
+    char magica[8];
+    uint32_t versao;
+    uint32_t tipoDado;
+    uint64_t linhas;
+    uint64_t colunas;
+    uint64_t passo;             // elementos por linha no arquivo (>= colunas)
+    uint32_t alinhamento;       // alinhamento em bytes do início de cada linha
+    uint32_t tamanhoCabecalho;  // deslocamento dos dados a partir do início do arquivo
+    uint8_t reservado[16];
+};
+
+static_assert(sizeof(CabecalhoMatrizBinaria) == 64, "cabeçalho binário deve ter 64 bytes");
+
+inline bool hostLittleEndian() {
+    const uint16_t teste = 1;
+    uint8_t primeiroByte;
+    memcpy(&primeiroByte, &teste, 1);
+    return primeiroByte == 1;
+}
+
+inline bool terminaCom(const std::string& texto, const std::string& sufixo) {
+    return texto.size() >= sufixo.size() &&
+           texto.compare(texto.size() - sufixo.size(), sufixo.size(), sufixo) == 0;
+}
+
+// Arquivos com extensão .bin usam o formato binário; os demais, texto
+inline bool ehArquivoBinario(const std::string& nomeArquivo) {
+    return terminaCom(nomeArquivo, ".bin");
+}
+
+// Resolve a opção --formato=texto|binario|auto na extensão dos arquivos.
+// O padrão é texto, o formato gravado por gerador_matrizes sem --formato. Em
+// "auto", usa o mais recente de `base`.txt e `base`.bin, avisando quando é o
+// .bin (que pode ter sobrado de outra execução com a mesma dimensão).
+inline bool escolherExtensao(const std::string& formato, const std::string& base,
+                             std::string& extensao) {
+    if (formato.empty() || formato == "texto") {
+        extensao = ".txt";
+    } else if (formato == "binario") {
+        extensao = ".bin";
+    } else if (formato == "auto") {
+        struct stat texto, binario;
+        bool temTexto = stat((base + ".txt").c_str(), &texto) == 0;
+        bool temBinario = stat((base + ".bin").c_str(), &binario) == 0;
+        bool binarioMaisNovo = temBinario && (!temTexto || binario.st_mtim.tv_sec > texto.st_mtim.tv_sec ||
+                                              (binario.st_mtim.tv_sec == texto.st_mtim.tv_sec &&
+                                               binario.st_mtim.tv_nsec >= texto.st_mtim.tv_nsec));
+        extensao = binarioMaisNovo ? ".bin" : ".txt";
+        if (binarioMaisNovo && temTexto) {
+            std::cerr << "Aviso: --formato=auto: usando " << base << ".bin, mais recente que " << base << ".txt"
+                      << std::endl;
+        }
+    } else {
+        std::cerr << "Erro: Formato desconhecido: " << formato
+                  << " (use texto, binario ou auto)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+inline CabecalhoMatrizBinaria criarCabecalho(int linhas, int colunas, int passo, TipoDado tipo = TIPO_FLOAT64) {
+    CabecalhoMatrizBinaria cab;
+    memset(&cab, 0, sizeof(cab));
+    memcpy(cab.magica, MAGICA_MATRIZ_BINARIA, sizeof(cab.magica));
+    cab.versao = VERSAO_MATRIZ_BINARIA;
+    cab.tipoDado = tipo;
+    cab.linhas = linhas;
+    cab.colunas = colunas;
+    cab.passo = passo;
+    cab.alinhamento = 64;
+    cab.tamanhoCabecalho = sizeof(CabecalhoMatrizBinaria);
+    return cab;
+}
+
+// `esperado` = TIPO_QUALQUER aceita qualquer tipo conhecido
+inline bool validarCabecalho(const CabecalhoMatrizBinaria& cab, uint64_t tamanhoArquivo,
+                             const std::string& nomeArquivo, TipoDado esperado = TIPO_FLOAT64) {
+    if (memcmp(cab.magica, MAGICA_MATRIZ_BINARIA, sizeof(cab.magica)) != 0) {
+        std::cerr << "Erro: " << nomeArquivo << " não é uma matriz binária" << std::endl;
+        return false;
+    }
+    if (cab.versao != VERSAO_MATRIZ_BINARIA) {
+        std::cerr << "Erro: Versão " << cab.versao << " do formato binário não suportada" << std::endl;
+        return false;
+    }
+    size_t bytesElemento = bytesTipoDado((TipoDado)cab.tipoDado);
+    if (bytesElemento == 0) {
+        std::cerr << "Erro: Tipo de dado " << cab.tipoDado << " não suportado em " << nomeArquivo << std::endl;
+        return false;
+    }
+    if (esperado != TIPO_QUALQUER && cab.tipoDado != (uint32_t)esperado) {
+        std::cerr << "Erro: " << nomeArquivo << " tem elementos " << nomeTipoDado((TipoDado)cab.tipoDado)
+                  << ", mas o esperado era " << nomeTipoDado(esperado) << " (veja --dtype)" << std::endl;
+        return false;
+    }
+    // O arquivo pode vir de qualquer lugar (ex.: um cliente do servidor): as
+    // dimensões viram int nas visões, e os dados precisam caber no arquivo.
+    // O alinhamento é uma potência de dois de no máximo uma página (o início
+    // do mapeamento), respeitada pelo cabeçalho e por cada linha.
+    uint64_t bytesLinha = cab.passo * bytesElemento;
+    if (cab.linhas == 0 || cab.colunas == 0 || cab.linhas > INT_MAX || cab.colunas > INT_MAX ||
+        cab.passo < cab.colunas || cab.passo > INT_MAX || cab.tamanhoCabecalho < sizeof(CabecalhoMatrizBinaria) ||
+        cab.alinhamento == 0 || cab.alinhamento > 4096 || (cab.alinhamento & (cab.alinhamento - 1)) != 0 ||
+        cab.tamanhoCabecalho % cab.alinhamento != 0 || bytesLinha % cab.alinhamento != 0) {
+        std::cerr << "Erro: Cabeçalho inválido em " << nomeArquivo << std::endl;
+        return false;
+    }
+    if (tamanhoArquivo < cab.tamanhoCabecalho ||
+        (tamanhoArquivo - cab.tamanhoCabecalho) / bytesLinha < cab.linhas) {
+        std::cerr << "Erro: Arquivo binário truncado: " << nomeArquivo << std::endl;
+        return false;
+    }
+    if (!hostLittleEndian()) {
+        std::cerr << "Erro: O formato binário só é suportado em máquinas little-endian" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Bytes do arquivo ocupados pelo cabeçalho e pelos dados (cabeçalho já validado)
+inline size_t bytesMatrizBinaria(const CabecalhoMatrizBinaria& cab) {
+    return cab.tamanhoCabecalho + cab.linhas * cab.passo * bytesTipoDado((TipoDado)cab.tipoDado);
+}
+
+// Lê apenas o cabeçalho de um arquivo binário
+inline bool lerCabecalhoBinario(const std::string& nomeArquivo, CabecalhoMatrizBinaria& cab,
+                                TipoDado esperado = TIPO_FLOAT64) {
+    int fd = open(nomeArquivo.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Erro ao abrir arquivo: " << nomeArquivo << std::endl;
+        return false;
+    }
+    struct stat info;
+    bool lido = fstat(fd, &info) == 0 && pread(fd, &cab, sizeof(cab), 0) == (ssize_t)sizeof(cab);
+    close(fd);
+    if (!lido) {
+        std::cerr << "Erro: Arquivo binário truncado: " << nomeArquivo << std::endl;
+        return false;
+    }
+    return validarCabecalho(cab, info.st_size, nomeArquivo, esperado);
+}
+
+// Região de arquivo mapeada em memória
+struct MapeamentoArquivo {
+    void* base;
+    size_t tamanho;
+};
+
+// Mapeia um arquivo binário de matriz com MAP_PRIVATE (cópia sob escrita):
+// a leitura não copia nada, e eventuais escritas não alteram o arquivo.
+// MAP_POPULATE traz as páginas já no carregamento, e não durante o cálculo.
+inline bool mapearMatrizBinaria(const std::string& nomeArquivo, CabecalhoMatrizBinaria& cab,
+                                MapeamentoArquivo& mapa, TipoDado esperado = TIPO_FLOAT64) {
+    int fd = open(nomeArquivo.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Erro ao abrir arquivo: " << nomeArquivo << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(cab) ||
+        pread(fd, &cab, sizeof(cab), 0) != (ssize_t)sizeof(cab)) {
+        std::cerr << "Erro: Arquivo binário truncado: " << nomeArquivo << std::endl;
+        close(fd);
+        return false;
+    }
+    if (!validarCabecalho(cab, info.st_size, nomeArquivo, esperado)) {
+        close(fd);
+        return false;
+    }
+
+    mapa.tamanho = bytesMatrizBinaria(cab);
+    mapa.base = mmap(nullptr, mapa.tamanho, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (mapa.base == MAP_FAILED) {
+        std::cerr << "Erro ao mapear arquivo: " << nomeArquivo << std::endl;
+        mapa.base = nullptr;
+        return false;
+    }
+    return true;
+}
+
+// Escreve todo o buffer, repetindo write() enquanto houver bytes pendentes
+inline bool escreverTudo(int fd, const void* dados, size_t bytes) {
+    const char* p = static_cast<const char*>(dados);
+    while (bytes > 0) {
+        ssize_t escritos = write(fd, p, bytes);
+        if (escritos <= 0) {
+            return false;
+        }
+        p += escritos;
+        bytes -= escritos;
+    }
+    return true;
+}
+
+#endif
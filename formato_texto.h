@@ -0,0 +1,586 @@
+#ifndef FORMATO_TEXTO_H
+#define FORMATO_TEXTO_H
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sys/uio.h>
+#include <thread>
+#include <vector>
+#include "formato_binario.h"
+
+/**
+ * Formato texto de matrizes (.txt).
+ *
+ * A primeira linha tem a dimensão N e cada uma das N linhas seguintes, os
+ * elementos de uma linha da matriz separados por espaço. Uma matriz
+ * retangular tem na primeira linha o número de linhas e o de colunas
+ * ("300 200"); as quadradas continuam com um número só. Os reais são
+ * escritos com duas casas decimais (o texto de fixed << setprecision(2)) e
+ * os inteiros, como número.
+ *
+ * Leitura e escrita não usam iostream. Na leitura o arquivo é mapeado, o
+ * início de cada linha é localizado com memchr e faixas de linhas são
+ * interpretadas em paralelo, uma thread por faixa. Na escrita, cada thread
+ * formata uma faixa de linhas em seu buffer e os buffers são gravados em
+ * ordem com um único writev. As conversões não alocam memória e dão
+ * exatamente o resultado de strtod/strtof e de printf("%.2f"): os casos
+ * comuns têm um caminho rápido exato, e os demais (expoentes, números muito
+ * grandes ou com muitos dígitos, inf e nan) usam a biblioteca C.
+ */
+
+// Abaixo disso, criar uma thread custa mais que interpretar ou formatar o texto
+const size_t BYTES_MINIMOS_THREAD_TEXTO = 1 << 20;
+
+// Texto formatado por thread antes de cada writev (limita a memória na escrita)
+const size_t BYTES_BLOCO_TEXTO = 4 << 20;
+
+// Maior texto de um elemento: printf("%.2f") de um double tem até 309 dígitos inteiros
+const size_t MAXIMO_BYTES_ELEMENTO = 320;
+
+// Valores abaixo disso têm v * 100 < 2^50: o caminho rápido de formatarNumero é exato
+const double LIMITE_FORMATACAO_RAPIDA = 1e13;
+
+const double POTENCIAS_DEZ[23] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+inline bool ehEspaco(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline void pularEspacos(const char*& p, const char* fim) {
+    while (p < fim && ehEspaco(*p)) {
+        p++;
+    }
+}
+
+// Escreve os dígitos decimais de n
+inline char* escreverDigitos(char* p, uint64_t n) {
+    char digitos[20];
+    int quantidade = 0;
+    do {
+        digitos[quantidade++] = (char)('0' + n % 10);
+        n /= 10;
+    } while (n > 0);
+    while (quantidade > 0) {
+        *p++ = digitos[--quantidade];
+    }
+    return p;
+}
+
+// Escreve v com duas casas decimais, como printf("%.2f"). No caminho rápido,
+// v * 100 = escalado + resto exatamente (fma), e o arredondamento para o
+// inteiro mais próximo (empate para o par) é decidido pela soma exata da
+// parte fracionária de escalado com resto.
+inline char* formatarNumero(char* p, double v) {
+    if (!(std::fabs(v) < LIMITE_FORMATACAO_RAPIDA)) {
+        return p + std::snprintf(p, MAXIMO_BYTES_ELEMENTO, "%.2f", v);
+    }
+    if (std::signbit(v)) {
+        *p++ = '-';  // também em -0.00, como printf
+        v = -v;
+    }
+    double escalado = v * 100.0;
+    double resto = std::fma(v, 100.0, -escalado);
+    double inteiro = std::floor(escalado);
+    double fracao = escalado - inteiro;
+    uint64_t centesimos = (uint64_t)inteiro;
+    if (fracao >= 0.25) {
+        double excesso = (fracao - 0.5) + resto;  // sinal exato: as duas parcelas são exatas
+        if (excesso > 0.0 || (excesso == 0.0 && (centesimos & 1) != 0)) {
+            centesimos++;
+        }
+    }
+    p = escreverDigitos(p, centesimos / 100);
+    *p++ = '.';
+    *p++ = (char)('0' + centesimos / 10 % 10);
+    *p++ = (char)('0' + centesimos % 10);
+    return p;
+}
+
+// Como em operator<<, o float é escrito pelo seu valor em double
+inline char* formatarNumero(char* p, float v) {
+    return formatarNumero(p, (double)v);
+}
+
+inline char* formatarNumero(char* p, int64_t v) {
+    if (v < 0) {
+        *p++ = '-';
+        return escreverDigitos(p, 0 - (uint64_t)v);
+    }
+    return escreverDigitos(p, (uint64_t)v);
+}
+
+inline char* formatarNumero(char* p, int32_t v) {
+    return formatarNumero(p, (int64_t)v);
+}
+
+inline char* formatarNumero(char* p, int8_t v) {
+    return formatarNumero(p, (int64_t)v);
+}
+
+// Número terminado por espaço ou pelo fim do texto
+inline bool terminaNumero(const char* p, const char* fim) {
+    return p == fim || ehEspaco(*p);
+}
+
+// Caminho lento: copia o número (até o próximo espaço) e converte com strtod/strtof
+template <typename F>
+inline bool interpretarComBiblioteca(const char*& p, const char* fim, F& v) {
+    const char* fimNumero = p;
+    while (!terminaNumero(fimNumero, fim)) {
+        fimNumero++;
+    }
+    char copia[MAXIMO_BYTES_ELEMENTO + 1];
+    size_t tamanho = fimNumero - p;
+    if (tamanho == 0 || tamanho > MAXIMO_BYTES_ELEMENTO) {
+        return false;
+    }
+    memcpy(copia, p, tamanho);
+    copia[tamanho] = '\0';
+    char* fimConvertido;
+    v = sizeof(F) == sizeof(float) ? (F)std::strtof(copia, &fimConvertido) : (F)std::strtod(copia, &fimConvertido);
+    if (fimConvertido != copia + tamanho) {
+        return false;
+    }
+    p = fimNumero;
+    return true;
+}
+
+// Lê um real em decimal simples ("-12.34"). Se a mantissa e a potência de
+// dez forem exatas em F, uma única divisão dá o valor corretamente
+// arredondado, o mesmo de strtod/strtof (Clinger, 1990); senão, usa a biblioteca.
+template <typename F, int DIGITOS_EXATOS, int MAXIMO_CASAS>
+inline bool interpretarReal(const char*& p, const char* fim, F& v) {
+    const char* inicio = p;
+    bool negativo = false;
+    if (p < fim && (*p == '-' || *p == '+')) {
+        negativo = *p == '-';
+        p++;
+    }
+    uint64_t mantissa = 0;
+    int significativos = 0, digitos = 0, casas = 0;
+    bool ponto = false;
+    for (; p < fim; p++) {
+        char c = *p;
+        if (c >= '0' && c <= '9') {
+            if (mantissa != 0 || c != '0') {
+                significativos++;
+            }
+            if (significativos <= 19) {
+                mantissa = mantissa * 10 + (uint64_t)(c - '0');
+            }
+            digitos++;
+            casas += ponto;
+        } else if (c == '.' && !ponto) {
+            ponto = true;
+        } else {
+            break;
+        }
+    }
+    if (digitos > 0 && terminaNumero(p, fim) && significativos <= 19 &&
+        mantissa <= (UINT64_C(1) << DIGITOS_EXATOS) && casas <= MAXIMO_CASAS) {
+        v = (F)mantissa / (F)POTENCIAS_DEZ[casas];
+        if (negativo) {
+            v = -v;
+        }
+        return true;
+    }
+    p = inicio;
+    return interpretarComBiblioteca(p, fim, v);
+}
+
+// 10^22 e 10^10 são as maiores potências de dez exatas em double e em float
+inline bool interpretarNumero(const char*& p, const char* fim, double& v) {
+    return interpretarReal<double, 53, 22>(p, fim, v);
+}
+
+inline bool interpretarNumero(const char*& p, const char* fim, float& v) {
+    return interpretarReal<float, 24, 10>(p, fim, v);
+}
+
+// Inteiro com sinal em [minimo, maximo]; fora do intervalo é erro, como em operator>>
+inline bool interpretarInteiro(const char*& p, const char* fim, int64_t minimo, int64_t maximo, int64_t& v) {
+    bool negativo = false;
+    if (p < fim && (*p == '-' || *p == '+')) {
+        negativo = *p == '-';
+        p++;
+    }
+    uint64_t limite = negativo ? 0 - (uint64_t)minimo : (uint64_t)maximo;
+    uint64_t valor = 0;
+    const char* inicioDigitos = p;
+    for (; p < fim && *p >= '0' && *p <= '9'; p++) {
+        uint64_t digito = (uint64_t)(*p - '0');
+        if (valor > (limite - digito) / 10) {
+            return false;
+        }
+        valor = valor * 10 + digito;
+    }
+    if (p == inicioDigitos || !terminaNumero(p, fim)) {
+        return false;
+    }
+    v = negativo ? (int64_t)(0 - valor) : (int64_t)valor;
+    return true;
+}
+
+inline bool interpretarNumero(const char*& p, const char* fim, int64_t& v) {
+    return interpretarInteiro(p, fim, INT64_MIN, INT64_MAX, v);
+}
+
+inline bool interpretarNumero(const char*& p, const char* fim, int32_t& v) {
+    int64_t x;
+    if (!interpretarInteiro(p, fim, INT32_MIN, INT32_MAX, x)) {
+        return false;
+    }
+    v = (int32_t)x;
+    return true;
+}
+
+inline bool interpretarNumero(const char*& p, const char* fim, int8_t& v) {
+    int64_t x;
+    if (!interpretarInteiro(p, fim, INT8_MIN, INT8_MAX, x)) {
+        return false;
+    }
+    v = (int8_t)x;
+    return true;
+}
+
+// Threads para `bytes` de texto em `linhas` linhas: uma por CPU, mas nenhuma
+// com menos de BYTES_MINIMOS_THREAD_TEXTO
+inline int threadsTexto(size_t bytes, int linhas) {
+    int cpus = std::max(1, (int)std::thread::hardware_concurrency());
+    int porTamanho = (int)std::max<size_t>(1, bytes / BYTES_MINIMOS_THREAD_TEXTO);
+    return std::max(1, std::min(std::min(cpus, porTamanho), linhas));
+}
+
+// Executa funcao(faixa) para cada faixa em [0, numFaixas), uma thread por
+// faixa; a faixa 0 roda na thread que chamou
+template <typename Funcao>
+inline void executarFaixas(int numFaixas, const Funcao& funcao) {
+    std::vector<std::thread> threads;
+    for (int f = 1; f < numFaixas; f++) {
+        threads.emplace_back([&funcao, f]() { funcao(f); });
+    }
+    funcao(0);
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+// Interpreta `numLinhas` linhas a partir de p (avançando-o) para `dados`; com
+// `exigirFim`, o texto não pode ter nada além delas até `fim`. Em caso de
+// erro, `linhaErro` (contada a partir de `linha0`) e `colunaErro` dizem o elemento.
+template <typename T>
+inline bool interpretarLinhas(const char*& p, const char* fim, T* dados, int colunas, int passo, int linha0,
+                              int numLinhas, bool exigirFim, int& linhaErro, int& colunaErro) {
+    for (int i = 0; i < numLinhas; i++) {
+        T* linha = dados + (size_t)i * passo;
+        for (int j = 0; j < colunas; j++) {
+            pularEspacos(p, fim);
+            if (p == fim || !interpretarNumero(p, fim, linha[j])) {
+                linhaErro = linha0 + i;
+                colunaErro = j;
+                return false;
+            }
+        }
+    }
+    if (exigirFim) {
+        pularEspacos(p, fim);
+        if (p != fim) {
+            linhaErro = linha0 + numLinhas;
+            colunaErro = 0;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Lê o cabeçalho "N" ou "LINHAS COLUNAS" a partir de `p` (que avança até o fim dele)
+inline bool lerCabecalhoTexto(const char*& p, const char* fim, int64_t& linhas, int64_t& colunas) {
+    pularEspacos(p, fim);
+    if (!interpretarNumero(p, fim, linhas)) {
+        return false;
+    }
+    while (p < fim && (*p == ' ' || *p == '\t' || *p == '\r')) {
+        p++;
+    }
+    if (p < fim && *p != '\n') {
+        return interpretarNumero(p, fim, colunas);
+    }
+    colunas = linhas;
+    return true;
+}
+
+// "N" para matrizes quadradas, "LINHASxCOLUNAS" para as demais (mensagens)
+inline std::string textoFormato(int64_t linhas, int64_t colunas) {
+    return linhas == colunas ? std::to_string(linhas) : std::to_string(linhas) + "x" + std::to_string(colunas);
+}
+
+// Leitura de uma matriz em texto, em blocos de linhas consecutivos
+class LeitorTexto {
+private:
+    void* base;
+    size_t tamanho;
+    const char* p;  // início da próxima linha a ler
+    const char* fim;
+    std::string nomeArquivo;
+    int proximaLinha;
+
+public:
+    LeitorTexto() : base(nullptr), tamanho(0), p(nullptr), fim(nullptr), proximaLinha(0) {}
+
+    ~LeitorTexto() {
+        if (base != nullptr) {
+            munmap(base, tamanho);
+        }
+    }
+
+    LeitorTexto(const LeitorTexto&) = delete;
+    LeitorTexto& operator=(const LeitorTexto&) = delete;
+
+    // Mapeia o arquivo e confere o formato linhas x colunas do cabeçalho.
+    // Sem MAP_POPULATE: a leitura antecipada do kernel acompanha os blocos lidos.
+    bool abrir(const std::string& nome, int linhas, int colunas) {
+        nomeArquivo = nome;
+        int fd = open(nome.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Erro ao abrir arquivo: " << nome << std::endl;
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            std::cerr << "Erro ao ler dimensão de: " << nome << std::endl;
+            close(fd);
+            return false;
+        }
+        tamanho = (size_t)info.st_size;
+        base = mmap(nullptr, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            std::cerr << "Erro ao mapear arquivo: " << nome << std::endl;
+            base = nullptr;
+            return false;
+        }
+        madvise(base, tamanho, MADV_SEQUENTIAL);
+        p = static_cast<const char*>(base);
+        fim = p + tamanho;
+
+        int64_t linhasArquivo = -1, colunasArquivo = -1;
+        if (!lerCabecalhoTexto(p, fim, linhasArquivo, colunasArquivo) || linhasArquivo != linhas ||
+            colunasArquivo != colunas) {
+            std::cerr << "Erro: Dimensão do arquivo (" << textoFormato(linhasArquivo, colunasArquivo)
+                      << ") não corresponde à esperada (" << textoFormato(linhas, colunas) << ")" << std::endl;
+            return false;
+        }
+        pularEspacos(p, fim);
+        return true;
+    }
+
+    // Lê as próximas `numLinhas` linhas para `dados`. Se o texto tiver uma
+    // linha da matriz por linha, faixas delas são interpretadas em paralelo;
+    // senão, o bloco é lido em uma faixa só.
+    template <typename T>
+    bool lerLinhas(T* dados, int colunas, int passo, int numLinhas) {
+        // Início de cada linha do bloco e da linha seguinte
+        std::vector<const char*> inicios;
+        inicios.reserve(numLinhas + 1);
+        const char* q = p;
+        while (q < fim && (int)inicios.size() <= numLinhas) {
+            inicios.push_back(q);
+            const char* quebra = static_cast<const char*>(memchr(q, '\n', fim - q));
+            q = quebra != nullptr ? quebra + 1 : fim;
+            pularEspacos(q, fim);
+        }
+        const char* fimBloco = (int)inicios.size() > numLinhas ? inicios[numLinhas] : fim;
+
+        bool ok = false;
+        int linhaErro = proximaLinha, colunaErro = 0;
+        int numFaixas = (int)inicios.size() >= numLinhas ? threadsTexto(fimBloco - p, numLinhas) : 1;
+        if (numFaixas > 1) {
+            std::vector<char> faixaOk(numFaixas, 1);
+            executarFaixas(numFaixas, [&](int f) {
+                int linha0 = (int)((int64_t)numLinhas * f / numFaixas);
+                int linha1 = (int)((int64_t)numLinhas * (f + 1) / numFaixas);
+                const char* inicio = inicios[linha0];
+                const char* fimFaixa = linha1 < numLinhas ? inicios[linha1] : fimBloco;
+                int l = 0, c = 0;
+                faixaOk[f] = interpretarLinhas(inicio, fimFaixa, dados + (size_t)linha0 * passo, colunas, passo,
+                                               proximaLinha + linha0, linha1 - linha0, fimFaixa != fim, l, c);
+            });
+            ok = std::count(faixaOk.begin(), faixaOk.end(), 0) == 0;
+            if (ok) {
+                p = fimBloco;
+            }
+        }
+        // Uma faixa só, ou linhas de texto que não coincidem com as da matriz
+        if (!ok) {
+            ok = interpretarLinhas(p, fim, dados, colunas, passo, proximaLinha, numLinhas, false, linhaErro,
+                                   colunaErro);
+            pularEspacos(p, fim);
+        }
+        if (!ok) {
+            std::cerr << "Erro: Valor inválido ou ausente no elemento (" << linhaErro << ", " << colunaErro
+                      << ") de " << nomeArquivo << std::endl;
+            return false;
+        }
+        proximaLinha += numLinhas;
+        return true;
+    }
+};
+
+// Lê uma matriz linhas x colunas em texto para `dados`
+template <typename T>
+inline bool lerMatrizTexto(const std::string& nomeArquivo, T* dados, int linhas, int colunas, int passo) {
+    LeitorTexto leitor;
+    return leitor.abrir(nomeArquivo, linhas, colunas) && leitor.lerLinhas(dados, colunas, passo, linhas);
+}
+
+// Formata as linhas [linha0, linha1) em `texto`, aumentando-o se preciso; retorna o tamanho usado
+template <typename T>
+inline size_t formatarLinhas(std::vector<char>& texto, const T* dados, int colunas, int passo, int linha0,
+                             int linha1) {
+    size_t usado = 0;
+    for (int i = linha0; i < linha1; i++) {
+        const T* linha = dados + (size_t)i * passo;
+        for (int j = 0; j < colunas; j++) {
+            if (texto.size() - usado < MAXIMO_BYTES_ELEMENTO + 1) {
+                texto.resize(std::max(2 * texto.size(), usado + BYTES_MINIMOS_THREAD_TEXTO));
+            }
+            char* p = formatarNumero(&texto[usado], linha[j]);
+            *p++ = j < colunas - 1 ? ' ' : '\n';
+            usado = p - &texto[0];
+        }
+    }
+    return usado;
+}
+
+// Grava todos os buffers, repetindo writev enquanto houver bytes pendentes
+inline bool escreverVetorTudo(int fd, std::vector<iovec>& partes) {
+    size_t primeira = 0;
+    while (primeira < partes.size()) {
+        int quantidade = (int)std::min(partes.size() - primeira, (size_t)IOV_MAX);
+        ssize_t escritos = writev(fd, &partes[primeira], quantidade);
+        if (escritos < 0) {
+            return false;
+        }
+        while (primeira < partes.size() && (size_t)escritos >= partes[primeira].iov_len) {
+            escritos -= partes[primeira].iov_len;
+            primeira++;
+        }
+        if (primeira < partes.size()) {
+            partes[primeira].iov_base = static_cast<char*>(partes[primeira].iov_base) + escritos;
+            partes[primeira].iov_len -= escritos;
+        }
+    }
+    return true;
+}
+
+// Gravação de uma matriz em texto, em blocos de linhas consecutivos
+class EscritorTexto {
+private:
+    int fd;
+    std::string nomeArquivo;
+    char cabecalho[32];
+    int tamanhoCabecalho;  // > 0 enquanto o cabeçalho não foi gravado
+    std::vector<std::vector<char>> textos;  // um buffer por thread, reaproveitado entre blocos
+    std::vector<size_t> usados;
+
+public:
+    EscritorTexto() : fd(-1), tamanhoCabecalho(0) {}
+
+    ~EscritorTexto() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    EscritorTexto(const EscritorTexto&) = delete;
+    EscritorTexto& operator=(const EscritorTexto&) = delete;
+
+    bool criar(const std::string& nome, int linhas, int colunas) {
+        nomeArquivo = nome;
+        fd = open(nome.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::cerr << "Erro ao criar arquivo: " << nome << std::endl;
+            return false;
+        }
+        tamanhoCabecalho = linhas == colunas ? std::snprintf(cabecalho, sizeof(cabecalho), "%d\n", linhas)
+                                             : std::snprintf(cabecalho, sizeof(cabecalho), "%d %d\n", linhas, colunas);
+        return true;
+    }
+
+    // Grava as próximas `numLinhas` linhas: a cada rodada, cada thread formata
+    // até BYTES_BLOCO_TEXTO de linhas e as faixas são gravadas em ordem, com o
+    // cabeçalho na primeira
+    template <typename T>
+    bool escreverLinhas(const T* dados, int colunas, int passo, int numLinhas) {
+        // Estimativa de 10 bytes por elemento (ex.: "123456.78 ")
+        size_t bytesLinha = (size_t)colunas * 10 + 1;
+        int numThreads = threadsTexto(bytesLinha * numLinhas, numLinhas);
+        int linhasPorFaixa = (int)std::max<size_t>(1, BYTES_BLOCO_TEXTO / bytesLinha);
+        if ((int)textos.size() < numThreads) {
+            textos.resize(numThreads);
+            usados.resize(numThreads);
+        }
+
+        bool ok = true;
+        for (int linha0 = 0; ok && linha0 < numLinhas;) {
+            int linhasRodada = std::min(numLinhas - linha0, numThreads * linhasPorFaixa);
+            int numFaixas = std::min(numThreads, linhasRodada);
+            executarFaixas(numFaixas, [&](int f) {
+                int inicio = linha0 + (int)((int64_t)linhasRodada * f / numFaixas);
+                int fim = linha0 + (int)((int64_t)linhasRodada * (f + 1) / numFaixas);
+                usados[f] = formatarLinhas(textos[f], dados, colunas, passo, inicio, fim);
+            });
+            std::vector<iovec> partes;
+            for (int f = 0; f < numFaixas; f++) {
+                partes.push_back({ textos[f].data(), usados[f] });
+            }
+            ok = gravar(partes);
+            linha0 += linhasRodada;
+        }
+        return ok;
+    }
+
+    // Grava o cabeçalho, se ainda não tiver sido gravado (matriz sem linhas), e fecha o arquivo
+    bool fechar() {
+        std::vector<iovec> nenhuma;
+        bool ok = gravar(nenhuma);
+        if (close(fd) != 0 && ok) {
+            std::cerr << "Erro ao escrever arquivo: " << nomeArquivo << std::endl;
+            ok = false;
+        }
+        fd = -1;
+        return ok;
+    }
+
+private:
+    bool gravar(std::vector<iovec>& partes) {
+        if (tamanhoCabecalho > 0) {
+            partes.insert(partes.begin(), iovec{ cabecalho, (size_t)tamanhoCabecalho });
+            tamanhoCabecalho = 0;
+        }
+        if (escreverVetorTudo(fd, partes)) {
+            return true;
+        }
+        std::cerr << "Erro ao escrever arquivo: " << nomeArquivo << std::endl;
+        return false;
+    }
+};
+
+// Grava uma matriz linhas x colunas em texto
+template <typename T>
+inline bool gravarMatrizTexto(const std::string& nomeArquivo, const T* dados, int linhas, int colunas,
+                              int passo) {
+    EscritorTexto escritor;
+    return escritor.criar(nomeArquivo, linhas, colunas) && escritor.escreverLinhas(dados, colunas, passo, linhas) &&
+           escritor.fechar();
+}
+
+#endif
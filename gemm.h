@@ -0,0 +1,258 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include "kernel_fixo.h"
+#include "matriz.h"
+#include "microkernel.h"
+#include "opcoes.h"
+
+/**
+ * Kernel de multiplicação em blocos (GEMM) compartilhado pelos três programas.
+ *
+ * C = A * B é calculado em três níveis de blocagem:
+ *  - nc colunas de B/C por vez (painel de B que deve caber na L3);
+ *  - kc elementos da dimensão interna por vez: o painel kc x nc de B é
+ *    empacotado em micro-painéis de nr colunas, e cada micro-painel
+ *    (kc x nr) deve caber na L1;
+ *  - mc linhas de A/C por vez: o bloco mc x kc de A é empacotado em
+ *    micro-painéis de mr linhas e deve caber na L2.
+ * O micro-kernel (microkernel.h) acumula um bloco mr x nr de C em
+ * registradores, percorrendo os dois micro-painéis de forma contígua.
+ *
+ * Cada thread ou processo chama o kernel sobre os tiles de C que recebe.
+ * Produtos quadrados pequenos de tamanho especializado (kernel_fixo.h) não
+ * passam pela blocagem.
+ */
+
+struct ParametrosBloco {
+    int mc;
+    int kc;
+    int nc;
+    int tileLinhas;   // tamanho dos tiles de C distribuídos entre os trabalhadores
+    int tileColunas;
+
+    ParametrosBloco() : mc(96), kc(256), nc(2048), tileLinhas(192), tileColunas(512) {}
+
+    // Opções deste grupo, para Opcoes::aceitarApenas
+    static const char* nomesOpcoes() { return "mc,kc,nc,tile"; }
+
+    // Lê --mc, --kc, --nc e --tile=LINHASxCOLUNAS da linha de comando
+    // (mantém os padrões se ausentes)
+    static ParametrosBloco deOpcoes(const Opcoes& opcoes) {
+        ParametrosBloco p;
+        p.mc = opcoes.inteiro("mc", p.mc);
+        p.kc = opcoes.inteiro("kc", p.kc);
+        p.nc = opcoes.inteiro("nc", p.nc);
+        if (opcoes.tem("tile")) {
+            std::string tile = opcoes.texto("tile", "");
+            size_t x = tile.find('x');
+            p.tileLinhas = atoi(tile.c_str());
+            p.tileColunas = x == std::string::npos ? p.tileLinhas : atoi(tile.c_str() + x + 1);
+        }
+        return p;
+    }
+
+    bool validar() const {
+        if (mc <= 0 || kc <= 0 || nc <= 0) {
+            std::cerr << "Erro: Os tamanhos de bloco (--mc, --kc, --nc) devem ser positivos." << std::endl;
+            return false;
+        }
+        if (tileLinhas <= 0 || tileColunas <= 0) {
+            std::cerr << "Erro: O tamanho de tile (--tile=LINHASxCOLUNAS) deve ser positivo." << std::endl;
+            return false;
+        }
+        return true;
+    }
+};
+
+// Divisão de uma matriz M x N em tiles numerados por linhas de tiles
+struct DivisaoTiles {
+    int linhas;
+    int colunas;
+    int tileLinhas;
+    int tileColunas;
+    int tilesPorLinha;
+    int tilesPorColuna;
+
+    DivisaoTiles(int m, int n, int tl, int tc)
+        : linhas(m), colunas(n), tileLinhas(std::min(tl, m)), tileColunas(std::min(tc, n)),
+          tilesPorLinha((n + tileColunas - 1) / tileColunas),
+          tilesPorColuna((m + tileLinhas - 1) / tileLinhas) {}
+
+    int total() const { return tilesPorLinha * tilesPorColuna; }
+
+    void tile(int t, int& linha0, int& coluna0, int& numLinhas, int& numColunas) const {
+        linha0 = (t / tilesPorLinha) * tileLinhas;
+        coluna0 = (t % tilesPorLinha) * tileColunas;
+        numLinhas = std::min(tileLinhas, linhas - linha0);
+        numColunas = std::min(tileColunas, colunas - coluna0);
+    }
+};
+
+inline int arredondarParaMultiplo(int valor, int multiplo) {
+    return (valor + multiplo - 1) / multiplo * multiplo;
+}
+
+// Empacota o bloco kb x nb de B em micro-painéis de nr colunas: para cada
+// micro-painel, kb linhas consecutivas de nr valores (completadas com zero)
+inline void empacotarPainelB(VisaoMatrizConst b, double* painel, int nr) {
+    for (int jr = 0; jr < b.colunas; jr += nr) {
+        int largura = std::min(nr, b.colunas - jr);
+        for (int k = 0; k < b.linhas; k++) {
+            const double* origem = b.linha(k) + jr;
+            memcpy(painel, origem, largura * sizeof(double));
+            for (int j = largura; j < nr; j++) {
+                painel[j] = 0.0;
+            }
+            painel += nr;
+        }
+    }
+}
+
+// Empacota o bloco mb x kb de A em micro-painéis de mr linhas: para cada
+// micro-painel, kb colunas consecutivas de mr valores (completadas com zero)
+inline void empacotarBlocoA(VisaoMatrizConst a, double* bloco, int mr) {
+    for (int ir = 0; ir < a.linhas; ir += mr) {
+        int altura = std::min(mr, a.linhas - ir);
+        for (int k = 0; k < a.colunas; k++) {
+            for (int i = 0; i < altura; i++) {
+                bloco[i] = a(ir + i, k);
+            }
+            for (int i = altura; i < mr; i++) {
+                bloco[i] = 0.0;
+            }
+            bloco += mr;
+        }
+    }
+}
+
+// C(mb x nb) += blocoA(mb x kb) * painelB(kb x nb), ambos já empacotados
+inline void macroKernel(const MicroKernel& uk, int kb, const double* blocoA,
+                        const double* painelB, VisaoMatriz c) {
+    alignas(64) double temp[16 * 16];
+
+    for (int jr = 0; jr < c.colunas; jr += uk.nr) {
+        int largura = std::min(uk.nr, c.colunas - jr);
+        const double* bp = painelB + (size_t)jr * kb;
+        for (int ir = 0; ir < c.linhas; ir += uk.mr) {
+            int altura = std::min(uk.mr, c.linhas - ir);
+            const double* ap = blocoA + (size_t)ir * kb;
+            if (altura == uk.mr && largura == uk.nr) {
+                uk.funcao(kb, ap, bp, &c(ir, jr), c.passo);
+            } else {
+                // Bloco de borda: calcula em um buffer temporário e soma a parte válida
+                memset(temp, 0, sizeof(temp));
+                uk.funcao(kb, ap, bp, temp, uk.nr);
+                for (int i = 0; i < altura; i++) {
+                    for (int j = 0; j < largura; j++) {
+                        c(ir + i, jr + j) += temp[i * uk.nr + j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Buffers de empacotamento reutilizáveis entre chamadas (um por trabalhador)
+class BuffersGemm {
+private:
+    double* blocoA;
+    double* painelB;
+    size_t capacidadeA;
+    size_t capacidadeB;
+
+    static double* garantir(double*& buffer, size_t& capacidade, size_t elementos) {
+        if (elementos > capacidade) {
+            liberarAlinhado(buffer);
+            buffer = static_cast<double*>(alocarAlinhado(elementos * sizeof(double)));
+            if (buffer == nullptr) {
+                capacidade = 0;
+                throw std::bad_alloc();
+            }
+            capacidade = elementos;
+        }
+        return buffer;
+    }
+
+public:
+    BuffersGemm() : blocoA(nullptr), painelB(nullptr), capacidadeA(0), capacidadeB(0) {}
+    ~BuffersGemm() {
+        liberarAlinhado(blocoA);
+        liberarAlinhado(painelB);
+    }
+
+    BuffersGemm(const BuffersGemm&) = delete;
+    BuffersGemm& operator=(const BuffersGemm&) = delete;
+
+    double* bufferA(size_t elementos) { return garantir(blocoA, capacidadeA, elementos); }
+    double* bufferB(size_t elementos) { return garantir(painelB, capacidadeB, elementos); }
+};
+
+// C += A * B usando blocagem, empacotamento e o micro-kernel selecionado
+inline void gemmAcumular(VisaoMatrizConst a, VisaoMatrizConst b, VisaoMatriz c,
+                         const ParametrosBloco& p, BuffersGemm& buffers) {
+    const MicroKernel& uk = microKernel();
+    const int M = c.linhas;
+    const int N = c.colunas;
+    const int K = a.colunas;
+    if (M == 0 || N == 0 || K == 0) {
+        return;
+    }
+
+    const int mc = arredondarParaMultiplo(std::min(p.mc, M), uk.mr);
+    const int nc = arredondarParaMultiplo(std::min(p.nc, N), uk.nr);
+    const int kc = std::min(p.kc, K);
+
+    double* blocoA = buffers.bufferA((size_t)mc * kc);
+    double* painelB = buffers.bufferB((size_t)kc * nc);
+
+    for (int jc = 0; jc < N; jc += nc) {
+        int nb = std::min(nc, N - jc);
+        for (int pc = 0; pc < K; pc += kc) {
+            int kb = std::min(kc, K - pc);
+            empacotarPainelB(b.sub(pc, jc, kb, nb), painelB, uk.nr);
+            for (int ic = 0; ic < M; ic += mc) {
+                int mb = std::min(mc, M - ic);
+                empacotarBlocoA(a.sub(ic, pc, mb, kb), blocoA, uk.mr);
+                macroKernel(uk, kb, blocoA, painelB, c.sub(ic, jc, mb, nb));
+            }
+        }
+    }
+}
+
+inline void gemmAcumular(VisaoMatrizConst a, VisaoMatrizConst b, VisaoMatriz c,
+                         const ParametrosBloco& p) {
+    BuffersGemm buffers;
+    gemmAcumular(a, b, c, p, buffers);
+}
+
+inline void zerar(VisaoMatriz c) {
+    for (int i = 0; i < c.linhas; i++) {
+        memset(c.linha(i), 0, c.colunas * sizeof(double));
+    }
+}
+
+// C = A * B
+inline void gemm(VisaoMatrizConst a, VisaoMatrizConst b, VisaoMatriz c,
+                 const ParametrosBloco& p, BuffersGemm& buffers) {
+    if (multiplicarFixo(a, b, c, p.kc)) {
+        return;
+    }
+    zerar(c);
+    gemmAcumular(a, b, c, p, buffers);
+}
+
+inline void gemm(VisaoMatrizConst a, VisaoMatrizConst b, VisaoMatriz c, const ParametrosBloco& p) {
+    if (multiplicarFixo(a, b, c, p.kc)) {
+        return;
+    }
+    zerar(c);
+    gemmAcumular(a, b, c, p);
+}
+
+#endif
@@ -0,0 +1,318 @@
+#ifndef GEMM_TIPADO_H
+#define GEMM_TIPADO_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "gemm.h"
+#include "matriz.h"
+#include "microkernel.h"
+#include "rastreamento.h"
+#include "tipo_elemento.h"
+#include "verificacao.h"
+
+/**
+ * Multiplicação para os tipos de elemento além de float64 (--dtype=float32,
+ * int32 ou int8; ver tipo_elemento.h).
+ *
+ * O kernel é genérico no tipo e segue a blocagem do GEMM em double: a
+ * dimensão interna em blocos de kc e as colunas em painéis de B que cabem na
+ * L2. Cada painel é copiado já convertido para o tipo do acumulador (a única
+ * "embalagem"), e blocos de C de R linhas por 2 registradores ficam em
+ * vetores do GCC (vector_size) durante toda a dimensão interna. As bordas
+ * seguem linha a linha, com o laço interno vetorizado pelo compilador
+ * (#pragma omp simd, com -fopenmp-simd).
+ *
+ * Os produtos são feitos no tipo do acumulador (int8 -> int32, int32 ->
+ * int64), e cada elemento de C soma a dimensão interna sempre na mesma ordem,
+ * sem FMA (fp-contract=off). O resultado não depende do kernel (escalar, AVX2 ou AVX-512), nem
+ * da divisão em tiles, nem do número de trabalhadores.
+ *
+ * executarTipado() é o caminho comum dos três programas: carrega A e B do
+ * tipo pedido, chama o kernel do programa (sequencial, threads ou processos)
+ * e grava C no tipo do acumulador (e, com --verify, o confere; ver verificacao.h).
+ */
+
+// Bytes do painel de B, já convertido para o acumulador, percorrido por todas
+// as linhas de um tile (cabe na L2)
+const size_t BYTES_PAINEL_TIPADO = 256 * 1024;
+
+// Bloco de C mantido em registradores: 2 vetores de acumuladores por linha,
+// em 8 linhas com os 32 registradores do AVX-512 e em 4 com os 16 dos demais
+const int VETORES_BLOCO_TIPADO = 2;
+
+inline constexpr int linhasBlocoTipado(int bytes) {
+    return bytes == 64 ? 8 : 4;
+}
+
+// C(R x 2L) += A(R x kb) * B(kb x 2L), com os acumuladores em vetores do GCC
+// (vector_size) de BYTES bytes, a largura dos registradores do conjunto de
+// instruções em uso (64 = zmm, 32 = ymm, 16 = xmm); L = BYTES / sizeof(A).
+// B vem do painel, já no tipo do acumulador.
+template <int BYTES, typename T, typename A>
+__attribute__((always_inline, optimize("fp-contract=off")))
+inline void blocoTipado(const T* a, int passoA, const A* b, int passoB, A* c, int passoC, int kb) {
+    const int LINHAS_BLOCO_TIPADO = linhasBlocoTipado(BYTES);
+    const int ELEMENTOS_VETOR_TIPADO = BYTES / sizeof(A);
+    typedef A VetorA __attribute__((vector_size(BYTES)));
+
+    VetorA acc[LINHAS_BLOCO_TIPADO][VETORES_BLOCO_TIPADO];
+#pragma GCC unroll 8
+    for (int r = 0; r < LINHAS_BLOCO_TIPADO; r++) {
+#pragma GCC unroll 8
+        for (int v = 0; v < VETORES_BLOCO_TIPADO; v++) {
+            memcpy(&acc[r][v], c + (size_t)r * passoC + v * ELEMENTOS_VETOR_TIPADO, sizeof(VetorA));
+        }
+    }
+    for (int p = 0; p < kb; p++) {
+        VetorA bp[VETORES_BLOCO_TIPADO];
+#pragma GCC unroll 8
+        for (int v = 0; v < VETORES_BLOCO_TIPADO; v++) {
+            memcpy(&bp[v], b + (size_t)p * passoB + v * ELEMENTOS_VETOR_TIPADO, sizeof(VetorA));
+        }
+#pragma GCC unroll 8
+        for (int r = 0; r < LINHAS_BLOCO_TIPADO; r++) {
+            const A arp = a[(size_t)r * passoA + p];
+#pragma GCC unroll 8
+            for (int v = 0; v < VETORES_BLOCO_TIPADO; v++) {
+                acc[r][v] += arp * bp[v];
+            }
+        }
+    }
+#pragma GCC unroll 8
+    for (int r = 0; r < LINHAS_BLOCO_TIPADO; r++) {
+#pragma GCC unroll 8
+        for (int v = 0; v < VETORES_BLOCO_TIPADO; v++) {
+            memcpy(c + (size_t)r * passoC + v * ELEMENTOS_VETOR_TIPADO, &acc[r][v], sizeof(VetorA));
+        }
+    }
+}
+
+// Bordas (menos de R linhas ou de 2L colunas): linha a linha, na ordem i-k-j
+template <typename T, typename A>
+__attribute__((always_inline, optimize("fp-contract=off")))
+inline void bordaTipada(VisaoMatrizConstT<T> a, VisaoMatrizConstT<A> b, VisaoMatrizT<A> c) {
+    for (int i = 0; i < c.linhas; i++) {
+        A* __restrict__ ci = c.linha(i);
+        const T* ai = a.linha(i);
+        for (int p = 0; p < a.colunas; p++) {
+            const A aip = ai[p];
+            const A* __restrict__ bp = b.linha(p);
+#pragma omp simd
+            for (int j = 0; j < c.colunas; j++) {
+                ci[j] += aip * bp[j];
+            }
+        }
+    }
+}
+
+// C = A * B em painéis de B (kc x nc), convertidos para o acumulador em
+// `painel` (contíguo, uma única conversão por elemento de B em cada tile);
+// dentro de cada painel, blocos R x 2L e as bordas. Sem contração em FMA (que
+// só existe nas versões vetoriais), para que as três versões façam exatamente
+// as mesmas operações.
+template <int BYTES, typename T, typename A>
+__attribute__((always_inline, optimize("fp-contract=off")))
+inline void corpoGemmTipado(VisaoMatrizConstT<T> a, VisaoMatrizConstT<T> b, VisaoMatrizT<A> c, int kc, int nc,
+                            A* painel) {
+    const int LINHAS_BLOCO_TIPADO = linhasBlocoTipado(BYTES);
+    const int COLUNAS_BLOCO_TIPADO = VETORES_BLOCO_TIPADO * BYTES / sizeof(A);
+    const int M = c.linhas;
+    const int N = c.colunas;
+    const int K = a.colunas;
+    const int mBlocos = M - M % LINHAS_BLOCO_TIPADO;
+
+    for (int i = 0; i < M; i++) {
+        std::fill(c.linha(i), c.linha(i) + N, A());
+    }
+
+    for (int jc = 0; jc < N; jc += nc) {
+        const int nb = std::min(nc, N - jc);
+        const int nBlocos = nb - nb % COLUNAS_BLOCO_TIPADO;
+        for (int pc = 0; pc < K; pc += kc) {
+            const int kb = std::min(kc, K - pc);
+            for (int p = 0; p < kb; p++) {
+                const T* __restrict__ origem = b.linha(pc + p) + jc;
+                A* __restrict__ destino = painel + (size_t)p * nb;
+#pragma omp simd
+                for (int j = 0; j < nb; j++) {
+                    destino[j] = (A)origem[j];
+                }
+            }
+
+            VisaoMatrizConstT<T> ap = a.sub(0, pc, M, kb);
+            VisaoMatrizConstT<A> bp(painel, kb, nb, nb);
+            VisaoMatrizT<A> cp = c.sub(0, jc, M, nb);
+            // A faixa kb x 2L do painel é reaproveitada (da L1) por todos os blocos de linhas
+            for (int j = 0; j < nBlocos; j += COLUNAS_BLOCO_TIPADO) {
+                for (int i = 0; i < mBlocos; i += LINHAS_BLOCO_TIPADO) {
+                    blocoTipado<BYTES>(ap.linha(i), ap.passo, bp.linha(0) + j, bp.passo, cp.linha(i) + j, cp.passo, kb);
+                }
+            }
+            if (nBlocos < nb) {
+                bordaTipada(ap.sub(0, 0, mBlocos, kb), bp.sub(0, nBlocos, kb, nb - nBlocos),
+                            cp.sub(0, nBlocos, mBlocos, nb - nBlocos));
+            }
+            bordaTipada(ap.sub(mBlocos, 0, M - mBlocos, kb), bp, cp.sub(mBlocos, 0, M - mBlocos, nb));
+        }
+    }
+}
+
+// O mesmo corpo compilado para cada conjunto de instruções (a versão
+// "escalar" usa o SSE2 de todo x86-64, como o compilador faria sozinho)
+template <typename T, typename A>
+__attribute__((target("avx512f,avx512bw,avx512dq"), optimize("fp-contract=off")))
+void gemmTipadoAvx512(VisaoMatrizConstT<T> a, VisaoMatrizConstT<T> b, VisaoMatrizT<A> c, int kc, int nc, A* painel) {
+    corpoGemmTipado<64>(a, b, c, kc, nc, painel);
+}
+
+template <typename T, typename A>
+__attribute__((target("avx2"), optimize("fp-contract=off")))
+void gemmTipadoAvx2(VisaoMatrizConstT<T> a, VisaoMatrizConstT<T> b, VisaoMatrizT<A> c, int kc, int nc, A* painel) {
+    corpoGemmTipado<32>(a, b, c, kc, nc, painel);
+}
+
+template <typename T, typename A>
+__attribute__((optimize("fp-contract=off")))
+void gemmTipadoEscalar(VisaoMatrizConstT<T> a, VisaoMatrizConstT<T> b, VisaoMatrizT<A> c, int kc, int nc, A* painel) {
+    corpoGemmTipado<16>(a, b, c, kc, nc, painel);
+}
+
+// C = A * B, com C no tipo do acumulador de T, seguindo o kernel escolhido em
+// --kernel. Tem a assinatura do gemm em double, para que quem distribui tiles
+// trate os dois da mesma forma; o painel convertido fica no buffer de B.
+template <typename T>
+inline void gemm(VisaoMatrizConstT<T> a, VisaoMatrizConstT<T> b,
+                 VisaoMatrizT<typename TipoElemento<T>::Acumulador> c, const ParametrosBloco& p,
+                 BuffersGemm& buffers) {
+    typedef typename TipoElemento<T>::Acumulador A;
+    const int kc = std::max(1, std::min(p.kc, a.colunas));
+    const int nc = std::min(std::max(64, (int)(BYTES_PAINEL_TIPADO / ((size_t)kc * sizeof(A))) / 64 * 64),
+                            std::max(1, c.colunas));
+    A* painel = reinterpret_cast<A*>(buffers.bufferB(((size_t)kc * nc * sizeof(A) + sizeof(double) - 1) /
+                                                     sizeof(double)));
+
+    const MicroKernel* uk = &microKernel();
+    if (uk == &kernelAvx512() && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq")) {
+        gemmTipadoAvx512(a, b, c, kc, nc, painel);
+    } else if (uk == &kernelAvx512() || uk == &kernelAvx2()) {
+        gemmTipadoAvx2(a, b, c, kc, nc, painel);
+    } else {
+        gemmTipadoEscalar(a, b, c, kc, nc, painel);
+    }
+}
+
+// Carrega A e B de matriz_{a,b}_N_<tipo><extensao>, calcula C com
+// `kernel(a, b, c)` `repeticoes` vezes e grava C em
+// <prefixoResultado>N<sufixoResultado>_<tipo><extensao>. Com `compartilhada`,
+// as três matrizes ficam em memória POSIX, para o pool de processos.
+template <typename T, typename Kernel>
+bool executarTipado(int dimensao, const std::string& extensao, const std::string& prefixoResultado,
+                    const std::string& sufixoResultado, bool compartilhada, int repeticoes,
+                    const ParametrosVerificacao& verificacao, Kernel& kernel) {
+    typedef typename TipoElemento<T>::Acumulador A;
+    const TipoDado tipo = TipoElemento<T>::codigo();
+    const std::string sufixoTipo = sufixoTipoDado(tipo);
+
+    std::unique_ptr<MatrizDensaT<T>> a, b;
+    std::unique_ptr<MatrizDensaT<A>> c;
+    if (compartilhada) {
+        a.reset(new MatrizDensaT<T>(dimensao, dimensao, true, nomeCompartilhadoUnico("matriz")));
+        b.reset(new MatrizDensaT<T>(dimensao, dimensao, true, nomeCompartilhadoUnico("matriz")));
+        c.reset(new MatrizDensaT<A>(dimensao, dimensao, true, nomeCompartilhadoUnico("matriz")));
+    } else {
+        a.reset(new MatrizDensaT<T>(dimensao));
+        b.reset(new MatrizDensaT<T>(dimensao));
+        c.reset(new MatrizDensaT<A>(dimensao));
+    }
+
+    std::string arquivoA = "matriz_a_" + std::to_string(dimensao) + sufixoTipo + extensao;
+    std::string arquivoB = "matriz_b_" + std::to_string(dimensao) + sufixoTipo + extensao;
+
+    long long inicioCarga = agoraNs();
+    std::cout << "Carregando matriz A de: " << arquivoA << std::endl;
+    if (!a->carregar(arquivoA)) {
+        return false;
+    }
+    std::cout << "Carregando matriz B de: " << arquivoB << std::endl;
+    if (!b->carregar(arquivoB)) {
+        return false;
+    }
+    registrarTrecho("carregar A e B", inicioCarga, agoraNs());
+
+    std::cout << "Iniciando multiplicação em " << nomeTipoDado(tipo) << " (acumulador "
+              << nomeTipoDado(tipoAcumulador(tipo)) << ")..." << std::endl;
+    std::chrono::duration<double> total(0);
+    for (int r = 0; r < repeticoes; r++) {
+        auto inicio = std::chrono::high_resolution_clock::now();
+        bool ok;
+        {
+            TrechoRastro trecho("multiplicação", r);
+            ok = kernel(*a, *b, *c);
+        }
+        auto fim = std::chrono::high_resolution_clock::now();
+        if (!ok) {
+            return false;
+        }
+        total += fim - inicio;
+        if (repeticoes > 1) {
+            std::cout << "Repetição " << (r + 1) << ": " << std::fixed << std::setprecision(3)
+                      << std::chrono::duration<double, std::milli>(fim - inicio).count() << " ms" << std::endl;
+        }
+    }
+
+    std::string arquivoResultado = prefixoResultado + std::to_string(dimensao) + sufixoResultado + sufixoTipo + extensao;
+    std::cout << "Salvando resultado em: " << arquivoResultado << std::endl;
+    long long inicioSalvar = agoraNs();
+    if (!c->salvar(arquivoResultado)) {
+        return false;
+    }
+    registrarTrecho("salvar resultado", inicioSalvar, agoraNs());
+
+    auto media = total / repeticoes;
+    double segundos = media.count();
+    double operacoes = 2.0 * dimensao * dimensao * dimensao;
+    std::cout << "Tempo de execução: " << std::chrono::duration_cast<std::chrono::milliseconds>(media).count()
+              << " ms" << std::endl;
+    std::printf("Desempenho: %.2f %s/s em %s\n", segundos > 0.0 ? operacoes / segundos / 1e9 : 0.0,
+                tipo == TIPO_FLOAT32 ? "GFLOP" : "GOP", nomeTipoDado(tipo));
+    return !verificacao.ativa() || verificarProduto(*a, *b, *c, verificacao);
+}
+
+// executarTipado() para o tipo escolhido em --dtype (float64 tem o caminho próprio)
+template <typename Kernel>
+bool executarComTipo(TipoDado tipo, int dimensao, const std::string& extensao, const std::string& prefixoResultado,
+                     const std::string& sufixoResultado, bool compartilhada, int repeticoes,
+                     const ParametrosVerificacao& verificacao, Kernel& kernel) {
+    switch (tipo) {
+        case TIPO_FLOAT32:
+            return executarTipado<float>(dimensao, extensao, prefixoResultado, sufixoResultado, compartilhada,
+                                         repeticoes, verificacao, kernel);
+        case TIPO_INT32:
+            return executarTipado<int32_t>(dimensao, extensao, prefixoResultado, sufixoResultado, compartilhada,
+                                           repeticoes, verificacao, kernel);
+        case TIPO_INT8:
+            return executarTipado<int8_t>(dimensao, extensao, prefixoResultado, sufixoResultado, compartilhada,
+                                          repeticoes, verificacao, kernel);
+        default:
+            std::cerr << "Erro: Tipo " << nomeTipoDado(tipo) << " sem caminho tipado" << std::endl;
+            return false;
+    }
+}
+
+// --dtype só vale para a multiplicação clássica de matrizes lidas de arquivo
+inline bool validarTipoDado(TipoDado tipo, bool strassen, bool fluxo, bool lote, bool contadores) {
+    if (tipo != TIPO_FLOAT64 && (strassen || fluxo || lote || contadores)) {
+        std::cerr << "Erro: --dtype=" << nomeTipoDado(tipo)
+                  << " usa só o algoritmo clássico e não aceita --fluxo, --lote nem --counters" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+#endif
@@ -1,8 +1,14 @@
 #include <iostream>
 #include <fstream>
-#include <random>
-#include <iomanip>
 #include <chrono>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "aleatorio.h"
+#include "lote.h"
+#include "matriz.h"
+#include "opcoes.h"
+#include "pool_threads.h"
 
 using namespace std;
 
@@ -13,69 +19,348 @@ using namespace std;
  * e as salva em arquivos de texto para posterior uso nos programas
  * de multiplicação.
  * 
- * Uso: ./gerador_matrizes <dimensao>
+ * Uso: ./gerador_matrizes <dimensao> [--formato=texto|binario] [--dtype=TIPO] [--densidade=D]
+ *      ./gerador_matrizes --lote=QUANTIDADE [--tamanhos=16,32,64,128]
+ *      ./gerador_matrizes --cadeia=D0,D1,...,Dn [--formato=texto|binario]
+ *      (todos aceitam --seed=SEMENTE e --threads=T)
  * 
  * Saída: 
- * - matriz_a_<dimensao>.txt
- * - matriz_b_<dimensao>.txt
+ * - matriz_a_<dimensao>.txt (ou .bin)
+ * - matriz_b_<dimensao>.txt (ou .bin)
+ * - com --dtype=float32|int32|int8: matriz_{a,b}_<dimensao>_<tipo>.txt (ou
+ *   .bin); os inteiros são sorteados de 1 a 100
+ * - com --densidade=D (entre 0 e 1, só float64), cada elemento é não nulo
+ *   com probabilidade D e os demais são 0.00 (ver esparsa.h)
+ * - lote_<quantidade>.lote: pares A, B quadrados com dimensões sorteadas
+ *   de --tamanhos (ver lote.h)
+ * - cadeia_<i>_<linhas>x<colunas>.txt (ou .bin), i = 1..n: a matriz Ai de
+ *   D(i-1) x Di de uma cadeia (ver cadeia.h)
+ *
+ * No formato binário os valores são arredondados para duas casas decimais,
+ * como no texto, de modo que converter um formato no outro não muda a matriz.
+ *
+ * Os valores vêm de um gerador baseado em contador (Philox, ver aleatorio.h):
+ * o elemento (i, j) depende só da semente, da matriz e de i * N + j. Blocos
+ * de linhas são gerados em paralelo por --threads threads (padrão: todas as
+ * CPUs) e, no texto, formatados sem iostream e gravados em ordem. Para uma
+ * mesma --seed os arquivos são idênticos byte a byte, com qualquer número de
+ * threads; sem --seed, a semente sorteada é impressa para repetir a execução.
  */
 
-void gerarMatriz(const string& nomeArquivo, int dimensao) {
-    ofstream arquivo(nomeArquivo);
+// Fluxos de Philox (ver aleatorio.h): A e B, os sorteios de dimensão do lote
+// e, a partir de FLUXO_PRIMEIRA_DO_LOTE, uma matriz do lote por fluxo. As
+// matrizes de uma cadeia usam fluxos a partir de FLUXO_PRIMEIRA_DA_CADEIA,
+// longe dos do lote
+const uint32_t FLUXO_MATRIZ_A = 0;
+const uint32_t FLUXO_MATRIZ_B = 1;
+const uint32_t FLUXO_SORTEIO_LOTE = 2;
+const uint32_t FLUXO_PRIMEIRA_DO_LOTE = 3;
+const uint32_t FLUXO_PRIMEIRA_DA_CADEIA = 1u << 31;
+
+// Linhas geradas por tarefa do pool
+const int LINHAS_BLOCO_GERACAO = 32;
+
+int numBlocosGeracao(int linhas) {
+    return (linhas + LINHAS_BLOCO_GERACAO - 1) / LINHAS_BLOCO_GERACAO;
+}
+
+// Escreve centesimos / 100 com duas casas decimais (o mesmo texto de fixed << setprecision(2))
+char* escreverCentesimos(char* p, int centesimos) {
+    char digitos[12];
+    int n = 0;
+    int inteira = centesimos / 100;
+    do {
+        digitos[n++] = (char)('0' + inteira % 10);
+        inteira /= 10;
+    } while (inteira > 0);
+    while (n > 0) {
+        *p++ = digitos[--n];
+    }
+    *p++ = '.';
+    *p++ = (char)('0' + centesimos / 10 % 10);
+    *p++ = (char)('0' + centesimos % 10);
+    return p;
+}
+
+// Texto das linhas [linha0, linha1) de uma matriz com `colunas` colunas
+void formatarLinhas(string& texto, const FluxoAleatorio& fluxo, int colunas, double densidade,
+                    int linha0, int linha1) {
+    // "99.99" e um separador por elemento, mais o fim de linha
+    texto.resize((size_t)(linha1 - linha0) * (colunas * 6 + 1));
+    char* p = &texto[0];
+    for (int i = linha0; i < linha1; i++) {
+        for (int j = 0; j < colunas; j++) {
+            p = escreverCentesimos(p, fluxo.centesimos((uint64_t)i * colunas + j, densidade));
+            *p++ = j < colunas - 1 ? ' ' : '\n';
+        }
+    }
+    texto.resize(p - &texto[0]);
+}
+
+// Formato texto: as threads formatam blocos de linhas em paralelo, gravados em ordem
+void gerarMatriz(const string& nomeArquivo, int linhas, int colunas, const FluxoAleatorio& fluxo,
+                 double densidade, PoolThreads& pool) {
+    ofstream arquivo(nomeArquivo, ios::binary);
     
     if (!arquivo.is_open()) {
         cerr << "Erro ao criar arquivo: " << nomeArquivo << endl;
         exit(1);
     }
     
-    // Configurar gerador de números aleatórios
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_real_distribution<double> dis(1.0, 100.0);
+    // Escrever dimensão no início do arquivo (linhas e colunas, se diferentes)
+    arquivo << linhas;
+    if (colunas != linhas) {
+        arquivo << " " << colunas;
+    }
+    arquivo << "\n";
     
-    // Escrever dimensão no início do arquivo
-    arquivo << dimensao << endl;
+    // Poucos blocos por thread de cada vez, para não guardar o texto inteiro na memória
+    int numBlocos = numBlocosGeracao(linhas);
+    int blocosPorRodada = pool.tamanho() * 4;
+    vector<string> textos(blocosPorRodada);
+    for (int primeiro = 0; primeiro < numBlocos; primeiro += blocosPorRodada) {
+        int rodada = min(blocosPorRodada, numBlocos - primeiro);
+        pool.paraCada(rodada, [&](int t, int) {
+            int linha0 = (primeiro + t) * LINHAS_BLOCO_GERACAO;
+            formatarLinhas(textos[t], fluxo, colunas, densidade, linha0,
+                           min(linhas, linha0 + LINHAS_BLOCO_GERACAO));
+        });
+        for (int t = 0; t < rodada; t++) {
+            arquivo.write(textos[t].data(), textos[t].size());
+        }
+    }
     
-    // Gerar e escrever matriz
-    for (int i = 0; i < dimensao; i++) {
-        for (int j = 0; j < dimensao; j++) {
-            arquivo << fixed << setprecision(2) << dis(gen);
-            if (j < dimensao - 1) {
-                arquivo << " ";
+    arquivo.close();
+    if (!arquivo) {
+        cerr << "Erro ao gravar arquivo: " << nomeArquivo << endl;
+        exit(1);
+    }
+    cout << "Matriz " << linhas << "x" << colunas << " salva em: " << nomeArquivo << endl;
+}
+
+// Preenche `m` com os valores do fluxo (em centésimos), blocos de linhas em paralelo
+void preencherMatriz(VisaoMatriz m, const FluxoAleatorio& fluxo, double densidade, PoolThreads& pool) {
+    pool.paraCada(numBlocosGeracao(m.linhas), [&](int bloco, int) {
+        int linha0 = bloco * LINHAS_BLOCO_GERACAO;
+        for (int i = linha0; i < min(m.linhas, linha0 + LINHAS_BLOCO_GERACAO); i++) {
+            double* linha = m.linha(i);
+            for (int j = 0; j < m.colunas; j++) {
+                linha[j] = fluxo.centesimos((uint64_t)i * m.colunas + j, densidade) / 100.0;
             }
         }
-        arquivo << endl;
+    });
+}
+
+void gerarMatrizBinaria(const string& nomeArquivo, int linhas, int colunas, const FluxoAleatorio& fluxo,
+                        double densidade, PoolThreads& pool) {
+    MatrizDensa matriz(linhas, colunas, true, SemInicializar());
+    preencherMatriz(matriz.visao(), fluxo, densidade, pool);
+    
+    if (!matriz.salvarEmArquivoBinario(nomeArquivo)) {
+        exit(1);
     }
+    cout << "Matriz " << linhas << "x" << colunas << " salva em: " << nomeArquivo << endl;
+}
+
+// Matriz com elementos de --dtype diferente de float64 (texto ou binário)
+template <typename T>
+void gerarMatrizTipada(const string& nomeArquivo, int dimensao, const FluxoAleatorio& fluxo, PoolThreads& pool) {
+    MatrizDensaT<T> matriz(dimensao);
     
-    arquivo.close();
+    pool.paraCada(numBlocosGeracao(dimensao), [&](int bloco, int) {
+        int linha0 = bloco * LINHAS_BLOCO_GERACAO;
+        for (int i = linha0; i < min(dimensao, linha0 + LINHAS_BLOCO_GERACAO); i++) {
+            T* linha = matriz.linha(i);
+            for (int j = 0; j < dimensao; j++) {
+                uint64_t indice = (uint64_t)i * dimensao + j;
+                linha[j] = TipoElemento<T>::codigo() == TIPO_FLOAT32 ? (T)(fluxo.centesimos(indice) / 100.0)
+                                                                    : (T)fluxo.inteiro(indice, 1, 100);
+            }
+        }
+    });
+    
+    if (!matriz.salvar(nomeArquivo)) {
+        exit(1);
+    }
     cout << "Matriz " << dimensao << "x" << dimensao << " salva em: " << nomeArquivo << endl;
 }
 
+void gerarMatrizDoTipo(TipoDado tipo, const string& nomeArquivo, int dimensao, bool binario, double densidade,
+                       const FluxoAleatorio& fluxo, PoolThreads& pool) {
+    switch (tipo) {
+        case TIPO_FLOAT32: gerarMatrizTipada<float>(nomeArquivo, dimensao, fluxo, pool); break;
+        case TIPO_INT32: gerarMatrizTipada<int32_t>(nomeArquivo, dimensao, fluxo, pool); break;
+        case TIPO_INT8: gerarMatrizTipada<int8_t>(nomeArquivo, dimensao, fluxo, pool); break;
+        default:
+            if (binario) {
+                gerarMatrizBinaria(nomeArquivo, dimensao, dimensao, fluxo, densidade, pool);
+            } else {
+                gerarMatriz(nomeArquivo, dimensao, dimensao, fluxo, densidade, pool);
+            }
+    }
+}
+
+// Lote com `quantidade` pares de matrizes quadradas de dimensões sorteadas
+bool gerarLote(const string& nomeArquivo, int quantidade, const vector<int>& tamanhos, uint64_t semente,
+               PoolThreads& pool) {
+    FluxoAleatorio sorteio(semente, FLUXO_SORTEIO_LOTE);
+    
+    vector<pair<int, int>> formatos;
+    for (int p = 0; p < quantidade; p++) {
+        int dim = tamanhos[sorteio.inteiro(p, 0, (int)tamanhos.size() - 1)];
+        formatos.push_back(make_pair(dim, dim));
+        formatos.push_back(make_pair(dim, dim));
+    }
+    
+    ArquivoLote lote;
+    if (!lote.criar(nomeArquivo, formatos)) {
+        return false;
+    }
+    // Cada matriz tem o próprio fluxo e é preenchida inteira por uma thread
+    pool.paraCada(lote.tamanhoLote(), [&](int i, int) {
+        FluxoAleatorio fluxo(semente, FLUXO_PRIMEIRA_DO_LOTE + i);
+        VisaoMatriz m = lote.matriz(i);
+        for (int l = 0; l < m.linhas; l++) {
+            double* linha = m.linha(l);
+            for (int j = 0; j < m.colunas; j++) {
+                linha[j] = fluxo.centesimos((uint64_t)l * m.colunas + j) / 100.0;
+            }
+        }
+    });
+    cout << "Lote com " << quantidade << " pares de matrizes salvo em: " << nomeArquivo << endl;
+    return true;
+}
+
+// Matrizes A1..An de uma cadeia com as dimensões D0, D1, ..., Dn; imprime a
+// lista para --cadeia dos programas de multiplicação
+void gerarCadeia(const vector<int>& dimensoes, bool binario, uint64_t semente, PoolThreads& pool) {
+    string lista;
+    for (size_t i = 1; i < dimensoes.size(); i++) {
+        int linhas = dimensoes[i - 1], colunas = dimensoes[i];
+        string nomeArquivo = "cadeia_" + to_string(i) + "_" + to_string(linhas) + "x" + to_string(colunas) +
+                             (binario ? ".bin" : ".txt");
+        FluxoAleatorio fluxo(semente, FLUXO_PRIMEIRA_DA_CADEIA + (uint32_t)i);
+        if (binario) {
+            gerarMatrizBinaria(nomeArquivo, linhas, colunas, fluxo, 1.0, pool);
+        } else {
+            gerarMatriz(nomeArquivo, linhas, colunas, fluxo, 1.0, pool);
+        }
+        lista += (i > 1 ? "," : "") + nomeArquivo;
+    }
+    cout << "Cadeia de " << dimensoes.size() - 1 << " matrizes: --cadeia=" << lista << endl;
+}
+
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        cout << "Uso: " << argv[0] << " <dimensao>" << endl;
+    Opcoes opcoes(argc, argv);
+    if (!opcoes.aceitarApenas({"cadeia,densidade,dtype,formato,lote,seed,tamanhos,threads"})) {
+        return 1;
+    }
+    bool modoLote = opcoes.tem("lote");
+    bool modoCadeia = opcoes.tem("cadeia");
+    int numThreads = opcoes.inteiro("threads", max(1, (int)thread::hardware_concurrency()));
+    
+    if (opcoes.numPosicionais() != (modoLote || modoCadeia ? 0 : 1)) {
+        cout << "Uso: " << argv[0] << " <dimensao> [--formato=texto|binario] [--dtype=float64|float32|int32|int8] [--densidade=D]" << endl;
+        cout << "     " << argv[0] << " --lote=QUANTIDADE [--tamanhos=16,32,64,128]" << endl;
+        cout << "     " << argv[0] << " --cadeia=D0,D1,...,Dn [--formato=texto|binario]  (Ai é D(i-1) x Di)" << endl;
+        cout << "Opções comuns: --seed=SEMENTE (resultado reproduzível) --threads=T" << endl;
         cout << "Exemplo: " << argv[0] << " 100" << endl;
         return 1;
     }
     
-    int dimensao = atoi(argv[1]);
+    if (numThreads <= 0) {
+        cerr << "Erro: O número de threads deve ser um número positivo." << endl;
+        return 1;
+    }
+    
+    uint64_t semente = opcoes.tem("seed") ? strtoull(opcoes.texto("seed", "0").c_str(), nullptr, 10)
+                                          : sementeAleatoria();
+    cout << "Semente: " << semente << " (repita com --seed=" << semente << ")" << endl;
+    PoolThreads pool(numThreads);
+    
+    if (modoLote) {
+        int quantidade = opcoes.inteiro("lote", 0);
+        vector<int> tamanhos = opcoes.listaInteiros("tamanhos", "16,32,64,128");
+        if (quantidade <= 0) {
+            cerr << "Erro: A quantidade de produtos do lote deve ser um número positivo." << endl;
+            return 1;
+        }
+        if (tamanhos.empty() || *min_element(tamanhos.begin(), tamanhos.end()) <= 0) {
+            cerr << "Erro: Os tamanhos do lote devem ser números positivos." << endl;
+            return 1;
+        }
+        
+        auto inicio = chrono::high_resolution_clock::now();
+        if (!gerarLote("lote_" + to_string(quantidade) + ".lote", quantidade, tamanhos, semente, pool)) {
+            return 1;
+        }
+        auto duracao = chrono::duration_cast<chrono::milliseconds>(chrono::high_resolution_clock::now() - inicio);
+        cout << "Lote gerado com sucesso em " << duracao.count() << " ms" << endl;
+        return 0;
+    }
+    
+    if (modoCadeia) {
+        vector<int> dimensoes = opcoes.listaInteiros("cadeia", "");
+        string formato = opcoes.texto("formato", "texto");
+        if (dimensoes.size() < 3 || *min_element(dimensoes.begin(), dimensoes.end()) <= 0) {
+            cerr << "Erro: A cadeia precisa de pelo menos três dimensões positivas (duas matrizes)." << endl;
+            return 1;
+        }
+        if (formato != "texto" && formato != "binario") {
+            cerr << "Erro: Formato desconhecido: " << formato << " (use texto ou binario)" << endl;
+            return 1;
+        }
+        
+        auto inicio = chrono::high_resolution_clock::now();
+        gerarCadeia(dimensoes, formato == "binario", semente, pool);
+        auto duracao = chrono::duration_cast<chrono::milliseconds>(chrono::high_resolution_clock::now() - inicio);
+        cout << "Cadeia gerada com sucesso em " << duracao.count() << " ms" << endl;
+        return 0;
+    }
+    
+    int dimensao = atoi(opcoes.posicional(0).c_str());
+    string formato = opcoes.texto("formato", "texto");
+    TipoDado tipo = TIPO_FLOAT64;
+    double densidade = atof(opcoes.texto("densidade", "1").c_str());
     
     if (dimensao <= 0) {
         cerr << "Erro: A dimensão deve ser um número positivo." << endl;
         return 1;
     }
     
+    if (formato != "texto" && formato != "binario") {
+        cerr << "Erro: Formato desconhecido: " << formato << " (use texto ou binario)" << endl;
+        return 1;
+    }
+    
+    if (!interpretarTipoDado(opcoes.texto("dtype", "float64"), tipo)) {
+        return 1;
+    }
+    
+    if (densidade < 0.0 || densidade > 1.0) {
+        cerr << "Erro: A densidade deve estar entre 0 e 1." << endl;
+        return 1;
+    }
+    
+    if (densidade < 1.0 && tipo != TIPO_FLOAT64) {
+        cerr << "Erro: Matrizes esparsas (--densidade) só são geradas em float64." << endl;
+        return 1;
+    }
+    
+    bool binario = formato == "binario";
+    string extensao = sufixoTipoDado(tipo) + (binario ? ".bin" : ".txt");
+    
     cout << "Gerando matrizes " << dimensao << "x" << dimensao << "..." << endl;
     
     auto inicio = chrono::high_resolution_clock::now();
     
     // Gerar matriz A
-    string arquivoA = "matriz_a_" + to_string(dimensao) + ".txt";
-    gerarMatriz(arquivoA, dimensao);
+    string arquivoA = "matriz_a_" + to_string(dimensao) + extensao;
+    gerarMatrizDoTipo(tipo, arquivoA, dimensao, binario, densidade, FluxoAleatorio(semente, FLUXO_MATRIZ_A), pool);
     
     // Gerar matriz B
-    string arquivoB = "matriz_b_" + to_string(dimensao) + ".txt";
-    gerarMatriz(arquivoB, dimensao);
+    string arquivoB = "matriz_b_" + to_string(dimensao) + extensao;
+    gerarMatrizDoTipo(tipo, arquivoB, dimensao, binario, densidade, FluxoAleatorio(semente, FLUXO_MATRIZ_B), pool);
     
     auto fim = chrono::high_resolution_clock::now();
     auto duracao = chrono::duration_cast<chrono::milliseconds>(fim - inicio);
@@ -0,0 +1,225 @@
+#ifndef KERNEL_FIXO_H
+#define KERNEL_FIXO_H
+
+#include <immintrin.h>
+#include <iostream>
+#include <string>
+#include "matriz.h"
+#include "microkernel.h"
+
+/**
+ * Kernels especializados em tempo de compilação para matrizes quadradas
+ * pequenas (N = 4, 8, 16, 32 e 64), que dominam os lotes.
+ *
+ * Para esses tamanhos o GEMM genérico gasta mais empacotando A e B e
+ * tratando bordas do que calculando. Aqui N é um parâmetro de template: os
+ * laços têm número fixo de iterações e, nas versões vetoriais, são
+ * desenrolados por completo (na escalar, só o das colunas, para não
+ * multiplicar o tempo de compilação). Os acumuladores de um bloco de C ficam
+ * em registradores e A e B são lidos diretamente, sem empacotamento.
+ *
+ * Há uma versão para cada família de micro-kernel (escalar, AVX2/FMA e
+ * AVX-512), escolhida pelo kernel em uso. Cada elemento de C é acumulado na
+ * mesma ordem e com as mesmas operações (FMA ou não) do micro-kernel
+ * correspondente, então o resultado é idêntico, bit a bit, ao do GEMM.
+ * multiplicarFixo() retorna false para os demais formatos, e o chamador
+ * segue pelo caminho genérico.
+ */
+
+typedef void (*FuncaoKernelFixo)(const double* a, int passoA, const double* b, int passoB,
+                                 double* c, int passoC);
+
+// Versão escalar: uma linha de C por vez, com os N acumuladores em registradores
+template <int N>
+inline void kernelFixoEscalar(const double* a, int passoA, const double* b, int passoB,
+                              double* c, int passoC) {
+    for (int i = 0; i < N; i++) {
+        double acc[N] = {};
+        for (int k = 0; k < N; k++) {
+            const double aik = a[(size_t)i * passoA + k];
+            const double* bk = b + (size_t)k * passoB;
+#pragma GCC unroll 64
+            for (int j = 0; j < N; j++) {
+                acc[j] += aik * bk[j];
+            }
+        }
+        for (int j = 0; j < N; j++) {
+            c[(size_t)i * passoC + j] = acc[j];
+        }
+    }
+}
+
+// Bloco R x (4 * V) de C com AVX2/FMA, percorrendo toda a dimensão interna
+template <int N, int R, int V>
+__attribute__((target("avx2,fma")))
+inline void blocoFixoAvx2(const double* a, int passoA, const double* b, int passoB,
+                          double* c, int passoC) {
+    __m256d acc[R][V];
+#pragma GCC unroll 16
+    for (int r = 0; r < R; r++) {
+#pragma GCC unroll 16
+        for (int v = 0; v < V; v++) {
+            acc[r][v] = _mm256_setzero_pd();
+        }
+    }
+#pragma GCC unroll 64
+    for (int k = 0; k < N; k++) {
+        __m256d bk[V];
+#pragma GCC unroll 16
+        for (int v = 0; v < V; v++) {
+            bk[v] = _mm256_loadu_pd(b + (size_t)k * passoB + 4 * v);
+        }
+#pragma GCC unroll 16
+        for (int r = 0; r < R; r++) {
+            __m256d ar = _mm256_broadcast_sd(a + (size_t)r * passoA + k);
+#pragma GCC unroll 16
+            for (int v = 0; v < V; v++) {
+                acc[r][v] = _mm256_fmadd_pd(ar, bk[v], acc[r][v]);
+            }
+        }
+    }
+#pragma GCC unroll 16
+    for (int r = 0; r < R; r++) {
+#pragma GCC unroll 16
+        for (int v = 0; v < V; v++) {
+            _mm256_storeu_pd(c + (size_t)r * passoC + 4 * v, acc[r][v]);
+        }
+    }
+}
+
+// 16 registradores ymm: blocos de até 4 linhas por 8 colunas (8 acumuladores)
+template <int N>
+__attribute__((target("avx2,fma")))
+inline void kernelFixoAvx2(const double* a, int passoA, const double* b, int passoB,
+                           double* c, int passoC) {
+    const int colunasBloco = N < 8 ? N : 8;
+    for (int i = 0; i < N; i += 4) {
+        for (int j = 0; j < N; j += colunasBloco) {
+            blocoFixoAvx2<N, 4, colunasBloco / 4>(a + (size_t)i * passoA, passoA, b + j, passoB,
+                                                  c + (size_t)i * passoC + j, passoC);
+        }
+    }
+}
+
+// Bloco R x (8 * V) de C com AVX-512, percorrendo toda a dimensão interna
+template <int N, int R, int V>
+__attribute__((target("avx512f")))
+inline void blocoFixoAvx512(const double* a, int passoA, const double* b, int passoB,
+                            double* c, int passoC) {
+    __m512d acc[R][V];
+#pragma GCC unroll 16
+    for (int r = 0; r < R; r++) {
+#pragma GCC unroll 16
+        for (int v = 0; v < V; v++) {
+            acc[r][v] = _mm512_setzero_pd();
+        }
+    }
+#pragma GCC unroll 64
+    for (int k = 0; k < N; k++) {
+        __m512d bk[V];
+#pragma GCC unroll 16
+        for (int v = 0; v < V; v++) {
+            bk[v] = _mm512_loadu_pd(b + (size_t)k * passoB + 8 * v);
+        }
+#pragma GCC unroll 16
+        for (int r = 0; r < R; r++) {
+            __m512d ar = _mm512_set1_pd(a[(size_t)r * passoA + k]);
+#pragma GCC unroll 16
+            for (int v = 0; v < V; v++) {
+                acc[r][v] = _mm512_fmadd_pd(ar, bk[v], acc[r][v]);
+            }
+        }
+    }
+#pragma GCC unroll 16
+    for (int r = 0; r < R; r++) {
+#pragma GCC unroll 16
+        for (int v = 0; v < V; v++) {
+            _mm512_storeu_pd(c + (size_t)r * passoC + 8 * v, acc[r][v]);
+        }
+    }
+}
+
+// 32 registradores zmm: blocos de até 8 linhas por 16 colunas ou 4 por 32
+// (16 acumuladores)
+template <int N>
+__attribute__((target("avx512f")))
+inline void kernelFixoAvx512(const double* a, int passoA, const double* b, int passoB,
+                             double* c, int passoC) {
+    const int colunasBloco = N < 32 ? N : 32;
+    const int linhasBloco = colunasBloco == 32 ? 4 : 8;
+    for (int i = 0; i < N; i += linhasBloco) {
+        for (int j = 0; j < N; j += colunasBloco) {
+            blocoFixoAvx512<N, linhasBloco, colunasBloco / 8>(a + (size_t)i * passoA, passoA, b + j, passoB,
+                                                              c + (size_t)i * passoC + j, passoC);
+        }
+    }
+}
+
+// Kernels para N = 4, 8, 16, 32 e 64 (índice log2(N) - 2) da família do kernel em uso.
+// Com AVX-512, N = 4 (menor que um registrador zmm) usa a versão AVX2, também com FMA.
+inline FuncaoKernelFixo kernelFixo(int indice) {
+    static const FuncaoKernelFixo escalar[] = {
+        kernelFixoEscalar<4>, kernelFixoEscalar<8>, kernelFixoEscalar<16>, kernelFixoEscalar<32>,
+        kernelFixoEscalar<64>
+    };
+    static const FuncaoKernelFixo avx2[] = {
+        kernelFixoAvx2<4>, kernelFixoAvx2<8>, kernelFixoAvx2<16>, kernelFixoAvx2<32>, kernelFixoAvx2<64>
+    };
+    static const FuncaoKernelFixo avx512[] = {
+        kernelFixoAvx2<4>, kernelFixoAvx512<8>, kernelFixoAvx512<16>, kernelFixoAvx512<32>,
+        kernelFixoAvx512<64>
+    };
+
+    const MicroKernel* uk = &microKernel();
+    if (uk == &kernelAvx512()) {
+        return indice == 0 && !cpuSuportaAvx2() ? nullptr : avx512[indice];
+    }
+    return uk == &kernelAvx2() ? avx2[indice] : escalar[indice];
+}
+
+// Liga ou desliga os kernels fixos (--fixos=auto|nao, para comparação)
+inline bool& kernelsFixosAtivos() {
+    static bool ativos = true;
+    return ativos;
+}
+
+inline bool selecionarKernelsFixos(const std::string& valor) {
+    if (valor == "auto" || valor == "sim") {
+        kernelsFixosAtivos() = true;
+    } else if (valor == "nao") {
+        kernelsFixosAtivos() = false;
+    } else {
+        std::cerr << "Erro: Valor inválido para --fixos: " << valor << " (use auto ou nao)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// C = A * B com um kernel fixo, se A, B e C forem N x N com N especializado.
+// Com kc < N o GEMM somaria a dimensão interna em partes; para manter o
+// mesmo resultado, esse caso também fica com o caminho genérico.
+inline bool multiplicarFixo(VisaoMatrizConst a, VisaoMatrizConst b, VisaoMatriz c, int kc) {
+    const int n = c.linhas;
+    if (!kernelsFixosAtivos() || n != c.colunas || n != a.linhas || n != a.colunas || n != b.linhas ||
+        n != b.colunas || n > kc) {
+        return false;
+    }
+
+    int indice;
+    switch (n) {
+        case 4: indice = 0; break;
+        case 8: indice = 1; break;
+        case 16: indice = 2; break;
+        case 32: indice = 3; break;
+        case 64: indice = 4; break;
+        default: return false;
+    }
+    FuncaoKernelFixo funcao = kernelFixo(indice);
+    if (funcao == nullptr) {
+        return false;
+    }
+    funcao(a.dados, a.passo, b.dados, b.passo, c.dados, c.passo);
+    return true;
+}
+
+#endif
@@ -0,0 +1,372 @@
+#ifndef LOTE_H
+#define LOTE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "formato_binario.h"
+#include "matriz.h"
+#include "memoria_compartilhada.h"
+#include "microkernel.h"
+#include "rastreamento.h"
+#include "verificacao.h"
+
+/**
+ * Modo em lote (--lote=ARQUIVO): muitos produtos pequenos em uma execução.
+ *
+ * Um arquivo de lote (.lote) guarda uma sequência de matrizes de qualquer
+ * formato: um cabeçalho de 64 bytes, um índice com a posição e as dimensões
+ * de cada matriz e os dados, cada matriz alinhada a 64 bytes e com o mesmo
+ * passo de MatrizDensa. O lote de entrada tem os pares A0, B0, A1, B1, ...;
+ * o de saída, gerado pelos programas de multiplicação, tem C0, C1, ...
+ *
+ * Como no formato binário, os arquivos são mapeados e usados sem cópia: a
+ * entrada com MAP_PRIVATE, a saída com MAP_SHARED, de modo que o resultado
+ * escrito pelas threads ou pelos processos filhos já está no arquivo. Cada
+ * matriz também pode ser descrita por um DescritorMatriz (arquivo e
+ * deslocamento) para o pool de processos.
+ *
+ * Os produtos são entregues a um KernelLote; a divisão entre os
+ * trabalhadores fica em multiplicacao.h.
+ */
+
+const char MAGICA_LOTE[8] = { 'M', 'A', 'T', 'L', 'O', 'T', 'E', '\0' };
+const uint32_t VERSAO_LOTE = 1;
+
+struct CabecalhoLote {
+    char magica[8];
+    uint32_t versao;
+    uint32_t tipoDado;
+    uint64_t numMatrizes;
+    uint64_t tamanhoCabecalho;  // deslocamento do índice a partir do início do arquivo
+    uint8_t reservado[32];
+};
+
+// Entrada do índice: onde está e qual é o formato de uma matriz do lote
+struct EntradaLote {
+    uint64_t deslocamento;
+    uint32_t linhas;
+    uint32_t colunas;
+    uint32_t passo;
+    uint8_t reservado[12];
+};
+
+static_assert(sizeof(CabecalhoLote) == 64, "cabeçalho do lote deve ter 64 bytes");
+static_assert(sizeof(EntradaLote) == 32, "entrada do índice do lote deve ter 32 bytes");
+
+// Produto C = A * B de um lote, como visões (threads) e descritores (processos)
+struct ProdutoLote {
+    VisaoMatrizConst a;
+    VisaoMatrizConst b;
+    VisaoMatriz c;
+    DescritorMatriz descA;
+    DescritorMatriz descB;
+    DescritorMatriz descC;
+};
+
+class ArquivoLote {
+private:
+    std::string nome;
+    char* base;
+    size_t tamanho;
+    const EntradaLote* indice;
+    int numMatrizes;
+    uint64_t geracao;  // ver DescritorMatriz::geracao
+
+    void fechar() {
+        if (base != nullptr) {
+            munmap(base, tamanho);
+            base = nullptr;
+        }
+        indice = nullptr;
+        numMatrizes = 0;
+    }
+
+public:
+    ArquivoLote() : base(nullptr), tamanho(0), indice(nullptr), numMatrizes(0), geracao(0) {}
+    ~ArquivoLote() { fechar(); }
+
+    ArquivoLote(const ArquivoLote&) = delete;
+    ArquivoLote& operator=(const ArquivoLote&) = delete;
+
+    // Mapeia um lote existente para leitura (MAP_PRIVATE, páginas trazidas já na abertura)
+    bool abrir(const std::string& arquivo) {
+        fechar();
+        nome = arquivo;
+        geracao = novaGeracao();
+        int fd = open(arquivo.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Erro ao abrir arquivo: " << arquivo << std::endl;
+            return false;
+        }
+
+        CabecalhoLote cab;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(cab) ||
+            pread(fd, &cab, sizeof(cab), 0) != (ssize_t)sizeof(cab)) {
+            std::cerr << "Erro: Arquivo de lote truncado: " << arquivo << std::endl;
+            close(fd);
+            return false;
+        }
+        if (memcmp(cab.magica, MAGICA_LOTE, sizeof(cab.magica)) != 0 || cab.versao != VERSAO_LOTE ||
+            cab.tipoDado != TIPO_FLOAT64 || !hostLittleEndian()) {
+            std::cerr << "Erro: " << arquivo << " não é um arquivo de lote válido" << std::endl;
+            close(fd);
+            return false;
+        }
+
+        tamanho = info.st_size;
+        void* mem = mmap(nullptr, tamanho, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        close(fd);
+        if (mem == MAP_FAILED) {
+            std::cerr << "Erro ao mapear arquivo: " << arquivo << std::endl;
+            return false;
+        }
+        base = static_cast<char*>(mem);
+
+        // Índice e dados de cada matriz precisam caber no arquivo
+        bool valido = cab.tamanhoCabecalho + cab.numMatrizes * sizeof(EntradaLote) <= tamanho;
+        indice = reinterpret_cast<const EntradaLote*>(base + cab.tamanhoCabecalho);
+        numMatrizes = (int)cab.numMatrizes;
+        for (int i = 0; valido && i < numMatrizes; i++) {
+            const EntradaLote& e = indice[i];
+            valido = e.passo >= e.colunas && e.deslocamento % ALINHAMENTO_CACHE == 0 &&
+                     e.deslocamento + (uint64_t)e.linhas * e.passo * sizeof(double) <= tamanho;
+        }
+        if (!valido) {
+            std::cerr << "Erro: Arquivo de lote truncado: " << arquivo << std::endl;
+            fechar();
+            return false;
+        }
+        return true;
+    }
+
+    // Cria um lote com matrizes de formatos (linhas, colunas) dados, mapeado com
+    // MAP_SHARED para escrita; o conteúdo começa zerado
+    bool criar(const std::string& arquivo, const std::vector<std::pair<int, int>>& formatos) {
+        fechar();
+        nome = arquivo;
+        geracao = novaGeracao();
+        size_t bytesIndice = formatos.size() * sizeof(EntradaLote);
+        size_t inicioDados = sizeof(CabecalhoLote) +
+                             (bytesIndice + ALINHAMENTO_CACHE - 1) / ALINHAMENTO_CACHE * ALINHAMENTO_CACHE;
+        std::vector<EntradaLote> entradas(formatos.size());
+        size_t fim = inicioDados;
+        for (size_t i = 0; i < formatos.size(); i++) {
+            EntradaLote& e = entradas[i];
+            memset(&e, 0, sizeof(e));
+            e.deslocamento = fim;
+            e.linhas = formatos[i].first;
+            e.colunas = formatos[i].second;
+            e.passo = calcularPasso(e.colunas, true);
+            fim += (size_t)e.linhas * e.passo * sizeof(double);
+        }
+
+        int fd = open(arquivo.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::cerr << "Erro ao criar arquivo: " << arquivo << std::endl;
+            return false;
+        }
+        if (ftruncate(fd, fim) != 0) {
+            std::cerr << "Erro ao dimensionar arquivo: " << arquivo << std::endl;
+            close(fd);
+            return false;
+        }
+        tamanho = fim;
+        void* mem = mmap(nullptr, tamanho, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mem == MAP_FAILED) {
+            std::cerr << "Erro ao mapear arquivo: " << arquivo << std::endl;
+            return false;
+        }
+        base = static_cast<char*>(mem);
+
+        CabecalhoLote cab;
+        memset(&cab, 0, sizeof(cab));
+        memcpy(cab.magica, MAGICA_LOTE, sizeof(cab.magica));
+        cab.versao = VERSAO_LOTE;
+        cab.tipoDado = TIPO_FLOAT64;
+        cab.numMatrizes = formatos.size();
+        cab.tamanhoCabecalho = sizeof(CabecalhoLote);
+        memcpy(base, &cab, sizeof(cab));
+        if (!entradas.empty()) {
+            memcpy(base + sizeof(cab), entradas.data(), bytesIndice);
+        }
+        indice = reinterpret_cast<const EntradaLote*>(base + sizeof(cab));
+        numMatrizes = (int)formatos.size();
+        return true;
+    }
+
+    int tamanhoLote() const { return numMatrizes; }
+    const std::string& arquivo() const { return nome; }
+
+    VisaoMatriz matriz(int i) const {
+        const EntradaLote& e = indice[i];
+        VisaoMatriz v = { reinterpret_cast<double*>(base + e.deslocamento), (int)e.linhas, (int)e.colunas,
+                          (int)e.passo };
+        return v;
+    }
+
+    // Descreve a matriz i para outro processo, que mapeia o próprio arquivo
+    bool descrever(int i, DescritorMatriz& d) const {
+        if (nome.size() >= sizeof(d.caminho)) {
+            return false;
+        }
+        const EntradaLote& e = indice[i];
+        memset(&d, 0, sizeof(d));
+        strcpy(d.caminho, nome.c_str());
+        d.ehShm = 0;
+        d.deslocamento = e.deslocamento;
+        d.linhas = e.linhas;
+        d.colunas = e.colunas;
+        d.passo = e.passo;
+        d.bytesElemento = sizeof(double);
+        d.geracao = geracao;
+        return true;
+    }
+};
+
+// Nome do resultado: "lote_1000.lote" com prefixo "resultado_threads_" e sufixo "_4"
+// vira "resultado_threads_lote_1000_4.lote" (no diretório atual)
+inline std::string nomeResultadoLote(const std::string& prefixo, const std::string& arquivo,
+                                     const std::string& sufixo) {
+    std::string base = arquivo.substr(arquivo.find_last_of('/') + 1);
+    if (terminaCom(base, ".lote")) {
+        base.resize(base.size() - 5);
+    }
+    return prefixo + base + sufixo + ".lote";
+}
+
+// Produtos de um lote de pares (A, B), com C no lote de saída (que é criado aqui)
+inline bool prepararLote(const ArquivoLote& entrada, const std::string& arquivoResultado,
+                         ArquivoLote& saida, std::vector<ProdutoLote>& produtos) {
+    if (entrada.tamanhoLote() % 2 != 0) {
+        std::cerr << "Erro: O lote deve ter um número par de matrizes (pares A, B)" << std::endl;
+        return false;
+    }
+    int numProdutos = entrada.tamanhoLote() / 2;
+    std::vector<std::pair<int, int>> formatos;
+    for (int p = 0; p < numProdutos; p++) {
+        VisaoMatriz a = entrada.matriz(2 * p);
+        VisaoMatriz b = entrada.matriz(2 * p + 1);
+        if (a.colunas != b.linhas) {
+            std::cerr << "Erro: Dimensões incompatíveis no produto " << p << " do lote ("
+                      << a.linhas << "x" << a.colunas << " por " << b.linhas << "x" << b.colunas << ")" << std::endl;
+            return false;
+        }
+        formatos.push_back(std::make_pair(a.linhas, b.colunas));
+    }
+    if (!saida.criar(arquivoResultado, formatos)) {
+        return false;
+    }
+
+    produtos.resize(numProdutos);
+    for (int p = 0; p < numProdutos; p++) {
+        ProdutoLote& produto = produtos[p];
+        produto.a = entrada.matriz(2 * p);
+        produto.b = entrada.matriz(2 * p + 1);
+        produto.c = saida.matriz(p);
+        if (!entrada.descrever(2 * p, produto.descA) || !entrada.descrever(2 * p + 1, produto.descB) ||
+            !saida.descrever(p, produto.descC)) {
+            std::cerr << "Erro: Caminho do lote longo demais" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+typedef std::function<bool(const std::vector<ProdutoLote>&)> KernelLote;
+
+// Todos os produtos do lote com Freivalds (ver verificacao.h), em uma linha de resumo
+inline bool verificarLote(const std::vector<ProdutoLote>& produtos, const ParametrosVerificacao& p) {
+    auto inicio = std::chrono::steady_clock::now();
+    uint64_t semente = sementeAleatoria();
+    ResultadoVerificacao pior = { 0.0, -1, true };
+    int produtoPior = -1, reprovados = 0;
+    for (size_t i = 0; i < produtos.size(); i++) {
+        const ProdutoLote& produto = produtos[i];
+        ResultadoVerificacao r = freivalds(produto.a, produto.b, VisaoMatrizConst(produto.c), p, semente + i);
+        reprovados += !r.aprovado;
+        if (produtoPior < 0 || std::isnan(r.erroMaximo) || r.erroMaximo > pior.erroMaximo) {
+            pior = r;
+            produtoPior = (int)i;
+        }
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+    std::printf("Verificação (Freivalds, %d vetores, %zu produtos): %s, erro relativo máximo %.2e no produto %d "
+                "(tolerância %.2e), %.1f ms\n",
+                p.vetores, produtos.size(), reprovados == 0 ? "OK" : "FALHOU", pior.erroMaximo, produtoPior,
+                p.toleranciaPara<double>(), ms);
+    if (reprovados > 0) {
+        std::printf("%d produto(s) reprovado(s)\n", reprovados);
+    }
+    return reprovados == 0;
+}
+
+// Executa e relata a multiplicação de todos os produtos de um lote,
+// `repeticoes` vezes (o tempo relatado é a média por lote)
+inline bool executarLote(const std::string& arquivo, const std::string& arquivoResultado, int repeticoes,
+                         const KernelLote& kernel, int numTrabalhadores, const ParametrosVerificacao& verificacao) {
+    auto inicioTotal = std::chrono::steady_clock::now();
+    ArquivoLote entrada, saida;
+    std::vector<ProdutoLote> produtos;
+    long long inicioCarga = agoraNs();
+    std::cout << "Carregando lote de: " << arquivo << std::endl;
+    if (!entrada.abrir(arquivo) || !prepararLote(entrada, arquivoResultado, saida, produtos)) {
+        return false;
+    }
+    registrarTrecho("carregar lote", inicioCarga, agoraNs());
+
+    double flops = 0.0;
+    int menor = 0, maior = 0;
+    for (size_t p = 0; p < produtos.size(); p++) {
+        const ProdutoLote& produto = produtos[p];
+        flops += 2.0 * produto.c.linhas * produto.a.colunas * produto.c.colunas;
+        int dim = std::max(produto.c.linhas, std::max(produto.a.colunas, produto.c.colunas));
+        menor = p == 0 ? dim : std::min(menor, dim);
+        maior = std::max(maior, dim);
+    }
+    std::cout << "Lote com " << produtos.size() << " produtos (maior dimensão de " << menor << " a " << maior
+              << ")" << std::endl;
+
+    std::chrono::duration<double> total(0);
+    for (int r = 0; r < repeticoes; r++) {
+        auto inicioRep = std::chrono::steady_clock::now();
+        {
+            TrechoRastro trecho("multiplicação", r);
+            if (!kernel(produtos)) {
+                return false;
+            }
+        }
+        auto fimRep = std::chrono::steady_clock::now();
+        total += fimRep - inicioRep;
+        if (repeticoes > 1) {
+            std::printf("Repetição %d: %.3f ms\n", r + 1,
+                        std::chrono::duration<double, std::milli>(fimRep - inicioRep).count());
+        }
+    }
+    double segundos = total.count() / repeticoes;
+
+    std::cout << "Resultado gravado em: " << arquivoResultado << std::endl;
+    std::cout << "Multiplicação em lote concluída!" << std::endl;
+    std::printf("Tempo de execução: %.3f ms por lote (%.1f µs por produto)\n", segundos * 1000.0,
+                produtos.empty() ? 0.0 : segundos * 1e6 / produtos.size());
+    std::printf("Vazão: %.0f produtos/s\n", segundos > 0.0 ? produtos.size() / segundos : 0.0);
+    std::printf("Tempo total: %.0f ms (incluindo abrir o lote e criar o resultado)\n",
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicioTotal).count());
+    relatarDesempenho(flops, segundos, numTrabalhadores);
+    return !verificacao.ativa() || verificarLote(produtos, verificacao);
+}
+
+#endif
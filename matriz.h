@@ -0,0 +1,361 @@
+#ifndef MATRIZ_H
+#define MATRIZ_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include "formato_binario.h"
+#include "formato_texto.h"
+#include "memoria.h"
+#include "memoria_compartilhada.h"
+
+/**
+ * Contêiner de matriz compartilhado pelos três programas de multiplicação.
+ *
+ * Os dados ficam em um único buffer contíguo, alinhado a 64 bytes (uma linha
+ * de cache) e armazenado por linhas, alocado com alocarAlinhado() (em páginas
+ * grandes, se for grande; ver memoria.h) ou tirado de uma arena de temporários. Cada linha ocupa `passo` elementos, que
+ * pode ser maior que o número de colunas: o preenchimento mantém o início de
+ * toda linha alinhado e evita que passos múltiplos de potências de dois façam
+ * as linhas de uma coluna caírem no mesmo conjunto da cache.
+ *
+ * A matriz pode ser lida/gravada em texto (.txt, ver formato_texto.h) ou no
+ * formato binário (.bin, ver formato_binario.h). No formato binário os dados não são
+ * copiados: o arquivo é mapeado e o buffer da matriz passa a ser o mapeamento.
+ *
+ * Uma matriz criada com um nome de memória compartilhada (ou carregada de um
+ * arquivo binário) pode ser descrita por um DescritorMatriz e mapeada por
+ * outros processos, também sem cópia.
+ *
+ * O tipo do elemento é um parâmetro de template (ver tipo_elemento.h);
+ * VisaoMatriz, VisaoMatrizConst e MatrizDensa são as versões em double usadas
+ * por todo o resto do código.
+ */
+
+const int DOUBLES_POR_LINHA_CACHE = ALINHAMENTO_CACHE / sizeof(double);
+
+// Visão (sem posse) de um bloco retangular de uma matriz armazenada por linhas
+template <typename T>
+struct VisaoMatrizT {
+    T* dados;
+    int linhas;
+    int colunas;
+    int passo;
+
+    T& operator()(int i, int j) const { return dados[(size_t)i * passo + j]; }
+    T* linha(int i) const { return dados + (size_t)i * passo; }
+
+    VisaoMatrizT sub(int linha0, int coluna0, int numLinhas, int numColunas) const {
+        VisaoMatrizT v = { linha(linha0) + coluna0, numLinhas, numColunas, passo };
+        return v;
+    }
+};
+
+// Versão somente leitura de VisaoMatrizT
+template <typename T>
+struct VisaoMatrizConstT {
+    const T* dados;
+    int linhas;
+    int colunas;
+    int passo;
+
+    VisaoMatrizConstT() : dados(nullptr), linhas(0), colunas(0), passo(0) {}
+    VisaoMatrizConstT(const T* d, int l, int c, int p)
+        : dados(d), linhas(l), colunas(c), passo(p) {}
+    VisaoMatrizConstT(const VisaoMatrizT<T>& v)
+        : dados(v.dados), linhas(v.linhas), colunas(v.colunas), passo(v.passo) {}
+
+    const T& operator()(int i, int j) const { return dados[(size_t)i * passo + j]; }
+    const T* linha(int i) const { return dados + (size_t)i * passo; }
+
+    VisaoMatrizConstT sub(int linha0, int coluna0, int numLinhas, int numColunas) const {
+        return VisaoMatrizConstT(linha(linha0) + coluna0, numLinhas, numColunas, passo);
+    }
+};
+
+typedef VisaoMatrizT<double> VisaoMatriz;
+typedef VisaoMatrizConstT<double> VisaoMatrizConst;
+
+// Calcula o passo (em elementos) de uma linha com `colunas` elementos.
+// Arredonda para uma linha de cache inteira e, com preenchimento ativo,
+// acrescenta mais uma linha de cache quando o passo em bytes é múltiplo de
+// 1 KiB (caso típico de N potência de dois), quebrando o aliasing de conjuntos.
+inline int calcularPasso(int colunas, bool preencher, size_t bytesElemento = sizeof(double)) {
+    const int porLinhaCache = ALINHAMENTO_CACHE / bytesElemento;
+    int passo = (colunas + porLinhaCache - 1) / porLinhaCache * porLinhaCache;
+    if (preencher && passo > 0 && (passo * bytesElemento) % 1024 == 0) {
+        passo += porLinhaCache;
+    }
+    return passo;
+}
+
+// Marca de construção: aloca sem zerar, deixando a primeira escrita de cada
+// página para quem vai usá-la (first touch em máquinas NUMA)
+struct SemInicializar {};
+
+template <typename T>
+class MatrizDensaT {
+protected:
+    T* dados;
+    int linhas;
+    int colunas;
+    int passo;
+    MapeamentoArquivo mapa;  // base != nullptr quando os dados vêm de um arquivo mapeado
+    std::string nomeCompartilhado;  // objeto shm_open que contém os dados, se houver
+    std::string arquivoOrigem;      // arquivo binário mapeado, se houver
+    size_t deslocamentoOrigem;
+    uint64_t geracao;  // ver DescritorMatriz::geracao
+    bool daArena;  // os dados pertencem a uma ArenaMemoria (ver memoria.h)
+
+    void alocar(bool zerar = true) {
+        size_t total = (size_t)linhas * passo;
+        dados = static_cast<T*>(alocarAlinhado(total * sizeof(T)));
+        if (dados == nullptr) {
+            throw std::bad_alloc();
+        }
+        if (zerar) {
+            memset(dados, 0, total * sizeof(T));
+        }
+    }
+
+    void alocarCompartilhada(const std::string& nome) {
+        size_t bytes = (size_t)linhas * passo * sizeof(T);
+        void* base = criarRegiaoCompartilhada(nome, bytes);
+        if (base == nullptr) {
+            throw std::bad_alloc();
+        }
+        mapa.base = base;
+        mapa.tamanho = bytes;
+        dados = static_cast<T*>(base);
+        nomeCompartilhado = nome;
+        geracao = novaGeracao();
+    }
+
+    void liberar() {
+        if (mapa.base != nullptr) {
+            munmap(mapa.base, mapa.tamanho);
+            mapa.base = nullptr;
+        } else if (!daArena) {
+            liberarAlinhado(dados);
+        }
+        daArena = false;
+        if (!nomeCompartilhado.empty()) {
+            shm_unlink(nomeCompartilhado.c_str());
+            nomeCompartilhado.clear();
+        }
+        arquivoOrigem.clear();
+        dados = nullptr;
+    }
+
+public:
+    explicit MatrizDensaT(int dim, bool preencher = true)
+        : dados(nullptr), linhas(dim), colunas(dim), passo(calcularPasso(dim, preencher, sizeof(T))),
+          deslocamentoOrigem(0), geracao(0), daArena(false) {
+        mapa.base = nullptr;
+        mapa.tamanho = 0;
+        alocar();
+    }
+
+    MatrizDensaT(int numLinhas, int numColunas, bool preencher)
+        : dados(nullptr), linhas(numLinhas), colunas(numColunas),
+          passo(calcularPasso(numColunas, preencher, sizeof(T))), deslocamentoOrigem(0), geracao(0), daArena(false) {
+        mapa.base = nullptr;
+        mapa.tamanho = 0;
+        alocar();
+    }
+
+    // Conteúdo indefinido até a primeira escrita (ex.: resultado de gemm, que zera cada tile)
+    MatrizDensaT(int numLinhas, int numColunas, bool preencher, SemInicializar)
+        : dados(nullptr), linhas(numLinhas), colunas(numColunas),
+          passo(calcularPasso(numColunas, preencher, sizeof(T))), deslocamentoOrigem(0), geracao(0), daArena(false) {
+        mapa.base = nullptr;
+        mapa.tamanho = 0;
+        alocar(false);
+    }
+
+    // Temporária na arena: conteúdo indefinido, válida até a arena voltar a
+    // uma marca anterior (ex.: os operandos de Strassen, ver EscopoArena)
+    MatrizDensaT(int numLinhas, int numColunas, bool preencher, ArenaMemoria& arena)
+        : dados(nullptr), linhas(numLinhas), colunas(numColunas),
+          passo(calcularPasso(numColunas, preencher, sizeof(T))), deslocamentoOrigem(0), geracao(0), daArena(true) {
+        mapa.base = nullptr;
+        mapa.tamanho = 0;
+        dados = static_cast<T*>(arena.alocar((size_t)linhas * passo * sizeof(T)));
+    }
+
+    // Matriz zerada em um objeto de memória compartilhada POSIX (shm_open)
+    MatrizDensaT(int numLinhas, int numColunas, bool preencher, const std::string& nomeShm)
+        : dados(nullptr), linhas(numLinhas), colunas(numColunas),
+          passo(calcularPasso(numColunas, preencher, sizeof(T))), deslocamentoOrigem(0), geracao(0), daArena(false) {
+        mapa.base = nullptr;
+        mapa.tamanho = 0;
+        alocarCompartilhada(nomeShm);
+    }
+
+    ~MatrizDensaT() {
+        liberar();
+    }
+
+    MatrizDensaT(const MatrizDensaT&) = delete;
+    MatrizDensaT& operator=(const MatrizDensaT&) = delete;
+
+    MatrizDensaT(MatrizDensaT&& outra)
+        : dados(outra.dados), linhas(outra.linhas), colunas(outra.colunas), passo(outra.passo),
+          mapa(outra.mapa), nomeCompartilhado(outra.nomeCompartilhado),
+          arquivoOrigem(outra.arquivoOrigem), deslocamentoOrigem(outra.deslocamentoOrigem),
+          geracao(outra.geracao), daArena(outra.daArena) {
+        outra.dados = nullptr;
+        outra.mapa.base = nullptr;
+        outra.nomeCompartilhado.clear();
+        outra.arquivoOrigem.clear();
+    }
+
+    // Preenche `d` para que outro processo possa mapear os mesmos dados.
+    // Só é possível para matrizes em memória compartilhada ou em arquivo binário.
+    bool descrever(DescritorMatriz& d) const {
+        const std::string& caminho = !nomeCompartilhado.empty() ? nomeCompartilhado : arquivoOrigem;
+        if (caminho.empty() || caminho.size() >= sizeof(d.caminho)) {
+            return false;
+        }
+        memset(&d, 0, sizeof(d));
+        strcpy(d.caminho, caminho.c_str());
+        d.ehShm = !nomeCompartilhado.empty();
+        d.deslocamento = nomeCompartilhado.empty() ? deslocamentoOrigem : 0;
+        d.linhas = linhas;
+        d.colunas = colunas;
+        d.passo = passo;
+        d.bytesElemento = sizeof(T);
+        d.geracao = geracao;
+        return true;
+    }
+
+    // Carrega no formato indicado pela extensão do arquivo (.bin ou texto)
+    bool carregar(const std::string& nomeArquivo) {
+        return ehArquivoBinario(nomeArquivo) ? carregarDeArquivoBinario(nomeArquivo)
+                                             : carregarDeArquivo(nomeArquivo);
+    }
+
+    bool salvar(const std::string& nomeArquivo) const {
+        return ehArquivoBinario(nomeArquivo) ? salvarEmArquivoBinario(nomeArquivo)
+                                             : salvarEmArquivo(nomeArquivo);
+    }
+
+    // Mapeia um arquivo binário e passa a usá-lo como buffer da matriz
+    bool carregarDeArquivoBinario(const std::string& nomeArquivo) {
+        CabecalhoMatrizBinaria cab;
+        MapeamentoArquivo novoMapa;
+        if (!mapearMatrizBinaria(nomeArquivo, cab, novoMapa, TipoElemento<T>::codigo())) {
+            return false;
+        }
+
+        if (cab.linhas != (uint64_t)linhas || cab.colunas != (uint64_t)colunas) {
+            std::cerr << "Erro: Dimensão do arquivo (" << cab.linhas << "x" << cab.colunas
+                      << ") não corresponde à esperada (" << linhas << "x" << colunas << ")" << std::endl;
+            munmap(novoMapa.base, novoMapa.tamanho);
+            return false;
+        }
+
+        liberar();
+        mapa = novoMapa;
+        dados = reinterpret_cast<T*>(static_cast<char*>(mapa.base) + cab.tamanhoCabecalho);
+        passo = (int)cab.passo;
+        arquivoOrigem = nomeArquivo;
+        deslocamentoOrigem = cab.tamanhoCabecalho;
+        geracao = novaGeracao();
+        return true;
+    }
+
+    bool salvarEmArquivoBinario(const std::string& nomeArquivo) const {
+        int fd = open(nomeArquivo.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::cerr << "Erro ao criar arquivo: " << nomeArquivo << std::endl;
+            return false;
+        }
+
+        CabecalhoMatrizBinaria cab = criarCabecalho(linhas, colunas, passo, TipoElemento<T>::codigo());
+        bool ok = escreverTudo(fd, &cab, sizeof(cab)) &&
+                  escreverTudo(fd, dados, (size_t)linhas * passo * sizeof(T));
+        close(fd);
+
+        if (!ok) {
+            std::cerr << "Erro ao escrever arquivo: " << nomeArquivo << std::endl;
+        }
+        return ok;
+    }
+
+    // Texto: mapeado e interpretado em paralelo (ver formato_texto.h)
+    bool carregarDeArquivo(const std::string& nomeArquivo) {
+        return lerMatrizTexto(nomeArquivo, dados, linhas, colunas, passo);
+    }
+
+    bool salvarEmArquivo(const std::string& nomeArquivo) const {
+        return gravarMatrizTexto(nomeArquivo, dados, linhas, colunas, passo);
+    }
+
+    T& operator()(int i, int j) { return dados[(size_t)i * passo + j]; }
+    const T& operator()(int i, int j) const { return dados[(size_t)i * passo + j]; }
+
+    T* linha(int i) { return dados + (size_t)i * passo; }
+    const T* linha(int i) const { return dados + (size_t)i * passo; }
+
+    VisaoMatrizT<T> visao() {
+        VisaoMatrizT<T> v = { dados, linhas, colunas, passo };
+        return v;
+    }
+    VisaoMatrizConstT<T> visao() const {
+        return VisaoMatrizConstT<T>(dados, linhas, colunas, passo);
+    }
+
+    int getDimensao() const { return linhas; }
+    int getLinhas() const { return linhas; }
+    int getColunas() const { return colunas; }
+    int getPasso() const { return passo; }
+};
+
+typedef MatrizDensaT<double> MatrizDensa;
+
+// Lê o formato linhas x colunas de um arquivo de matriz (texto ou binário)
+inline bool lerFormatoArquivo(const std::string& nomeArquivo, int& linhas, int& colunas,
+                              TipoDado tipo = TIPO_FLOAT64) {
+    if (ehArquivoBinario(nomeArquivo)) {
+        CabecalhoMatrizBinaria cab;
+        if (!lerCabecalhoBinario(nomeArquivo, cab, tipo)) {
+            return false;
+        }
+        linhas = (int)cab.linhas;
+        colunas = (int)cab.colunas;
+        return true;
+    }
+
+    std::ifstream arquivo(nomeArquivo);
+    std::string primeira;
+    int64_t l = -1, c = -1;
+    if (!std::getline(arquivo >> std::ws, primeira)) {
+        std::cerr << "Erro ao ler dimensão de: " << nomeArquivo << std::endl;
+        return false;
+    }
+    const char* p = primeira.data();
+    if (!lerCabecalhoTexto(p, p + primeira.size(), l, c) || l <= 0 || c <= 0 || l > INT_MAX || c > INT_MAX) {
+        std::cerr << "Erro ao ler dimensão de: " << nomeArquivo << std::endl;
+        return false;
+    }
+    linhas = (int)l;
+    colunas = (int)c;
+    return true;
+}
+
+// Lê a dimensão de um arquivo de matriz quadrada (texto ou binário); -1 em caso de erro
+inline int lerDimensaoArquivo(const std::string& nomeArquivo, TipoDado tipo = TIPO_FLOAT64) {
+    int linhas, colunas;
+    if (!lerFormatoArquivo(nomeArquivo, linhas, colunas, tipo)) {
+        return -1;
+    }
+    return linhas == colunas ? linhas : -1;
+}
+
+#endif
@@ -0,0 +1,325 @@
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <vector>
+
+/**
+ * Camada de alocação das matrizes e dos buffers temporários.
+ *
+ * Uma matriz de 1600 x 1600 ocupa mais de 4.800 páginas de 4 KiB, e o
+ * percurso de B por colunas passa por uma página diferente a cada linha: a
+ * TLB de dados não dá conta. Alocações de pelo menos LIMIAR_PAGINAS_GRANDES
+ * são feitas com mmap, alinhadas a 2 MiB, e marcadas com
+ * madvise(MADV_HUGEPAGE), para que o kernel as cubra com páginas grandes
+ * transparentes (THP). Com --paginas-grandes=hugetlb, elas vêm do conjunto
+ * reservado de páginas grandes (MAP_HUGETLB) e, se ele estiver vazio, caem
+ * para o THP com um aviso; --paginas-grandes=nao volta ao posix_memalign.
+ * As regiões de memória compartilhada (shm_open) também recebem o
+ * madvise, o que só tem efeito se o kernel permitir THP em shmem.
+ *
+ * Os temporários de Strassen saem de uma arena por thread (arenaDaThread()):
+ * os blocos da arena ficam alocados e são reaproveitados em pilha, de modo
+ * que, depois da primeira multiplicação, as seguintes não alocam nada.
+ *
+ * relatarMemoria() imprime o pico de memória residente e quanto dos
+ * mapeamentos grandes do processo está em páginas grandes, segundo
+ * /proc/self/smaps.
+ */
+
+const size_t ALINHAMENTO_CACHE = 64;
+const size_t TAMANHO_PAGINA_GRANDE = 2 * 1024 * 1024;
+const size_t LIMIAR_PAGINAS_GRANDES = TAMANHO_PAGINA_GRANDE;
+
+enum ModoPaginasGrandes { PAGINAS_NORMAIS, PAGINAS_THP, PAGINAS_HUGETLB };
+
+inline ModoPaginasGrandes& modoPaginasGrandes() {
+    static ModoPaginasGrandes modo = PAGINAS_THP;
+    return modo;
+}
+
+// Lê --paginas-grandes=auto|thp|hugetlb|nao (auto = thp)
+inline bool selecionarPaginasGrandes(const std::string& nome) {
+    if (nome == "auto" || nome == "thp") {
+        modoPaginasGrandes() = PAGINAS_THP;
+    } else if (nome == "hugetlb") {
+        modoPaginasGrandes() = PAGINAS_HUGETLB;
+    } else if (nome == "nao") {
+        modoPaginasGrandes() = PAGINAS_NORMAIS;
+    } else {
+        std::cerr << "Erro: Valor inválido para --paginas-grandes: " << nome << " (use auto, thp, hugetlb ou nao)"
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Alocações de matrizes e buffers desde o início do processo (ver relatarMemoria)
+inline std::atomic<long>& alocacoesRealizadas() {
+    static std::atomic<long> total(0);
+    return total;
+}
+
+// Pede páginas grandes transparentes para uma região já mapeada
+inline void aconselharPaginasGrandes(void* base, size_t bytes) {
+    if (modoPaginasGrandes() != PAGINAS_NORMAIS && bytes >= LIMIAR_PAGINAS_GRANDES) {
+        madvise(base, bytes, MADV_HUGEPAGE);
+    }
+}
+
+// Cabeçalho guardado antes de cada bloco de alocarAlinhado(), para liberá-lo
+struct CabecalhoAlocacao {
+    void* base;      // início do mapeamento (mmap) ou da alocação (posix_memalign)
+    size_t tamanho;  // bytes mapeados; 0 = posix_memalign
+};
+
+static_assert(sizeof(CabecalhoAlocacao) <= ALINHAMENTO_CACHE, "o cabeçalho deve caber em uma linha de cache");
+
+// Mapeamento anônimo de `bytes` com páginas grandes (hugetlb ou THP);
+// nullptr se não for possível
+inline void* mapearPaginasGrandes(size_t& bytes) {
+    static std::atomic<bool> avisado(false);
+    bytes = (bytes + TAMANHO_PAGINA_GRANDE - 1) / TAMANHO_PAGINA_GRANDE * TAMANHO_PAGINA_GRANDE;
+    if (modoPaginasGrandes() == PAGINAS_HUGETLB) {
+        void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED) {
+            return base;
+        }
+        if (!avisado.exchange(true)) {
+            std::cerr << "Aviso: Sem páginas grandes reservadas (MAP_HUGETLB, ver /proc/sys/vm/nr_hugepages); "
+                         "usando páginas grandes transparentes"
+                      << std::endl;
+        }
+    }
+
+    // THP: o kernel só usa páginas grandes em trechos alinhados a 2 MiB, então
+    // mapeia 2 MiB a mais e descarta as sobras antes e depois do trecho alinhado
+    size_t excesso = bytes + TAMANHO_PAGINA_GRANDE;
+    char* bruto = static_cast<char*>(mmap(nullptr, excesso, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                                          -1, 0));
+    if (bruto == MAP_FAILED) {
+        return nullptr;
+    }
+    uintptr_t inicio = ((uintptr_t)bruto + TAMANHO_PAGINA_GRANDE - 1) / TAMANHO_PAGINA_GRANDE * TAMANHO_PAGINA_GRANDE;
+    char* base = reinterpret_cast<char*>(inicio);
+    if (base > bruto) {
+        munmap(bruto, base - bruto);
+    }
+    if (bruto + excesso > base + bytes) {
+        munmap(base + bytes, bruto + excesso - (base + bytes));
+    }
+    madvise(base, bytes, MADV_HUGEPAGE);
+    return base;
+}
+
+// Aloca `bytes` alinhados a ALINHAMENTO_CACHE (nullptr em caso de falha).
+// Os blocos grandes ficam em páginas grandes, conforme --paginas-grandes.
+inline void* alocarAlinhado(size_t bytes) {
+    alocacoesRealizadas()++;
+    size_t total = bytes + ALINHAMENTO_CACHE;
+    CabecalhoAlocacao cab = { nullptr, 0 };
+    if (modoPaginasGrandes() != PAGINAS_NORMAIS && bytes >= LIMIAR_PAGINAS_GRANDES) {
+        size_t mapeado = total;
+        cab.base = mapearPaginasGrandes(mapeado);
+        cab.tamanho = cab.base != nullptr ? mapeado : 0;
+    }
+    if (cab.base == nullptr && posix_memalign(&cab.base, ALINHAMENTO_CACHE, total) != 0) {
+        return nullptr;
+    }
+    std::memcpy(cab.base, &cab, sizeof(cab));
+    return static_cast<char*>(cab.base) + ALINHAMENTO_CACHE;
+}
+
+inline void liberarAlinhado(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    CabecalhoAlocacao cab;
+    std::memcpy(&cab, static_cast<char*>(ptr) - ALINHAMENTO_CACHE, sizeof(cab));
+    if (cab.tamanho > 0) {
+        munmap(cab.base, cab.tamanho);
+    } else {
+        free(cab.base);
+    }
+}
+
+// Arena de temporários: blocos alocados uma vez e reaproveitados em pilha.
+// marca() e restaurar() delimitam os temporários de um escopo; quem aloca
+// depois de uma marca deve restaurá-la antes de quem alocou antes.
+class ArenaMemoria {
+public:
+    struct Marca {
+        size_t bloco;
+        size_t usado;
+    };
+
+private:
+    struct Bloco {
+        char* dados;
+        size_t tamanho;
+    };
+
+    static const size_t BLOCO_MINIMO = 4 * 1024 * 1024;
+
+    std::vector<Bloco> blocos;
+    size_t atual;  // bloco em uso
+    size_t usado;  // bytes usados no bloco atual
+
+public:
+    ArenaMemoria() : atual(0), usado(0) {}
+    ~ArenaMemoria() {
+        for (const Bloco& b : blocos) {
+            liberarAlinhado(b.dados);
+        }
+    }
+
+    ArenaMemoria(const ArenaMemoria&) = delete;
+    ArenaMemoria& operator=(const ArenaMemoria&) = delete;
+
+    // `bytes` alinhados a ALINHAMENTO_CACHE, válidos até a restauração de uma marca anterior
+    void* alocar(size_t bytes) {
+        bytes = (bytes + ALINHAMENTO_CACHE - 1) / ALINHAMENTO_CACHE * ALINHAMENTO_CACHE;
+        // Blocos já alocados são percorridos em ordem: a mesma sequência de
+        // pedidos cai sempre nas mesmas posições
+        while (atual < blocos.size() && usado + bytes > blocos[atual].tamanho) {
+            atual++;
+            usado = 0;
+        }
+        if (atual == blocos.size()) {
+            size_t tamanho = std::max(bytes, blocos.empty() ? BLOCO_MINIMO : 2 * blocos.back().tamanho);
+            void* dados = alocarAlinhado(tamanho);
+            if (dados == nullptr) {
+                throw std::bad_alloc();
+            }
+            Bloco b = { static_cast<char*>(dados), tamanho };
+            blocos.push_back(b);
+            usado = 0;
+        }
+        void* p = blocos[atual].dados + usado;
+        usado += bytes;
+        return p;
+    }
+
+    Marca marca() const {
+        Marca m = { atual, usado };
+        return m;
+    }
+
+    void restaurar(const Marca& m) {
+        atual = m.bloco;
+        usado = m.usado;
+    }
+
+    size_t capacidade() const {
+        size_t total = 0;
+        for (const Bloco& b : blocos) {
+            total += b.tamanho;
+        }
+        return total;
+    }
+};
+
+// Arena de temporários da thread atual
+inline ArenaMemoria& arenaDaThread() {
+    static thread_local ArenaMemoria arena;
+    return arena;
+}
+
+// Devolve à arena da thread, no fim do escopo, o que foi alocado nele
+class EscopoArena {
+private:
+    ArenaMemoria& arena;
+    ArenaMemoria::Marca inicio;
+
+public:
+    EscopoArena() : arena(arenaDaThread()), inicio(arena.marca()) {}
+    ~EscopoArena() { arena.restaurar(inicio); }
+
+    EscopoArena(const EscopoArena&) = delete;
+    EscopoArena& operator=(const EscopoArena&) = delete;
+};
+
+// Pico de memória residente do processo, em MiB
+inline double picoMemoriaResidenteMiB() {
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    return uso.ru_maxrss / 1024.0;  // ru_maxrss em KiB no Linux
+}
+
+// Memória residente e em páginas grandes nos mapeamentos de dados (sem
+// execução) com pelo menos LIMIAR_PAGINAS_GRANDES: matrizes, buffers e arenas
+struct CoberturaPaginas {
+    long long residenteKiB;
+    long long grandesKiB;
+};
+
+inline CoberturaPaginas medirCoberturaPaginas() {
+    CoberturaPaginas cobertura = { 0, 0 };
+    std::ifstream smaps("/proc/self/smaps");
+    std::string linha;
+    bool contar = false;
+    while (std::getline(smaps, linha)) {
+        unsigned long long inicio, fim;
+        char permissoes[8];
+        if (std::sscanf(linha.c_str(), "%llx-%llx %7s", &inicio, &fim, permissoes) == 3) {
+            contar = fim - inicio >= LIMIAR_PAGINAS_GRANDES && std::strchr(permissoes, 'x') == nullptr;
+            continue;
+        }
+        if (!contar) {
+            continue;
+        }
+        std::istringstream campos(linha);
+        std::string nome;
+        long long kib = 0;
+        campos >> nome >> kib;
+        if (nome == "Rss:") {
+            cobertura.residenteKiB += kib;
+        } else if (nome == "AnonHugePages:" || nome == "ShmemPmdMapped:" || nome == "FilePmdMapped:") {
+            cobertura.grandesKiB += kib;
+        } else if (nome == "Private_Hugetlb:" || nome == "Shared_Hugetlb:") {
+            // Páginas de hugetlb não entram no Rss
+            cobertura.residenteKiB += kib;
+            cobertura.grandesKiB += kib;
+        }
+    }
+    return cobertura;
+}
+
+inline const char* nomeModoPaginasGrandes() {
+    switch (modoPaginasGrandes()) {
+        case PAGINAS_HUGETLB: return "hugetlb, com THP se faltarem";
+        case PAGINAS_NORMAIS: return "desligadas";
+        default: return "THP";
+    }
+}
+
+// Pico de memória residente e cobertura por páginas grandes, medidos com as
+// matrizes ainda alocadas. `alocacoesUltima` (>= 0) é o número de alocações
+// feitas durante a última repetição: zero quando as matrizes, os buffers de
+// empacotamento e as arenas de todos os trabalhadores já existiam.
+inline void relatarMemoria(long alocacoesUltima) {
+    CoberturaPaginas c = medirCoberturaPaginas();
+    std::printf("Memória: pico residente %.1f MiB; páginas grandes (%s) em %.0f%% dos mapeamentos grandes "
+                "(%.1f de %.1f MiB)\n",
+                picoMemoriaResidenteMiB(), nomeModoPaginasGrandes(),
+                c.residenteKiB > 0 ? 100.0 * c.grandesKiB / c.residenteKiB : 0.0, c.grandesKiB / 1024.0,
+                c.residenteKiB / 1024.0);
+    if (alocacoesUltima >= 0) {
+        std::printf("Alocações de matrizes e buffers na última repetição: %ld\n", alocacoesUltima);
+    }
+}
+
+#endif
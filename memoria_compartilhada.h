@@ -0,0 +1,109 @@
+#ifndef MEMORIA_COMPARTILHADA_H
+#define MEMORIA_COMPARTILHADA_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "memoria.h"
+
+/**
+ * Memória compartilhada entre processos.
+ *
+ * Uma matriz compartilhável vive em um objeto de memória POSIX (shm_open)
+ * ou em um arquivo binário mapeado. Em ambos os casos ela é identificada
+ * por um DescritorMatriz de tamanho fixo, que pode ser passado a processos
+ * já existentes (por exemplo, um pool criado antes das matrizes) para que
+ * eles mapeiem os mesmos dados sem nenhuma cópia.
+ */
+
+struct DescritorMatriz {
+    char caminho[256];      // nome POSIX ("/...") ou caminho de arquivo
+    int32_t ehShm;          // 1 = shm_open, 0 = arquivo comum
+    uint64_t deslocamento;  // início dos dados dentro do objeto (bytes)
+    int32_t linhas;
+    int32_t colunas;
+    int32_t passo;
+    int32_t bytesElemento;  // sizeof do tipo do elemento (ver tipo_elemento.h)
+    uint64_t geracao;       // muda a cada novo objeto no mesmo caminho (ver novaGeracao)
+};
+
+// Identifica um objeto mapeado pelo processo que o descreve. Um arquivo
+// substituído no mesmo caminho (e às vezes com o mesmo inode, reaproveitado)
+// recebe outra geração ao ser mapeado de novo, e quem guardou o mapeamento
+// antigo sabe que precisa refazê-lo.
+inline uint64_t novaGeracao() {
+    static std::atomic<uint64_t> contador(1);
+    return contador++;
+}
+
+// Gera um nome único para shm_open a partir do PID e de um contador
+inline std::string nomeCompartilhadoUnico(const std::string& prefixo) {
+    static std::atomic<int> contador(0);
+    char nome[96];
+    snprintf(nome, sizeof(nome), "/%s_%d_%d", prefixo.c_str(), (int)getpid(), contador++);
+    return nome;
+}
+
+// Cria (ou recria) um objeto shm_open zerado de `bytes` e o mapeia para leitura e escrita
+inline void* criarRegiaoCompartilhada(const std::string& nome, size_t bytes) {
+    int fd = shm_open(nome.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        std::cerr << "Erro ao criar memória compartilhada: " << nome << std::endl;
+        return nullptr;
+    }
+    if (ftruncate(fd, bytes) != 0) {
+        std::cerr << "Erro ao dimensionar memória compartilhada: " << nome << std::endl;
+        close(fd);
+        shm_unlink(nome.c_str());
+        return nullptr;
+    }
+    void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        std::cerr << "Erro ao mapear memória compartilhada: " << nome << std::endl;
+        shm_unlink(nome.c_str());
+        return nullptr;
+    }
+    alocacoesRealizadas()++;
+    aconselharPaginasGrandes(base, bytes);
+    return base;
+}
+
+// Bytes do objeto necessários para a região descrita por `d`
+inline size_t extensaoDescritor(const DescritorMatriz& d) {
+    return d.deslocamento + (size_t)d.linhas * d.passo * d.bytesElemento;
+}
+
+// Mapeia o objeto descrito por `d` (MAP_SHARED) inteiro, para que outras
+// regiões do mesmo objeto possam reaproveitar o mapeamento. Retorna a base
+// do mapeamento (para munmap) e o tamanho mapeado em `tamanho`.
+inline void* mapearDescritor(const DescritorMatriz& d, bool escrita, size_t& tamanho) {
+    int flags = escrita ? O_RDWR : O_RDONLY;
+    int fd = d.ehShm ? shm_open(d.caminho, flags, 0) : open(d.caminho, flags);
+    if (fd < 0) {
+        std::cerr << "Erro ao abrir matriz compartilhada: " << d.caminho << std::endl;
+        return nullptr;
+    }
+    struct stat info;
+    tamanho = extensaoDescritor(d);
+    if (fstat(fd, &info) == 0 && (size_t)info.st_size > tamanho) {
+        tamanho = info.st_size;
+    }
+    int prot = escrita ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* base = mmap(nullptr, tamanho, prot, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        std::cerr << "Erro ao mapear matriz compartilhada: " << d.caminho << std::endl;
+        return nullptr;
+    }
+    return base;
+}
+
+#endif
@@ -0,0 +1,257 @@
+#ifndef MICROKERNEL_H
+#define MICROKERNEL_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <immintrin.h>
+#include <unistd.h>
+
+/**
+ * Micro-kernels de registradores usados pelo GEMM em blocos (gemm.h).
+ *
+ * Cada micro-kernel calcula C(mr x nr) += Ap * Bp, onde Ap é um
+ * micro-painel de A empacotado (kc colunas de mr valores) e Bp um
+ * micro-painel de B empacotado (kc linhas de nr valores). Há três versões:
+ *  - escalar 4x4, que roda em qualquer x86-64;
+ *  - AVX2/FMA 6x8 (12 acumuladores ymm);
+ *  - AVX-512 8x16 (16 acumuladores zmm).
+ * As versões vetoriais são compiladas com atributos `target`, de modo que
+ * um único binário gerado por `make` funciona em todas as máquinas; a
+ * escolha é feita em tempo de execução consultando o cpuid.
+ */
+
+typedef void (*FuncaoMicroKernel)(int kc, const double* ap, const double* bp,
+                                  double* c, int passoC);
+
+struct MicroKernel {
+    const char* nome;
+    int mr;
+    int nr;
+    FuncaoMicroKernel funcao;
+    int flopsPorCiclo;  // pico teórico por núcleo (duas unidades de FMA)
+};
+
+inline void microKernelEscalar4x4(int kc, const double* ap, const double* bp,
+                                  double* c, int passoC) {
+    double acc[4][4] = {};
+    for (int k = 0; k < kc; k++) {
+        for (int i = 0; i < 4; i++) {
+            const double aik = ap[i];
+            for (int j = 0; j < 4; j++) {
+                acc[i][j] += aik * bp[j];
+            }
+        }
+        ap += 4;
+        bp += 4;
+    }
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            c[(size_t)i * passoC + j] += acc[i][j];
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+inline void microKernelAvx2_6x8(int kc, const double* ap, const double* bp,
+                                double* c, int passoC) {
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+    __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+    __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+    __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+    __m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+
+    for (int k = 0; k < kc; k++) {
+        __m256d b0 = _mm256_load_pd(bp);
+        __m256d b1 = _mm256_load_pd(bp + 4);
+        __m256d a;
+        a = _mm256_broadcast_sd(ap + 0); c00 = _mm256_fmadd_pd(a, b0, c00); c01 = _mm256_fmadd_pd(a, b1, c01);
+        a = _mm256_broadcast_sd(ap + 1); c10 = _mm256_fmadd_pd(a, b0, c10); c11 = _mm256_fmadd_pd(a, b1, c11);
+        a = _mm256_broadcast_sd(ap + 2); c20 = _mm256_fmadd_pd(a, b0, c20); c21 = _mm256_fmadd_pd(a, b1, c21);
+        a = _mm256_broadcast_sd(ap + 3); c30 = _mm256_fmadd_pd(a, b0, c30); c31 = _mm256_fmadd_pd(a, b1, c31);
+        a = _mm256_broadcast_sd(ap + 4); c40 = _mm256_fmadd_pd(a, b0, c40); c41 = _mm256_fmadd_pd(a, b1, c41);
+        a = _mm256_broadcast_sd(ap + 5); c50 = _mm256_fmadd_pd(a, b0, c50); c51 = _mm256_fmadd_pd(a, b1, c51);
+        ap += 6;
+        bp += 8;
+    }
+
+#define ACUMULAR_LINHA_AVX2(i, r0, r1) \
+    _mm256_storeu_pd(c + (size_t)(i) * passoC, _mm256_add_pd(_mm256_loadu_pd(c + (size_t)(i) * passoC), r0)); \
+    _mm256_storeu_pd(c + (size_t)(i) * passoC + 4, _mm256_add_pd(_mm256_loadu_pd(c + (size_t)(i) * passoC + 4), r1));
+    ACUMULAR_LINHA_AVX2(0, c00, c01)
+    ACUMULAR_LINHA_AVX2(1, c10, c11)
+    ACUMULAR_LINHA_AVX2(2, c20, c21)
+    ACUMULAR_LINHA_AVX2(3, c30, c31)
+    ACUMULAR_LINHA_AVX2(4, c40, c41)
+    ACUMULAR_LINHA_AVX2(5, c50, c51)
+#undef ACUMULAR_LINHA_AVX2
+}
+
+__attribute__((target("avx512f")))
+inline void microKernelAvx512_8x16(int kc, const double* ap, const double* bp,
+                                   double* c, int passoC) {
+    __m512d c00 = _mm512_setzero_pd(), c01 = _mm512_setzero_pd();
+    __m512d c10 = _mm512_setzero_pd(), c11 = _mm512_setzero_pd();
+    __m512d c20 = _mm512_setzero_pd(), c21 = _mm512_setzero_pd();
+    __m512d c30 = _mm512_setzero_pd(), c31 = _mm512_setzero_pd();
+    __m512d c40 = _mm512_setzero_pd(), c41 = _mm512_setzero_pd();
+    __m512d c50 = _mm512_setzero_pd(), c51 = _mm512_setzero_pd();
+    __m512d c60 = _mm512_setzero_pd(), c61 = _mm512_setzero_pd();
+    __m512d c70 = _mm512_setzero_pd(), c71 = _mm512_setzero_pd();
+
+    for (int k = 0; k < kc; k++) {
+        __m512d b0 = _mm512_load_pd(bp);
+        __m512d b1 = _mm512_load_pd(bp + 8);
+        __m512d a;
+        a = _mm512_set1_pd(ap[0]); c00 = _mm512_fmadd_pd(a, b0, c00); c01 = _mm512_fmadd_pd(a, b1, c01);
+        a = _mm512_set1_pd(ap[1]); c10 = _mm512_fmadd_pd(a, b0, c10); c11 = _mm512_fmadd_pd(a, b1, c11);
+        a = _mm512_set1_pd(ap[2]); c20 = _mm512_fmadd_pd(a, b0, c20); c21 = _mm512_fmadd_pd(a, b1, c21);
+        a = _mm512_set1_pd(ap[3]); c30 = _mm512_fmadd_pd(a, b0, c30); c31 = _mm512_fmadd_pd(a, b1, c31);
+        a = _mm512_set1_pd(ap[4]); c40 = _mm512_fmadd_pd(a, b0, c40); c41 = _mm512_fmadd_pd(a, b1, c41);
+        a = _mm512_set1_pd(ap[5]); c50 = _mm512_fmadd_pd(a, b0, c50); c51 = _mm512_fmadd_pd(a, b1, c51);
+        a = _mm512_set1_pd(ap[6]); c60 = _mm512_fmadd_pd(a, b0, c60); c61 = _mm512_fmadd_pd(a, b1, c61);
+        a = _mm512_set1_pd(ap[7]); c70 = _mm512_fmadd_pd(a, b0, c70); c71 = _mm512_fmadd_pd(a, b1, c71);
+        ap += 8;
+        bp += 16;
+    }
+
+#define ACUMULAR_LINHA_AVX512(i, r0, r1) \
+    _mm512_storeu_pd(c + (size_t)(i) * passoC, _mm512_add_pd(_mm512_loadu_pd(c + (size_t)(i) * passoC), r0)); \
+    _mm512_storeu_pd(c + (size_t)(i) * passoC + 8, _mm512_add_pd(_mm512_loadu_pd(c + (size_t)(i) * passoC + 8), r1));
+    ACUMULAR_LINHA_AVX512(0, c00, c01)
+    ACUMULAR_LINHA_AVX512(1, c10, c11)
+    ACUMULAR_LINHA_AVX512(2, c20, c21)
+    ACUMULAR_LINHA_AVX512(3, c30, c31)
+    ACUMULAR_LINHA_AVX512(4, c40, c41)
+    ACUMULAR_LINHA_AVX512(5, c50, c51)
+    ACUMULAR_LINHA_AVX512(6, c60, c61)
+    ACUMULAR_LINHA_AVX512(7, c70, c71)
+#undef ACUMULAR_LINHA_AVX512
+}
+
+inline const MicroKernel& kernelEscalar() {
+    static const MicroKernel k = { "escalar 4x4", 4, 4, microKernelEscalar4x4, 4 };
+    return k;
+}
+
+inline const MicroKernel& kernelAvx2() {
+    static const MicroKernel k = { "AVX2/FMA 6x8", 6, 8, microKernelAvx2_6x8, 16 };
+    return k;
+}
+
+inline const MicroKernel& kernelAvx512() {
+    static const MicroKernel k = { "AVX-512 8x16", 8, 16, microKernelAvx512_8x16, 32 };
+    return k;
+}
+
+inline bool cpuSuportaAvx2() {
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+
+inline bool cpuSuportaAvx512() {
+    return __builtin_cpu_supports("avx512f");
+}
+
+// Melhor kernel suportado pela CPU em que o programa está rodando
+inline const MicroKernel* detectarMicroKernel() {
+    __builtin_cpu_init();
+    if (cpuSuportaAvx512()) {
+        return &kernelAvx512();
+    }
+    if (cpuSuportaAvx2()) {
+        return &kernelAvx2();
+    }
+    return &kernelEscalar();
+}
+
+// Kernel em uso. Começa com a detecção automática e pode ser trocado por
+// selecionarMicroKernel (opção --kernel) antes de iniciar os trabalhadores.
+inline const MicroKernel*& microKernelAtual() {
+    static const MicroKernel* atual = detectarMicroKernel();
+    return atual;
+}
+
+inline const MicroKernel& microKernel() {
+    return *microKernelAtual();
+}
+
+// Seleciona o kernel por nome: auto, escalar, avx2 ou avx512
+inline bool selecionarMicroKernel(const std::string& nome) {
+    const MicroKernel*& atual = microKernelAtual();
+    if (nome.empty() || nome == "auto") {
+        return true;
+    }
+    if (nome == "escalar") {
+        atual = &kernelEscalar();
+    } else if (nome == "avx2") {
+        if (!cpuSuportaAvx2()) {
+            std::cerr << "Erro: Esta CPU não suporta AVX2/FMA." << std::endl;
+            return false;
+        }
+        atual = &kernelAvx2();
+    } else if (nome == "avx512") {
+        if (!cpuSuportaAvx512()) {
+            std::cerr << "Erro: Esta CPU não suporta AVX-512." << std::endl;
+            return false;
+        }
+        atual = &kernelAvx512();
+    } else {
+        std::cerr << "Erro: Kernel desconhecido: " << nome
+                  << " (use auto, escalar, avx2 ou avx512)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Frequência máxima do núcleo em GHz (cpufreq ou, na falta dele, /proc/cpuinfo)
+inline double frequenciaCpuGhz() {
+    std::ifstream cpufreq("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq");
+    double khz = 0.0;
+    if (cpufreq >> khz && khz > 0.0) {
+        return khz / 1e6;
+    }
+
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string linha;
+    while (std::getline(cpuinfo, linha)) {
+        if (linha.compare(0, 7, "cpu MHz") == 0) {
+            size_t pos = linha.find(':');
+            if (pos != std::string::npos) {
+                return atof(linha.c_str() + pos + 1) / 1000.0;
+            }
+        }
+    }
+    return 0.0;
+}
+
+// Pico teórico em GFLOP/s para `numNucleos` núcleos com o kernel atual
+inline double picoTeoricoGflops(int numNucleos) {
+    return frequenciaCpuGhz() * microKernel().flopsPorCiclo * numNucleos;
+}
+
+// Imprime o kernel usado e a taxa obtida em relação ao pico da máquina.
+// `numTrabalhadores` é limitado ao número de núcleos disponíveis.
+inline void relatarDesempenho(double flops, double segundos, int numTrabalhadores) {
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+    int numNucleos = numTrabalhadores;
+    if (nucleos > 0 && numNucleos > nucleos) {
+        numNucleos = (int)nucleos;
+    }
+
+    double gflops = segundos > 0.0 ? flops / segundos / 1e9 : 0.0;
+    double pico = picoTeoricoGflops(numNucleos);
+
+    std::printf("Kernel: %s\n", microKernel().nome);
+    if (pico > 0.0) {
+        std::printf("Desempenho: %.2f GFLOP/s (%.1f%% do pico teórico de %.1f GFLOP/s em %d núcleo(s))\n",
+                    gflops, 100.0 * gflops / pico, pico, numNucleos);
+    } else {
+        std::printf("Desempenho: %.2f GFLOP/s\n", gflops);
+    }
+}
+
+#endif
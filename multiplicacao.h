@@ -0,0 +1,299 @@
+#ifndef MULTIPLICACAO_H
+#define MULTIPLICACAO_H
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "esparsa.h"
+#include "gemm.h"
+#include "lote.h"
+#include "matriz.h"
+#include "pool_processos.h"
+#include "pool_threads.h"
+#include "rastreamento.h"
+#include "strassen.h"
+
+/**
+ * As três formas de calcular C = A * B, compartilhadas pelos programas de
+ * multiplicação e pelo benchmark:
+ *  - multiplicarSequencial: na thread chamadora;
+ *  - MultiplicadorThreads: tiles de C (ou produtos de Strassen) no pool de threads;
+ *  - multiplicarComProcessos: o mesmo no pool de processos, com A, B e C em
+ *    memória compartilhada ou em arquivo binário mapeado.
+ * Cada uma também tem uma versão para lotes de produtos independentes (ver
+ * lote.h): os produtos pequenos são tarefas inteiras, distribuídas entre os
+ * trabalhadores; um produto com tiles suficientes para ocupar todos eles é
+ * dividido em tiles, como uma multiplicação isolada. O modo em cadeia (ver
+ * cadeia.h) usa as mesmas versões para cada etapa de produtos independentes.
+ * A divisão em tiles também serve aos tipos de --dtype (ver gemm_tipado.h).
+ * Com operandos esparsos (ver esparsa.h), o trabalho é dividido em blocos de
+ * linhas de C em vez de tiles.
+ * Com `verboso`, cada uma imprime como dividiu o trabalho. Com o rastreamento
+ * ligado, a montagem e a combinação dos produtos de Strassen aparecem na faixa
+ * da thread principal.
+ */
+
+inline void multiplicarSequencial(const MatrizDensa& a, const MatrizDensa& b, MatrizDensa& c,
+                                  const ParametrosBloco& blocos, const ParametrosStrassen& algo,
+                                  BuffersGemm& buffers) {
+    strassenSequencial(a.visao(), b.visao(), c.visao(), algo, blocos, buffers);
+}
+
+// Um produto do lote é dividido entre os trabalhadores quando tem pelo menos
+// um tile para cada um; os demais são calculados inteiros por um só trabalhador
+inline bool dividirProdutoDoLote(const ProdutoLote& produto, const ParametrosBloco& blocos, int numTrabalhadores) {
+    DivisaoTiles divisao(produto.c.linhas, produto.c.colunas, blocos.tileLinhas, blocos.tileColunas);
+    return numTrabalhadores > 1 && divisao.total() >= numTrabalhadores;
+}
+
+inline void multiplicarLoteSequencial(const std::vector<ProdutoLote>& produtos, const ParametrosBloco& blocos,
+                                      BuffersGemm& buffers) {
+    for (const ProdutoLote& produto : produtos) {
+        gemm(produto.a, produto.b, produto.c, blocos, buffers);
+    }
+}
+
+class MultiplicadorThreads {
+private:
+    PoolThreads& pool;
+    // Um conjunto de buffers de empacotamento por thread, reaproveitado entre chamadas
+    std::vector<std::unique_ptr<BuffersGemm>> buffers;
+
+public:
+    explicit MultiplicadorThreads(PoolThreads& p) : pool(p) {
+        for (int t = 0; t < pool.tamanho(); t++) {
+            buffers.emplace_back(new BuffersGemm());
+        }
+    }
+
+    void multiplicar(const MatrizDensa& a, const MatrizDensa& b, MatrizDensa& c,
+                     const ParametrosBloco& blocos, const ParametrosStrassen& algo, bool verboso) {
+        if (algo.deveRecursar(c.getLinhas(), a.getColunas(), c.getColunas())) {
+            // Os 7 produtos do primeiro nível (49 com mais de 7 threads) são
+            // tarefas independentes; cada uma continua a recursão sozinha
+            long long inicioPlano = agoraNs();
+            PlanoStrassen plano(algo, RegiaoMatriz(a), RegiaoMatriz(b), RegiaoMatriz(c), false,
+                                pool.tamanho() > 7 ? 2 : 1);
+            registrarTrecho("montar operandos", inicioPlano, agoraNs());
+            std::vector<ProdutoStrassen> produtos;
+            plano.coletarProdutos(produtos);
+
+            if (verboso) {
+                std::cout << "Distribuindo " << produtos.size() << " produtos de " << algo.nome()
+                          << " entre " << pool.tamanho() << " threads" << std::endl;
+            }
+
+            pool.paraCada((int)produtos.size(), [&](int i, int trabalhador) {
+                const ProdutoStrassen& produto = produtos[i];
+                strassenSequencial(produto.a.visao(), produto.b.visao(), produto.c.visaoEscrita(),
+                                   algo, blocos, *buffers[trabalhador]);
+            }, "produto");
+            TrechoRastro trecho("combinar produtos");
+            plano.concluir(blocos, *buffers[0]);
+            return;
+        }
+
+        multiplicarClassico(a.visao(), b.visao(), c.visao(), blocos, verboso);
+    }
+
+    // C = A * B com o kernel clássico, em tiles de C distribuídos às threads
+    template <typename T, typename A>
+    void multiplicarClassico(VisaoMatrizConstT<T> va, VisaoMatrizConstT<T> vb, VisaoMatrizT<A> vc,
+                             const ParametrosBloco& blocos, bool verboso) {
+        DivisaoTiles divisao(vc.linhas, vc.colunas, blocos.tileLinhas, blocos.tileColunas);
+
+        if (verboso) {
+            std::cout << "Dividindo o resultado em " << divisao.total() << " tiles de "
+                      << divisao.tileLinhas << "x" << divisao.tileColunas
+                      << " entre " << pool.tamanho() << " threads (com roubo de trabalho)" << std::endl;
+        }
+
+        pool.paraCada(divisao.total(), [&](int tile, int trabalhador) {
+            int linha0, coluna0, numLinhas, numColunas;
+            divisao.tile(tile, linha0, coluna0, numLinhas, numColunas);
+            gemm(va.sub(linha0, 0, numLinhas, va.colunas),
+                 vb.sub(0, coluna0, vb.linhas, numColunas),
+                 vc.sub(linha0, coluna0, numLinhas, numColunas), blocos, *buffers[trabalhador]);
+        }, "tile");
+    }
+
+    // C = A * B na forma esparsa já preparada, em blocos de linhas de C distribuídos às threads
+    void multiplicarEsparso(const ProdutoEsparso& produto, const MatrizDensa& a, const MatrizDensa& b,
+                            MatrizDensa& c, bool verboso) {
+        int numBlocos = (c.getLinhas() + LINHAS_TAREFA_ESPARSA - 1) / LINHAS_TAREFA_ESPARSA;
+        if (verboso) {
+            std::cout << "Distribuindo " << numBlocos << " blocos de " << LINHAS_TAREFA_ESPARSA << " linhas ("
+                      << nomeFormaEsparsa(produto.getForma()) << ") entre " << pool.tamanho()
+                      << " threads (com roubo de trabalho)" << std::endl;
+        }
+
+        OperandoEsparso opA = produto.operandoA(a);
+        OperandoEsparso opB = produto.operandoB(b);
+        VisaoMatriz vc = c.visao();
+        pool.paraCada(numBlocos, [&](int bloco, int) {
+            int linha0 = bloco * LINHAS_TAREFA_ESPARSA;
+            calcularLinhasEsparsas(produto.getForma(), opA, opB, vc, linha0,
+                                   std::min(vc.linhas, linha0 + LINHAS_TAREFA_ESPARSA));
+        }, "linhas");
+    }
+
+    // Todos os produtos de um lote; os pequenos viram uma única chamada ao pool
+    void multiplicarLote(const std::vector<ProdutoLote>& produtos, const ParametrosBloco& blocos, bool verboso) {
+        std::vector<int> inteiros;
+        int divididos = 0;
+        for (size_t p = 0; p < produtos.size(); p++) {
+            if (dividirProdutoDoLote(produtos[p], blocos, pool.tamanho())) {
+                const ProdutoLote& produto = produtos[p];
+                multiplicarClassico(produto.a, produto.b, produto.c, blocos, false);
+                divididos++;
+            } else {
+                inteiros.push_back((int)p);
+            }
+        }
+
+        if (verboso) {
+            std::cout << "Distribuindo " << inteiros.size() << " produtos inteiros entre " << pool.tamanho()
+                      << " threads (" << divididos << " divididos em tiles)" << std::endl;
+        }
+
+        pool.paraCada((int)inteiros.size(), [&](int i, int trabalhador) {
+            const ProdutoLote& produto = produtos[inteiros[i]];
+            gemm(produto.a, produto.b, produto.c, blocos, *buffers[trabalhador]);
+        }, "produto");
+    }
+};
+
+inline bool multiplicarComProcessos(const MatrizDensa& a, const MatrizDensa& b, MatrizDensa& c,
+                                    PoolProcessos& pool, const ParametrosBloco& blocos,
+                                    const ParametrosStrassen& algo, bool verboso) {
+    DescritorMatriz descA, descB, descC;
+    if (!a.descrever(descA) || !b.descrever(descB) || !c.descrever(descC)) {
+        std::cerr << "Erro: Matriz fora de memória compartilhada" << std::endl;
+        return false;
+    }
+
+    if (algo.deveRecursar(c.getLinhas(), a.getColunas(), c.getColunas())) {
+        // Operandos e produtos do primeiro nível (ou dos dois primeiros, com
+        // mais de 7 processos) ficam em memória compartilhada temporária
+        long long inicioPlano = agoraNs();
+        PlanoStrassen plano(algo, RegiaoMatriz(a), RegiaoMatriz(b), RegiaoMatriz(c), true,
+                            pool.tamanho() > 7 ? 2 : 1);
+        registrarTrecho("montar operandos", inicioPlano, agoraNs());
+        std::vector<ProdutoStrassen> produtos;
+        plano.coletarProdutos(produtos);
+
+        std::vector<ProdutoDescrito> descritos(produtos.size());
+        for (size_t i = 0; i < produtos.size(); i++) {
+            if (!produtos[i].a.descrever(descritos[i].a) || !produtos[i].b.descrever(descritos[i].b) ||
+                !produtos[i].c.descrever(descritos[i].c)) {
+                std::cerr << "Erro: Matriz fora de memória compartilhada" << std::endl;
+                return false;
+            }
+        }
+
+        if (verboso) {
+            std::cout << "Distribuindo " << produtos.size() << " produtos de " << algo.nome()
+                      << " entre " << pool.tamanho() << " processos (contador compartilhado)" << std::endl;
+        }
+
+        if (!pool.multiplicarProdutos(descritos, blocos, algo)) {
+            return false;
+        }
+        TrechoRastro trecho("combinar produtos");
+        BuffersGemm buffers;
+        plano.concluir(blocos, buffers);
+        return true;
+    }
+
+    if (verboso) {
+        DivisaoTiles divisao(c.getLinhas(), c.getColunas(), blocos.tileLinhas, blocos.tileColunas);
+        std::cout << "Distribuindo " << divisao.total() << " tiles de "
+                  << divisao.tileLinhas << "x" << divisao.tileColunas
+                  << " entre " << pool.tamanho() << " processos (contador compartilhado)" << std::endl;
+    }
+    return pool.multiplicar(descA, descB, descC, blocos);
+}
+
+// C = A * B na forma esparsa já preparada (operandos esparsos em memória
+// compartilhada), em blocos de linhas de C retirados pelos filhos
+inline bool multiplicarEsparsoComProcessos(const ProdutoEsparso& produto, const MatrizDensa& a, const MatrizDensa& b,
+                                           MatrizDensa& c, PoolProcessos& pool, bool verboso) {
+    DescritorMatriz descA, descB, descC;
+    if (!produto.descrever(a, b, descA, descB) || !c.descrever(descC)) {
+        std::cerr << "Erro: Matriz fora de memória compartilhada" << std::endl;
+        return false;
+    }
+    if (verboso) {
+        std::cout << "Distribuindo " << (c.getLinhas() + LINHAS_TAREFA_ESPARSA - 1) / LINHAS_TAREFA_ESPARSA
+                  << " blocos de " << LINHAS_TAREFA_ESPARSA << " linhas (" << nomeFormaEsparsa(produto.getForma())
+                  << ") entre " << pool.tamanho() << " processos (contador compartilhado)" << std::endl;
+    }
+    return pool.multiplicarEsparso(produto.getForma(), descA, descB, descC);
+}
+
+// C = A * B com elementos de --dtype (C no tipo do acumulador), em tiles do pool
+template <typename T, typename A>
+inline bool multiplicarTipadoComProcessos(const MatrizDensaT<T>& a, const MatrizDensaT<T>& b, MatrizDensaT<A>& c,
+                                          PoolProcessos& pool, const ParametrosBloco& blocos, bool verboso) {
+    DescritorMatriz descA, descB, descC;
+    if (!a.descrever(descA) || !b.descrever(descB) || !c.descrever(descC)) {
+        std::cerr << "Erro: Matriz fora de memória compartilhada" << std::endl;
+        return false;
+    }
+    if (verboso) {
+        DivisaoTiles divisao(c.getLinhas(), c.getColunas(), blocos.tileLinhas, blocos.tileColunas);
+        std::cout << "Distribuindo " << divisao.total() << " tiles de "
+                  << divisao.tileLinhas << "x" << divisao.tileColunas
+                  << " entre " << pool.tamanho() << " processos (contador compartilhado)" << std::endl;
+    }
+    return pool.multiplicar(descA, descB, descC, blocos, TipoElemento<T>::codigo());
+}
+
+// C = A * B com o kernel clássico sobre regiões de matrizes compartilháveis
+// (por exemplo, blocos dos buffers de painéis do modo em fluxo)
+inline bool multiplicarRegioesComProcessos(const RegiaoMatriz& a, const RegiaoMatriz& b, const RegiaoMatriz& c,
+                                           PoolProcessos& pool, const ParametrosBloco& blocos) {
+    DescritorMatriz descA, descB, descC;
+    if (!a.descrever(descA) || !b.descrever(descB) || !c.descrever(descC)) {
+        std::cerr << "Erro: Matriz fora de memória compartilhada" << std::endl;
+        return false;
+    }
+    return pool.multiplicar(descA, descB, descC, blocos);
+}
+
+// Todos os produtos de um lote, com as matrizes nos arquivos de lote mapeados
+// pelos filhos; os pequenos vão ao pool em grupos de até MAX_PRODUTOS_POOL
+inline bool multiplicarLoteComProcessos(const std::vector<ProdutoLote>& produtos, PoolProcessos& pool,
+                                        const ParametrosBloco& blocos, bool verboso) {
+    std::vector<ProdutoDescrito> inteiros;
+    int divididos = 0;
+    for (const ProdutoLote& produto : produtos) {
+        if (dividirProdutoDoLote(produto, blocos, pool.tamanho())) {
+            if (!pool.multiplicar(produto.descA, produto.descB, produto.descC, blocos)) {
+                return false;
+            }
+            divididos++;
+        } else {
+            ProdutoDescrito descrito = { produto.descA, produto.descB, produto.descC };
+            inteiros.push_back(descrito);
+        }
+    }
+
+    if (verboso) {
+        std::cout << "Distribuindo " << inteiros.size() << " produtos inteiros entre " << pool.tamanho()
+                  << " processos em grupos de até " << MAX_PRODUTOS_POOL << " (" << divididos
+                  << " divididos em tiles)" << std::endl;
+    }
+
+    for (size_t inicio = 0; inicio < inteiros.size(); inicio += MAX_PRODUTOS_POOL) {
+        size_t fim = std::min(inteiros.size(), inicio + (size_t)MAX_PRODUTOS_POOL);
+        std::vector<ProdutoDescrito> grupo(inteiros.begin() + inicio, inteiros.begin() + fim);
+        if (!pool.multiplicarProdutos(grupo, blocos, ParametrosStrassen())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif
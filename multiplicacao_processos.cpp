@@ -1,200 +1,349 @@
 #include <iostream>
-#include <fstream>
-#include <vector>
 #include <chrono>
 #include <iomanip>
-#include <unistd.h>
-#include <sys/wait.h>
-#include <sys/mman.h>
-#include <cstring>
+#include <vector>
+#include "afinidade.h"
+#include "ajuste.h"
+#include "cadeia.h"
+#include "cannon.h"
+#include "contadores.h"
+#include "fluxo.h"
+#include "gemm_tipado.h"
+#include "lote.h"
+#include "matriz.h"
+#include "multiplicacao.h"
+#include "opcoes.h"
+#include "pipeline.h"
+#include "rastreamento.h"
 
 using namespace std;
 
-class MatrizProcessos {
-private:
-    vector<vector<double>> dados;
-    int dimensao;
-
+class MatrizProcessos : public MatrizDensa {
 public:
-    MatrizProcessos(int dim) : dimensao(dim) {
-        dados.resize(dim, vector<double>(dim, 0.0));
-    }
+    // As matrizes ficam em memória compartilhada POSIX: os processos do pool
+    // mapeiam A, B e C diretamente, sem herdar cópias nem copiar o resultado
+    MatrizProcessos(int dim) : MatrizDensa(dim, dim, true, nomeCompartilhadoUnico("matriz")) {}
     
-    bool carregarDeArquivo(const string& nomeArquivo) {
-        ifstream arquivo(nomeArquivo);
-        if (!arquivo.is_open()) {
-            cerr << "Erro ao abrir arquivo: " << nomeArquivo << endl;
-            return false;
-        }
-        
-        int dimArquivo;
-        arquivo >> dimArquivo;
-        
-        if (dimArquivo != dimensao) {
-            cerr << "Erro: Dimensão do arquivo (" << dimArquivo 
-                 << ") não corresponde à esperada (" << dimensao << ")" << endl;
+    // Tiles de C (ou produtos de Strassen) distribuídos ao pool de processos (ver multiplicacao.h)
+    bool multiplicarComProcessos(const MatrizProcessos& a, const MatrizProcessos& b, PoolProcessos& pool,
+                                 const ParametrosBloco& blocos, const ParametrosStrassen& algo) {
+        if (a.linhas != b.linhas || a.linhas != linhas) {
+            cerr << "Erro: Dimensões incompatíveis para multiplicação" << endl;
             return false;
         }
         
-        for (int i = 0; i < dimensao; i++) {
-            for (int j = 0; j < dimensao; j++) {
-                arquivo >> dados[i][j];
-            }
-        }
-        
-        arquivo.close();
-        return true;
+        return ::multiplicarComProcessos(a, b, *this, pool, blocos, algo, true);
     }
-    
-    bool salvarEmArquivo(const string& nomeArquivo) const {
-        ofstream arquivo(nomeArquivo);
-        if (!arquivo.is_open()) {
-            cerr << "Erro ao criar arquivo: " << nomeArquivo << endl;
-            return false;
-        }
-        
-        arquivo << dimensao << endl;
-        
-        for (int i = 0; i < dimensao; i++) {
-            for (int j = 0; j < dimensao; j++) {
-                arquivo << fixed << setprecision(2) << dados[i][j];
-                if (j < dimensao - 1) {
-                    arquivo << " ";
-                }
-            }
-            arquivo << endl;
-        }
-        
-        arquivo.close();
-        return true;
+};
+
+// Kernel de executarTipado() para os tipos de --dtype: tiles de C entre os processos
+struct KernelTipadoProcessos {
+    PoolProcessos& pool;
+    const ParametrosBloco& blocos;
+    bool primeira;
+
+    KernelTipadoProcessos(PoolProcessos& p, const ParametrosBloco& b) : pool(p), blocos(b), primeira(true) {}
+
+    template <typename T, typename A>
+    bool operator()(const MatrizDensaT<T>& a, const MatrizDensaT<T>& b, MatrizDensaT<A>& c) {
+        bool ok = multiplicarTipadoComProcessos(a, b, c, pool, blocos, primeira);
+        primeira = false;
+        return ok;
     }
+};
+
+// Algoritmo de Cannon na grade de ranks (ver cannon.h): cada rank recebe só os
+// seus blocos, e C é recolhida pelo coordenador
+bool executarCannon(int dimensao, const string& extensao, int numProcessos, const ParametrosCannon& cannon,
+                    const ParametrosBloco& blocos, int repeticoes, const vector<int>& cpus,
+                    const ParametrosVerificacao& verificacao) {
+    // Ranks criados antes das matrizes, para que nenhum herde cópias de A e B
+    GradeCannon grade(ParametrosCannon::ladoGrade(numProcessos, dimensao), cpus);
+    if (!grade.ok()) {
+        return false;
+    }
+    imprimirAfinidade(cpus, "Rank");
     
-    void copiarDeMemoriaCompartilhada(double* memCompartilhada) {
-        for (int i = 0; i < dimensao; i++) {
-            for (int j = 0; j < dimensao; j++) {
-                dados[i][j] = memCompartilhada[i * dimensao + j];
-            }
-        }
+    MatrizDensa matrizA(dimensao);
+    MatrizDensa matrizB(dimensao);
+    MatrizDensa resultado(dimensao);
+    string arquivoA = "matriz_a_" + to_string(dimensao) + extensao;
+    string arquivoB = "matriz_b_" + to_string(dimensao) + extensao;
+    
+    long long inicioCarga = agoraNs();
+    cout << "Carregando matriz A de: " << arquivoA << endl;
+    if (!matrizA.carregar(arquivoA)) {
+        return false;
     }
+    cout << "Carregando matriz B de: " << arquivoB << endl;
+    if (!matrizB.carregar(arquivoB)) {
+        return false;
+    }
+    registrarTrecho("carregar A e B", inicioCarga, agoraNs());
     
-    void multiplicarComProcessos(const MatrizProcessos& a, const MatrizProcessos& b, int numProcessos) {
-        if (a.dimensao != b.dimensao || a.dimensao != dimensao) {
-            cerr << "Erro: Dimensões incompatíveis para multiplicação" << endl;
-            return;
-        }
-        
-        // Criar memória compartilhada para o resultado
-        size_t tamanhoMemoria = dimensao * dimensao * sizeof(double);
-        double* resultado_compartilhado = (double*)mmap(NULL, tamanhoMemoria, 
-                                                       PROT_READ | PROT_WRITE, 
-                                                       MAP_SHARED | MAP_ANONYMOUS, -1, 0);
-        
-        if (resultado_compartilhado == MAP_FAILED) {
-            cerr << "Erro ao criar memória compartilhada" << endl;
-            return;
+    cout << "Iniciando multiplicação com Cannon em grade " << grade.lado() << "x" << grade.lado()
+         << (cannon.sincrono ? " (troca depois do cálculo)" : " (troca sobreposta ao cálculo)") << "..." << endl;
+    chrono::duration<double> total(0);
+    long alocacoesAntesUltima = 0;
+    for (int r = 0; r < repeticoes; r++) {
+        if (r == repeticoes - 1) {
+            alocacoesAntesUltima = alocacoesRealizadas();
         }
-        
-        // Inicializar memória compartilhada
-        memset(resultado_compartilhado, 0, tamanhoMemoria);
-        
-        vector<pid_t> processos;
-        int linhasPorProcesso = dimensao / numProcessos;
-        int linhasRestantes = dimensao % numProcessos;
-        
-        cout << "Distribuindo " << dimensao << " linhas entre " << numProcessos << " processos" << endl;
-        cout << "Linhas por processo: " << linhasPorProcesso;
-        if (linhasRestantes > 0) {
-            cout << " (+" << linhasRestantes << " linhas extras para os primeiros processos)";
-        }
-        cout << endl;
-        
-        int linhaAtual = 0;
-        
-        // Criar processos filhos
-        for (int p = 0; p < numProcessos; p++) {
-            int linhaInicio = linhaAtual;
-            int linhaFim = linhaInicio + linhasPorProcesso;
-            
-            // Distribuir linhas restantes entre os primeiros processos
-            if (p < linhasRestantes) {
-                linhaFim++;
+        auto inicioRep = chrono::high_resolution_clock::now();
+        {
+            TrechoRastro trecho("multiplicação", r);
+            if (!grade.multiplicar(matrizA, matrizB, resultado, blocos, cannon.sincrono)) {
+                return false;
             }
-            
-            cout << "Processo " << p << ": linhas " << linhaInicio << " a " << (linhaFim - 1) << endl;
-            
-            pid_t pid = fork();
-            
-            if (pid == 0) {
-               
-                for (int i = linhaInicio; i < linhaFim; i++) {
-                    for (int j = 0; j < dimensao; j++) {
-                        double soma = 0.0;
-                        for (int k = 0; k < dimensao; k++) {
-                            soma += a.dados[i][k] * b.dados[k][j];
-                        }
-                        resultado_compartilhado[i * dimensao + j] = soma;
-                    }
-                }
-                exit(0); 
-            } else if (pid > 0) {
-                
-                processos.push_back(pid);
-            } else {
-                cerr << "Erro ao criar processo filho" << endl;
-                return;
-            }
-            
-            linhaAtual = linhaFim;
         }
-        
-        
-        for (pid_t pid : processos) {
-            int status;
-            waitpid(pid, &status, 0);
+        auto fimRep = chrono::high_resolution_clock::now();
+        total += fimRep - inicioRep;
+        if (repeticoes > 1) {
+            cout << "Repetição " << (r + 1) << ": " << fixed << setprecision(3)
+                 << chrono::duration<double, milli>(fimRep - inicioRep).count() << " ms" << endl;
         }
-        
-        
-        copiarDeMemoriaCompartilhada(resultado_compartilhado);
-        
-        
-        munmap(resultado_compartilhado, tamanhoMemoria);
     }
     
-    int getDimensao() const { return dimensao; }
+    auto media = total / repeticoes;
+    cout << "Estatísticas por rank" << (repeticoes > 1 ? " (última repetição):" : ":") << endl;
+    grade.imprimirEstatisticas();
     
-    const vector<vector<double>>& getDados() const { return dados; }
-};
+    string arquivoResultado = "resultado_processos_" + to_string(dimensao) + "_" + to_string(numProcessos) + extensao;
+    cout << "Salvando resultado em: " << arquivoResultado << endl;
+    long long inicioSalvar = agoraNs();
+    if (!resultado.salvar(arquivoResultado)) {
+        return false;
+    }
+    long long fimSalvar = agoraNs();
+    registrarTrecho("salvar resultado", inicioSalvar, fimSalvar);
+    
+    cout << "Multiplicação com Cannon concluída!" << endl;
+    cout << "Tempo de execução: " << chrono::duration_cast<chrono::milliseconds>(media).count() << " ms" << endl;
+    printf("Tempo de ponta a ponta (carregar, multiplicar e salvar): %.0f ms\n", (fimSalvar - inicioCarga) / 1e6);
+    relatarDesempenho(2.0 * dimensao * dimensao * dimensao, media.count(), numProcessos);
+    relatarMemoria(repeticoes > 1 ? alocacoesRealizadas() - alocacoesAntesUltima : -1);
+    
+    // Verificação de Freivalds, em O(k n²) (fora da medição)
+    return !verificacao.ativa() || verificarProduto(matrizA, matrizB, resultado, verificacao);
+}
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        cout << "Uso: " << argv[0] << " <dimensao> <num_processos>" << endl;
+    Opcoes opcoes(argc, argv);
+    if (!opcoes.aceitarApenas({ParametrosBloco::nomesOpcoes(), ParametrosStrassen::nomesOpcoes(),
+                               ParametrosFluxo::nomesOpcoes(), ParametrosPipeline::nomesOpcoes(),
+                               ParametrosCadeia::nomesOpcoes(), ParametrosEsparsa::nomesOpcoes(),
+                               ParametrosVerificacao::nomesOpcoes(), ParametrosCannon::nomesOpcoes(),
+                               "ajuste,counters,dtype,fixos,formato,kernel,lote,paginas-grandes,repeticoes,trace",
+                               "numa,pin"})) {
+        return 1;
+    }
+    
+    // Nos modos em lote e em cadeia as matrizes vêm dos arquivos, e não há
+    // dimensão. P pode ser omitido: vem do cache de --autotune (ver ajuste.h)
+    bool modoLote = opcoes.tem("lote");
+    bool modoCadeia = opcoes.tem("cadeia");
+    int posicionaisSemP = modoLote || modoCadeia ? 0 : 1;
+    if (opcoes.numPosicionais() != posicionaisSemP && opcoes.numPosicionais() != posicionaisSemP + 1) {
+        cout << "Uso: " << argv[0] << " <dimensao> [num_processos] [opções]" << endl;
+        cout << "     " << argv[0] << " --lote=ARQUIVO.lote [num_processos] [opções]" << endl;
+        cout << "     " << argv[0] << " --cadeia=A1,A2,...,An [num_processos] [opções]" << endl;
+        cout << "Opções: --mc=N --kc=N --nc=N            tamanhos de bloco do kernel" << endl;
+        cout << "        --tile=LINHASxCOLUNAS          tamanho dos tiles distribuídos aos processos" << endl;
+        cout << "        --repeticoes=N                 repete a multiplicação reutilizando os processos" << endl;
+        cout << "        --kernel=auto|escalar|avx2|avx512 --fixos=auto|nao  (kernels fixos para N = 4..64)" << endl;
+        cout << "        --paginas-grandes=auto|thp|hugetlb|nao  páginas grandes para matrizes e buffers" << endl;
+        cout << "        --algo=classico|strassen|winograd --crossover=N" << endl;
+        cout << "        --dtype=float64|float32|int32|int8  tipo dos elementos (int8/int32 acumulam em int32/int64)" << endl;
+        cout << "        --esparsa=auto|sim|nao --limiar-esparsa=D  operandos esparsos em CSR/CSC (auto: pela densidade)" << endl;
+        cout << "        --verify[=K] --tolerancia=T        confere C com Freivalds (K vetores, padrão 2)" << endl;
+        cout << "        --formato=texto|binario|auto      formato dos arquivos (padrão .txt; auto: o mais recente)" << endl;
+        cout << "        --pin=compact|scatter|LISTA    fixa cada processo em uma CPU (ex.: --pin=0,2,4-7)" << endl;
+        cout << "        --numa=interleave|local        política de alocação das matrizes em NUMA" << endl;
+        cout << "        --counters                     contadores de hardware por trabalhador (perf_event_open)" << endl;
+        cout << "        --fluxo --memoria=TAMANHO --painel-b=N  multiplica em painéis a partir dos .bin" << endl;
+        cout << "        --pipeline[=LINHAS]            lê, multiplica e grava em blocos de linhas sobrepostos" << endl;
+        cout << "        --cannon[=sobreposto|sincrono] algoritmo de Cannon em grade q x q, com troca de mensagens" << endl;
+        cout << "        --lote=ARQUIVO.lote            multiplica todos os pares de um lote (ver gerador_matrizes --lote)" << endl;
+        cout << "        --cadeia=A1,A2,...,An          produto de uma cadeia de matrizes (.txt, .bin ou .lote) na ordem ótima" << endl;
+        cout << "        --ajuste=ARQUIVO|nao           cache de benchmark_multiplicacao --autotune, usado sem P" << endl;
+        cout << "        --trace=ARQUIVO.json           linha do tempo por trabalhador (formato do Chrome/Perfetto)" << endl;
         cout << "Exemplo: " << argv[0] << " 100 4" << endl;
         return 1;
     }
     
-    int dimensao = atoi(argv[1]);
-    int numProcessos = atoi(argv[2]);
+    int dimensao = modoLote || modoCadeia ? 0 : atoi(opcoes.posicional(0).c_str());
+    bool pOmitido = opcoes.numPosicionais() == posicionaisSemP;
+    int numProcessos = pOmitido ? 0 : atoi(opcoes.posicional(posicionaisSemP).c_str());
+    ParametrosBloco blocos = ParametrosBloco::deOpcoes(opcoes);
+    int repeticoes = opcoes.inteiro("repeticoes", 1);
+    ParametrosStrassen algo;
+    ParametrosFluxo fluxo;
+    ParametrosPipeline pipeline;
+    ParametrosCadeia cadeia;
+    ParametrosCannon cannon;
+    TipoDado tipo = TIPO_FLOAT64;
+    ParametrosEsparsa esparsa;
+    ParametrosVerificacao verificacao;
     
-    if (dimensao <= 0) {
+    if (!modoLote && !modoCadeia && dimensao <= 0) {
         cerr << "Erro: A dimensão deve ser um número positivo." << endl;
         return 1;
     }
     
-    if (numProcessos <= 0) {
+    if (!pOmitido && numProcessos <= 0) {
         cerr << "Erro: O número de processos deve ser um número positivo." << endl;
         return 1;
     }
+    aplicarAjuste(opcoes, "processos", dimensao, numProcessos, blocos);
+    
+    if (repeticoes <= 0) {
+        cerr << "Erro: O número de repetições deve ser um número positivo." << endl;
+        return 1;
+    }
+    
+    if (!blocos.validar() || !selecionarMicroKernel(opcoes.texto("kernel", "auto")) ||
+        !selecionarKernelsFixos(opcoes.texto("fixos", "auto")) ||
+        !selecionarPaginasGrandes(opcoes.texto("paginas-grandes", "auto")) ||
+        !ParametrosStrassen::deOpcoes(opcoes, algo) || !ParametrosFluxo::deOpcoes(opcoes, fluxo) ||
+        !ParametrosPipeline::deOpcoes(opcoes, pipeline) || !ParametrosCannon::deOpcoes(opcoes, cannon) ||
+        !ParametrosCadeia::deOpcoes(opcoes, cadeia) ||
+        !interpretarTipoDado(opcoes.texto("dtype", "float64"), tipo) ||
+        !validarTipoDado(tipo, algo.algoritmo != ALGO_CLASSICO, fluxo.ativo, modoLote, opcoes.tem("counters")) ||
+        !ParametrosEsparsa::deOpcoes(opcoes, esparsa) || !ParametrosVerificacao::deOpcoes(opcoes, verificacao) ||
+        !esparsa.validar(tipo != TIPO_FLOAT64, algo.algoritmo != ALGO_CLASSICO, fluxo.ativo, modoLote)) {
+        return 1;
+    }
+    
+    if (modoLote && (algo.algoritmo != ALGO_CLASSICO || fluxo.ativo)) {
+        cerr << "Erro: O modo em lote usa só o algoritmo clássico e não aceita --fluxo" << endl;
+        return 1;
+    }
+    
+    string extensao;
+    string baseA = "matriz_a_" + to_string(dimensao) + sufixoTipoDado(tipo);
+    if (!modoLote && !modoCadeia && !escolherExtensao(opcoes.texto("formato", "texto"), baseA, extensao)) {
+        return 1;
+    }
     
     // Verificar se o número de processos não excede o número de linhas
-    if (numProcessos > dimensao) {
+    if (!modoLote && !modoCadeia && numProcessos > dimensao) {
         cout << "Aviso: Número de processos (" << numProcessos 
              << ") maior que o número de linhas (" << dimensao 
              << "). Ajustando para " << dimensao << " processos." << endl;
         numProcessos = dimensao;
     }
     
-    cout << "Iniciando multiplicação paralela (processos) de matrizes " 
-         << dimensao << "x" << dimensao << " com " << numProcessos << " processos" << endl;
+    // O algoritmo de Cannon usa uma grade quadrada de processos
+    int ladoGrade = ParametrosCannon::ladoGrade(numProcessos, dimensao);
+    if (cannon.ativo && ladoGrade * ladoGrade != numProcessos) {
+        cout << "Aviso: O algoritmo de Cannon usa uma grade q x q. Ajustando para " << ladoGrade * ladoGrade
+             << " processos (grade " << ladoGrade << "x" << ladoGrade << ")." << endl;
+        numProcessos = ladoGrade * ladoGrade;
+    }
+    
+    vector<int> cpus;
+    if (!planejarAfinidade(opcoes.texto("pin", ""), numProcessos, cpus) ||
+        !aplicarPoliticaNuma(opcoes.texto("numa", ""))) {
+        return 1;
+    }
+    bool contar = opcoes.tem("counters") && verificarContadores();
+    // Antes do pool, para que threads e processos filhos registrem seus trechos
+    SessaoRastro rastro(opcoes.texto("trace", ""), numProcessos);
+    
+    if (modoLote || modoCadeia) {
+        cout << "Iniciando multiplicação paralela (processos) " << (modoLote ? "em lote" : "em cadeia") << " com "
+             << numProcessos << " processos" << endl;
+    } else {
+        cout << "Iniciando multiplicação paralela (processos) de matrizes " 
+             << dimensao << "x" << dimensao << " com " << numProcessos << " processos" << endl;
+        imprimirAlgoritmo(algo);
+    }
+    
+    if (cannon.ativo) {
+        bool ok = executarCannon(dimensao, extensao, numProcessos, cannon, blocos, repeticoes, cpus, verificacao);
+        return ok && rastro.salvar() ? 0 : 1;
+    }
+    
+    // Processos criados antes das matrizes e reutilizados em todas as repetições.
+    // As páginas de C só são tocadas pelos filhos, no nó de cada um.
+    PoolProcessos pool(numProcessos, cpus, contar);
+    if (!pool.ok()) {
+        return 1;
+    }
+    imprimirAfinidade(cpus, "Processo");
+    
+    if (modoLote) {
+        // Os filhos mapeiam os próprios arquivos de lote (entrada e resultado)
+        bool primeira = true;
+        KernelLote kernel = [&](const vector<ProdutoLote>& produtos) {
+            bool ok = multiplicarLoteComProcessos(produtos, pool, blocos, primeira);
+            primeira = false;
+            return ok;
+        };
+        string arquivoLote = opcoes.texto("lote", "");
+        string arquivoResultado = nomeResultadoLote("resultado_processos_", arquivoLote, "_" + to_string(numProcessos));
+        if (!executarLote(arquivoLote, arquivoResultado, repeticoes, kernel, numProcessos, verificacao)) {
+            return 1;
+        }
+        cout << "Estatísticas por processo (acumuladas):" << endl;
+        pool.imprimirEstatisticas(false);
+        if (contar) {
+            pool.imprimirContadores(false);
+        }
+        return rastro.salvar() ? 0 : 1;
+    }
+    
+    if (modoCadeia) {
+        // Fatores, intermediários e resultado descritos aos filhos: os lidos de
+        // .bin e .lote pelo arquivo, os demais em memória compartilhada
+        KernelLote kernel = [&](const vector<ProdutoLote>& produtos) {
+            return multiplicarLoteComProcessos(produtos, pool, blocos, false);
+        };
+        if (!executarCadeia(cadeia, "resultado_processos_", "_" + to_string(numProcessos), true, repeticoes, kernel,
+                            numProcessos, verificacao)) {
+            return 1;
+        }
+        cout << "Estatísticas por processo (acumuladas):" << endl;
+        pool.imprimirEstatisticas(false);
+        if (contar) {
+            pool.imprimirContadores(false);
+        }
+        return rastro.salvar() ? 0 : 1;
+    }
+    
+    if (fluxo.ativo || pipeline.ativo) {
+        // Os buffers de painéis (fluxo) ou as matrizes (pipeline) ficam em memória
+        // compartilhada com os filhos
+        KernelFluxo kernel = [&](const RegiaoMatriz& a, const RegiaoMatriz& b, const RegiaoMatriz& c) {
+            return multiplicarRegioesComProcessos(a, b, c, pool, blocos);
+        };
+        string arquivoResultado = "resultado_processos_" + to_string(dimensao) + "_" + to_string(numProcessos) +
+                                  (fluxo.ativo ? ".bin" : extensao);
+        bool ok = fluxo.ativo ? executarEmFluxo(dimensao, arquivoResultado, fluxo, true, kernel, numProcessos, verificacao)
+                              : executarEmPipeline(dimensao, extensao, arquivoResultado, pipeline, true, kernel,
+                                                   numProcessos, verificacao);
+        if (!ok) {
+            return 1;
+        }
+        cout << "Estatísticas por processo (acumuladas):" << endl;
+        pool.imprimirEstatisticas(false);
+        if (contar) {
+            pool.imprimirContadores(false);
+        }
+        return rastro.salvar() ? 0 : 1;
+    }
+    
+    if (tipo != TIPO_FLOAT64) {
+        // A, B e C em memória compartilhada, no tipo pedido
+        KernelTipadoProcessos kernel(pool, blocos);
+        if (!executarComTipo(tipo, dimensao, extensao, "resultado_processos_", "_" + to_string(numProcessos), true,
+                             repeticoes, verificacao, kernel)) {
+            return 1;
+        }
+        cout << "Estatísticas por processo" << (repeticoes > 1 ? " (acumuladas):" : ":") << endl;
+        pool.imprimirEstatisticas(repeticoes == 1);
+        return rastro.salvar() ? 0 : 1;
+    }
     
     // Criar matrizes
     MatrizProcessos matrizA(dimensao);
@@ -202,32 +351,81 @@ int main(int argc, char* argv[]) {
     MatrizProcessos resultado(dimensao);
     
     // Carregar matrizes dos arquivos
-    string arquivoA = "matriz_a_" + to_string(dimensao) + ".txt";
-    string arquivoB = "matriz_b_" + to_string(dimensao) + ".txt";
+    string arquivoA = "matriz_a_" + to_string(dimensao) + extensao;
+    string arquivoB = "matriz_b_" + to_string(dimensao) + extensao;
     
+    long long inicioCarga = agoraNs();
     cout << "Carregando matriz A de: " << arquivoA << endl;
-    if (!matrizA.carregarDeArquivo(arquivoA)) {
+    if (!matrizA.carregar(arquivoA)) {
         return 1;
     }
     
     cout << "Carregando matriz B de: " << arquivoB << endl;
-    if (!matrizB.carregarDeArquivo(arquivoB)) {
+    if (!matrizB.carregar(arquivoB)) {
+        return 1;
+    }
+    registrarTrecho("carregar A e B", inicioCarga, agoraNs());
+    
+    // Com operandos esparsos o bastante, converte para CSR/CSC (fora da medição)
+    ProdutoEsparso produtoEsparso;
+    if (algo.algoritmo == ALGO_CLASSICO && !produtoEsparso.preparar(matrizA, matrizB, esparsa, true)) {
         return 1;
     }
     
     cout << "Iniciando multiplicação com processos..." << endl;
-    auto inicio = chrono::high_resolution_clock::now();
+    chrono::duration<double> total(0);
+    long alocacoesAntesUltima = 0;
+    
+    for (int r = 0; r < repeticoes; r++) {
+        if (r == repeticoes - 1) {
+            alocacoesAntesUltima = alocacoesRealizadas();
+        }
+        auto inicioRep = chrono::high_resolution_clock::now();
+        
+        bool ok;
+        {
+            TrechoRastro trecho("multiplicação", r);
+            if (produtoEsparso.ativo()) {
+                ok = multiplicarEsparsoComProcessos(produtoEsparso, matrizA, matrizB, resultado, pool, r == 0);
+            } else {
+                ok = resultado.multiplicarComProcessos(matrizA, matrizB, pool, blocos, algo);
+            }
+        }
+        // Uma falha que não invalida o pool (ex.: descritor) deixaria C incompleta
+        if (!ok || !pool.ok()) {
+            return 1;
+        }
+        
+        auto fimRep = chrono::high_resolution_clock::now();
+        total += fimRep - inicioRep;
+        if (repeticoes > 1) {
+            cout << "Repetição " << (r + 1) << ": " << fixed << setprecision(3)
+                 << chrono::duration<double, milli>(fimRep - inicioRep).count() << " ms" << endl;
+        }
+    }
     
-    resultado.multiplicarComProcessos(matrizA, matrizB, numProcessos);
+    // Tempo de uma multiplicação (média das repetições)
+    auto media = total / repeticoes;
+    auto duracao = chrono::duration_cast<chrono::milliseconds>(media);
+    double segundos = media.count();
     
-    auto fim = chrono::high_resolution_clock::now();
-    auto duracao = chrono::duration_cast<chrono::milliseconds>(fim - inicio);
+    cout << "Estatísticas por processo" << (repeticoes > 1 ? " (acumuladas):" : ":") << endl;
+    pool.imprimirEstatisticas(repeticoes == 1);
+    if (contar) {
+        pool.imprimirContadores(repeticoes == 1);
+    }
     
     // Salvar resultado
-    string arquivoResultado = "resultado_processos_" + to_string(dimensao) + "_" + to_string(numProcessos) + ".txt";
+    string arquivoResultado = "resultado_processos_" + to_string(dimensao) + "_" + to_string(numProcessos) + extensao;
     cout << "Salvando resultado em: " << arquivoResultado << endl;
     
-    if (!resultado.salvarEmArquivo(arquivoResultado)) {
+    long long inicioSalvar = agoraNs();
+    if (!resultado.salvar(arquivoResultado)) {
+        return 1;
+    }
+    long long fimSalvar = agoraNs();
+    registrarTrecho("salvar resultado", inicioSalvar, fimSalvar);
+    if (!rastro.salvar()) {
         return 1;
     }
     
@@ -235,6 +433,28 @@ int main(int argc, char* argv[]) {
     cout << "Tempo de execução: " << duracao.count() << " ms" << endl;
     cout << "Tempo de execução: " << fixed << setprecision(3) 
          << duracao.count() / 1000.0 << " segundos" << endl;
+    // Sem sobreposição: as etapas somam (compare com --pipeline)
+    printf("Tempo de ponta a ponta (carregar, multiplicar e salvar): %.0f ms\n", (fimSalvar - inicioCarga) / 1e6);
+    if (produtoEsparso.ativo()) {
+        relatarDesempenhoEsparso(produtoEsparso, dimensao, segundos, numProcessos);
+    } else {
+        relatarDesempenho(2.0 * dimensao * dimensao * dimensao, segundos, numProcessos);
+    }
+    relatarMemoria(repeticoes > 1 ? alocacoesRealizadas() - alocacoesAntesUltima : -1);
+    
+    // Erro de Strassen/Winograd em relação ao algoritmo clássico (fora da medição)
+    if (algo.algoritmo != ALGO_CLASSICO) {
+        MatrizProcessos referencia(dimensao);
+        if (!referencia.multiplicarComProcessos(matrizA, matrizB, pool, blocos, ParametrosStrassen())) {
+            return 1;
+        }
+        relatarErroStrassen(algo, matrizA.visao(), matrizB.visao(), resultado.visao(), referencia.visao());
+    }
+    
+    // Verificação de Freivalds, em O(k n²) (fora da medição)
+    if (verificacao.ativa() && !verificarProduto(matrizA, matrizB, resultado, verificacao)) {
+        return 1;
+    }
     
     return 0;
 }
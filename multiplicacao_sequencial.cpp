@@ -1,105 +1,198 @@
 #include <iostream>
-#include <fstream>
-#include <vector>
 #include <chrono>
 #include <iomanip>
+#include <memory>
+#include <vector>
+#include "ajuste.h"
+#include "cadeia.h"
+#include "contadores.h"
+#include "fluxo.h"
+#include "gemm_tipado.h"
+#include "lote.h"
+#include "matriz.h"
+#include "multiplicacao.h"
+#include "opcoes.h"
+#include "pipeline.h"
+#include "rastreamento.h"
 
 using namespace std;
 
-class Matriz {
-private:
-    vector<vector<double>> dados;
-    int dimensao;
-
+class Matriz : public MatrizDensa {
 public:
-    Matriz(int dim) : dimensao(dim) {
-        dados.resize(dim, vector<double>(dim, 0.0));
-    }
-    
-    bool carregarDeArquivo(const string& nomeArquivo) {
-        ifstream arquivo(nomeArquivo);
-        if (!arquivo.is_open()) {
-            cerr << "Erro ao abrir arquivo: " << nomeArquivo << endl;
-            return false;
-        }
-        
-        int dimArquivo;
-        arquivo >> dimArquivo;
-        
-        if (dimArquivo != dimensao) {
-            cerr << "Erro: Dimensão do arquivo (" << dimArquivo 
-                 << ") não corresponde à esperada (" << dimensao << ")" << endl;
-            return false;
-        }
-        
-        for (int i = 0; i < dimensao; i++) {
-            for (int j = 0; j < dimensao; j++) {
-                arquivo >> dados[i][j];
-            }
-        }
-        
-        arquivo.close();
-        return true;
-    }
-    
-    bool salvarEmArquivo(const string& nomeArquivo) const {
-        ofstream arquivo(nomeArquivo);
-        if (!arquivo.is_open()) {
-            cerr << "Erro ao criar arquivo: " << nomeArquivo << endl;
-            return false;
-        }
-        
-        arquivo << dimensao << endl;
-        
-        for (int i = 0; i < dimensao; i++) {
-            for (int j = 0; j < dimensao; j++) {
-                arquivo << fixed << setprecision(2) << dados[i][j];
-                if (j < dimensao - 1) {
-                    arquivo << " ";
-                }
-            }
-            arquivo << endl;
-        }
-        
-        arquivo.close();
-        return true;
-    }
+    Matriz(int dim) : MatrizDensa(dim) {}
     
-    void multiplicarSequencial(const Matriz& a, const Matriz& b) {
-        if (a.dimensao != b.dimensao || a.dimensao != dimensao) {
+    void multiplicarSequencial(const Matriz& a, const Matriz& b, const ParametrosBloco& blocos,
+                               const ParametrosStrassen& algo) {
+        if (a.linhas != b.linhas || a.linhas != linhas) {
             cerr << "Erro: Dimensões incompatíveis para multiplicação" << endl;
             return;
         }
         
-        // Algoritmo clássico de multiplicação de matrizes O(n³)
-        for (int i = 0; i < dimensao; i++) {
-            for (int j = 0; j < dimensao; j++) {
-                dados[i][j] = 0.0;
-                for (int k = 0; k < dimensao; k++) {
-                    dados[i][j] += a.dados[i][k] * b.dados[k][j];
-                }
-            }
-        }
+        // Multiplicação O(n³) em blocos (ver gemm.h) ou, com --algo, Strassen/Winograd
+        // até o crossover (ver strassen.h)
+        BuffersGemm buffers;
+        ::multiplicarSequencial(a, b, *this, blocos, algo, buffers);
+    }
+};
+
+// Kernel de executarTipado() para os tipos de --dtype
+struct KernelTipadoSequencial {
+    const ParametrosBloco& blocos;
+    BuffersGemm buffers;
+
+    explicit KernelTipadoSequencial(const ParametrosBloco& b) : blocos(b) {}
+
+    template <typename T, typename A>
+    bool operator()(const MatrizDensaT<T>& a, const MatrizDensaT<T>& b, MatrizDensaT<A>& c) {
+        gemm(a.visao(), b.visao(), c.visao(), blocos, buffers);
+        return true;
     }
-    
-    int getDimensao() const { return dimensao; }
 };
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        cout << "Uso: " << argv[0] << " <dimensao>" << endl;
+    Opcoes opcoes(argc, argv);
+    if (!opcoes.aceitarApenas({ParametrosBloco::nomesOpcoes(), ParametrosStrassen::nomesOpcoes(),
+                               ParametrosFluxo::nomesOpcoes(), ParametrosPipeline::nomesOpcoes(),
+                               ParametrosCadeia::nomesOpcoes(), ParametrosEsparsa::nomesOpcoes(),
+                               ParametrosVerificacao::nomesOpcoes(),
+                               "ajuste,counters,dtype,fixos,formato,kernel,lote,paginas-grandes,repeticoes,trace"})) {
+        return 1;
+    }
+    
+    // Nos modos em lote e em cadeia as matrizes vêm dos arquivos, e não há dimensão
+    bool modoLote = opcoes.tem("lote");
+    bool modoCadeia = opcoes.tem("cadeia");
+    if (opcoes.numPosicionais() != (modoLote || modoCadeia ? 0 : 1)) {
+        cout << "Uso: " << argv[0] << " <dimensao> [opções]" << endl;
+        cout << "     " << argv[0] << " --lote=ARQUIVO.lote [--repeticoes=N] [opções]" << endl;
+        cout << "     " << argv[0] << " --cadeia=A1,A2,...,An [--repeticoes=N] [opções]" << endl;
+        cout << "Opções: --mc=N --kc=N --nc=N            tamanhos de bloco do kernel" << endl;
+        cout << "        --kernel=auto|escalar|avx2|avx512 --fixos=auto|nao  (kernels fixos para N = 4..64)" << endl;
+        cout << "        --paginas-grandes=auto|thp|hugetlb|nao  páginas grandes para matrizes e buffers" << endl;
+        cout << "        --algo=classico|strassen|winograd --crossover=N" << endl;
+        cout << "        --dtype=float64|float32|int32|int8  tipo dos elementos (int8/int32 acumulam em int32/int64)" << endl;
+        cout << "        --esparsa=auto|sim|nao --limiar-esparsa=D  operandos esparsos em CSR/CSC (auto: pela densidade)" << endl;
+        cout << "        --verify[=K] --tolerancia=T        confere C com Freivalds (K vetores, padrão 2)" << endl;
+        cout << "        --formato=texto|binario|auto      formato dos arquivos (padrão .txt; auto: o mais recente)" << endl;
+        cout << "        --counters                     contadores de hardware da multiplicação (perf_event_open)" << endl;
+        cout << "        --fluxo --memoria=TAMANHO --painel-b=N  multiplica em painéis a partir dos .bin" << endl;
+        cout << "        --pipeline[=LINHAS]            lê, multiplica e grava em blocos de linhas sobrepostos" << endl;
+        cout << "        --lote=ARQUIVO.lote            multiplica todos os pares de um lote (ver gerador_matrizes --lote)" << endl;
+        cout << "        --cadeia=A1,A2,...,An          produto de uma cadeia de matrizes (.txt, .bin ou .lote) na ordem ótima" << endl;
+        cout << "        --ajuste=ARQUIVO|nao           cache de benchmark_multiplicacao --autotune (tamanhos de bloco)" << endl;
+        cout << "        --trace=ARQUIVO.json           linha do tempo por trabalhador (formato do Chrome/Perfetto)" << endl;
         cout << "Exemplo: " << argv[0] << " 100" << endl;
         return 1;
     }
     
-    int dimensao = atoi(argv[1]);
+    int dimensao = modoLote || modoCadeia ? 0 : atoi(opcoes.posicional(0).c_str());
+    ParametrosBloco blocos = ParametrosBloco::deOpcoes(opcoes);
+    ParametrosStrassen algo;
+    ParametrosFluxo fluxo;
+    ParametrosPipeline pipeline;
+    ParametrosCadeia cadeia;
+    TipoDado tipo = TIPO_FLOAT64;
+    ParametrosEsparsa esparsa;
+    ParametrosVerificacao verificacao;
     
-    if (dimensao <= 0) {
+    if (!modoLote && !modoCadeia && dimensao <= 0) {
         cerr << "Erro: A dimensão deve ser um número positivo." << endl;
         return 1;
     }
+    int semTrabalhadores = 0;
+    aplicarAjuste(opcoes, "sequencial", dimensao, semTrabalhadores, blocos);
+    
+    if (!blocos.validar() || !selecionarMicroKernel(opcoes.texto("kernel", "auto")) ||
+        !selecionarKernelsFixos(opcoes.texto("fixos", "auto")) ||
+        !selecionarPaginasGrandes(opcoes.texto("paginas-grandes", "auto")) ||
+        !ParametrosStrassen::deOpcoes(opcoes, algo) || !ParametrosFluxo::deOpcoes(opcoes, fluxo) ||
+        !ParametrosPipeline::deOpcoes(opcoes, pipeline) || !ParametrosCadeia::deOpcoes(opcoes, cadeia) ||
+        !interpretarTipoDado(opcoes.texto("dtype", "float64"), tipo) ||
+        !validarTipoDado(tipo, algo.algoritmo != ALGO_CLASSICO, fluxo.ativo, modoLote, opcoes.tem("counters")) ||
+        !ParametrosEsparsa::deOpcoes(opcoes, esparsa) || !ParametrosVerificacao::deOpcoes(opcoes, verificacao) ||
+        !esparsa.validar(tipo != TIPO_FLOAT64, algo.algoritmo != ALGO_CLASSICO, fluxo.ativo, modoLote)) {
+        return 1;
+    }
+    
+    if (modoLote && (algo.algoritmo != ALGO_CLASSICO || fluxo.ativo)) {
+        cerr << "Erro: O modo em lote usa só o algoritmo clássico e não aceita --fluxo" << endl;
+        return 1;
+    }
+    
+    string extensao;
+    string baseA = "matriz_a_" + to_string(dimensao) + sufixoTipoDado(tipo);
+    if (!modoLote && !modoCadeia && !escolherExtensao(opcoes.texto("formato", "texto"), baseA, extensao)) {
+        return 1;
+    }
+    
+    bool contar = opcoes.tem("counters") && verificarContadores();
+    SessaoRastro rastro(opcoes.texto("trace", ""), 0);
+    
+    if (modoLote) {
+        cout << "Iniciando multiplicação sequencial em lote" << endl;
+        BuffersGemm buffers;
+        unique_ptr<ContadoresHardware> contadores(contar ? new ContadoresHardware() : nullptr);
+        vector<ContagemEventos> contagens(1, ContagemEventos());
+        KernelLote kernel = [&](const vector<ProdutoLote>& produtos) {
+            if (contadores) {
+                contadores->iniciar();
+            }
+            multiplicarLoteSequencial(produtos, blocos, buffers);
+            if (contadores) {
+                contadores->parar(contagens[0]);
+            }
+            return true;
+        };
+        string arquivoLote = opcoes.texto("lote", "");
+        string arquivoResultado = nomeResultadoLote("resultado_sequencial_", arquivoLote, "");
+        if (!executarLote(arquivoLote, arquivoResultado, opcoes.inteiro("repeticoes", 1), kernel, 1, verificacao)) {
+            return 1;
+        }
+        if (contar) {
+            imprimirContadores(contagens, "Thread");
+        }
+        return rastro.salvar() ? 0 : 1;
+    }
+    
+    if (modoCadeia) {
+        cout << "Iniciando multiplicação sequencial em cadeia" << endl;
+        BuffersGemm buffers;
+        KernelLote kernel = [&](const vector<ProdutoLote>& produtos) {
+            multiplicarLoteSequencial(produtos, blocos, buffers);
+            return true;
+        };
+        bool ok = executarCadeia(cadeia, "resultado_sequencial_", "", false, opcoes.inteiro("repeticoes", 1), kernel, 1,
+                                 verificacao) &&
+                  rastro.salvar();
+        return ok ? 0 : 1;
+    }
     
     cout << "Iniciando multiplicação sequencial de matrizes " << dimensao << "x" << dimensao << endl;
+    imprimirAlgoritmo(algo);
+    
+    if (tipo != TIPO_FLOAT64) {
+        KernelTipadoSequencial kernel(blocos);
+        bool ok = executarComTipo(tipo, dimensao, extensao, "resultado_sequencial_", "", false, 1, verificacao,
+                                  kernel) &&
+                  rastro.salvar();
+        return ok ? 0 : 1;
+    }
+    
+    if (fluxo.ativo || pipeline.ativo) {
+        // Em fluxo só os painéis ficam na memória, e o resultado é gravado direto
+        // em .bin; em pipeline, cada bloco de linhas é gravado ao ficar pronto
+        BuffersGemm buffers;
+        KernelFluxo kernel = [&](const RegiaoMatriz& a, const RegiaoMatriz& b, const RegiaoMatriz& c) {
+            gemm(a.visao(), b.visao(), c.visaoEscrita(), blocos, buffers);
+            return true;
+        };
+        string arquivoResultado = "resultado_sequencial_" + to_string(dimensao) + (fluxo.ativo ? ".bin" : extensao);
+        bool ok = (fluxo.ativo ? executarEmFluxo(dimensao, arquivoResultado, fluxo, false, kernel, 1, verificacao)
+                               : executarEmPipeline(dimensao, extensao, arquivoResultado, pipeline, false, kernel, 1,
+                                                    verificacao)) &&
+                  rastro.salvar();
+        return ok ? 0 : 1;
+    }
     
     // Criar matrizes
     Matriz matrizA(dimensao);
@@ -107,33 +200,69 @@ int main(int argc, char* argv[]) {
     Matriz resultado(dimensao);
     
     // Carregar matrizes dos arquivos
-    string arquivoA = "matriz_a_" + to_string(dimensao) + ".txt";
-    string arquivoB = "matriz_b_" + to_string(dimensao) + ".txt";
+    string arquivoA = "matriz_a_" + to_string(dimensao) + extensao;
+    string arquivoB = "matriz_b_" + to_string(dimensao) + extensao;
     
+    long long inicioCarga = agoraNs();
     cout << "Carregando matriz A de: " << arquivoA << endl;
-    if (!matrizA.carregarDeArquivo(arquivoA)) {
+    if (!matrizA.carregar(arquivoA)) {
         return 1;
     }
     
     cout << "Carregando matriz B de: " << arquivoB << endl;
-    if (!matrizB.carregarDeArquivo(arquivoB)) {
+    if (!matrizB.carregar(arquivoB)) {
+        return 1;
+    }
+    registrarTrecho("carregar A e B", inicioCarga, agoraNs());
+    
+    // Com operandos esparsos o bastante, converte para CSR/CSC (fora da medição)
+    ProdutoEsparso produtoEsparso;
+    if (algo.algoritmo == ALGO_CLASSICO && !produtoEsparso.preparar(matrizA, matrizB, esparsa, false)) {
         return 1;
     }
     
     // Medir tempo de execução da multiplicação
+    // Os contadores são abertos antes da medição e ligados só durante a multiplicação
+    unique_ptr<ContadoresHardware> contadores(contar ? new ContadoresHardware() : nullptr);
+    vector<ContagemEventos> contagens(1, ContagemEventos());
+    
     cout << "Iniciando multiplicação..." << endl;
     auto inicio = chrono::high_resolution_clock::now();
+    if (contadores) {
+        contadores->iniciar();
+    }
     
-    resultado.multiplicarSequencial(matrizA, matrizB);
+    {
+        TrechoRastro trecho("multiplicação");
+        if (produtoEsparso.ativo()) {
+            produtoEsparso.multiplicarSequencial(matrizA, matrizB, resultado);
+        } else {
+            resultado.multiplicarSequencial(matrizA, matrizB, blocos, algo);
+        }
+    }
     
+    if (contadores) {
+        contadores->parar(contagens[0]);
+    }
     auto fim = chrono::high_resolution_clock::now();
     auto duracao = chrono::duration_cast<chrono::milliseconds>(fim - inicio);
+    double segundos = chrono::duration<double>(fim - inicio).count();
+    
+    if (contar) {
+        imprimirContadores(contagens, "Thread");
+    }
     
     // Salvar resultado
-    string arquivoResultado = "resultado_sequencial_" + to_string(dimensao) + ".txt";
+    string arquivoResultado = "resultado_sequencial_" + to_string(dimensao) + extensao;
     cout << "Salvando resultado em: " << arquivoResultado << endl;
     
-    if (!resultado.salvarEmArquivo(arquivoResultado)) {
+    long long inicioSalvar = agoraNs();
+    if (!resultado.salvar(arquivoResultado)) {
+        return 1;
+    }
+    long long fimSalvar = agoraNs();
+    registrarTrecho("salvar resultado", inicioSalvar, fimSalvar);
+    if (!rastro.salvar()) {
         return 1;
     }
     
@@ -141,6 +270,26 @@ int main(int argc, char* argv[]) {
     cout << "Tempo de execução: " << duracao.count() << " ms" << endl;
     cout << "Tempo de execução: " << fixed << setprecision(3) 
          << duracao.count() / 1000.0 << " segundos" << endl;
+    // Sem sobreposição: as etapas somam (compare com --pipeline)
+    printf("Tempo de ponta a ponta (carregar, multiplicar e salvar): %.0f ms\n", (fimSalvar - inicioCarga) / 1e6);
+    if (produtoEsparso.ativo()) {
+        relatarDesempenhoEsparso(produtoEsparso, dimensao, segundos, 1);
+    } else {
+        relatarDesempenho(2.0 * dimensao * dimensao * dimensao, segundos, 1);
+    }
+    relatarMemoria(-1);
+    
+    // Erro de Strassen/Winograd em relação ao algoritmo clássico (fora da medição)
+    if (algo.algoritmo != ALGO_CLASSICO) {
+        Matriz referencia(dimensao);
+        referencia.multiplicarSequencial(matrizA, matrizB, blocos, ParametrosStrassen());
+        relatarErroStrassen(algo, matrizA.visao(), matrizB.visao(), resultado.visao(), referencia.visao());
+    }
+    
+    // Verificação de Freivalds, em O(k n²) (fora da medição)
+    if (verificacao.ativa() && !verificarProduto(matrizA, matrizB, resultado, verificacao)) {
+        return 1;
+    }
     
     return 0;
 }
@@ -1,200 +1,345 @@
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <thread>
 #include <chrono>
 #include <iomanip>
-#include <mutex>
+#include <memory>
+#include "afinidade.h"
+#include "ajuste.h"
+#include "cadeia.h"
+#include "contadores.h"
+#include "fluxo.h"
+#include "gemm_tipado.h"
+#include "lote.h"
+#include "matriz.h"
+#include "multiplicacao.h"
+#include "opcoes.h"
+#include "pipeline.h"
+#include "rastreamento.h"
 
 using namespace std;
 
-class MatrizThreads {
-private:
-    vector<vector<double>> dados;
-    int dimensao;
-
+class MatrizThreads : public MatrizDensa {
 public:
-    MatrizThreads(int dim) : dimensao(dim) {
-        dados.resize(dim, vector<double>(dim, 0.0));
-    }
-    
-    bool carregarDeArquivo(const string& nomeArquivo) {
-        ifstream arquivo(nomeArquivo);
-        if (!arquivo.is_open()) {
-            cerr << "Erro ao abrir arquivo: " << nomeArquivo << endl;
-            return false;
-        }
-        
-        int dimArquivo;
-        arquivo >> dimArquivo;
-        
-        if (dimArquivo != dimensao) {
-            cerr << "Erro: Dimensão do arquivo (" << dimArquivo 
-                 << ") não corresponde à esperada (" << dimensao << ")" << endl;
-            return false;
-        }
-        
-        for (int i = 0; i < dimensao; i++) {
-            for (int j = 0; j < dimensao; j++) {
-                arquivo >> dados[i][j];
-            }
-        }
-        
-        arquivo.close();
-        return true;
-    }
+    MatrizThreads(int dim) : MatrizDensa(dim) {}
+    MatrizThreads(int dim, SemInicializar s) : MatrizDensa(dim, dim, true, s) {}
     
-    bool salvarEmArquivo(const string& nomeArquivo) const {
-        ofstream arquivo(nomeArquivo);
-        if (!arquivo.is_open()) {
-            cerr << "Erro ao criar arquivo: " << nomeArquivo << endl;
-            return false;
-        }
-        
-        arquivo << dimensao << endl;
-        
-        for (int i = 0; i < dimensao; i++) {
-            for (int j = 0; j < dimensao; j++) {
-                arquivo << fixed << setprecision(2) << dados[i][j];
-                if (j < dimensao - 1) {
-                    arquivo << " ";
-                }
-            }
-            arquivo << endl;
-        }
-        
-        arquivo.close();
-        return true;
-    }
-    
-    // Função executada por cada thread para calcular uma faixa de linhas
-    static void calcularLinhas(const MatrizThreads& a, const MatrizThreads& b, 
-                              MatrizThreads& resultado, int linhaInicio, int linhaFim) {
-        int dim = a.dimensao;
-        
-        for (int i = linhaInicio; i < linhaFim; i++) {
-            for (int j = 0; j < dim; j++) {
-                resultado.dados[i][j] = 0.0;
-                for (int k = 0; k < dim; k++) {
-                    resultado.dados[i][j] += a.dados[i][k] * b.dados[k][j];
-                }
-            }
-        }
-    }
-    
-    void multiplicarComThreads(const MatrizThreads& a, const MatrizThreads& b, int numThreads) {
-        if (a.dimensao != b.dimensao || a.dimensao != dimensao) {
+    // Tiles de C (ou produtos de Strassen) distribuídos ao pool de threads (ver multiplicacao.h)
+    void multiplicarComThreads(const MatrizThreads& a, const MatrizThreads& b, MultiplicadorThreads& multiplicador,
+                               const ParametrosBloco& blocos, const ParametrosStrassen& algo) {
+        if (a.linhas != b.linhas || a.linhas != linhas) {
             cerr << "Erro: Dimensões incompatíveis para multiplicação" << endl;
             return;
         }
         
-        vector<thread> threads;
-        int linhasPorThread = dimensao / numThreads;
-        int linhasRestantes = dimensao % numThreads;
-        
-        cout << "Distribuindo " << dimensao << " linhas entre " << numThreads << " threads" << endl;
-        cout << "Linhas por thread: " << linhasPorThread;
-        if (linhasRestantes > 0) {
-            cout << " (+" << linhasRestantes << " linhas extras para as primeiras threads)";
-        }
-        cout << endl;
-        
-        int linhaAtual = 0;
-        
-        // Criar e iniciar threads
-        for (int t = 0; t < numThreads; t++) {
-            int linhaInicio = linhaAtual;
-            int linhaFim = linhaInicio + linhasPorThread;
-            
-            // Distribuir linhas restantes entre as primeiras threads
-            if (t < linhasRestantes) {
-                linhaFim++;
-            }
-            
-            cout << "Thread " << t << ": linhas " << linhaInicio << " a " << (linhaFim - 1) << endl;
-            
-            threads.emplace_back(calcularLinhas, ref(a), ref(b), ref(*this), linhaInicio, linhaFim);
-            
-            linhaAtual = linhaFim;
-        }
-        
-        // Aguardar conclusão de todas as threads
-        for (auto& t : threads) {
-            t.join();
-        }
+        multiplicador.multiplicar(a, b, *this, blocos, algo, true);
+    }
+};
+
+// Kernel de executarTipado() para os tipos de --dtype: tiles de C entre as threads
+struct KernelTipadoThreads {
+    MultiplicadorThreads& multiplicador;
+    const ParametrosBloco& blocos;
+    bool primeira;
+
+    KernelTipadoThreads(MultiplicadorThreads& m, const ParametrosBloco& b)
+        : multiplicador(m), blocos(b), primeira(true) {}
+
+    template <typename T, typename A>
+    bool operator()(const MatrizDensaT<T>& a, const MatrizDensaT<T>& b, MatrizDensaT<A>& c) {
+        multiplicador.multiplicarClassico(a.visao(), b.visao(), c.visao(), blocos, primeira);
+        primeira = false;
+        return true;
     }
-    
-    int getDimensao() const { return dimensao; }
-    
-    // Permitir acesso aos dados para as threads
-    friend void calcularLinhas(const MatrizThreads& a, const MatrizThreads& b, 
-                              MatrizThreads& resultado, int linhaInicio, int linhaFim);
 };
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        cout << "Uso: " << argv[0] << " <dimensao> <num_threads>" << endl;
+    Opcoes opcoes(argc, argv);
+    if (!opcoes.aceitarApenas({ParametrosBloco::nomesOpcoes(), ParametrosStrassen::nomesOpcoes(),
+                               ParametrosFluxo::nomesOpcoes(), ParametrosPipeline::nomesOpcoes(),
+                               ParametrosCadeia::nomesOpcoes(), ParametrosEsparsa::nomesOpcoes(),
+                               ParametrosVerificacao::nomesOpcoes(),
+                               "ajuste,counters,dtype,fixos,formato,kernel,lote,paginas-grandes,repeticoes,trace",
+                               "numa,pin"})) {
+        return 1;
+    }
+    
+    // Nos modos em lote e em cadeia as matrizes vêm dos arquivos, e não há
+    // dimensão. P pode ser omitido: vem do cache de --autotune (ver ajuste.h)
+    bool modoLote = opcoes.tem("lote");
+    bool modoCadeia = opcoes.tem("cadeia");
+    int posicionaisSemP = modoLote || modoCadeia ? 0 : 1;
+    if (opcoes.numPosicionais() != posicionaisSemP && opcoes.numPosicionais() != posicionaisSemP + 1) {
+        cout << "Uso: " << argv[0] << " <dimensao> [num_threads] [opções]" << endl;
+        cout << "     " << argv[0] << " --lote=ARQUIVO.lote [num_threads] [opções]" << endl;
+        cout << "     " << argv[0] << " --cadeia=A1,A2,...,An [num_threads] [opções]" << endl;
+        cout << "Opções: --mc=N --kc=N --nc=N            tamanhos de bloco do kernel" << endl;
+        cout << "        --tile=LINHASxCOLUNAS          tamanho dos tiles distribuídos às threads" << endl;
+        cout << "        --repeticoes=N                 repete a multiplicação reutilizando as threads" << endl;
+        cout << "        --kernel=auto|escalar|avx2|avx512 --fixos=auto|nao  (kernels fixos para N = 4..64)" << endl;
+        cout << "        --paginas-grandes=auto|thp|hugetlb|nao  páginas grandes para matrizes e buffers" << endl;
+        cout << "        --algo=classico|strassen|winograd --crossover=N" << endl;
+        cout << "        --dtype=float64|float32|int32|int8  tipo dos elementos (int8/int32 acumulam em int32/int64)" << endl;
+        cout << "        --esparsa=auto|sim|nao --limiar-esparsa=D  operandos esparsos em CSR/CSC (auto: pela densidade)" << endl;
+        cout << "        --verify[=K] --tolerancia=T        confere C com Freivalds (K vetores, padrão 2)" << endl;
+        cout << "        --formato=texto|binario|auto      formato dos arquivos (padrão .txt; auto: o mais recente)" << endl;
+        cout << "        --pin=compact|scatter|LISTA    fixa cada thread em uma CPU (ex.: --pin=0,2,4-7)" << endl;
+        cout << "        --numa=interleave|local        política de alocação das matrizes em NUMA" << endl;
+        cout << "        --counters                     contadores de hardware por trabalhador (perf_event_open)" << endl;
+        cout << "        --fluxo --memoria=TAMANHO --painel-b=N  multiplica em painéis a partir dos .bin" << endl;
+        cout << "        --pipeline[=LINHAS]            lê, multiplica e grava em blocos de linhas sobrepostos" << endl;
+        cout << "        --lote=ARQUIVO.lote            multiplica todos os pares de um lote (ver gerador_matrizes --lote)" << endl;
+        cout << "        --cadeia=A1,A2,...,An          produto de uma cadeia de matrizes (.txt, .bin ou .lote) na ordem ótima" << endl;
+        cout << "        --ajuste=ARQUIVO|nao           cache de benchmark_multiplicacao --autotune, usado sem P" << endl;
+        cout << "        --trace=ARQUIVO.json           linha do tempo por trabalhador (formato do Chrome/Perfetto)" << endl;
         cout << "Exemplo: " << argv[0] << " 100 4" << endl;
         return 1;
     }
     
-    int dimensao = atoi(argv[1]);
-    int numThreads = atoi(argv[2]);
+    int dimensao = modoLote || modoCadeia ? 0 : atoi(opcoes.posicional(0).c_str());
+    bool pOmitido = opcoes.numPosicionais() == posicionaisSemP;
+    int numThreads = pOmitido ? 0 : atoi(opcoes.posicional(posicionaisSemP).c_str());
+    ParametrosBloco blocos = ParametrosBloco::deOpcoes(opcoes);
+    int repeticoes = opcoes.inteiro("repeticoes", 1);
+    ParametrosStrassen algo;
+    ParametrosFluxo fluxo;
+    ParametrosPipeline pipeline;
+    ParametrosCadeia cadeia;
+    TipoDado tipo = TIPO_FLOAT64;
+    ParametrosEsparsa esparsa;
+    ParametrosVerificacao verificacao;
     
-    if (dimensao <= 0) {
+    if (!modoLote && !modoCadeia && dimensao <= 0) {
         cerr << "Erro: A dimensão deve ser um número positivo." << endl;
         return 1;
     }
     
-    if (numThreads <= 0) {
+    if (!pOmitido && numThreads <= 0) {
         cerr << "Erro: O número de threads deve ser um número positivo." << endl;
         return 1;
     }
+    aplicarAjuste(opcoes, "threads", dimensao, numThreads, blocos);
+    
+    if (repeticoes <= 0) {
+        cerr << "Erro: O número de repetições deve ser um número positivo." << endl;
+        return 1;
+    }
+    
+    if (!blocos.validar() || !selecionarMicroKernel(opcoes.texto("kernel", "auto")) ||
+        !selecionarKernelsFixos(opcoes.texto("fixos", "auto")) ||
+        !selecionarPaginasGrandes(opcoes.texto("paginas-grandes", "auto")) ||
+        !ParametrosStrassen::deOpcoes(opcoes, algo) || !ParametrosFluxo::deOpcoes(opcoes, fluxo) ||
+        !ParametrosPipeline::deOpcoes(opcoes, pipeline) || !ParametrosCadeia::deOpcoes(opcoes, cadeia) ||
+        !interpretarTipoDado(opcoes.texto("dtype", "float64"), tipo) ||
+        !validarTipoDado(tipo, algo.algoritmo != ALGO_CLASSICO, fluxo.ativo, modoLote, opcoes.tem("counters")) ||
+        !ParametrosEsparsa::deOpcoes(opcoes, esparsa) || !ParametrosVerificacao::deOpcoes(opcoes, verificacao) ||
+        !esparsa.validar(tipo != TIPO_FLOAT64, algo.algoritmo != ALGO_CLASSICO, fluxo.ativo, modoLote)) {
+        return 1;
+    }
+    
+    if (modoLote && (algo.algoritmo != ALGO_CLASSICO || fluxo.ativo)) {
+        cerr << "Erro: O modo em lote usa só o algoritmo clássico e não aceita --fluxo" << endl;
+        return 1;
+    }
+    
+    string extensao;
+    string baseA = "matriz_a_" + to_string(dimensao) + sufixoTipoDado(tipo);
+    if (!modoLote && !modoCadeia && !escolherExtensao(opcoes.texto("formato", "texto"), baseA, extensao)) {
+        return 1;
+    }
     
     // Verificar se o número de threads não excede o número de linhas
-    if (numThreads > dimensao) {
+    if (!modoLote && !modoCadeia && numThreads > dimensao) {
         cout << "Aviso: Número de threads (" << numThreads 
              << ") maior que o número de linhas (" << dimensao 
              << "). Ajustando para " << dimensao << " threads." << endl;
         numThreads = dimensao;
     }
     
+    vector<int> cpus;
+    if (!planejarAfinidade(opcoes.texto("pin", ""), numThreads, cpus) ||
+        !aplicarPoliticaNuma(opcoes.texto("numa", ""))) {
+        return 1;
+    }
+    bool contar = opcoes.tem("counters") && verificarContadores();
+    // Antes do pool, para que threads e processos filhos registrem seus trechos
+    SessaoRastro rastro(opcoes.texto("trace", ""), numThreads);
+    
+    if (modoLote) {
+        cout << "Iniciando multiplicação paralela (threads) em lote com " << numThreads << " threads" << endl;
+        PoolThreads pool(numThreads, cpus, contar);
+        MultiplicadorThreads multiplicador(pool);
+        imprimirAfinidade(cpus, "Thread");
+        bool primeira = true;
+        KernelLote kernel = [&](const vector<ProdutoLote>& produtos) {
+            multiplicador.multiplicarLote(produtos, blocos, primeira);
+            primeira = false;
+            return true;
+        };
+        string arquivoLote = opcoes.texto("lote", "");
+        string arquivoResultado = nomeResultadoLote("resultado_threads_", arquivoLote, "_" + to_string(numThreads));
+        if (!executarLote(arquivoLote, arquivoResultado, repeticoes, kernel, numThreads, verificacao)) {
+            return 1;
+        }
+        cout << "Estatísticas por thread (acumuladas):" << endl;
+        pool.imprimirEstatisticas(false);
+        if (contar) {
+            pool.imprimirContadores(false);
+        }
+        return rastro.salvar() ? 0 : 1;
+    }
+    
+    if (modoCadeia) {
+        cout << "Iniciando multiplicação paralela (threads) em cadeia com " << numThreads << " threads" << endl;
+        PoolThreads pool(numThreads, cpus, contar);
+        MultiplicadorThreads multiplicador(pool);
+        imprimirAfinidade(cpus, "Thread");
+        // Os produtos de uma etapa são independentes: os grandes são divididos
+        // em tiles e os pequenos vão inteiros para as threads
+        KernelLote kernel = [&](const vector<ProdutoLote>& produtos) {
+            multiplicador.multiplicarLote(produtos, blocos, false);
+            return true;
+        };
+        if (!executarCadeia(cadeia, "resultado_threads_", "_" + to_string(numThreads), false, repeticoes, kernel,
+                            numThreads, verificacao)) {
+            return 1;
+        }
+        cout << "Estatísticas por thread (acumuladas):" << endl;
+        pool.imprimirEstatisticas(false);
+        if (contar) {
+            pool.imprimirContadores(false);
+        }
+        return rastro.salvar() ? 0 : 1;
+    }
+    
     cout << "Iniciando multiplicação paralela (threads) de matrizes " 
          << dimensao << "x" << dimensao << " com " << numThreads << " threads" << endl;
+    imprimirAlgoritmo(algo);
+    
+    if (fluxo.ativo || pipeline.ativo) {
+        // Em fluxo só os painéis ficam na memória; em pipeline, os blocos de linhas
+        // de A chegam aos poucos. Cada bloco é dividido em tiles entre as threads
+        PoolThreads pool(numThreads, cpus, contar);
+        MultiplicadorThreads multiplicador(pool);
+        imprimirAfinidade(cpus, "Thread");
+        KernelFluxo kernel = [&](const RegiaoMatriz& a, const RegiaoMatriz& b, const RegiaoMatriz& c) {
+            multiplicador.multiplicarClassico(a.visao(), b.visao(), c.visaoEscrita(), blocos, false);
+            return true;
+        };
+        string arquivoResultado = "resultado_threads_" + to_string(dimensao) + "_" + to_string(numThreads) +
+                                  (fluxo.ativo ? ".bin" : extensao);
+        bool ok = fluxo.ativo ? executarEmFluxo(dimensao, arquivoResultado, fluxo, false, kernel, numThreads, verificacao)
+                              : executarEmPipeline(dimensao, extensao, arquivoResultado, pipeline, false, kernel,
+                                                   numThreads, verificacao);
+        if (!ok) {
+            return 1;
+        }
+        cout << "Estatísticas por thread (acumuladas):" << endl;
+        pool.imprimirEstatisticas(false);
+        if (contar) {
+            pool.imprimirContadores(false);
+        }
+        return rastro.salvar() ? 0 : 1;
+    }
+    
+    if (tipo != TIPO_FLOAT64) {
+        PoolThreads pool(numThreads, cpus, contar);
+        MultiplicadorThreads multiplicador(pool);
+        imprimirAfinidade(cpus, "Thread");
+        KernelTipadoThreads kernel(multiplicador, blocos);
+        if (!executarComTipo(tipo, dimensao, extensao, "resultado_threads_", "_" + to_string(numThreads), false,
+                             repeticoes, verificacao, kernel)) {
+            return 1;
+        }
+        cout << "Estatísticas por thread" << (repeticoes > 1 ? " (acumuladas):" : ":") << endl;
+        pool.imprimirEstatisticas(repeticoes == 1);
+        return rastro.salvar() ? 0 : 1;
+    }
     
     // Criar matrizes
     MatrizThreads matrizA(dimensao);
     MatrizThreads matrizB(dimensao);
-    MatrizThreads resultado(dimensao);
+    // O resultado não é zerado aqui: cada tile é zerado (e portanto tocado pela
+    // primeira vez) pela thread que o calcula, ficando no nó NUMA dela
+    MatrizThreads resultado(dimensao, SemInicializar());
     
     // Carregar matrizes dos arquivos
-    string arquivoA = "matriz_a_" + to_string(dimensao) + ".txt";
-    string arquivoB = "matriz_b_" + to_string(dimensao) + ".txt";
+    string arquivoA = "matriz_a_" + to_string(dimensao) + extensao;
+    string arquivoB = "matriz_b_" + to_string(dimensao) + extensao;
     
+    long long inicioCarga = agoraNs();
     cout << "Carregando matriz A de: " << arquivoA << endl;
-    if (!matrizA.carregarDeArquivo(arquivoA)) {
+    if (!matrizA.carregar(arquivoA)) {
         return 1;
     }
     
     cout << "Carregando matriz B de: " << arquivoB << endl;
-    if (!matrizB.carregarDeArquivo(arquivoB)) {
+    if (!matrizB.carregar(arquivoB)) {
+        return 1;
+    }
+    registrarTrecho("carregar A e B", inicioCarga, agoraNs());
+    
+    // Com operandos esparsos o bastante, converte para CSR/CSC (fora da medição)
+    ProdutoEsparso produtoEsparso;
+    if (algo.algoritmo == ALGO_CLASSICO && !produtoEsparso.preparar(matrizA, matrizB, esparsa, false)) {
         return 1;
     }
     
+    // Threads criadas uma única vez e reutilizadas em todas as repetições
+    PoolThreads pool(numThreads, cpus, contar);
+    MultiplicadorThreads multiplicador(pool);
+    imprimirAfinidade(cpus, "Thread");
+    
     // Medir tempo de execução da multiplicação
     cout << "Iniciando multiplicação com threads..." << endl;
-    auto inicio = chrono::high_resolution_clock::now();
+    chrono::duration<double> total(0);
+    long alocacoesAntesUltima = 0;
+    
+    for (int r = 0; r < repeticoes; r++) {
+        if (r == repeticoes - 1) {
+            alocacoesAntesUltima = alocacoesRealizadas();
+        }
+        auto inicioRep = chrono::high_resolution_clock::now();
+        
+        {
+            TrechoRastro trecho("multiplicação", r);
+            if (produtoEsparso.ativo()) {
+                multiplicador.multiplicarEsparso(produtoEsparso, matrizA, matrizB, resultado, r == 0);
+            } else {
+                resultado.multiplicarComThreads(matrizA, matrizB, multiplicador, blocos, algo);
+            }
+        }
+        
+        auto fimRep = chrono::high_resolution_clock::now();
+        total += fimRep - inicioRep;
+        if (repeticoes > 1) {
+            cout << "Repetição " << (r + 1) << ": " << fixed << setprecision(3)
+                 << chrono::duration<double, milli>(fimRep - inicioRep).count() << " ms" << endl;
+        }
+    }
     
-    resultado.multiplicarComThreads(matrizA, matrizB, numThreads);
+    // Tempo de uma multiplicação (média das repetições)
+    auto media = total / repeticoes;
+    auto duracao = chrono::duration_cast<chrono::milliseconds>(media);
+    double segundos = media.count();
     
-    auto fim = chrono::high_resolution_clock::now();
-    auto duracao = chrono::duration_cast<chrono::milliseconds>(fim - inicio);
+    cout << "Estatísticas por thread" << (repeticoes > 1 ? " (acumuladas):" : ":") << endl;
+    pool.imprimirEstatisticas(repeticoes == 1);
+    if (contar) {
+        pool.imprimirContadores(repeticoes == 1);
+    }
     
     // Salvar resultado
-    string arquivoResultado = "resultado_threads_" + to_string(dimensao) + "_" + to_string(numThreads) + ".txt";
+    string arquivoResultado = "resultado_threads_" + to_string(dimensao) + "_" + to_string(numThreads) + extensao;
     cout << "Salvando resultado em: " << arquivoResultado << endl;
     
-    if (!resultado.salvarEmArquivo(arquivoResultado)) {
+    long long inicioSalvar = agoraNs();
+    if (!resultado.salvar(arquivoResultado)) {
+        return 1;
+    }
+    long long fimSalvar = agoraNs();
+    registrarTrecho("salvar resultado", inicioSalvar, fimSalvar);
+    if (!rastro.salvar()) {
         return 1;
     }
     
@@ -202,6 +347,26 @@ int main(int argc, char* argv[]) {
     cout << "Tempo de execução: " << duracao.count() << " ms" << endl;
     cout << "Tempo de execução: " << fixed << setprecision(3) 
          << duracao.count() / 1000.0 << " segundos" << endl;
+    // Sem sobreposição: as etapas somam (compare com --pipeline)
+    printf("Tempo de ponta a ponta (carregar, multiplicar e salvar): %.0f ms\n", (fimSalvar - inicioCarga) / 1e6);
+    if (produtoEsparso.ativo()) {
+        relatarDesempenhoEsparso(produtoEsparso, dimensao, segundos, numThreads);
+    } else {
+        relatarDesempenho(2.0 * dimensao * dimensao * dimensao, segundos, numThreads);
+    }
+    relatarMemoria(repeticoes > 1 ? alocacoesRealizadas() - alocacoesAntesUltima : -1);
+    
+    // Erro de Strassen/Winograd em relação ao algoritmo clássico (fora da medição)
+    if (algo.algoritmo != ALGO_CLASSICO) {
+        MatrizThreads referencia(dimensao, SemInicializar());
+        referencia.multiplicarComThreads(matrizA, matrizB, multiplicador, blocos, ParametrosStrassen());
+        relatarErroStrassen(algo, matrizA.visao(), matrizB.visao(), resultado.visao(), referencia.visao());
+    }
+    
+    // Verificação de Freivalds, em O(k n²) (fora da medição)
+    if (verificacao.ativa() && !verificarProduto(matrizA, matrizB, resultado, verificacao)) {
+        return 1;
+    }
     
     return 0;
 }
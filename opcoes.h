@@ -0,0 +1,112 @@
+#ifndef OPCOES_H
+#define OPCOES_H
+
+#include <cstdlib>
+#include <initializer_list>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * Leitura simples da linha de comando: argumentos no formato --nome=valor
+ * (ou apenas --nome) viram opções; os demais são posicionais, na ordem em
+ * que aparecem.
+ *
+ * Cada programa declara o conjunto de nomes que aceita (aceitarApenas), e um
+ * nome fora dele, como o erro de digitação --verfy, é recusado em vez de
+ * ignorado. Os grupos de opções lidos por um deOpcoes() vêm do próprio
+ * grupo (ex.: ParametrosBloco::nomesOpcoes()).
+ */
+class Opcoes {
+private:
+    std::vector<std::string> posicionais;
+    std::map<std::string, std::string> valores;
+
+    // Itens não vazios de uma lista separada por vírgulas
+    static std::vector<std::string> dividir(const std::string& valor) {
+        std::vector<std::string> itens;
+        size_t inicio = 0;
+        while (inicio <= valor.size()) {
+            size_t virgula = valor.find(',', inicio);
+            if (virgula == std::string::npos) {
+                virgula = valor.size();
+            }
+            if (virgula > inicio) {
+                itens.push_back(valor.substr(inicio, virgula - inicio));
+            }
+            inicio = virgula + 1;
+        }
+        return itens;
+    }
+
+public:
+    Opcoes(int argc, char* argv[]) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg.size() > 2 && arg.compare(0, 2, "--") == 0) {
+                size_t igual = arg.find('=');
+                if (igual == std::string::npos) {
+                    valores[arg.substr(2)] = "";
+                } else {
+                    valores[arg.substr(2, igual - 2)] = arg.substr(igual + 1);
+                }
+            } else {
+                posicionais.push_back(arg);
+            }
+        }
+    }
+
+    // Recusa opções fora de `conhecidas`, grupos de nomes separados por vírgula
+    bool aceitarApenas(std::initializer_list<const char*> conhecidas) const {
+        std::set<std::string> nomes;
+        for (const char* grupo : conhecidas) {
+            for (const std::string& nome : dividir(grupo)) {
+                nomes.insert(nome);
+            }
+        }
+        for (std::map<std::string, std::string>::const_iterator it = valores.begin(); it != valores.end(); ++it) {
+            if (nomes.count(it->first) == 0) {
+                std::cerr << "Erro: Opção desconhecida: --" << it->first << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int numPosicionais() const { return (int)posicionais.size(); }
+    const std::string& posicional(int i) const { return posicionais[i]; }
+
+    bool tem(const std::string& nome) const { return valores.count(nome) > 0; }
+
+    std::string texto(const std::string& nome, const std::string& padrao) const {
+        std::map<std::string, std::string>::const_iterator it = valores.find(nome);
+        return it == valores.end() ? padrao : it->second;
+    }
+
+    int inteiro(const std::string& nome, int padrao) const {
+        std::map<std::string, std::string>::const_iterator it = valores.find(nome);
+        return it == valores.end() || it->second.empty() ? padrao : atoi(it->second.c_str());
+    }
+
+    double real(const std::string& nome, double padrao) const {
+        std::map<std::string, std::string>::const_iterator it = valores.find(nome);
+        return it == valores.end() || it->second.empty() ? padrao : atof(it->second.c_str());
+    }
+
+    // Lista separada por vírgulas (--nome=a,b,c)
+    std::vector<std::string> lista(const std::string& nome, const std::string& padrao) const {
+        return dividir(texto(nome, padrao));
+    }
+
+    std::vector<int> listaInteiros(const std::string& nome, const std::string& padrao) const {
+        std::vector<int> numeros;
+        for (const std::string& item : lista(nome, padrao)) {
+            numeros.push_back(atoi(item.c_str()));
+        }
+        return numeros;
+    }
+};
+
+#endif
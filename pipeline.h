@@ -0,0 +1,303 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "fluxo.h"
+#include "formato_texto.h"
+#include "matriz.h"
+#include "opcoes.h"
+#include "rastreamento.h"
+#include "verificacao.h"
+
+/**
+ * Execução em pipeline (--pipeline[=LINHAS]): leitura, multiplicação e
+ * gravação sobrepostas, por blocos de linhas.
+ *
+ * No caminho normal, A e B são lidas inteiras, C é calculada e só então
+ * gravada: durante a E/S a CPU fica parada e, durante o cálculo, o disco.
+ * No pipeline, B é lida inteira em segundo plano (todo bloco de C precisa
+ * dela) ao mesmo tempo em que A é lida, em ordem, em blocos de linhas. O
+ * bloco i de C = A[bloco i] * B é calculado assim que o bloco i de A chega
+ * e gravado em segundo plano, também em ordem, enquanto o bloco seguinte é
+ * calculado. Funciona com texto e com .bin (ver formato_texto.h e
+ * ArquivoMatriz em fluxo.h) e dá o mesmo arquivo do caminho normal.
+ *
+ * O tempo relatado é o de ponta a ponta, da abertura dos arquivos até o fim
+ * da gravação de C, com o tempo de cada etapa para mostrar a sobreposição.
+ * Como no modo em fluxo, o cálculo de cada bloco é delegado a um KernelFluxo.
+ */
+
+// Blocos de A em que a matriz é dividida quando LINHAS não é dado
+const int BLOCOS_PIPELINE = 16;
+
+struct ParametrosPipeline {
+    bool ativo;
+    int linhasBloco;  // 0 = automático
+
+    ParametrosPipeline() : ativo(false), linhasBloco(0) {}
+
+    // Opções deste grupo, para Opcoes::aceitarApenas
+    static const char* nomesOpcoes() { return "pipeline"; }
+
+    // Lê --pipeline[=LINHAS]; só o caminho float64 clássico, com uma repetição
+    static bool deOpcoes(const Opcoes& opcoes, ParametrosPipeline& p) {
+        p.ativo = opcoes.tem("pipeline");
+        if (!p.ativo) {
+            return true;
+        }
+        p.linhasBloco = opcoes.inteiro("pipeline", 0);
+        if (p.linhasBloco < 0) {
+            std::cerr << "Erro: O número de linhas por bloco de --pipeline não pode ser negativo." << std::endl;
+            return false;
+        }
+        if (opcoes.tem("fluxo") || opcoes.tem("lote") || opcoes.texto("algo", "classico") != "classico" ||
+            opcoes.texto("dtype", "float64") != "float64" || opcoes.texto("esparsa", "auto") == "sim" ||
+            opcoes.inteiro("repeticoes", 1) != 1) {
+            std::cerr << "Erro: --pipeline usa o algoritmo clássico em float64, com uma repetição, e não se "
+                         "combina com --fluxo, --lote nem --esparsa=sim"
+                      << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Linhas por bloco: LINHAS, ou cerca de BLOCOS_PIPELINE blocos múltiplos
+    // da altura dos micro-kernels, com pelo menos 64 linhas
+    int linhasPara(int linhas) const {
+        if (linhasBloco > 0) {
+            return std::min(linhasBloco, linhas);
+        }
+        int porBloco = (linhas + BLOCOS_PIPELINE - 1) / BLOCOS_PIPELINE;
+        porBloco = std::max(64, (porBloco + 7) / 8 * 8);
+        return std::min(porBloco, linhas);
+    }
+};
+
+// Lê uma matriz em texto ou .bin em blocos de linhas consecutivos
+class LeitorMatriz {
+private:
+    LeitorTexto texto;
+    ArquivoMatriz binario;
+    bool ehBinario;
+    int proximaLinha;
+
+public:
+    LeitorMatriz() : ehBinario(false), proximaLinha(0) {}
+
+    bool abrir(const std::string& nomeArquivo, int linhas, int colunas) {
+        ehBinario = ehArquivoBinario(nomeArquivo);
+        if (!ehBinario) {
+            return texto.abrir(nomeArquivo, linhas, colunas);
+        }
+        if (!binario.abrir(nomeArquivo)) {
+            return false;
+        }
+        if (binario.cab.linhas != (uint64_t)linhas || binario.cab.colunas != (uint64_t)colunas) {
+            std::cerr << "Erro: Dimensão do arquivo (" << binario.cab.linhas << "x" << binario.cab.colunas
+                      << ") não corresponde à esperada (" << linhas << "x" << colunas << ")" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Lê as próximas destino.linhas linhas
+    bool ler(VisaoMatriz destino) {
+        bool ok = ehBinario ? binario.ler(proximaLinha, 0, destino)
+                            : texto.lerLinhas(destino.dados, destino.colunas, destino.passo, destino.linhas);
+        proximaLinha += destino.linhas;
+        return ok;
+    }
+};
+
+// Grava uma matriz em texto ou .bin em blocos de linhas consecutivos
+class EscritorMatriz {
+private:
+    EscritorTexto texto;
+    ArquivoMatriz binario;
+    bool ehBinario;
+    int proximaLinha;
+
+public:
+    EscritorMatriz() : ehBinario(false), proximaLinha(0) {}
+
+    bool criar(const std::string& nomeArquivo, int linhas, int colunas) {
+        ehBinario = ehArquivoBinario(nomeArquivo);
+        return ehBinario ? binario.criar(nomeArquivo, linhas, colunas) : texto.criar(nomeArquivo, linhas, colunas);
+    }
+
+    // Grava as próximas origem.linhas linhas
+    bool escrever(VisaoMatrizConst origem) {
+        bool ok = ehBinario ? binario.escrever(proximaLinha, origem)
+                            : texto.escreverLinhas(origem.dados, origem.colunas, origem.passo, origem.linhas);
+        proximaLinha += origem.linhas;
+        return ok;
+    }
+
+    bool fechar() {
+        return ehBinario || texto.fechar();
+    }
+};
+
+struct EstatisticasPipeline {
+    int blocos;
+    int linhasBloco;
+    double segundosLerA;
+    double segundosLerB;
+    double segundosCalculo;
+    double segundosGravar;
+    double segundosEsperandoLeitura;  // tempo em que o cálculo ficou parado esperando A ou B
+    double segundosGravacaoFinal;     // do fim do cálculo ao fim da gravação de C
+};
+
+// Segundos desde `inicio`
+inline double segundosDesde(std::chrono::steady_clock::time_point inicio) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+// C = A * B em pipeline, com A e C nos arquivos dados. Com `compartilhada`,
+// as matrizes ficam em memória compartilhada (pool de processos).
+inline bool multiplicarEmPipeline(const std::string& arquivoA, const std::string& arquivoB,
+                                  const std::string& arquivoC, int dimensao, const ParametrosPipeline& pp,
+                                  bool compartilhada, const KernelFluxo& kernel, EstatisticasPipeline& estat,
+                                  std::unique_ptr<MatrizDensa> matrizes[3]) {
+    int n = dimensao;
+    for (int m = 0; m < 3; m++) {
+        matrizes[m].reset(compartilhada ? new MatrizDensa(n, n, true, nomeCompartilhadoUnico("pipeline"))
+                                        : new MatrizDensa(n, n, true, SemInicializar()));
+    }
+    MatrizDensa& a = *matrizes[0];
+    MatrizDensa& b = *matrizes[1];
+    MatrizDensa& c = *matrizes[2];
+
+    LeitorMatriz leitorA, leitorB;
+    EscritorMatriz escritorC;
+    if (!leitorA.abrir(arquivoA, n, n) || !leitorB.abrir(arquivoB, n, n) || !escritorC.criar(arquivoC, n, n)) {
+        return false;
+    }
+
+    int r = pp.linhasPara(n);
+    estat.linhasBloco = r;
+    estat.blocos = (n + r - 1) / r;
+    estat.segundosLerA = estat.segundosLerB = estat.segundosCalculo = estat.segundosGravar = 0.0;
+    estat.segundosEsperandoLeitura = estat.segundosGravacaoFinal = 0.0;
+    auto linhasBloco = [&](int i) { return std::min(r, n - i * r); };
+
+    // Leitura de B inteira e de A bloco a bloco, cada uma em sua thread;
+    // blocoLido[i] é cumprida quando o bloco i de A estiver na memória
+    std::vector<std::promise<bool>> blocoLido(estat.blocos);
+    std::vector<std::future<bool>> blocoPronto;
+    for (auto& promessa : blocoLido) {
+        blocoPronto.push_back(promessa.get_future());
+    }
+    std::future<bool> leituraB = std::async(std::launch::async, [&] {
+        auto inicio = std::chrono::steady_clock::now();
+        bool ok = leitorB.ler(b.visao());
+        estat.segundosLerB = segundosDesde(inicio);
+        return ok;
+    });
+    std::future<bool> leituraA = std::async(std::launch::async, [&] {
+        auto inicio = std::chrono::steady_clock::now();
+        bool ok = true;
+        for (int i = 0; i < estat.blocos; i++) {
+            ok = ok && leitorA.ler(a.visao().sub(i * r, 0, linhasBloco(i), n));
+            blocoLido[i].set_value(ok);
+        }
+        estat.segundosLerA = segundosDesde(inicio);
+        return ok;
+    });
+
+    // Espera uma leitura, contabilizando o tempo parado
+    auto aguardarLeitura = [&](std::future<bool>& leitura) {
+        long long inicio = agoraNs();
+        bool ok = leitura.get();
+        long long fim = agoraNs();
+        estat.segundosEsperandoLeitura += (fim - inicio) * 1e-9;
+        registrarTrecho("esperar leitura", inicio, fim);
+        return ok;
+    };
+
+    // Cada bloco de C é gravado por uma tarefa que antes espera a gravação do
+    // bloco anterior, para que os blocos saiam em ordem
+    std::shared_future<bool> gravacao;
+    bool ok = aguardarLeitura(leituraB);
+    for (int i = 0; ok && i < estat.blocos; i++) {
+        ok = aguardarLeitura(blocoPronto[i]);
+        if (!ok) {
+            break;
+        }
+        RegiaoMatriz regiaoA = RegiaoMatriz(a).sub(i * r, 0, linhasBloco(i), n);
+        RegiaoMatriz regiaoC = RegiaoMatriz(c).sub(i * r, 0, linhasBloco(i), n);
+        auto inicio = std::chrono::steady_clock::now();
+        {
+            TrechoRastro trecho("bloco em pipeline", i);
+            ok = kernel(regiaoA, RegiaoMatriz(b), regiaoC);
+        }
+        estat.segundosCalculo += segundosDesde(inicio);
+
+        std::shared_future<bool> anterior = gravacao;
+        VisaoMatrizConst origem = regiaoC.visao();
+        gravacao = std::async(std::launch::async, [&, anterior, origem] {
+            bool gravou = !anterior.valid() || anterior.get();
+            auto inicioGravacao = std::chrono::steady_clock::now();
+            gravou = gravou && escritorC.escrever(origem);
+            // As gravações são encadeadas, então só uma atualiza o tempo por vez
+            estat.segundosGravar += segundosDesde(inicioGravacao);
+            return gravou;
+        }).share();
+    }
+
+    // Espera a leitura de A (mesmo após um erro) e a última gravação
+    auto fimCalculo = std::chrono::steady_clock::now();
+    ok = leituraA.get() && ok;
+    if (gravacao.valid()) {
+        ok = gravacao.get() && ok;
+    }
+    ok = escritorC.fechar() && ok;
+    estat.segundosGravacaoFinal = segundosDesde(fimCalculo);
+    return ok;
+}
+
+// Executa e relata a multiplicação em pipeline de matriz_a_N e matriz_b_N (com
+// a extensão dada) e, com --verify, confere o resultado, que fica na memória
+inline bool executarEmPipeline(int dimensao, const std::string& extensao, const std::string& arquivoResultado,
+                               const ParametrosPipeline& pp, bool compartilhada, const KernelFluxo& kernel,
+                               int numTrabalhadores, const ParametrosVerificacao& verificacao) {
+    std::string arquivoA = "matriz_a_" + std::to_string(dimensao) + extensao;
+    std::string arquivoB = "matriz_b_" + std::to_string(dimensao) + extensao;
+    std::cout << "Multiplicação em pipeline de " << arquivoA << " e " << arquivoB << " para " << arquivoResultado
+              << std::endl;
+
+    EstatisticasPipeline estat;
+    std::unique_ptr<MatrizDensa> matrizes[3];
+    auto inicio = std::chrono::steady_clock::now();
+    if (!multiplicarEmPipeline(arquivoA, arquivoB, arquivoResultado, dimensao, pp, compartilhada, kernel, estat,
+                               matrizes)) {
+        return false;
+    }
+    double segundos = segundosDesde(inicio);
+
+    double serial = estat.segundosLerA + estat.segundosLerB + estat.segundosCalculo + estat.segundosGravar;
+    std::printf("Blocos: %d de %d linhas\n", estat.blocos, estat.linhasBloco);
+    std::printf("Etapas: ler A %.0f ms, ler B %.0f ms, calcular %.0f ms, gravar C %.0f ms (soma %.0f ms)\n",
+                estat.segundosLerA * 1000.0, estat.segundosLerB * 1000.0, estat.segundosCalculo * 1000.0,
+                estat.segundosGravar * 1000.0, serial * 1000.0);
+    std::printf("Cálculo esperou %.0f ms pela leitura; gravação terminou %.0f ms após o cálculo\n",
+                estat.segundosEsperandoLeitura * 1000.0, estat.segundosGravacaoFinal * 1000.0);
+    std::printf("Pico de memória residente: %.1f MiB\n", picoMemoriaResidenteMiB());
+    std::cout << "Multiplicação em pipeline concluída!" << std::endl;
+    std::printf("Tempo de execução: %.0f ms (de ponta a ponta, incluindo leitura e gravação)\n", segundos * 1000.0);
+    std::printf("Tempo de execução: %.3f segundos\n", segundos);
+    std::printf("Sobreposição: %.0f ms economizados em relação às etapas em série\n",
+                std::max(0.0, serial - segundos) * 1000.0);
+    relatarDesempenho(2.0 * dimensao * dimensao * dimensao, segundos, numTrabalhadores);
+    return !verificacao.ativa() || verificarProduto(*matrizes[0], *matrizes[1], *matrizes[2], verificacao);
+}
+
+#endif
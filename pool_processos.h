@@ -0,0 +1,517 @@
+#ifndef POOL_PROCESSOS_H
+#define POOL_PROCESSOS_H
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <poll.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+#include "afinidade.h"
+#include "contadores.h"
+#include "esparsa.h"
+#include "gemm.h"
+#include "gemm_tipado.h"
+#include "memoria_compartilhada.h"
+#include "rastreamento.h"
+#include "strassen.h"
+
+/**
+ * Pool de processos pré-criados (prefork) para a multiplicação.
+ *
+ * Os P filhos são criados uma única vez e ficam bloqueados lendo o seu canal
+ * de comandos, um socketpair em que o pai escreve com MSG_NOSIGNAL: um filho
+ * que morreu não derruba o pai com SIGPIPE. Para cada multiplicação, o pai
+ * escreve no bloco de controle compartilhado os descritores de A, B e C
+ * (memória POSIX ou arquivo binário) e acorda os filhos. Cada filho mapeia
+ * as matrizes (reaproveitando o mapeamento se forem as mesmas da chamada
+ * anterior) e retira tiles de C de um contador atômico compartilhado até
+ * que acabem, escrevendo diretamente no mapeamento de C. Não há cópia de
+ * entrada nem de saída.
+ *
+ * Além dos tiles de um único produto, o pool aceita uma lista de produtos
+ * independentes (os 7 subprodutos de Strassen ou um grupo de produtos de um
+ * lote), retirados do mesmo contador compartilhado e resolvidos com
+ * strassenSequencial().
+ *
+ * Os tiles de um produto podem ter elementos de outro tipo (--dtype, ver
+ * gemm_tipado.h); o tipo vai no bloco de controle junto com os descritores.
+ * No produto esparso (ver esparsa.h), os descritores de A e/ou B apontam para
+ * os objetos CSR/CSC, e os filhos retiram blocos de linhas de C.
+ *
+ * Cada filho pode ser fixado em uma CPU logo após o fork. Como as páginas de
+ * C só são tocadas pelos filhos (e os buffers de empacotamento são alocados
+ * neles), ambos ficam no nó NUMA de quem os usa. Com contadores de hardware
+ * ligados, cada filho mede apenas o intervalo em que executa um comando; com
+ * o rastreamento ligado, registra na própria faixa cada tile ou produto.
+ */
+
+struct EstatisticasProcesso {
+    long tarefas;
+    double segundosOcupado;
+    double segundosOcioso;
+    ContagemEventos eventos;
+};
+
+// Produto C = A * B de uma lista, descrito para os filhos
+struct ProdutoDescrito {
+    DescritorMatriz a;
+    DescritorMatriz b;
+    DescritorMatriz c;
+};
+
+const int MAX_PRODUTOS_POOL = 64;
+
+// Bloco de controle em memória anônima compartilhada, criado antes do fork
+struct ControlePoolProcessos {
+    std::atomic<int> proximoTile;  // próximo tile ('M'), produto ('L') ou bloco de linhas ('E')
+    int totalTiles;
+    DescritorMatriz a;
+    DescritorMatriz b;
+    DescritorMatriz c;
+    TipoDado tipo;  // tipo dos elementos de A e B no comando 'M'
+    FormaEsparsa formaEsparsa;  // representação de A e B no comando 'E'
+    ParametrosBloco blocos;
+    ParametrosStrassen algoritmo;
+    int totalProdutos;
+    ProdutoDescrito produtos[MAX_PRODUTOS_POOL];
+    // Logo após o bloco vem um vetor de EstatisticasProcesso, uma por filho
+};
+
+class PoolProcessos {
+private:
+    // O caminho sozinho não basta: um .bin substituído no mesmo lugar (ex.: pelo
+    // servidor, que recarrega entradas alteradas) chega com outra geração
+    static bool mesmoObjeto(const DescritorMatriz& x, const DescritorMatriz& y) {
+        return strcmp(x.caminho, y.caminho) == 0 && x.ehShm == y.ehShm && x.geracao == y.geracao;
+    }
+
+    // Mapeamento de uma matriz mantido por um filho entre chamadas
+    struct MapeamentoFilho {
+        DescritorMatriz d;
+        void* base;
+        size_t tamanho;
+
+        MapeamentoFilho() : base(nullptr), tamanho(0) { memset(&d, 0, sizeof(d)); }
+        ~MapeamentoFilho() {
+            if (base != nullptr) {
+                munmap(base, tamanho);
+            }
+        }
+
+        MapeamentoFilho(const MapeamentoFilho&) = delete;
+        MapeamentoFilho& operator=(const MapeamentoFilho&) = delete;
+
+        // Regiões diferentes do mesmo objeto (ex.: painéis do modo em fluxo)
+        // reaproveitam o mapeamento, que cobre o objeto inteiro
+        template <typename T = double>
+        T* obter(const DescritorMatriz& novo, bool escrita) {
+            if (base == nullptr || !mesmoObjeto(d, novo) || extensaoDescritor(novo) > tamanho) {
+                if (base != nullptr) {
+                    munmap(base, tamanho);
+                }
+                base = mapearDescritor(novo, escrita, tamanho);
+                if (base == nullptr) {
+                    return nullptr;
+                }
+            }
+            d = novo;
+            return reinterpret_cast<T*>(static_cast<char*>(base) + d.deslocamento);
+        }
+    };
+
+    int numProcessos;
+    ControlePoolProcessos* controle;
+    size_t tamanhoControle;
+    std::vector<pid_t> filhos;
+    std::vector<int> canaisComando;  // extremidade do pai, uma por filho
+    int canalConcluido;              // extremidade de leitura, compartilhada
+    std::vector<EstatisticasProcesso> totais;
+    bool contarEventos;
+    bool valido;
+
+    EstatisticasProcesso* estatisticasFilhos() const {
+        return reinterpret_cast<EstatisticasProcesso*>(controle + 1);
+    }
+
+    void lacoFilho(int id, int cpu, int fdComando, int fdConcluido, long long inicioFork) {
+        faixaAtual() = id + 1;
+        if (cpu >= 0 && !fixarNaCpu(cpu)) {
+            std::fprintf(stderr, "Aviso: Não foi possível fixar o processo %d na CPU %d\n", id, cpu);
+        }
+
+        BuffersGemm buffers;
+        MapeamentoFilho mapaA, mapaB, mapaC;
+        std::unique_ptr<ContadoresHardware> contadores;
+        if (contarEventos) {
+            contadores.reset(new ContadoresHardware());
+        }
+        registrarTrecho("criação", inicioFork, agoraNs());
+        char comando;
+
+        while (read(fdComando, &comando, 1) == 1 && (comando == 'M' || comando == 'L' || comando == 'E')) {
+            EstatisticasProcesso& estat = estatisticasFilhos()[id];
+            if (contadores) {
+                contadores->iniciar();
+            }
+            bool ok = comando == 'L'   ? calcularProdutos(estat, buffers)
+                      : comando == 'E' ? calcularLinhasEsparsas(estat, mapaA, mapaB, mapaC)
+                                       : calcularTilesDoTipo(estat, buffers, mapaA, mapaB, mapaC);
+            char resposta = ok ? 'K' : 'E';
+            if (contadores) {
+                contadores->parar(estat.eventos);
+            }
+            if (send(fdConcluido, &resposta, 1, MSG_NOSIGNAL) != 1) {
+                break;
+            }
+        }
+        _exit(0);
+    }
+
+    bool calcularTilesDoTipo(EstatisticasProcesso& estat, BuffersGemm& buffers,
+                             MapeamentoFilho& mapaA, MapeamentoFilho& mapaB, MapeamentoFilho& mapaC) {
+        switch (controle->tipo) {
+            case TIPO_FLOAT32: return calcularTiles<float>(estat, buffers, mapaA, mapaB, mapaC);
+            case TIPO_INT32: return calcularTiles<int32_t>(estat, buffers, mapaA, mapaB, mapaC);
+            case TIPO_INT8: return calcularTiles<int8_t>(estat, buffers, mapaA, mapaB, mapaC);
+            default: return calcularTiles<double>(estat, buffers, mapaA, mapaB, mapaC);
+        }
+    }
+
+    // Retira tiles de C do contador compartilhado até que acabem
+    template <typename T>
+    bool calcularTiles(EstatisticasProcesso& estat, BuffersGemm& buffers,
+                       MapeamentoFilho& mapaA, MapeamentoFilho& mapaB, MapeamentoFilho& mapaC) {
+        typedef typename TipoElemento<T>::Acumulador A;
+        const T* dadosA = mapaA.obter<T>(controle->a, false);
+        const T* dadosB = mapaB.obter<T>(controle->b, false);
+        A* dadosC = mapaC.obter<A>(controle->c, true);
+        if (dadosA == nullptr || dadosB == nullptr || dadosC == nullptr) {
+            return false;
+        }
+
+        const DescritorMatriz& da = controle->a;
+        const DescritorMatriz& db = controle->b;
+        const DescritorMatriz& dc = controle->c;
+        VisaoMatrizConstT<T> a(dadosA, da.linhas, da.colunas, da.passo);
+        VisaoMatrizConstT<T> b(dadosB, db.linhas, db.colunas, db.passo);
+        VisaoMatrizT<A> c = { dadosC, dc.linhas, dc.colunas, dc.passo };
+        const ParametrosBloco& blocos = controle->blocos;
+        DivisaoTiles divisao(c.linhas, c.colunas, blocos.tileLinhas, blocos.tileColunas);
+
+        int tile;
+        while ((tile = controle->proximoTile.fetch_add(1)) < controle->totalTiles) {
+            long long inicio = agoraNs();
+            int linha0, coluna0, numLinhas, numColunas;
+            divisao.tile(tile, linha0, coluna0, numLinhas, numColunas);
+            gemm(a.sub(linha0, 0, numLinhas, a.colunas),
+                 b.sub(0, coluna0, b.linhas, numColunas),
+                 c.sub(linha0, coluna0, numLinhas, numColunas), blocos, buffers);
+            long long fim = agoraNs();
+            estat.tarefas++;
+            estat.segundosOcupado += (fim - inicio) * 1e-9;
+            registrarTrecho("tile", inicio, fim, tile);
+        }
+        return true;
+    }
+
+    // Operando do produto esparso: o objeto CSR/CSC ou a matriz densa descrita por `d`
+    static bool mapearOperandoEsparso(MapeamentoFilho& mapa, const DescritorMatriz& d, bool esparso,
+                                      OperandoEsparso& op) {
+        memset(&op.esparsa, 0, sizeof(op.esparsa));
+        if (esparso) {
+            const char* base = mapa.obter<char>(d, false);
+            if (base != nullptr) {
+                op.esparsa = visaoEsparsa(base);
+            }
+            return base != nullptr;
+        }
+        const double* dados = mapa.obter(d, false);
+        op.densa = VisaoMatrizConst(dados, d.linhas, d.colunas, d.passo);
+        return dados != nullptr;
+    }
+
+    // Retira blocos de LINHAS_TAREFA_ESPARSA linhas de C até que acabem
+    bool calcularLinhasEsparsas(EstatisticasProcesso& estat, MapeamentoFilho& mapaA, MapeamentoFilho& mapaB,
+                                MapeamentoFilho& mapaC) {
+        FormaEsparsa forma = controle->formaEsparsa;
+        OperandoEsparso a, b;
+        double* dadosC = mapaC.obter(controle->c, true);
+        if (!mapearOperandoEsparso(mapaA, controle->a, forma != ESPARSA_DENSA_CSC, a) ||
+            !mapearOperandoEsparso(mapaB, controle->b, forma != ESPARSA_CSR_DENSA, b) || dadosC == nullptr) {
+            return false;
+        }
+
+        const DescritorMatriz& dc = controle->c;
+        VisaoMatriz c = { dadosC, dc.linhas, dc.colunas, dc.passo };
+        int bloco;
+        while ((bloco = controle->proximoTile.fetch_add(1)) < controle->totalTiles) {
+            long long inicio = agoraNs();
+            int linha0 = bloco * LINHAS_TAREFA_ESPARSA;
+            ::calcularLinhasEsparsas(forma, a, b, c, linha0, std::min(c.linhas, linha0 + LINHAS_TAREFA_ESPARSA));
+            long long fim = agoraNs();
+            estat.tarefas++;
+            estat.segundosOcupado += (fim - inicio) * 1e-9;
+            registrarTrecho("linhas", inicio, fim, bloco);
+        }
+        return true;
+    }
+
+    // Retira produtos da lista até que acabem. Os mapeamentos valem só durante
+    // o comando, mas produtos no mesmo objeto (ex.: um arquivo de lote) os reaproveitam
+    bool calcularProdutos(EstatisticasProcesso& estat, BuffersGemm& buffers) {
+        MapeamentoFilho mapaA, mapaB, mapaC;
+        int i;
+        while ((i = controle->proximoTile.fetch_add(1)) < controle->totalProdutos) {
+            long long inicio = agoraNs();
+            const ProdutoDescrito& produto = controle->produtos[i];
+            const double* dadosA = mapaA.obter(produto.a, false);
+            const double* dadosB = mapaB.obter(produto.b, false);
+            double* dadosC = mapaC.obter(produto.c, true);
+            if (dadosA == nullptr || dadosB == nullptr || dadosC == nullptr) {
+                return false;
+            }
+
+            VisaoMatrizConst a(dadosA, produto.a.linhas, produto.a.colunas, produto.a.passo);
+            VisaoMatrizConst b(dadosB, produto.b.linhas, produto.b.colunas, produto.b.passo);
+            VisaoMatriz c = { dadosC, produto.c.linhas, produto.c.colunas, produto.c.passo };
+            strassenSequencial(a, b, c, controle->algoritmo, controle->blocos, buffers);
+            long long fim = agoraNs();
+            estat.tarefas++;
+            estat.segundosOcupado += (fim - inicio) * 1e-9;
+            registrarTrecho("produto", inicio, fim, i);
+        }
+        return true;
+    }
+
+    // Envia um comando a todos os filhos e espera que terminem
+    bool executarComando(char comando) {
+        memset(estatisticasFilhos(), 0, numProcessos * sizeof(EstatisticasProcesso));
+        controle->proximoTile.store(0);
+
+        long long inicio = agoraNs();
+        for (int fd : canaisComando) {
+            if (send(fd, &comando, 1, MSG_NOSIGNAL) != 1) {
+                std::cerr << "Erro ao enviar comando ao processo filho" << std::endl;
+                valido = false;
+                return false;
+            }
+        }
+
+        if (!aguardarFilhos()) {
+            std::cerr << "Erro: Falha na multiplicação em algum processo filho" << std::endl;
+            valido = false;
+            return false;
+        }
+
+        long long fim = agoraNs();
+        registrarOciosidade(numProcessos, inicio, fim, "aguardar processos");
+        double segundos = (fim - inicio) * 1e-9;
+        for (int p = 0; p < numProcessos; p++) {
+            EstatisticasProcesso& e = estatisticasFilhos()[p];
+            e.segundosOcioso = segundos - e.segundosOcupado;
+            totais[p].tarefas += e.tarefas;
+            totais[p].segundosOcupado += e.segundosOcupado;
+            totais[p].segundosOcioso += e.segundosOcioso;
+            totais[p].eventos.somar(e.eventos);
+        }
+        return true;
+    }
+
+    // Aguarda uma resposta de cada filho, verificando se algum morreu
+    bool aguardarFilhos() {
+        int pendentes = numProcessos;
+        bool ok = true;
+        while (pendentes > 0) {
+            struct pollfd pfd = { canalConcluido, POLLIN, 0 };
+            int r = poll(&pfd, 1, 100);
+            if (r > 0) {
+                char resposta;
+                if (read(canalConcluido, &resposta, 1) != 1) {
+                    return false;
+                }
+                ok = ok && resposta == 'K';
+                pendentes--;
+            } else if (r < 0 && errno != EINTR) {
+                return false;
+            } else if (r == 0) {
+                for (pid_t pid : filhos) {
+                    int status;
+                    if (waitpid(pid, &status, WNOHANG) == pid) {
+                        std::cerr << "Erro: Processo filho " << pid << " terminou inesperadamente" << std::endl;
+                        return false;
+                    }
+                }
+            }
+        }
+        return ok;
+    }
+
+public:
+    // `cpus`, se não estiver vazio, tem a CPU de cada processo filho;
+    // com `contar`, cada filho mede os contadores de hardware dos seus comandos
+    explicit PoolProcessos(int n, const std::vector<int>& cpus = std::vector<int>(), bool contar = false)
+        : numProcessos(n), controle(nullptr), canalConcluido(-1), totais(n), contarEventos(contar),
+          valido(false) {
+        memset(totais.data(), 0, n * sizeof(EstatisticasProcesso));
+
+        tamanhoControle = sizeof(ControlePoolProcessos) + n * sizeof(EstatisticasProcesso);
+        void* mem = mmap(nullptr, tamanhoControle, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) {
+            std::cerr << "Erro ao criar memória compartilhada" << std::endl;
+            return;
+        }
+        controle = new (mem) ControlePoolProcessos();
+
+        int fdsConcluido[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fdsConcluido) != 0) {
+            std::cerr << "Erro ao criar canal de respostas" << std::endl;
+            return;
+        }
+        canalConcluido = fdsConcluido[0];
+
+        std::cout.flush();
+        for (int p = 0; p < n; p++) {
+            int fdsComando[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, fdsComando) != 0) {
+                std::cerr << "Erro ao criar canal de comandos" << std::endl;
+                break;
+            }
+
+            long long inicioFork = agoraNs();
+            pid_t pid = fork();
+            if (pid == 0) {
+                // O filho só precisa do próprio canal de comandos e do canal de respostas
+                close(fdsComando[1]);
+                close(fdsConcluido[0]);
+                for (int fd : canaisComando) {
+                    close(fd);
+                }
+                lacoFilho(p, cpus.empty() ? -1 : cpus[p], fdsComando[0], fdsConcluido[1], inicioFork);
+            } else if (pid > 0) {
+                if (rastreadorAtivo() != nullptr) {
+                    rastreadorAtivo()->nomear(p + 1, "Processo " + std::to_string(p) + " (pid " +
+                                                         std::to_string(pid) + ")");
+                }
+                close(fdsComando[0]);
+                filhos.push_back(pid);
+                canaisComando.push_back(fdsComando[1]);
+            } else {
+                std::cerr << "Erro ao criar processo filho" << std::endl;
+                close(fdsComando[0]);
+                close(fdsComando[1]);
+                break;
+            }
+        }
+        close(fdsConcluido[1]);
+        valido = (int)filhos.size() == n;
+    }
+
+    ~PoolProcessos() {
+        char parar = 'S';
+        for (int fd : canaisComando) {
+            if (send(fd, &parar, 1, MSG_NOSIGNAL) != 1) {
+                // o filho já terminou; nada a fazer
+            }
+            close(fd);
+        }
+        for (pid_t pid : filhos) {
+            int status;
+            waitpid(pid, &status, 0);
+        }
+        if (canalConcluido >= 0) {
+            close(canalConcluido);
+        }
+        if (controle != nullptr) {
+            controle->~ControlePoolProcessos();
+            munmap(controle, tamanhoControle);
+        }
+    }
+
+    PoolProcessos(const PoolProcessos&) = delete;
+    PoolProcessos& operator=(const PoolProcessos&) = delete;
+
+    bool ok() const { return valido; }
+    int tamanho() const { return numProcessos; }
+
+    // C = A * B, dividido em tiles retirados dinamicamente pelos filhos.
+    // `tipo` é o tipo dos elementos de A e B (C é do tipo do acumulador).
+    bool multiplicar(const DescritorMatriz& a, const DescritorMatriz& b, const DescritorMatriz& c,
+                     const ParametrosBloco& blocos, TipoDado tipo = TIPO_FLOAT64) {
+        if (!valido) {
+            return false;
+        }
+
+        DivisaoTiles divisao(c.linhas, c.colunas, blocos.tileLinhas, blocos.tileColunas);
+        controle->a = a;
+        controle->b = b;
+        controle->c = c;
+        controle->tipo = tipo;
+        controle->blocos = blocos;
+        controle->totalTiles = divisao.total();
+        return executarComando('M');
+    }
+
+    // C = A * B na forma esparsa indicada (ver esparsa.h): `a` e/ou `b`
+    // descrevem objetos CSR/CSC; os filhos retiram blocos de linhas de C
+    bool multiplicarEsparso(FormaEsparsa forma, const DescritorMatriz& a, const DescritorMatriz& b,
+                            const DescritorMatriz& c) {
+        if (!valido) {
+            return false;
+        }
+
+        controle->a = a;
+        controle->b = b;
+        controle->c = c;
+        controle->formaEsparsa = forma;
+        controle->totalTiles = (c.linhas + LINHAS_TAREFA_ESPARSA - 1) / LINHAS_TAREFA_ESPARSA;
+        return executarComando('E');
+    }
+
+    // Calcula cada produto da lista (até MAX_PRODUTOS_POOL) com strassenSequencial(),
+    // distribuindo os produtos dinamicamente entre os filhos
+    bool multiplicarProdutos(const std::vector<ProdutoDescrito>& produtos, const ParametrosBloco& blocos,
+                             const ParametrosStrassen& algoritmo) {
+        if (!valido) {
+            return false;
+        }
+        if ((int)produtos.size() > MAX_PRODUTOS_POOL) {
+            std::cerr << "Erro: Mais de " << MAX_PRODUTOS_POOL << " produtos em uma chamada" << std::endl;
+            return false;
+        }
+
+        std::copy(produtos.begin(), produtos.end(), controle->produtos);
+        controle->totalProdutos = (int)produtos.size();
+        controle->blocos = blocos;
+        controle->algoritmo = algoritmo;
+        return executarComando('L');
+    }
+
+    void imprimirEstatisticas(bool ultimaChamada) const {
+        for (int p = 0; p < numProcessos; p++) {
+            const EstatisticasProcesso& e = ultimaChamada ? estatisticasFilhos()[p] : totais[p];
+            std::printf("Processo %d (pid %d): %ld tiles, ocupado %.1f ms, ocioso %.1f ms\n",
+                        p, (int)filhos[p], e.tarefas, e.segundosOcupado * 1000.0, e.segundosOcioso * 1000.0);
+        }
+    }
+
+    void imprimirContadores(bool ultimaChamada) const {
+        std::vector<ContagemEventos> contagens;
+        for (int p = 0; p < numProcessos; p++) {
+            contagens.push_back(ultimaChamada ? estatisticasFilhos()[p].eventos : totais[p].eventos);
+        }
+        ::imprimirContadores(contagens, "Processo");
+    }
+};
+
+#endif
@@ -0,0 +1,260 @@
+#ifndef POOL_THREADS_H
+#define POOL_THREADS_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "afinidade.h"
+#include "contadores.h"
+#include "rastreamento.h"
+
+/**
+ * Pool persistente de threads com roubo de trabalho.
+ *
+ * As threads são criadas uma única vez e reaproveitadas em todas as
+ * chamadas de paraCada(). Cada chamada divide as tarefas (índices 0..n-1)
+ * em faixas contíguas, uma por trabalhador, colocadas na fila (deque) do
+ * trabalhador. O dono consome a própria fila pelo fim; quando ela esvazia,
+ * rouba tarefas do início da fila dos outros trabalhadores. Assim um
+ * trabalhador lento ou descalonado não atrasa o término da chamada.
+ *
+ * O pool também contabiliza, por trabalhador, tarefas executadas, tarefas
+ * roubadas e tempo ocupado/ocioso. Opcionalmente, cada thread é fixada em
+ * uma CPU (ver afinidade.h) assim que começa a rodar e abrir os próprios
+ * contadores de hardware (ver contadores.h), ligados só enquanto executa tarefas.
+ * Com o rastreamento ligado (ver rastreamento.h), cada thread registra na
+ * própria faixa a criação, cada tarefa e o tempo ocioso até o fim da chamada.
+ */
+
+struct EstatisticasTrabalhador {
+    long tarefas;
+    long roubadas;
+    double segundosOcupado;
+    double segundosOcioso;
+    ContagemEventos eventos;
+
+    EstatisticasTrabalhador()
+        : tarefas(0), roubadas(0), segundosOcupado(0.0), segundosOcioso(0.0), eventos() {}
+};
+
+class PoolThreads {
+public:
+    // Função de tarefa: recebe o índice da tarefa e o índice do trabalhador
+    typedef std::function<void(int, int)> FuncaoTarefa;
+
+private:
+    struct FilaTrabalhador {
+        std::mutex trava;
+        std::deque<int> tarefas;
+        EstatisticasTrabalhador chamada;  // estatísticas da chamada em andamento
+        EstatisticasTrabalhador total;    // acumulado desde a criação do pool
+        char preenchimento[64];           // evita falso compartilhamento entre filas vizinhas
+    };
+
+    std::vector<std::unique_ptr<FilaTrabalhador>> filas;
+    std::vector<std::thread> trabalhadores;
+    std::vector<int> cpus;  // CPU de cada thread (vazio = sem afinidade)
+    bool contarEventos;
+
+    std::mutex trava;
+    std::condition_variable cvInicio;
+    std::condition_variable cvFim;
+    const FuncaoTarefa* funcaoAtual;
+    const char* rotuloAtual;  // nome das tarefas no rastreamento
+    long long inicioCriacao;
+    unsigned long geracao;
+    int trabalhadoresAtivos;
+    bool encerrar;
+
+    bool pegarTarefa(int id, int& tarefa, bool& roubada) {
+        FilaTrabalhador& propria = *filas[id];
+        {
+            std::lock_guard<std::mutex> l(propria.trava);
+            if (!propria.tarefas.empty()) {
+                tarefa = propria.tarefas.back();
+                propria.tarefas.pop_back();
+                roubada = false;
+                return true;
+            }
+        }
+
+        int n = (int)filas.size();
+        for (int d = 1; d < n; d++) {
+            FilaTrabalhador& vitima = *filas[(id + d) % n];
+            std::lock_guard<std::mutex> l(vitima.trava);
+            if (!vitima.tarefas.empty()) {
+                tarefa = vitima.tarefas.front();
+                vitima.tarefas.pop_front();
+                roubada = true;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void laco(int id) {
+        unsigned long geracaoVista = 0;
+        FilaTrabalhador& fila = *filas[id];
+        faixaAtual() = id + 1;
+
+        // Fixar antes de qualquer alocação, para que as páginas tocadas por
+        // esta thread fiquem no nó da CPU em que ela vai rodar
+        if (!cpus.empty() && !fixarNaCpu(cpus[id])) {
+            std::fprintf(stderr, "Aviso: Não foi possível fixar a thread %d na CPU %d\n", id, cpus[id]);
+        }
+        std::unique_ptr<ContadoresHardware> contadores;
+        if (contarEventos) {
+            contadores.reset(new ContadoresHardware());
+        }
+        registrarTrecho("criação", inicioCriacao, agoraNs());
+
+        while (true) {
+            const FuncaoTarefa* funcao;
+            const char* rotulo;
+            {
+                std::unique_lock<std::mutex> l(trava);
+                cvInicio.wait(l, [&] { return encerrar || geracao != geracaoVista; });
+                if (encerrar) {
+                    return;
+                }
+                geracaoVista = geracao;
+                funcao = funcaoAtual;
+                rotulo = rotuloAtual;
+            }
+
+            // Nenhuma tarefa é criada durante a chamada: quando todas as filas
+            // estão vazias, o trabalhador terminou sua parte.
+            int tarefa;
+            bool roubada;
+            if (contadores) {
+                contadores->iniciar();
+            }
+            while (pegarTarefa(id, tarefa, roubada)) {
+                long long inicio = agoraNs();
+                (*funcao)(tarefa, id);
+                long long fim = agoraNs();
+                fila.chamada.tarefas++;
+                fila.chamada.roubadas += roubada ? 1 : 0;
+                fila.chamada.segundosOcupado += (fim - inicio) * 1e-9;
+                registrarTrecho(rotulo, inicio, fim, tarefa);
+            }
+            if (contadores) {
+                contadores->parar(fila.chamada.eventos);
+            }
+
+            std::lock_guard<std::mutex> l(trava);
+            if (--trabalhadoresAtivos == 0) {
+                cvFim.notify_all();
+            }
+        }
+    }
+
+public:
+    // `cpusTrabalhadores`, se não estiver vazio, tem a CPU de cada thread;
+    // com `contar`, cada thread mede os contadores de hardware das suas tarefas
+    explicit PoolThreads(int numThreads, const std::vector<int>& cpusTrabalhadores = std::vector<int>(),
+                         bool contar = false)
+        : cpus(cpusTrabalhadores), contarEventos(contar), funcaoAtual(nullptr), rotuloAtual(nullptr),
+          inicioCriacao(agoraNs()), geracao(0), trabalhadoresAtivos(0), encerrar(false) {
+        for (int t = 0; t < numThreads; t++) {
+            filas.emplace_back(new FilaTrabalhador());
+            if (rastreadorAtivo() != nullptr) {
+                rastreadorAtivo()->nomear(t + 1, "Thread " + std::to_string(t));
+            }
+        }
+        for (int t = 0; t < numThreads; t++) {
+            trabalhadores.emplace_back(&PoolThreads::laco, this, t);
+        }
+    }
+
+    ~PoolThreads() {
+        {
+            std::lock_guard<std::mutex> l(trava);
+            encerrar = true;
+        }
+        cvInicio.notify_all();
+        for (auto& t : trabalhadores) {
+            t.join();
+        }
+    }
+
+    PoolThreads(const PoolThreads&) = delete;
+    PoolThreads& operator=(const PoolThreads&) = delete;
+
+    int tamanho() const { return (int)trabalhadores.size(); }
+
+    // Executa funcao(tarefa, trabalhador) para cada tarefa em [0, numTarefas)
+    // e retorna quando todas tiverem terminado. `rotulo` nomeia as tarefas no rastreamento.
+    void paraCada(int numTarefas, const FuncaoTarefa& funcao, const char* rotulo = "tarefa") {
+        int n = tamanho();
+        long long inicio = agoraNs();
+
+        {
+            std::lock_guard<std::mutex> l(trava);
+            for (int t = 0; t < n; t++) {
+                FilaTrabalhador& fila = *filas[t];
+                std::lock_guard<std::mutex> lf(fila.trava);
+                fila.chamada = EstatisticasTrabalhador();
+                int primeira = (int)((long)numTarefas * t / n);
+                int ultima = (int)((long)numTarefas * (t + 1) / n);
+                for (int tarefa = primeira; tarefa < ultima; tarefa++) {
+                    fila.tarefas.push_back(tarefa);
+                }
+            }
+            funcaoAtual = &funcao;
+            rotuloAtual = rotulo;
+            trabalhadoresAtivos = n;
+            geracao++;
+        }
+        cvInicio.notify_all();
+
+        {
+            std::unique_lock<std::mutex> l(trava);
+            cvFim.wait(l, [&] { return trabalhadoresAtivos == 0; });
+            funcaoAtual = nullptr;
+        }
+
+        long long fim = agoraNs();
+        registrarOciosidade(n, inicio, fim, "aguardar threads");
+        double segundos = (fim - inicio) * 1e-9;
+        for (int t = 0; t < n; t++) {
+            FilaTrabalhador& fila = *filas[t];
+            fila.chamada.segundosOcioso = segundos - fila.chamada.segundosOcupado;
+            fila.total.tarefas += fila.chamada.tarefas;
+            fila.total.roubadas += fila.chamada.roubadas;
+            fila.total.segundosOcupado += fila.chamada.segundosOcupado;
+            fila.total.segundosOcioso += fila.chamada.segundosOcioso;
+            fila.total.eventos.somar(fila.chamada.eventos);
+        }
+    }
+
+    // Estatísticas da última chamada (ultimaChamada = true) ou acumuladas
+    EstatisticasTrabalhador estatisticas(int trabalhador, bool ultimaChamada) const {
+        return ultimaChamada ? filas[trabalhador]->chamada : filas[trabalhador]->total;
+    }
+
+    void imprimirEstatisticas(bool ultimaChamada) const {
+        for (int t = 0; t < tamanho(); t++) {
+            EstatisticasTrabalhador e = estatisticas(t, ultimaChamada);
+            std::printf("Thread %d: %ld tarefas (%ld roubadas), ocupada %.1f ms, ociosa %.1f ms\n",
+                        t, e.tarefas, e.roubadas, e.segundosOcupado * 1000.0, e.segundosOcioso * 1000.0);
+        }
+    }
+
+    void imprimirContadores(bool ultimaChamada) const {
+        std::vector<ContagemEventos> contagens;
+        for (int t = 0; t < tamanho(); t++) {
+            contagens.push_back(estatisticas(t, ultimaChamada).eventos);
+        }
+        ::imprimirContadores(contagens, "Thread");
+    }
+};
+
+#endif
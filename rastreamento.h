@@ -0,0 +1,255 @@
+#ifndef RASTREAMENTO_H
+#define RASTREAMENTO_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <sys/mman.h>
+#include <vector>
+
+/**
+ * Linha do tempo por trabalhador (--trace=arquivo.json), exportada no
+ * formato de eventos do Chrome (abre em chrome://tracing ou no Perfetto).
+ *
+ * Cada faixa (a thread principal é a faixa 0; o trabalhador i, a faixa
+ * i + 1) tem um buffer próprio de tamanho fixo em que só uma thread ou
+ * processo escreve de cada vez: registrar um trecho é copiar o evento e
+ * publicar o novo total com um store atômico, sem travas. Os buffers ficam em
+ * memória anônima compartilhada, criada antes do fork, para que os processos
+ * filhos também registrem neles. Quando um buffer enche, os eventos seguintes
+ * são descartados e contados.
+ *
+ * O rastreamento é global ao processo (rastreadorAtivo()) e desligado por
+ * padrão; com ele desligado, cada ponto de registro custa um teste de ponteiro.
+ */
+
+const int CAPACIDADE_FAIXA_RASTRO = 1 << 15;
+
+struct EventoRastro {
+    long long inicio;  // ns do steady_clock (o mesmo relógio em todos os processos)
+    long long fim;
+    char nome[24];
+    int argumento;     // índice do tile/produto, ou -1
+};
+
+struct FaixaRastro {
+    std::atomic<int> total;
+    std::atomic<int> descartados;
+    EventoRastro eventos[CAPACIDADE_FAIXA_RASTRO];
+};
+
+inline long long agoraNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class Rastreador {
+private:
+    FaixaRastro* faixas;
+    size_t tamanho;
+    int numFaixas;
+    long long origem;
+    std::vector<std::string> nomesFaixas;
+
+public:
+    explicit Rastreador(int n) : faixas(nullptr), tamanho(n * sizeof(FaixaRastro)), numFaixas(n),
+                                 origem(agoraNs()), nomesFaixas(n) {
+        void* mem = mmap(nullptr, tamanho, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) {
+            std::cerr << "Aviso: Não foi possível alocar os buffers de rastreamento" << std::endl;
+            numFaixas = 0;
+            return;
+        }
+        faixas = static_cast<FaixaRastro*>(mem);
+        for (int f = 0; f < n; f++) {
+            new (&faixas[f].total) std::atomic<int>(0);
+            new (&faixas[f].descartados) std::atomic<int>(0);
+        }
+        nomesFaixas[0] = "Principal";
+    }
+
+    ~Rastreador() {
+        if (faixas != nullptr) {
+            munmap(faixas, tamanho);
+        }
+    }
+
+    Rastreador(const Rastreador&) = delete;
+    Rastreador& operator=(const Rastreador&) = delete;
+
+    int tamanhoFaixas() const { return numFaixas; }
+
+    void nomear(int faixa, const std::string& nome) {
+        if (faixa < numFaixas) {
+            nomesFaixas[faixa] = nome;
+        }
+    }
+
+    // Só quem é dono da faixa no momento pode chamar
+    void registrar(int faixa, const char* nome, long long inicio, long long fim, int argumento = -1) {
+        if (faixa >= numFaixas) {
+            return;
+        }
+        FaixaRastro& f = faixas[faixa];
+        int i = f.total.load(std::memory_order_relaxed);
+        if (i >= CAPACIDADE_FAIXA_RASTRO) {
+            f.descartados.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        EventoRastro& e = f.eventos[i];
+        e.inicio = inicio;
+        e.fim = fim;
+        strncpy(e.nome, nome, sizeof(e.nome) - 1);
+        e.nome[sizeof(e.nome) - 1] = '\0';
+        e.argumento = argumento;
+        f.total.store(i + 1, std::memory_order_release);
+    }
+
+    // Fim do último trecho da faixa (ou `padrao`, se ela estiver vazia)
+    long long ultimoFim(int faixa, long long padrao) const {
+        if (faixa >= numFaixas) {
+            return padrao;
+        }
+        int total = faixas[faixa].total.load(std::memory_order_acquire);
+        return total > 0 ? faixas[faixa].eventos[total - 1].fim : padrao;
+    }
+
+    bool exportar(const std::string& arquivo) const {
+        FILE* saida = std::fopen(arquivo.c_str(), "w");
+        if (saida == nullptr) {
+            std::cerr << "Erro ao criar arquivo: " << arquivo << std::endl;
+            return false;
+        }
+
+        std::fprintf(saida, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+        bool primeiro = true;
+        int descartados = 0;
+        for (int f = 0; f < numFaixas; f++) {
+            std::string nome = nomesFaixas[f].empty() ? "Faixa " + std::to_string(f) : nomesFaixas[f];
+            std::fprintf(saida, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                                "\"args\": {\"name\": \"%s\"}}",
+                         primeiro ? "" : ",\n", f, nome.c_str());
+            std::fprintf(saida, ",\n{\"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                                "\"args\": {\"sort_index\": %d}}", f, f);
+            primeiro = false;
+
+            int total = faixas[f].total.load(std::memory_order_acquire);
+            descartados += faixas[f].descartados.load(std::memory_order_relaxed);
+            for (int i = 0; i < total; i++) {
+                const EventoRastro& e = faixas[f].eventos[i];
+                std::fprintf(saida, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+                                    "\"ts\": %.3f, \"dur\": %.3f",
+                             e.nome, f, (e.inicio - origem) / 1000.0, (e.fim - e.inicio) / 1000.0);
+                if (e.argumento >= 0) {
+                    std::fprintf(saida, ", \"args\": {\"indice\": %d}", e.argumento);
+                }
+                std::fprintf(saida, "}");
+            }
+        }
+        std::fprintf(saida, "\n]}\n");
+        bool ok = std::fclose(saida) == 0;
+
+        if (descartados > 0) {
+            std::cerr << "Aviso: " << descartados << " eventos de rastreamento descartados (buffer cheio)"
+                      << std::endl;
+        }
+        return ok;
+    }
+};
+
+// Rastreador do processo (nullptr = rastreamento desligado)
+inline Rastreador*& rastreadorAtivo() {
+    static Rastreador* ativo = nullptr;
+    return ativo;
+}
+
+// Faixa em que a thread atual registra seus trechos
+inline int& faixaAtual() {
+    static thread_local int faixa = 0;
+    return faixa;
+}
+
+inline void registrarTrecho(const char* nome, long long inicio, long long fim, int argumento = -1) {
+    if (rastreadorAtivo() != nullptr) {
+        rastreadorAtivo()->registrar(faixaAtual(), nome, inicio, fim, argumento);
+    }
+}
+
+// Depois de uma chamada a um pool: a espera da thread principal e, para cada
+// trabalhador, o intervalo entre a última tarefa e o fim da chamada. Os
+// trabalhadores já estão parados, então suas faixas podem ser escritas daqui.
+inline void registrarOciosidade(int numTrabalhadores, long long inicio, long long fim, const char* rotuloEspera) {
+    Rastreador* rastro = rastreadorAtivo();
+    if (rastro == nullptr) {
+        return;
+    }
+    rastro->registrar(faixaAtual(), rotuloEspera, inicio, fim);
+    for (int t = 0; t < numTrabalhadores; t++) {
+        long long ocioso = std::max(rastro->ultimoFim(t + 1, inicio), inicio);
+        if (ocioso < fim) {
+            rastro->registrar(t + 1, "ocioso", ocioso, fim);
+        }
+    }
+}
+
+// Registra, na faixa da thread atual, o intervalo em que o objeto existiu
+class TrechoRastro {
+private:
+    const char* nome;
+    int argumento;
+    long long inicio;
+
+public:
+    explicit TrechoRastro(const char* n, int arg = -1)
+        : nome(n), argumento(arg), inicio(rastreadorAtivo() != nullptr ? agoraNs() : 0) {}
+
+    ~TrechoRastro() {
+        if (rastreadorAtivo() != nullptr) {
+            registrarTrecho(nome, inicio, agoraNs(), argumento);
+        }
+    }
+
+    TrechoRastro(const TrechoRastro&) = delete;
+    TrechoRastro& operator=(const TrechoRastro&) = delete;
+};
+
+// Liga o rastreamento (se `arquivo` não estiver vazio) enquanto existir.
+// A faixa 0 é a thread principal; as demais, os trabalhadores.
+class SessaoRastro {
+private:
+    std::string arquivo;
+    std::unique_ptr<Rastreador> rastreador;
+
+public:
+    SessaoRastro(const std::string& arq, int numTrabalhadores) : arquivo(arq) {
+        if (!arquivo.empty()) {
+            rastreador.reset(new Rastreador(numTrabalhadores + 1));
+            rastreadorAtivo() = rastreador.get();
+        }
+    }
+
+    ~SessaoRastro() {
+        if (rastreador) {
+            rastreadorAtivo() = nullptr;
+        }
+    }
+
+    SessaoRastro(const SessaoRastro&) = delete;
+    SessaoRastro& operator=(const SessaoRastro&) = delete;
+
+    bool salvar() const {
+        if (!rastreador) {
+            return true;
+        }
+        std::cout << "Salvando rastro em: " << arquivo << std::endl;
+        return rastreador->exportar(arquivo);
+    }
+};
+
+#endif
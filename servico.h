@@ -0,0 +1,151 @@
+#ifndef SERVICO_H
+#define SERVICO_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "memoria_compartilhada.h"
+
+/**
+ * Protocolo do servidor de multiplicação (servidor_multiplicacao.cpp e
+ * cliente_multiplicacao.cpp).
+ *
+ * O servidor mantém o pool de trabalhadores e as matrizes usadas há pouco
+ * na memória e atende pedidos por um socket Unix local (SOCK_STREAM). Cada
+ * pedido e cada resposta são uma estrutura de tamanho fixo; uma conexão
+ * pode enviar vários pedidos em sequência. Cliente e servidor rodam na
+ * mesma máquina, então as estruturas vão como estão na memória.
+ *
+ * As entradas são caminhos de arquivo (.txt ou .bin) ou "shm:/NOME", um
+ * objeto de memória compartilhada POSIX no formato .bin (cabeçalho e
+ * linhas), mapeado sem cópia. O resultado é gravado no arquivo pedido ou,
+ * se nenhum for dado, devolvido sem cópia: a resposta traz o
+ * DescritorMatriz de C em memória compartilhada, que o cliente mapeia. C
+ * continua válido até o próximo pedido da mesma conexão ou até o fim dela.
+ */
+
+const uint32_t MAGICA_SERVICO = 0x4d554c54;  // "MULT"
+const char* const SOCKET_SERVICO_PADRAO = "multiplicacao.sock";
+const int ESPERA_ENVIO_SERVICO_MS = 5000;  // limite para o outro lado liberar espaço no socket
+
+enum OperacaoServico : int32_t {
+    OP_MULTIPLICAR = 1,
+    OP_ESTATISTICAS = 2,  // resumo de latência e vazão do servidor, em texto
+    OP_ENCERRAR = 3
+};
+
+struct PedidoServico {
+    uint32_t magica;
+    int32_t operacao;
+    char entradaA[256];  // arquivo ou "shm:/NOME"
+    char entradaB[256];
+    char saida[256];     // arquivo para C; vazio = C em memória compartilhada
+    int32_t vetoresVerificacao;  // Freivalds (0 = sem verificação)
+};
+
+struct RespostaServico {
+    uint32_t magica;
+    int32_t ok;
+    uint64_t numeroPedido;
+    DescritorMatriz resultado;  // válido se ok e sem arquivo de saída
+    int32_t entradasEmCache;    // quantas entradas já estavam na memória (0 a 2)
+    double msCarga;
+    double msCalculo;
+    double msVerificacao;
+    double msGravacao;
+    double msTotal;  // do recebimento do pedido ao envio da resposta
+    char texto[2048];  // erro, ou as estatísticas de OP_ESTATISTICAS
+};
+
+// Endereço do socket; false se o caminho não couber em sun_path
+inline bool enderecoServico(const std::string& caminho, sockaddr_un& endereco) {
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    if (caminho.empty() || caminho.size() >= sizeof(endereco.sun_path)) {
+        std::cerr << "Erro: Caminho de socket inválido: " << caminho << std::endl;
+        return false;
+    }
+    strcpy(endereco.sun_path, caminho.c_str());
+    return true;
+}
+
+// Copia `texto` para um campo de tamanho fixo; false se não couber
+inline bool copiarCampo(char* campo, size_t tamanho, const std::string& texto) {
+    if (texto.size() >= tamanho) {
+        return false;
+    }
+    memset(campo, 0, tamanho);
+    memcpy(campo, texto.c_str(), texto.size());
+    return true;
+}
+
+// Envia e recebe uma estrutura inteira; false se a conexão fechar ou falhar
+inline bool enviarTudo(int fd, const void* dados, size_t bytes) {
+    const char* p = static_cast<const char*>(dados);
+    while (bytes > 0) {
+        ssize_t n = send(fd, p, bytes, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Socket não bloqueante (lado do servidor): espera o cliente ler, com limite
+            pollfd espera = { fd, POLLOUT, 0 };
+            int prontos = poll(&espera, 1, ESPERA_ENVIO_SERVICO_MS);
+            if (prontos > 0 || (prontos < 0 && errno == EINTR)) {
+                continue;
+            }
+            return false;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        bytes -= (size_t)n;
+    }
+    return true;
+}
+
+inline bool receberTudo(int fd, void* dados, size_t bytes) {
+    char* p = static_cast<char*>(dados);
+    while (bytes > 0) {
+        ssize_t n = recv(fd, p, bytes, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        bytes -= (size_t)n;
+    }
+    return true;
+}
+
+// Versão sem bloqueio de receberTudo: lê o que já chegou da estrutura e
+// acumula em `recebidos`, que indica a estrutura completa ao chegar a
+// `bytes`. False se a conexão fechar ou falhar.
+inline bool receberDisponivel(int fd, void* dados, size_t bytes, size_t& recebidos) {
+    char* p = static_cast<char*>(dados);
+    while (recebidos < bytes) {
+        ssize_t n = recv(fd, p + recebidos, bytes - recebidos, MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        recebidos += (size_t)n;
+    }
+    return true;
+}
+
+#endif
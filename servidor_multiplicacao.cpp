@@ -0,0 +1,532 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <fcntl.h>
+#include <memory>
+#include <poll.h>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+#include "afinidade.h"
+#include "ajuste.h"
+#include "matriz.h"
+#include "multiplicacao.h"
+#include "opcoes.h"
+#include "servico.h"
+#include "verificacao.h"
+
+using namespace std;
+
+/**
+ * Servidor de multiplicação residente (protocolo em servico.h).
+ *
+ * Uso: ./servidor_multiplicacao [P] [--backend=threads|processos|sequencial]
+ *      [--socket=CAMINHO] [--residentes=N] [opções de bloco e --algo]
+ *
+ * Cada execução dos programas de multiplicação paga o custo de partida:
+ * criar o processo, ler as matrizes, criar as threads ou os processos e
+ * desfazer tudo no fim. O servidor cria o pool (threads, ou processos com
+ * prefork) uma única vez e mantém as últimas N entradas carregadas
+ * (--residentes, padrão 8), validadas pelo inode, tamanho e data de
+ * modificação do arquivo. Os pedidos são atendidos um de cada vez, todos
+ * com o pool inteiro; várias conexões podem estar abertas ao mesmo tempo.
+ *
+ * Para cada pedido é impressa uma linha com os tempos de carga, cálculo,
+ * verificação e gravação; o resumo de latência e vazão é pedido com
+ * cliente_multiplicacao --estatisticas. SIGINT e SIGTERM encerram o
+ * servidor, removendo o socket e a memória compartilhada.
+ */
+
+static volatile sig_atomic_t sinalEncerrar = 0;
+
+static void tratarSinal(int) {
+    sinalEncerrar = 1;
+}
+
+// Milissegundos entre dois instantes
+static double msEntre(chrono::steady_clock::time_point inicio, chrono::steady_clock::time_point fim) {
+    return chrono::duration<double, milli>(fim - inicio).count();
+}
+
+// Entradas carregadas, reaproveitadas enquanto o arquivo não mudar
+class EntradasResidentes {
+private:
+    struct Entrada {
+        string nome;  // como veio no pedido
+        dev_t dispositivo;
+        ino_t inode;
+        off_t tamanho;
+        long long modificacaoNs;
+        unique_ptr<MatrizDensa> matriz;
+        uint64_t ultimoUso;
+    };
+
+    vector<Entrada> entradas;
+    size_t capacidade;
+    bool compartilhada;  // entradas texto em memória compartilhada (pool de processos)
+    uint64_t relogio;
+
+    // Caminho do arquivo: "shm:/NOME" é o objeto em /dev/shm
+    static string caminhoDe(const string& nome) {
+        if (nome.compare(0, 4, "shm:") != 0) {
+            return nome;
+        }
+        size_t inicio = nome.find_first_not_of('/', 4);
+        return "/dev/shm/" + (inicio == string::npos ? string() : nome.substr(inicio));
+    }
+
+    static unique_ptr<MatrizDensa> carregar(const string& nome, const string& caminho, bool compartilhada,
+                                            string& erro) {
+        // Objetos de memória compartilhada estão sempre no formato .bin
+        bool binario = caminho != nome || ehArquivoBinario(caminho);
+        int dimensao = -1;
+        if (binario) {
+            CabecalhoMatrizBinaria cab;
+            if (lerCabecalhoBinario(caminho, cab) && cab.linhas == cab.colunas) {
+                dimensao = (int)cab.linhas;
+            }
+        } else {
+            dimensao = lerDimensaoArquivo(caminho);
+        }
+        if (dimensao <= 0) {
+            erro = "não foi possível ler uma matriz quadrada de " + nome;
+            return unique_ptr<MatrizDensa>();
+        }
+
+        // Arquivos .bin são mapeados sem cópia (ver MatrizDensa::carregarDeArquivoBinario)
+        unique_ptr<MatrizDensa> m(compartilhada && !binario
+                                      ? new MatrizDensa(dimensao, dimensao, true, nomeCompartilhadoUnico("servidor"))
+                                      : new MatrizDensa(dimensao, dimensao, true, SemInicializar()));
+        bool ok = binario ? m->carregarDeArquivoBinario(caminho) : m->carregarDeArquivo(caminho);
+        if (!ok) {
+            erro = "falha ao carregar " + nome;
+            return unique_ptr<MatrizDensa>();
+        }
+        return m;
+    }
+
+public:
+    EntradasResidentes(size_t n, bool memoriaCompartilhada)
+        : capacidade(n), compartilhada(memoriaCompartilhada), relogio(0) {}
+
+    // Matriz da entrada `nome`, carregada se preciso; `protegida` não é
+    // descartada para abrir espaço (a outra entrada do mesmo pedido)
+    const MatrizDensa* obter(const string& nome, const MatrizDensa* protegida, bool& emCache, string& erro) {
+        string caminho = caminhoDe(nome);
+        struct stat info;
+        if (stat(caminho.c_str(), &info) != 0) {
+            erro = "entrada inexistente: " + nome;
+            return nullptr;
+        }
+        long long modificacao = (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+
+        relogio++;
+        for (size_t i = 0; i < entradas.size(); i++) {
+            Entrada& e = entradas[i];
+            if (e.nome != nome) {
+                continue;
+            }
+            if (e.dispositivo == info.st_dev && e.inode == info.st_ino && e.tamanho == info.st_size &&
+                e.modificacaoNs == modificacao) {
+                e.ultimoUso = relogio;
+                emCache = true;
+                return e.matriz.get();
+            }
+            // O arquivo mudou: a versão antiga é descartada
+            if (e.matriz.get() == protegida) {
+                erro = "a entrada " + nome + " mudou durante o pedido";
+                return nullptr;
+            }
+            entradas.erase(entradas.begin() + i);
+            break;
+        }
+
+        emCache = false;
+        Entrada nova;
+        nova.nome = nome;
+        nova.dispositivo = info.st_dev;
+        nova.inode = info.st_ino;
+        nova.tamanho = info.st_size;
+        nova.modificacaoNs = modificacao;
+        nova.ultimoUso = relogio;
+        nova.matriz = carregar(nome, caminho, compartilhada, erro);
+        if (!nova.matriz) {
+            return nullptr;
+        }
+        // Descarta as usadas há mais tempo
+        while (entradas.size() >= capacidade) {
+            size_t antiga = entradas.size();
+            for (size_t i = 0; i < entradas.size(); i++) {
+                if (entradas[i].matriz.get() != protegida &&
+                    (antiga == entradas.size() || entradas[i].ultimoUso < entradas[antiga].ultimoUso)) {
+                    antiga = i;
+                }
+            }
+            if (antiga == entradas.size()) {
+                break;
+            }
+            entradas.erase(entradas.begin() + antiga);
+        }
+        entradas.push_back(std::move(nova));
+        return entradas.back().matriz.get();
+    }
+
+    size_t quantidade() const { return entradas.size(); }
+    size_t limite() const { return capacidade; }
+};
+
+// Uma conexão aberta e o resultado do seu último pedido, mantido até o próximo
+struct Conexao {
+    int fd;
+    unique_ptr<MatrizDensa> resultado;
+    PedidoServico pedido;  // pedido em recepção, que pode chegar aos pedaços
+    size_t recebidos;      // bytes de `pedido` já recebidos
+};
+
+class Servidor {
+private:
+    string backend;
+    const ParametrosBloco& blocos;
+    const ParametrosStrassen& algo;
+    unique_ptr<PoolThreads> poolThreads;
+    unique_ptr<MultiplicadorThreads> multiplicador;
+    unique_ptr<PoolProcessos> poolProcessos;
+    BuffersGemm buffers;
+    EntradasResidentes residentes;
+
+    // Estatísticas
+    uint64_t pedidos;
+    uint64_t falhas;
+    uint64_t entradasEmCache;
+    vector<double> latencias;
+    vector<double> calculos;
+    chrono::steady_clock::time_point inicioServico;
+    double msOcupado;
+
+    bool multiplicar(const MatrizDensa& a, const MatrizDensa& b, MatrizDensa& c) {
+        if (poolThreads) {
+            multiplicador->multiplicar(a, b, c, blocos, algo, false);
+            return true;
+        }
+        if (poolProcessos) {
+            return poolProcessos->ok() && multiplicarComProcessos(a, b, c, *poolProcessos, blocos, algo, false);
+        }
+        multiplicarSequencial(a, b, c, blocos, algo, buffers);
+        return true;
+    }
+
+    static string percentis(vector<double> v) {
+        if (v.empty()) {
+            return "-";
+        }
+        sort(v.begin(), v.end());
+        double soma = 0.0;
+        for (double x : v) {
+            soma += x;
+        }
+        char texto[160];
+        snprintf(texto, sizeof(texto), "mín %.3f, mediana %.3f, p95 %.3f, máx %.3f, média %.3f", v.front(),
+                 v[v.size() / 2], v[(size_t)ceil(0.95 * v.size()) - 1], v.back(), soma / v.size());
+        return texto;
+    }
+
+public:
+    Servidor(const string& nomeBackend, int p, const vector<int>& cpus, const ParametrosBloco& b,
+             const ParametrosStrassen& s, size_t numResidentes)
+        : backend(nomeBackend), blocos(b), algo(s), residentes(numResidentes, nomeBackend == "processos"),
+          pedidos(0), falhas(0), entradasEmCache(0), inicioServico(chrono::steady_clock::now()), msOcupado(0.0) {
+        if (backend == "threads") {
+            poolThreads.reset(new PoolThreads(p, cpus));
+            multiplicador.reset(new MultiplicadorThreads(*poolThreads));
+        } else if (backend == "processos") {
+            poolProcessos.reset(new PoolProcessos(p, cpus));
+        }
+    }
+
+    bool ok() const { return !poolProcessos || poolProcessos->ok(); }
+
+    void multiplicarPedido(const PedidoServico& pedido, Conexao& conexao, RespostaServico& resposta) {
+        auto inicio = chrono::steady_clock::now();
+        resposta.numeroPedido = ++pedidos;
+        // O resultado anterior desta conexão deixa de valer
+        conexao.resultado.reset();
+
+        auto inicioCarga = chrono::steady_clock::now();
+        string erro;
+        bool emCacheA = false, emCacheB = false;
+        const MatrizDensa* a = residentes.obter(pedido.entradaA, nullptr, emCacheA, erro);
+        const MatrizDensa* b = a ? residentes.obter(pedido.entradaB, a, emCacheB, erro) : nullptr;
+        resposta.entradasEmCache = (int)emCacheA + (int)emCacheB;
+        if (b != nullptr && a->getColunas() != b->getLinhas()) {
+            erro = "dimensões incompatíveis";
+            b = nullptr;
+        }
+        auto fimCarga = chrono::steady_clock::now();
+        resposta.msCarga = msEntre(inicioCarga, fimCarga);
+
+        bool ok = b != nullptr;
+        string saida = pedido.saida;
+        if (ok) {
+            int n = a->getLinhas();
+            // C fica em memória compartilhada para o pool de processos ou para o cliente
+            bool compartilhada = saida.empty() || poolProcessos;
+            unique_ptr<MatrizDensa> c(compartilhada ? new MatrizDensa(n, n, true, nomeCompartilhadoUnico("servidor"))
+                                                    : new MatrizDensa(n, n, true, SemInicializar()));
+            auto inicioCalculo = chrono::steady_clock::now();
+            ok = multiplicar(*a, *b, *c);
+            auto fimCalculo = chrono::steady_clock::now();
+            resposta.msCalculo = msEntre(inicioCalculo, fimCalculo);
+            if (!ok) {
+                erro = "falha na multiplicação";
+            }
+
+            if (ok && pedido.vetoresVerificacao > 0) {
+                ParametrosVerificacao verificacao;
+                verificacao.vetores = pedido.vetoresVerificacao;
+                ok = verificarProduto(*a, *b, *c, verificacao);
+                resposta.msVerificacao = msEntre(fimCalculo, chrono::steady_clock::now());
+                if (!ok) {
+                    erro = "a verificação de Freivalds falhou";
+                }
+            }
+
+            auto inicioGravacao = chrono::steady_clock::now();
+            if (ok && !saida.empty()) {
+                ok = c->salvar(saida);
+                if (!ok) {
+                    erro = "falha ao gravar " + saida;
+                }
+            } else if (ok) {
+                ok = c->descrever(resposta.resultado);
+                conexao.resultado = std::move(c);
+            }
+            resposta.msGravacao = msEntre(inicioGravacao, chrono::steady_clock::now());
+        }
+
+        resposta.ok = ok;
+        if (!ok) {
+            falhas++;
+            copiarCampo(resposta.texto, sizeof(resposta.texto), erro.substr(0, sizeof(resposta.texto) - 1));
+        }
+        entradasEmCache += resposta.entradasEmCache;
+        resposta.msTotal = msEntre(inicio, chrono::steady_clock::now());
+        msOcupado += resposta.msTotal;
+        // As estatísticas de latência são só dos pedidos atendidos
+        if (ok) {
+            latencias.push_back(resposta.msTotal);
+            calculos.push_back(resposta.msCalculo);
+        }
+
+        if (ok) {
+            int n = a->getLinhas();
+            double gflops = resposta.msCalculo > 0.0 ? 2.0 * n * n * n / (resposta.msCalculo * 1e6) : 0.0;
+            printf("Pedido %llu: %dx%d, %d/2 entradas em memória, carga %.3f ms, cálculo %.3f ms (%.2f GFLOP/s), "
+                   "verificação %.3f ms, gravação %.3f ms, total %.3f ms\n",
+                   (unsigned long long)resposta.numeroPedido, n, n, resposta.entradasEmCache, resposta.msCarga,
+                   resposta.msCalculo, gflops, resposta.msVerificacao, resposta.msGravacao, resposta.msTotal);
+        } else {
+            printf("Pedido %llu: erro: %s\n", (unsigned long long)resposta.numeroPedido, erro.c_str());
+        }
+        fflush(stdout);
+    }
+
+    string estatisticas() const {
+        double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicioServico).count();
+        char texto[512];
+        snprintf(texto, sizeof(texto),
+                 "Backend: %s; %llu pedido(s), %llu com erro, em %.1f s (%.2f pedidos/s; ocupado %.1f%% do tempo)\n"
+                 "Entradas já na memória: %llu de %llu; residentes: %zu de %zu\n",
+                 backend.c_str(), (unsigned long long)pedidos, (unsigned long long)falhas, segundos,
+                 segundos > 0.0 ? pedidos / segundos : 0.0, segundos > 0.0 ? msOcupado / (10.0 * segundos) : 0.0,
+                 (unsigned long long)entradasEmCache, (unsigned long long)(2 * pedidos), residentes.quantidade(),
+                 residentes.limite());
+        return string(texto) + "Latência no servidor (ms): " + percentis(latencias) + "\n" +
+               "Cálculo (ms): " + percentis(calculos) + "\n";
+    }
+};
+
+// Cria o socket de escuta; um socket antigo só é removido se ninguém o atender
+int abrirSocket(const string& caminho) {
+    sockaddr_un endereco;
+    if (!enderecoServico(caminho, endereco)) {
+        return -1;
+    }
+    int teste = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (teste >= 0 && connect(teste, (sockaddr*)&endereco, sizeof(endereco)) == 0) {
+        cerr << "Erro: Já há um servidor atendendo em " << caminho << endl;
+        close(teste);
+        return -1;
+    }
+    if (teste >= 0) {
+        close(teste);
+    }
+    unlink(caminho.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || bind(fd, (sockaddr*)&endereco, sizeof(endereco)) != 0 || listen(fd, 16) != 0) {
+        cerr << "Erro ao abrir o socket " << caminho << ": " << strerror(errno) << endl;
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char* argv[]) {
+    Opcoes opcoes(argc, argv);
+    if (!opcoes.aceitarApenas({ParametrosBloco::nomesOpcoes(), ParametrosStrassen::nomesOpcoes(),
+                               "ajuda,ajuste,backend,fixos,kernel,numa,paginas-grandes,pin,residentes,socket"})) {
+        return 1;
+    }
+    if (opcoes.numPosicionais() > 1 || opcoes.tem("ajuda")) {
+        cout << "Uso: " << argv[0] << " [num_trabalhadores] [opções]" << endl;
+        cout << "Opções: --backend=threads|processos|sequencial  (padrão threads)" << endl;
+        cout << "        --socket=CAMINHO               socket Unix (padrão multiplicacao.sock)" << endl;
+        cout << "        --residentes=N                 entradas mantidas na memória (padrão 8)" << endl;
+        cout << "        --mc=N --kc=N --nc=N --tile=LxC --kernel=... --fixos=auto|nao --algo=... --crossover=N" << endl;
+        cout << "        --paginas-grandes=auto|thp|hugetlb|nao  páginas grandes para matrizes e buffers" << endl;
+        cout << "        --pin=compact|scatter|LISTA --numa=interleave|local" << endl;
+        cout << "        --ajuste=ARQUIVO|nao           cache de benchmark_multiplicacao --autotune, usado sem P" << endl;
+        cout << "Exemplo: " << argv[0] << " 4 --backend=processos" << endl;
+        return 1;
+    }
+
+    string backend = opcoes.texto("backend", "threads");
+    string caminhoSocket = opcoes.texto("socket", SOCKET_SERVICO_PADRAO);
+    int residentes = opcoes.inteiro("residentes", 8);
+    int p = opcoes.numPosicionais() == 1 ? atoi(opcoes.posicional(0).c_str()) : 0;
+    ParametrosBloco blocos = ParametrosBloco::deOpcoes(opcoes);
+    ParametrosStrassen algo;
+
+    if (backend != "threads" && backend != "processos" && backend != "sequencial") {
+        cerr << "Erro: Backend desconhecido: " << backend << " (use threads, processos ou sequencial)" << endl;
+        return 1;
+    }
+    if (opcoes.numPosicionais() == 1 && p <= 0) {
+        cerr << "Erro: O número de trabalhadores deve ser um número positivo." << endl;
+        return 1;
+    }
+    if (residentes <= 0) {
+        cerr << "Erro: O número de entradas residentes deve ser positivo." << endl;
+        return 1;
+    }
+    // O ajuste é por tamanho, que só se conhece nos pedidos; sem P, usa o número de CPUs
+    aplicarAjuste(opcoes, backend, 0, p, blocos);
+    if (backend == "sequencial") {
+        p = 1;
+    }
+
+    vector<int> cpus;
+    if (!blocos.validar() || !selecionarMicroKernel(opcoes.texto("kernel", "auto")) ||
+        !selecionarKernelsFixos(opcoes.texto("fixos", "auto")) || !ParametrosStrassen::deOpcoes(opcoes, algo) ||
+        !selecionarPaginasGrandes(opcoes.texto("paginas-grandes", "auto")) ||
+        !planejarAfinidade(opcoes.texto("pin", ""), p, cpus) || !aplicarPoliticaNuma(opcoes.texto("numa", ""))) {
+        return 1;
+    }
+
+    // Pool criado antes do socket: os processos filhos não herdam as conexões
+    Servidor servidor(backend, p, cpus, blocos, algo, (size_t)residentes);
+    if (!servidor.ok()) {
+        return 1;
+    }
+    int escuta = abrirSocket(caminhoSocket);
+    if (escuta < 0) {
+        return 1;
+    }
+
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = tratarSinal;
+    sigaction(SIGINT, &acao, nullptr);
+    sigaction(SIGTERM, &acao, nullptr);
+
+    cout << "Servidor de multiplicação em " << caminhoSocket << " (backend " << backend << ", P = " << p
+         << ", até " << residentes << " entradas residentes)" << endl;
+    cout << "Kernel: " << microKernel().nome << endl;
+    imprimirAlgoritmo(algo);
+    fflush(stdout);
+
+    vector<Conexao> conexoes;
+    bool encerrar = false;
+    while (!encerrar && !sinalEncerrar) {
+        vector<pollfd> fds(1 + conexoes.size());
+        fds[0].fd = escuta;
+        fds[0].events = POLLIN;
+        for (size_t i = 0; i < conexoes.size(); i++) {
+            fds[i + 1].fd = conexoes[i].fd;
+            fds[i + 1].events = POLLIN;
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            cerr << "Erro em poll: " << strerror(errno) << endl;
+            break;
+        }
+
+        // Pedidos das conexões abertas, na ordem em que aparecem
+        for (size_t i = conexoes.size(); i-- > 0;) {
+            if (fds[i + 1].revents == 0) {
+                continue;
+            }
+            // Os sockets das conexões não bloqueiam: um cliente que parou no
+            // meio de um pedido não trava o laço, e o resto chega depois
+            Conexao& conexao = conexoes[i];
+            bool manter = receberDisponivel(conexao.fd, &conexao.pedido, sizeof(conexao.pedido), conexao.recebidos);
+            if (manter && conexao.recebidos == sizeof(conexao.pedido)) {
+                conexao.recebidos = 0;
+                PedidoServico& pedido = conexao.pedido;
+                RespostaServico resposta;
+                memset(&resposta, 0, sizeof(resposta));
+                resposta.magica = MAGICA_SERVICO;
+                manter = pedido.magica == MAGICA_SERVICO;
+                if (manter) {
+                    pedido.entradaA[sizeof(pedido.entradaA) - 1] = '\0';
+                    pedido.entradaB[sizeof(pedido.entradaB) - 1] = '\0';
+                    pedido.saida[sizeof(pedido.saida) - 1] = '\0';
+                    if (pedido.operacao == OP_MULTIPLICAR) {
+                        servidor.multiplicarPedido(pedido, conexao, resposta);
+                    } else if (pedido.operacao == OP_ESTATISTICAS) {
+                        resposta.ok = 1;
+                        copiarCampo(resposta.texto, sizeof(resposta.texto), servidor.estatisticas());
+                    } else if (pedido.operacao == OP_ENCERRAR) {
+                        resposta.ok = 1;
+                        encerrar = true;
+                    } else {
+                        copiarCampo(resposta.texto, sizeof(resposta.texto), "operação desconhecida");
+                    }
+                    manter = enviarTudo(conexao.fd, &resposta, sizeof(resposta));
+                }
+            }
+            if (!manter) {
+                close(conexoes[i].fd);
+                conexoes.erase(conexoes.begin() + i);
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(escuta, nullptr, nullptr);
+            if (fd >= 0) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                Conexao conexao;
+                conexao.fd = fd;
+                memset(&conexao.pedido, 0, sizeof(conexao.pedido));
+                conexao.recebidos = 0;
+                conexoes.push_back(std::move(conexao));
+            }
+        }
+    }
+
+    for (Conexao& conexao : conexoes) {
+        close(conexao.fd);
+    }
+    close(escuta);
+    unlink(caminhoSocket.c_str());
+    cout << servidor.estatisticas();
+    cout << "Servidor encerrado." << endl;
+    return 0;
+}
@@ -0,0 +1,511 @@
+#ifndef STRASSEN_H
+#define STRASSEN_H
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "gemm.h"
+#include "matriz.h"
+#include "memoria_compartilhada.h"
+#include "opcoes.h"
+
+/**
+ * Multiplicação recursiva de Strassen e variante de Winograd.
+ *
+ * C é dividido em quadrantes e calculado com 7 produtos de meia dimensão em
+ * vez de 8. A recursão para quando alguma dimensão fica menor ou igual ao
+ * crossover (--crossover, padrão 2048) e então usa o kernel clássico de
+ * gemm.h. Dimensões ímpares são tratadas por descascamento: a parte par é
+ * calculada recursivamente e a última linha/coluna/termo interno, com gemm.
+ *
+ * Versão sequencial: strassenSequencial(), que escreve C = A * B usando três
+ * matrizes temporárias por nível, tiradas da arena da thread (memoria.h): depois
+ * da primeira chamada, as seguintes não alocam. A variante de Winograd segue o
+ * escalonamento de 22 passos de Boyer et al., com 15 somas por nível (a de
+ * Strassen usa 18).
+ *
+ * Versão paralela: PlanoStrassen monta os operandos dos 7 produtos do
+ * primeiro nível (ou dos 49 dos dois primeiros níveis) em matrizes
+ * temporárias, na arena da thread que monta o plano ou, para o pool de
+ * processos, em memória compartilhada (reaproveitada entre chamadas, ver
+ * ReservaCompartilhada). Cada produto é uma tarefa independente, resolvida com
+ * strassenSequencial() por uma thread ou processo; depois o plano combina os
+ * produtos em C.
+ */
+
+enum AlgoritmoMultiplicacao {
+    ALGO_CLASSICO,
+    ALGO_STRASSEN,
+    ALGO_WINOGRAD
+};
+
+struct ParametrosStrassen {
+    AlgoritmoMultiplicacao algoritmo;
+    int crossover;  // abaixo (ou igual) disso, usa o kernel clássico
+
+    ParametrosStrassen() : algoritmo(ALGO_CLASSICO), crossover(2048) {}
+
+    // Opções deste grupo, para Opcoes::aceitarApenas
+    static const char* nomesOpcoes() { return "algo,crossover"; }
+
+    // Lê --algo=classico|strassen|winograd e --crossover=N
+    static bool deOpcoes(const Opcoes& opcoes, ParametrosStrassen& p) {
+        std::string algo = opcoes.texto("algo", "classico");
+        if (algo == "classico") {
+            p.algoritmo = ALGO_CLASSICO;
+        } else if (algo == "strassen") {
+            p.algoritmo = ALGO_STRASSEN;
+        } else if (algo == "winograd") {
+            p.algoritmo = ALGO_WINOGRAD;
+        } else {
+            std::cerr << "Erro: Algoritmo desconhecido: " << algo
+                      << " (use classico, strassen ou winograd)" << std::endl;
+            return false;
+        }
+        p.crossover = opcoes.inteiro("crossover", p.crossover);
+        if (p.crossover < 2) {
+            std::cerr << "Erro: O crossover (--crossover) deve ser pelo menos 2." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    const char* nome() const {
+        return algoritmo == ALGO_STRASSEN ? "Strassen" : algoritmo == ALGO_WINOGRAD ? "Winograd" : "clássico";
+    }
+
+    // Vale dividir um produto m x k x n em quadrantes?
+    bool deveRecursar(int m, int k, int n) const {
+        return algoritmo != ALGO_CLASSICO && std::min(m, std::min(k, n)) > crossover;
+    }
+};
+
+// z = x + sinal * y (z pode ser a mesma região que x ou y)
+inline void somarMatrizes(VisaoMatriz z, VisaoMatrizConst x, VisaoMatrizConst y, double sinal) {
+    for (int i = 0; i < z.linhas; i++) {
+        double* lz = z.linha(i);
+        const double* lx = x.linha(i);
+        const double* ly = y.linha(i);
+        for (int j = 0; j < z.colunas; j++) {
+            lz[j] = lx[j] + sinal * ly[j];
+        }
+    }
+}
+
+// z = coef * x, ou z += coef * x se `acumular` (z pode ser a mesma região que x)
+inline void escalarMatriz(VisaoMatriz z, VisaoMatrizConst x, double coef, bool acumular) {
+    for (int i = 0; i < z.linhas; i++) {
+        double* lz = z.linha(i);
+        const double* lx = x.linha(i);
+        if (acumular) {
+            for (int j = 0; j < z.colunas; j++) {
+                lz[j] += coef * lx[j];
+            }
+        } else {
+            for (int j = 0; j < z.colunas; j++) {
+                lz[j] = coef * lx[j];
+            }
+        }
+    }
+}
+
+// z = soma de coef[q] * quadrante[q], ignorando coeficientes nulos
+inline void combinarQuadrantes(VisaoMatriz z, const VisaoMatrizConst quadrantes[], const double coef[], int numQuadrantes) {
+    bool iniciado = false;
+    for (int q = 0; q < numQuadrantes; q++) {
+        if (coef[q] != 0.0) {
+            escalarMatriz(z, quadrantes[q], coef[q], iniciado);
+            iniciado = true;
+        }
+    }
+    if (!iniciado) {
+        zerar(z);
+    }
+}
+
+// Completa C = A * B quando apenas a parte par (m2 x k2 x n2) foi calculada
+inline void corrigirBordas(VisaoMatrizConst a, VisaoMatrizConst b, VisaoMatriz c, int m2, int k2, int n2,
+                           const ParametrosBloco& blocos, BuffersGemm& buffers) {
+    int m = c.linhas, k = a.colunas, n = c.colunas;
+    if (k2 < k) {
+        gemmAcumular(a.sub(0, k2, m2, k - k2), b.sub(k2, 0, k - k2, n2), c.sub(0, 0, m2, n2), blocos, buffers);
+    }
+    if (n2 < n) {
+        gemm(a, b.sub(0, n2, k, n - n2), c.sub(0, n2, m, n - n2), blocos, buffers);
+    }
+    if (m2 < m) {
+        gemm(a.sub(m2, 0, m - m2, k), b.sub(0, 0, k, n2), c.sub(m2, 0, m - m2, n2), blocos, buffers);
+    }
+}
+
+// Coeficientes dos 7 produtos sobre os quadrantes (ordem 11, 12, 21, 22):
+// Mi = (soma de COEF_A[i][q] * Aq) * (soma de COEF_B[i][q] * Bq), e
+// Cq = soma de COEF_C[q][i] * Mi.
+const double COEF_STRASSEN_A[7][4] = {
+    { 1, 0, 0, 1 }, { 0, 0, 1, 1 }, { 1, 0, 0, 0 }, { 0, 0, 0, 1 },
+    { 1, 1, 0, 0 }, { -1, 0, 1, 0 }, { 0, 1, 0, -1 } };
+const double COEF_STRASSEN_B[7][4] = {
+    { 1, 0, 0, 1 }, { 1, 0, 0, 0 }, { 0, 1, 0, -1 }, { -1, 0, 1, 0 },
+    { 0, 0, 0, 1 }, { 1, 1, 0, 0 }, { 0, 0, 1, 1 } };
+const double COEF_STRASSEN_C[4][7] = {
+    { 1, 0, 0, 1, -1, 0, 1 }, { 0, 0, 1, 0, 1, 0, 0 },
+    { 0, 1, 0, 1, 0, 0, 0 }, { 1, -1, 1, 0, 0, 1, 0 } };
+
+// Winograd: P1 = A11 B11, P2 = A12 B21, P3 = S4 B22, P4 = A22 T4,
+// P5 = S1 T1, P6 = S2 T2, P7 = S3 T3, com os Si e Ti expandidos
+const double COEF_WINOGRAD_A[7][4] = {
+    { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 1, 1, -1, -1 }, { 0, 0, 0, 1 },
+    { 0, 0, 1, 1 }, { -1, 0, 1, 1 }, { 1, 0, -1, 0 } };
+const double COEF_WINOGRAD_B[7][4] = {
+    { 1, 0, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 }, { 1, -1, -1, 1 },
+    { -1, 1, 0, 0 }, { 1, -1, 0, 1 }, { 0, -1, 0, 1 } };
+const double COEF_WINOGRAD_C[4][7] = {
+    { 1, 1, 0, 0, 0, 0, 0 }, { 1, 0, 1, 0, 1, 1, 0 },
+    { 1, 0, 0, -1, 0, 1, 1 }, { 1, 0, 0, 0, 1, 1, 1 } };
+
+inline void quadrantes(VisaoMatrizConst x, int mh, int nh, VisaoMatrizConst q[4]) {
+    q[0] = x.sub(0, 0, mh, nh);
+    q[1] = x.sub(0, nh, mh, nh);
+    q[2] = x.sub(mh, 0, mh, nh);
+    q[3] = x.sub(mh, nh, mh, nh);
+}
+
+inline void quadrantes(VisaoMatriz x, int mh, int nh, VisaoMatriz q[4]) {
+    q[0] = x.sub(0, 0, mh, nh);
+    q[1] = x.sub(0, nh, mh, nh);
+    q[2] = x.sub(mh, 0, mh, nh);
+    q[3] = x.sub(mh, nh, mh, nh);
+}
+
+// C = A * B, recursivo até o crossover, na thread/processo chamador
+inline void strassenSequencial(VisaoMatrizConst a, VisaoMatrizConst b, VisaoMatriz c,
+                               const ParametrosStrassen& ps, const ParametrosBloco& blocos,
+                               BuffersGemm& buffers) {
+    int m = c.linhas, k = a.colunas, n = c.colunas;
+    if (!ps.deveRecursar(m, k, n)) {
+        gemm(a, b, c, blocos, buffers);
+        return;
+    }
+
+    int mh = m / 2, kh = k / 2, nh = n / 2;
+    VisaoMatrizConst qa[4], qb[4];
+    VisaoMatriz qc[4];
+    quadrantes(a, mh, kh, qa);
+    quadrantes(b, kh, nh, qb);
+    quadrantes(c, mh, nh, qc);
+
+    // Temporárias na arena da thread, devolvidas no fim desta chamada
+    EscopoArena escopo;
+    MatrizDensa tx(mh, kh, true, arenaDaThread());
+    MatrizDensa ty(kh, nh, true, arenaDaThread());
+    MatrizDensa tz(mh, nh, true, arenaDaThread());
+    VisaoMatriz x = tx.visao(), y = ty.visao(), z = tz.visao();
+
+    if (ps.algoritmo == ALGO_WINOGRAD) {
+        somarMatrizes(x, qa[0], qa[2], -1.0);                   // S3 = A11 - A21
+        somarMatrizes(y, qb[3], qb[1], -1.0);                   // T3 = B22 - B12
+        strassenSequencial(x, y, qc[2], ps, blocos, buffers);   // P7 -> C21
+        somarMatrizes(x, qa[2], qa[3], 1.0);                    // S1 = A21 + A22
+        somarMatrizes(y, qb[1], qb[0], -1.0);                   // T1 = B12 - B11
+        strassenSequencial(x, y, qc[3], ps, blocos, buffers);   // P5 -> C22
+        somarMatrizes(x, x, qa[0], -1.0);                       // S2 = S1 - A11
+        somarMatrizes(y, qb[3], y, -1.0);                       // T2 = B22 - T1
+        strassenSequencial(x, y, qc[1], ps, blocos, buffers);   // P6 -> C12
+        somarMatrizes(x, qa[1], x, -1.0);                       // S4 = A12 - S2
+        strassenSequencial(x, qb[3], qc[0], ps, blocos, buffers);  // P3 -> C11
+        strassenSequencial(qa[0], qb[0], z, ps, blocos, buffers);  // P1
+        somarMatrizes(qc[1], z, qc[1], 1.0);                    // U2 = P1 + P6
+        somarMatrizes(qc[2], qc[1], qc[2], 1.0);                // U3 = U2 + P7
+        somarMatrizes(qc[1], qc[1], qc[3], 1.0);                // U4 = U2 + P5
+        somarMatrizes(qc[3], qc[2], qc[3], 1.0);                // C22 = U3 + P5
+        somarMatrizes(qc[1], qc[1], qc[0], 1.0);                // C12 = U4 + P3
+        somarMatrizes(y, y, qb[2], -1.0);                       // T4 = T2 - B21
+        strassenSequencial(qa[3], y, qc[0], ps, blocos, buffers);  // P4 -> C11
+        somarMatrizes(qc[2], qc[2], qc[0], -1.0);               // C21 = U3 - P4
+        strassenSequencial(qa[1], qb[2], qc[0], ps, blocos, buffers);  // P2 -> C11
+        somarMatrizes(qc[0], qc[0], z, 1.0);                    // C11 = P1 + P2
+    } else {
+        // Cada quadrante de C recebe o primeiro produto em que aparece e
+        // acumula os seguintes (M1 inicia C11 e C22, M2 inicia C21, M3 inicia C12)
+        bool iniciado[4] = { false, false, false, false };
+        for (int i = 0; i < 7; i++) {
+            combinarQuadrantes(x, qa, COEF_STRASSEN_A[i], 4);
+            combinarQuadrantes(y, qb, COEF_STRASSEN_B[i], 4);
+            strassenSequencial(x, y, z, ps, blocos, buffers);
+            for (int q = 0; q < 4; q++) {
+                if (COEF_STRASSEN_C[q][i] != 0.0) {
+                    escalarMatriz(qc[q], z, COEF_STRASSEN_C[q][i], iniciado[q]);
+                    iniciado[q] = true;
+                }
+            }
+        }
+    }
+
+    corrigirBordas(a, b, c, 2 * mh, 2 * kh, 2 * nh, blocos, buffers);
+}
+
+// Região retangular de uma MatrizDensa, que pode ser descrita para outro processo
+struct RegiaoMatriz {
+    const MatrizDensa* matriz;
+    int linha0, coluna0, linhas, colunas;
+
+    RegiaoMatriz() : matriz(nullptr), linha0(0), coluna0(0), linhas(0), colunas(0) {}
+    explicit RegiaoMatriz(const MatrizDensa& m)
+        : matriz(&m), linha0(0), coluna0(0), linhas(m.getLinhas()), colunas(m.getColunas()) {}
+
+    RegiaoMatriz sub(int l0, int c0, int numLinhas, int numColunas) const {
+        RegiaoMatriz r = *this;
+        r.linha0 += l0;
+        r.coluna0 += c0;
+        r.linhas = numLinhas;
+        r.colunas = numColunas;
+        return r;
+    }
+
+    VisaoMatrizConst visao() const {
+        return matriz->visao().sub(linha0, coluna0, linhas, colunas);
+    }
+
+    // As regiões de saída apontam para matrizes não constantes; o ponteiro
+    // é const apenas para que as entradas também possam ser regiões
+    VisaoMatriz visaoEscrita() const {
+        VisaoMatrizConst v = visao();
+        VisaoMatriz e = { const_cast<double*>(v.dados), v.linhas, v.colunas, v.passo };
+        return e;
+    }
+
+    bool descrever(DescritorMatriz& d) const {
+        if (!matriz->descrever(d)) {
+            return false;
+        }
+        d.deslocamento += ((uint64_t)linha0 * d.passo + coluna0) * d.bytesElemento;
+        d.linhas = linhas;
+        d.colunas = colunas;
+        return true;
+    }
+};
+
+// Um produto independente C = A * B do plano
+struct ProdutoStrassen {
+    RegiaoMatriz a, b, c;
+};
+
+// Temporárias em memória compartilhada dos planos do pool de processos. Um
+// plano pega daqui as do formato que precisa e, ao terminar, as devolve; o
+// plano raiz, no fim, descarta as que não foram reaproveitadas. Assim a
+// reserva guarda só as temporárias do último plano, e repetir o mesmo produto
+// não cria objetos shm_open novos. Os nomes (e a geração) também se repetem,
+// e os filhos do pool mantêm seus mapeamentos.
+class ReservaCompartilhada {
+private:
+    std::vector<std::unique_ptr<MatrizDensa>> livres;
+    std::vector<std::unique_ptr<MatrizDensa>> devolvidas;
+
+public:
+    std::unique_ptr<MatrizDensa> obter(int linhas, int colunas) {
+        for (size_t i = 0; i < livres.size(); i++) {
+            if (livres[i]->getLinhas() == linhas && livres[i]->getColunas() == colunas) {
+                std::unique_ptr<MatrizDensa> m = std::move(livres[i]);
+                livres[i] = std::move(livres.back());
+                livres.pop_back();
+                return m;
+            }
+        }
+        return std::unique_ptr<MatrizDensa>(
+            new MatrizDensa(linhas, colunas, true, nomeCompartilhadoUnico("strassen")));
+    }
+
+    void devolver(std::unique_ptr<MatrizDensa> m) { devolvidas.push_back(std::move(m)); }
+
+    // Fim do plano raiz: o que não foi pedido de novo é liberado
+    void concluirPlano() {
+        livres = std::move(devolvidas);
+        devolvidas.clear();
+    }
+};
+
+inline ReservaCompartilhada& reservaCompartilhada() {
+    static ReservaCompartilhada reserva;
+    return reserva;
+}
+
+class PlanoStrassen {
+private:
+    const ParametrosStrassen& ps;
+    RegiaoMatriz a, b, c;
+    int mh, kh, nh;
+    bool compartilhada;
+    bool raiz;  // só o plano raiz conclui a reserva compartilhada
+    ArenaMemoria::Marca inicioArena;  // temporárias locais vêm da arena da thread que monta o plano
+    std::vector<std::unique_ptr<MatrizDensa>> temporarias;
+    RegiaoMatriz x[7], y[7], p[7];
+    std::unique_ptr<PlanoStrassen> subplanos[7];
+
+    RegiaoMatriz novaTemporaria(int linhas, int colunas) {
+        if (compartilhada) {
+            temporarias.push_back(reservaCompartilhada().obter(linhas, colunas));
+        } else {
+            temporarias.emplace_back(new MatrizDensa(linhas, colunas, true, arenaDaThread()));
+        }
+        return RegiaoMatriz(*temporarias.back());
+    }
+
+    // Operando de um produto: o próprio quadrante, se o coeficiente for
+    // único e igual a 1, ou uma temporária com a combinação linear
+    RegiaoMatriz montarOperando(const RegiaoMatriz& origem, int mq, int nq, const double coef[4]) {
+        RegiaoMatriz q[4] = { origem.sub(0, 0, mq, nq), origem.sub(0, nq, mq, nq),
+                              origem.sub(mq, 0, mq, nq), origem.sub(mq, nq, mq, nq) };
+        int usados = 0, unico = 0;
+        for (int i = 0; i < 4; i++) {
+            if (coef[i] != 0.0) {
+                usados++;
+                unico = i;
+            }
+        }
+        if (usados == 1 && coef[unico] == 1.0) {
+            return q[unico];
+        }
+
+        RegiaoMatriz t = novaTemporaria(mq, nq);
+        VisaoMatrizConst vq[4] = { q[0].visao(), q[1].visao(), q[2].visao(), q[3].visao() };
+        combinarQuadrantes(t.visaoEscrita(), vq, coef, 4);
+        return t;
+    }
+
+public:
+    // Monta os operandos de C = A * B. Com `niveis` = 2 cada produto é
+    // dividido mais uma vez (49 produtos), se ainda estiver acima do crossover.
+    PlanoStrassen(const ParametrosStrassen& parametros, const RegiaoMatriz& ra, const RegiaoMatriz& rb,
+                  const RegiaoMatriz& rc, bool memoriaCompartilhada, int niveis)
+        : ps(parametros), a(ra), b(rb), c(rc), mh(rc.linhas / 2), kh(ra.colunas / 2), nh(rc.colunas / 2),
+          compartilhada(memoriaCompartilhada), raiz(true), inicioArena(arenaDaThread().marca()) {
+        bool winograd = ps.algoritmo == ALGO_WINOGRAD;
+        for (int i = 0; i < 7; i++) {
+            x[i] = montarOperando(a, mh, kh, winograd ? COEF_WINOGRAD_A[i] : COEF_STRASSEN_A[i]);
+            y[i] = montarOperando(b, kh, nh, winograd ? COEF_WINOGRAD_B[i] : COEF_STRASSEN_B[i]);
+            p[i] = novaTemporaria(mh, nh);
+            if (niveis > 1 && ps.deveRecursar(mh, kh, nh)) {
+                subplanos[i].reset(new PlanoStrassen(ps, x[i], y[i], p[i], compartilhada, niveis - 1));
+                subplanos[i]->raiz = false;
+            }
+        }
+    }
+
+    // Os subplanos alocaram na arena depois deste plano, então a devolvem antes
+    ~PlanoStrassen() {
+        for (int i = 0; i < 7; i++) {
+            subplanos[i].reset();
+        }
+        if (compartilhada) {
+            for (size_t i = 0; i < temporarias.size(); i++) {
+                reservaCompartilhada().devolver(std::move(temporarias[i]));
+            }
+            if (raiz) {
+                reservaCompartilhada().concluirPlano();
+            }
+        }
+        temporarias.clear();
+        arenaDaThread().restaurar(inicioArena);
+    }
+
+    PlanoStrassen(const PlanoStrassen&) = delete;
+    PlanoStrassen& operator=(const PlanoStrassen&) = delete;
+
+    // Produtos independentes que os trabalhadores devem calcular
+    void coletarProdutos(std::vector<ProdutoStrassen>& produtos) const {
+        for (int i = 0; i < 7; i++) {
+            if (subplanos[i]) {
+                subplanos[i]->coletarProdutos(produtos);
+            } else {
+                ProdutoStrassen produto = { x[i], y[i], p[i] };
+                produtos.push_back(produto);
+            }
+        }
+    }
+
+    // Depois que todos os produtos foram calculados: combina-os em C
+    void concluir(const ParametrosBloco& blocos, BuffersGemm& buffers) {
+        for (int i = 0; i < 7; i++) {
+            if (subplanos[i]) {
+                subplanos[i]->concluir(blocos, buffers);
+            }
+        }
+
+        const double (*coefC)[7] = ps.algoritmo == ALGO_WINOGRAD ? COEF_WINOGRAD_C : COEF_STRASSEN_C;
+        VisaoMatrizConst produtos[7];
+        for (int i = 0; i < 7; i++) {
+            produtos[i] = p[i].visao();
+        }
+        VisaoMatriz qc[4];
+        quadrantes(c.visaoEscrita(), mh, nh, qc);
+        for (int q = 0; q < 4; q++) {
+            combinarQuadrantes(qc[q], produtos, coefC[q], 7);
+        }
+        corrigirBordas(a.visao(), b.visao(), c.visaoEscrita(), 2 * mh, 2 * kh, 2 * nh, blocos, buffers);
+    }
+};
+
+inline void imprimirAlgoritmo(const ParametrosStrassen& ps) {
+    if (ps.algoritmo != ALGO_CLASSICO) {
+        std::printf("Algoritmo: %s com crossover %d (GFLOP/s calculado com 2n³ operações)\n",
+                    ps.nome(), ps.crossover);
+    }
+}
+
+// Limite de Higham (Accuracy and Stability of Numerical Algorithms, teorema
+// 23.2) para o erro máximo de C = A * B com n x n, em relação ao valor exato:
+//   Strassen: [(n/n0)^log2(12) (n0² + 5 n0) - 5n] u ‖A‖ ‖B‖
+//   Winograd: [(n/n0)^log2(18) (n0² + 6 n0) - 6n] u ‖A‖ ‖B‖
+//   clássico: n² u ‖A‖ ‖B‖ (em norma do máximo)
+// com n0 o tamanho em que a recursão para e u = 2^-53.
+inline double limiteErroMultiplicacao(const ParametrosStrassen& ps, int n, double normaA, double normaB) {
+    const double u = DBL_EPSILON / 2.0;
+    int niveis = 0;
+    int n0 = n;
+    while (ps.deveRecursar(n0, n0, n0)) {
+        n0 /= 2;
+        niveis++;
+    }
+    double fator;
+    if (ps.algoritmo == ALGO_CLASSICO || niveis == 0) {
+        fator = (double)n * n;
+    } else if (ps.algoritmo == ALGO_STRASSEN) {
+        fator = std::pow(12.0, niveis) * ((double)n0 * n0 + 5.0 * n0) - 5.0 * n;
+    } else {
+        fator = std::pow(18.0, niveis) * ((double)n0 * n0 + 6.0 * n0) - 6.0 * n;
+    }
+    return fator * u * normaA * normaB;
+}
+
+inline double normaMaximo(VisaoMatrizConst x) {
+    double maximo = 0.0;
+    for (int i = 0; i < x.linhas; i++) {
+        for (int j = 0; j < x.colunas; j++) {
+            maximo = std::max(maximo, std::fabs(x(i, j)));
+        }
+    }
+    return maximo;
+}
+
+// Compara C com o resultado clássico e imprime o erro e o limite teórico
+inline void relatarErroStrassen(const ParametrosStrassen& ps, VisaoMatrizConst a, VisaoMatrizConst b,
+                                VisaoMatrizConst c, VisaoMatrizConst referencia) {
+    double erroMaximo = 0.0;
+    for (int i = 0; i < c.linhas; i++) {
+        for (int j = 0; j < c.colunas; j++) {
+            erroMaximo = std::max(erroMaximo, std::fabs(c(i, j) - referencia(i, j)));
+        }
+    }
+    double normaA = normaMaximo(a), normaB = normaMaximo(b), normaRef = normaMaximo(referencia);
+    double limite = limiteErroMultiplicacao(ps, c.linhas, normaA, normaB);
+    std::printf("Erro máximo em relação ao clássico: %.3e (relativo: %.3e)\n",
+                erroMaximo, normaRef > 0.0 ? erroMaximo / normaRef : 0.0);
+    std::printf("Limite teórico do erro (%s, crossover %d): %.3e\n", ps.nome(), ps.crossover, limite);
+}
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef TIPO_ELEMENTO_H
+#define TIPO_ELEMENTO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+/**
+ * Tipos de elemento das matrizes (--dtype).
+ *
+ * float64 é o tipo padrão e o único usado por Strassen, pelos modos em fluxo
+ * e em lote e pelos micro-kernels de gemm.h. float32, int32 e int8 têm um
+ * caminho próprio (gemm_tipado.h) nos três programas: com menos bytes por
+ * elemento, o tráfego de memória cai pela metade ou a um quarto e cabem mais
+ * elementos em cada registrador vetorial.
+ *
+ * O resultado é acumulado (e gravado) em um tipo mais largo nos inteiros,
+ * para não transbordar: int8 -> int32 e int32 -> int64. Em ponto flutuante,
+ * como em qualquer BLAS, o acumulador é do próprio tipo.
+ */
+
+// Código gravado no cabeçalho dos arquivos binários e de lote
+enum TipoDado {
+    TIPO_QUALQUER = 0,  // só na validação de arquivos: aceita qualquer tipo
+    TIPO_FLOAT64 = 1,
+    TIPO_FLOAT32 = 2,
+    TIPO_INT32 = 3,
+    TIPO_INT8 = 4,
+    TIPO_INT64 = 5   // só como resultado de int32
+};
+
+template <typename T> struct TipoElemento;
+
+template <> struct TipoElemento<double> {
+    typedef double Acumulador;
+    static TipoDado codigo() { return TIPO_FLOAT64; }
+};
+
+template <> struct TipoElemento<float> {
+    typedef float Acumulador;
+    static TipoDado codigo() { return TIPO_FLOAT32; }
+};
+
+template <> struct TipoElemento<int64_t> {
+    typedef int64_t Acumulador;
+    static TipoDado codigo() { return TIPO_INT64; }
+};
+
+template <> struct TipoElemento<int32_t> {
+    typedef int64_t Acumulador;
+    static TipoDado codigo() { return TIPO_INT32; }
+};
+
+template <> struct TipoElemento<int8_t> {
+    typedef int32_t Acumulador;
+    static TipoDado codigo() { return TIPO_INT8; }
+};
+
+inline size_t bytesTipoDado(TipoDado tipo) {
+    switch (tipo) {
+        case TIPO_FLOAT64: return 8;
+        case TIPO_FLOAT32: return 4;
+        case TIPO_INT32: return 4;
+        case TIPO_INT8: return 1;
+        case TIPO_INT64: return 8;
+        case TIPO_QUALQUER: break;
+    }
+    return 0;
+}
+
+inline const char* nomeTipoDado(TipoDado tipo) {
+    switch (tipo) {
+        case TIPO_FLOAT64: return "float64";
+        case TIPO_FLOAT32: return "float32";
+        case TIPO_INT32: return "int32";
+        case TIPO_INT8: return "int8";
+        case TIPO_INT64: return "int64";
+        case TIPO_QUALQUER: break;
+    }
+    return "desconhecido";
+}
+
+// Tipo do resultado de A * B com elementos do tipo `tipo`
+inline TipoDado tipoAcumulador(TipoDado tipo) {
+    switch (tipo) {
+        case TIPO_INT8: return TIPO_INT32;
+        case TIPO_INT32: return TIPO_INT64;
+        default: return tipo;
+    }
+}
+
+// Lê --dtype=float64|float32|int32|int8
+inline bool interpretarTipoDado(const std::string& nome, TipoDado& tipo) {
+    if (nome.empty() || nome == "float64") {
+        tipo = TIPO_FLOAT64;
+    } else if (nome == "float32") {
+        tipo = TIPO_FLOAT32;
+    } else if (nome == "int32") {
+        tipo = TIPO_INT32;
+    } else if (nome == "int8") {
+        tipo = TIPO_INT8;
+    } else {
+        std::cerr << "Erro: Tipo de dado desconhecido: " << nome
+                  << " (use float64, float32, int32 ou int8)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Sufixo dos nomes de arquivo: vazio para float64 (os nomes de sempre),
+// "_float32", "_int8" etc. para os demais
+inline std::string sufixoTipoDado(TipoDado tipo) {
+    return tipo == TIPO_FLOAT64 ? std::string() : std::string("_") + nomeTipoDado(tipo);
+}
+
+#endif
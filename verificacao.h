@@ -0,0 +1,236 @@
+#ifndef VERIFICACAO_H
+#define VERIFICACAO_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <sys/mman.h>
+#include <vector>
+#include "aleatorio.h"
+#include "matriz.h"
+#include "opcoes.h"
+
+/**
+ * Verificação probabilística do resultado (algoritmo de Freivalds).
+ *
+ * Em vez de recalcular A * B (O(n³)), sorteia k vetores x e compara
+ * A (B x) com C x, em O(k n²). Um C errado passa por um vetor com
+ * probabilidade desprezível, a menos que o erro seja da ordem dos
+ * arredondamentos. Em ponto flutuante as duas contas diferem por
+ * arredondamento, então a diferença é medida em relação ao maior valor
+ * que os termos de uma linha podem somar:
+ *   erro_i = |(A (B x))_i - (C x)_i| / max_k (|A| (|B| x))_k
+ * Uma escala por linha seria mais justa com o algoritmo clássico, mas o
+ * erro de Strassen/Winograd só é limitado em norma (ver strassen.h) e
+ * linhas quase nulas de C, comuns com operandos esparsos, falhariam à toa.
+ * O produto é aceito se o maior erro_i for no máximo a tolerância
+ * (--tolerancia; por padrão 1e-9 em float64 e 1,2e-4 em float32). Os
+ * elementos de x são inteiros de 0 a 1023: com os tipos inteiros de --dtype
+ * as contas são exatas e o erro é zero.
+ *
+ * Com --verify[=K] (K = 2 por padrão), os programas de multiplicação
+ * verificam C depois da medição, inclusive nos modos em fluxo, em lote e
+ * em cadeia, e terminam com erro se a verificação falhar. Uma cadeia
+ * C = A1 A2 ... An é conferida sem nenhum produto de matrizes, comparando
+ * A1 (A2 (... (An x))) com C x.
+ */
+
+struct ParametrosVerificacao {
+    int vetores;  // 0 = sem verificação
+    double tolerancia;  // negativa = padrão do tipo dos elementos
+
+    ParametrosVerificacao() : vetores(0), tolerancia(-1.0) {}
+
+    bool ativa() const { return vetores > 0; }
+
+    // 1e-9 em float64; mil vezes o epsilon em float32; os inteiros são exatos
+    template <typename T>
+    double toleranciaPara() const {
+        return tolerancia >= 0.0 ? tolerancia : std::max(1e-9, 1000.0 * std::numeric_limits<T>::epsilon());
+    }
+
+    // Opções deste grupo, para Opcoes::aceitarApenas
+    static const char* nomesOpcoes() { return "verify,tolerancia"; }
+
+    // Lê --verify[=K] e --tolerancia=T
+    static bool deOpcoes(const Opcoes& opcoes, ParametrosVerificacao& p) {
+        p.vetores = opcoes.tem("verify") ? opcoes.inteiro("verify", 2) : 0;
+        if (opcoes.tem("verify") && p.vetores <= 0) {
+            std::cerr << "Erro: O número de vetores de --verify deve ser um número positivo." << std::endl;
+            return false;
+        }
+        if (opcoes.tem("tolerancia") && (p.tolerancia = opcoes.real("tolerancia", 0.0)) < 0.0) {
+            std::cerr << "Erro: A tolerância (--tolerancia) não pode ser negativa." << std::endl;
+            return false;
+        }
+        return true;
+    }
+};
+
+struct ResultadoVerificacao {
+    double erroMaximo;
+    int linhaErroMaximo;
+    bool aprovado;
+};
+
+// y = M x e yAbs = |M| xAbs, com M armazenada por linhas
+template <typename T>
+inline void multiplicarPorVetor(VisaoMatrizConstT<T> m, const double* x, const double* xAbs, double* y,
+                                double* yAbs) {
+    for (int i = 0; i < m.linhas; i++) {
+        const T* linha = m.linha(i);
+        double soma = 0.0, somaAbs = 0.0;
+#pragma omp simd reduction(+ : soma, somaAbs)
+        for (int j = 0; j < m.colunas; j++) {
+            double v = (double)linha[j];
+            soma += v * x[j];
+            somaAbs += std::fabs(v) * xAbs[j];
+        }
+        y[i] = soma;
+        yAbs[i] = somaAbs;
+    }
+}
+
+// Freivalds com `p.vetores` vetores sorteados a partir de `semente`
+template <typename T, typename A>
+inline ResultadoVerificacao freivalds(VisaoMatrizConstT<T> a, VisaoMatrizConstT<T> b, VisaoMatrizConstT<A> c,
+                                      const ParametrosVerificacao& p, uint64_t semente) {
+    ResultadoVerificacao r = { 0.0, -1, true };
+    std::vector<double> x(b.colunas), y(b.linhas), yAbs(b.linhas), z(a.linhas), zAbs(a.linhas);
+    std::vector<double> w(c.linhas), descartado(c.linhas);
+
+    for (int v = 0; v < p.vetores; v++) {
+        FluxoAleatorio fluxo(semente, (uint32_t)v);
+        for (int j = 0; j < b.colunas; j++) {
+            x[j] = fluxo.inteiro(j, 0, 1023);
+        }
+        multiplicarPorVetor(b, x.data(), x.data(), y.data(), yAbs.data());
+        multiplicarPorVetor(a, y.data(), yAbs.data(), z.data(), zAbs.data());
+        multiplicarPorVetor(c, x.data(), x.data(), w.data(), descartado.data());
+
+        double escala = 0.0;
+        for (int i = 0; i < a.linhas; i++) {
+            escala = std::max(escala, zAbs[i]);
+        }
+        for (int i = 0; i < c.linhas; i++) {
+            double diferenca = std::fabs(z[i] - w[i]);
+            double erro = escala > 0.0 ? diferenca / escala : diferenca;
+            // NaN em C nunca passa
+            if (std::isnan(erro) || erro > r.erroMaximo) {
+                r.erroMaximo = erro;
+                r.linhaErroMaximo = i;
+            }
+        }
+        if (std::isnan(r.erroMaximo)) {
+            break;
+        }
+    }
+    r.aprovado = r.erroMaximo <= p.template toleranciaPara<T>();
+    return r;
+}
+
+// Freivalds para C = A1 A2 ... An (fatores já compatíveis), com a escala
+// max |A1| (|A2| (... (|An| x))) propagada junto com o produto
+inline ResultadoVerificacao freivaldsCadeia(const std::vector<VisaoMatrizConst>& fatores, VisaoMatrizConst c,
+                                            const ParametrosVerificacao& p, uint64_t semente) {
+    ResultadoVerificacao r = { 0.0, -1, true };
+    std::vector<double> x(c.colunas), y, yAbs, proximo, proximoAbs, w(c.linhas), descartado(c.linhas);
+
+    for (int v = 0; v < p.vetores; v++) {
+        FluxoAleatorio fluxo(semente, (uint32_t)v);
+        for (int j = 0; j < c.colunas; j++) {
+            x[j] = fluxo.inteiro(j, 0, 1023);
+        }
+        y = x;
+        yAbs = x;
+        for (size_t f = fatores.size(); f-- > 0;) {
+            proximo.resize(fatores[f].linhas);
+            proximoAbs.resize(fatores[f].linhas);
+            multiplicarPorVetor(fatores[f], y.data(), yAbs.data(), proximo.data(), proximoAbs.data());
+            y.swap(proximo);
+            yAbs.swap(proximoAbs);
+        }
+        multiplicarPorVetor(c, x.data(), x.data(), w.data(), descartado.data());
+
+        double escala = 0.0;
+        for (int i = 0; i < c.linhas; i++) {
+            escala = std::max(escala, yAbs[i]);
+        }
+        for (int i = 0; i < c.linhas; i++) {
+            double diferenca = std::fabs(y[i] - w[i]);
+            double erro = escala > 0.0 ? diferenca / escala : diferenca;
+            if (std::isnan(erro) || erro > r.erroMaximo) {
+                r.erroMaximo = erro;
+                r.linhaErroMaximo = i;
+            }
+        }
+        if (std::isnan(r.erroMaximo)) {
+            break;
+        }
+    }
+    r.aprovado = r.erroMaximo <= p.toleranciaPara<double>();
+    return r;
+}
+
+// Verifica C = A * B e imprime o resultado
+template <typename T, typename A>
+inline bool verificarProduto(VisaoMatrizConstT<T> a, VisaoMatrizConstT<T> b, VisaoMatrizConstT<A> c,
+                             const ParametrosVerificacao& p) {
+    if (a.colunas != b.linhas || c.linhas != a.linhas || c.colunas != b.colunas) {
+        std::cerr << "Erro: Dimensões incompatíveis na verificação" << std::endl;
+        return false;
+    }
+    auto inicio = std::chrono::steady_clock::now();
+    ResultadoVerificacao r = freivalds(a, b, c, p, sementeAleatoria());
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+
+    if (r.aprovado) {
+        std::printf("Verificação (Freivalds, %d vetores): OK, erro relativo máximo %.2e (tolerância %.2e), %.1f ms\n",
+                    p.vetores, r.erroMaximo, p.template toleranciaPara<T>(), ms);
+    } else {
+        std::printf("Verificação (Freivalds, %d vetores): FALHOU, erro relativo %.2e na linha %d (tolerância %.2e)\n",
+                    p.vetores, r.erroMaximo, r.linhaErroMaximo, p.template toleranciaPara<T>());
+    }
+    return r.aprovado;
+}
+
+template <typename T, typename A>
+inline bool verificarProduto(const MatrizDensaT<T>& a, const MatrizDensaT<T>& b, const MatrizDensaT<A>& c,
+                             const ParametrosVerificacao& p) {
+    return verificarProduto(a.visao(), b.visao(), c.visao(), p);
+}
+
+// Verifica C = A * B com as três matrizes em arquivos .bin (float64), mapeados
+// sem cópia (ex.: depois do modo em fluxo, em que nenhuma delas fica na memória)
+inline bool verificarArquivosBinarios(const std::string& arquivoA, const std::string& arquivoB,
+                                      const std::string& arquivoC, const ParametrosVerificacao& p) {
+    CabecalhoMatrizBinaria cab[3];
+    MapeamentoArquivo mapa[3] = { { nullptr, 0 }, { nullptr, 0 }, { nullptr, 0 } };
+    const std::string* arquivos[3] = { &arquivoA, &arquivoB, &arquivoC };
+    bool ok = true;
+    for (int m = 0; m < 3 && ok; m++) {
+        ok = mapearMatrizBinaria(*arquivos[m], cab[m], mapa[m]);
+    }
+    if (ok) {
+        VisaoMatrizConst v[3];
+        for (int m = 0; m < 3; m++) {
+            v[m] = VisaoMatrizConst(reinterpret_cast<const double*>(static_cast<const char*>(mapa[m].base) +
+                                                                    cab[m].tamanhoCabecalho),
+                                    (int)cab[m].linhas, (int)cab[m].colunas, (int)cab[m].passo);
+        }
+        ok = verificarProduto(v[0], v[1], v[2], p);
+    }
+    for (int m = 0; m < 3; m++) {
+        if (mapa[m].base != nullptr) {
+            munmap(mapa[m].base, mapa[m].tamanho);
+        }
+    }
+    return ok;
+}
+
+#endif
@@ -57,9 +57,273 @@ if [ -f "$ARQUIVO_SEQ" ] && [ -f "$ARQUIVO_THREADS" ] && [ -f "$ARQUIVO_PROCESSO
         echo "Primeiras diferenças:"
         diff "$ARQUIVO_THREADS" "$ARQUIVO_PROCESSOS" | head -10
     fi
+    
+    echo "Comparando formato texto vs binário..."
+    ./conversor_matrizes "matriz_a_${TAMANHO}.txt" "matriz_a_${TAMANHO}.bin" > /dev/null
+    ./conversor_matrizes "matriz_b_${TAMANHO}.txt" "matriz_b_${TAMANHO}.bin" > /dev/null
+    # Sem --formato, os .bin presentes não mudam as entradas nem o resultado (texto)
+    cp "$ARQUIVO_SEQ" "resultado_padrao_${TAMANHO}.txt"
+    ./multiplicacao_sequencial $TAMANHO > /dev/null
+    OK_PADRAO=0
+    cmp -s "$ARQUIVO_SEQ" "resultado_padrao_${TAMANHO}.txt" && [ ! -e "resultado_sequencial_${TAMANHO}.bin" ] || OK_PADRAO=1
+    ./multiplicacao_sequencial $TAMANHO --formato=binario > /dev/null
+    ./conversor_matrizes "resultado_sequencial_${TAMANHO}.bin" "resultado_binario_${TAMANHO}.txt" > /dev/null
+    if [ $OK_PADRAO = 0 ] && diff -q "$ARQUIVO_SEQ" "resultado_binario_${TAMANHO}.txt" > /dev/null; then
+        echo "Texto e Binário: IDÊNTICOS"
+    else
+        echo "Texto e Binário: DIFERENTES"
+        diff "$ARQUIVO_SEQ" "resultado_binario_${TAMANHO}.txt" | head -10
+    fi
+    rm -f matriz_?_${TAMANHO}.bin resultado_*_${TAMANHO}.bin "resultado_binario_${TAMANHO}.txt" \
+        "resultado_padrao_${TAMANHO}.txt"
 else
     echo "Erro: Nem todos os arquivos de resultado foram gerados"
 fi
 
+echo "Comparando modo em lote (sequencial, threads e processos)..."
+./gerador_matrizes --lote=20 --tamanhos=7,16,50,200 > /dev/null
+./multiplicacao_sequencial --lote=lote_20.lote > /dev/null
+./multiplicacao_threads --lote=lote_20.lote $NUM_THREADS > /dev/null
+./multiplicacao_processos --lote=lote_20.lote $NUM_PROCESSOS > /dev/null
+if cmp -s resultado_sequencial_lote_20.lote "resultado_threads_lote_20_${NUM_THREADS}.lote" &&
+   cmp -s resultado_sequencial_lote_20.lote "resultado_processos_lote_20_${NUM_PROCESSOS}.lote"; then
+    echo "Lote: IDÊNTICOS"
+else
+    echo "Lote: DIFERENTES"
+fi
+rm -f lote_20.lote resultado_*_lote_20*.lote
+
+echo "Comparando tipos de elemento (--dtype, sequencial, threads e processos)..."
+for TIPO in float32 int32 int8; do
+    ./gerador_matrizes $TAMANHO --dtype=$TIPO > /dev/null
+    ./multiplicacao_sequencial $TAMANHO --dtype=$TIPO > /dev/null
+    ./multiplicacao_threads $TAMANHO $NUM_THREADS --dtype=$TIPO --tile=16x16 > /dev/null
+    ./multiplicacao_processos $TAMANHO $NUM_PROCESSOS --dtype=$TIPO --tile=16x16 > /dev/null
+    if cmp -s "resultado_sequencial_${TAMANHO}_${TIPO}.txt" "resultado_threads_${TAMANHO}_${NUM_THREADS}_${TIPO}.txt" &&
+       cmp -s "resultado_sequencial_${TAMANHO}_${TIPO}.txt" "resultado_processos_${TAMANHO}_${NUM_PROCESSOS}_${TIPO}.txt"; then
+        echo "Tipo ${TIPO}: IDÊNTICOS"
+    else
+        echo "Tipo ${TIPO}: DIFERENTES"
+    fi
+    rm -f matriz_?_${TAMANHO}_${TIPO}.txt resultado_*_${TAMANHO}*_${TIPO}.txt
+done
+
+echo "Comparando operandos esparsos (--esparsa, sequencial, threads e processos)..."
+# A esparsa, B esparsa e as duas: as três formas de esparsa.h
+./gerador_matrizes $TAMANHO > /dev/null
+mv "matriz_a_${TAMANHO}.txt" densa_a.txt
+mv "matriz_b_${TAMANHO}.txt" densa_b.txt
+./gerador_matrizes $TAMANHO --densidade=0.05 > /dev/null
+mv "matriz_a_${TAMANHO}.txt" esparsa_a.txt
+mv "matriz_b_${TAMANHO}.txt" esparsa_b.txt
+for PAR in "esparsa densa" "densa esparsa" "esparsa esparsa"; do
+    set -- $PAR
+    cp "$1_a.txt" "matriz_a_${TAMANHO}.txt"
+    cp "$2_b.txt" "matriz_b_${TAMANHO}.txt"
+    ./multiplicacao_sequencial $TAMANHO --esparsa=sim > /dev/null
+    ./multiplicacao_threads $TAMANHO $NUM_THREADS --esparsa=sim > /dev/null
+    ./multiplicacao_processos $TAMANHO $NUM_PROCESSOS --esparsa=sim > /dev/null
+    if cmp -s "$ARQUIVO_SEQ" "$ARQUIVO_THREADS" && cmp -s "$ARQUIVO_SEQ" "$ARQUIVO_PROCESSOS"; then
+        echo "Esparsa (A $1, B $2): IDÊNTICOS"
+    else
+        echo "Esparsa (A $1, B $2): DIFERENTES"
+    fi
+done
+rm -f densa_?.txt esparsa_?.txt
+
+echo "Conferindo a rejeição de cabeçalhos .bin corrompidos..."
+# Campos gravados em um .bin válido (deslocamento em bytes): linhas = 2^31 com
+# colunas = passo = 2^30 (linhas * passo * 8 estoura para 0), passo < colunas,
+# alinhamento que não é potência de dois e dados que não cabem no arquivo
+./conversor_matrizes "matriz_a_${TAMANHO}.txt" cabecalho_valido.bin > /dev/null
+OK_CABECALHO=0
+for CAMPO in "16 \x00\x00\x00\x80\x00\x00\x00\x00\x00\x00\x00\x40\x00\x00\x00\x00\x00\x00\x00\x40" \
+             "32 \x08\x00\x00\x00" "40 \x30\x00\x00\x00" "16 \x00\x01\x00\x00"; do
+    set -- $CAMPO
+    cp cabecalho_valido.bin cabecalho_corrompido.bin
+    printf "$2" | dd of=cabecalho_corrompido.bin bs=1 seek=$1 conv=notrunc 2> /dev/null
+    ./comparador_matrizes cabecalho_corrompido.bin cabecalho_corrompido.bin 2>&1 |
+        grep -q "Cabeçalho inválido\|truncado" || OK_CABECALHO=1
+done
+if [ $OK_CABECALHO = 0 ]; then
+    echo "Cabeçalhos corrompidos: OK"
+else
+    echo "Cabeçalhos corrompidos: FALHOU"
+fi
+rm -f cabecalho_valido.bin cabecalho_corrompido.bin
+
+echo "Conferindo a rejeição de opções desconhecidas..."
+if ! ./multiplicacao_sequencial $TAMANHO --verfy > saida_opcao.txt 2>&1 \
+    && grep -q "Opção desconhecida: --verfy" saida_opcao.txt; then
+    echo "Opções desconhecidas: OK"
+else
+    echo "Opções desconhecidas: FALHOU"
+fi
+rm -f saida_opcao.txt
+
+echo "Comparando o gerador com --seed (1 e 3 threads)..."
+./gerador_matrizes $TAMANHO --seed=2024 --threads=1 > /dev/null
+mv "matriz_a_${TAMANHO}.txt" semente_1.txt
+./gerador_matrizes $TAMANHO --seed=2024 --threads=3 > /dev/null
+if cmp -s semente_1.txt "matriz_a_${TAMANHO}.txt"; then
+    echo "Gerador: IDÊNTICOS"
+else
+    echo "Gerador: DIFERENTES"
+fi
+rm -f semente_1.txt
+
+echo "Conferindo com --verify (Freivalds) e com o comparador..."
+# O código de saída é diferente de zero se a verificação ou a comparação falhar
+if ./multiplicacao_sequencial $TAMANHO --verify > /dev/null &&
+   ./multiplicacao_threads $TAMANHO $NUM_THREADS --verify=4 > /dev/null &&
+   ./multiplicacao_processos $TAMANHO $NUM_PROCESSOS --verify --algo=strassen --crossover=32 > /dev/null &&
+   ./comparador_matrizes "$ARQUIVO_SEQ" "$ARQUIVO_THREADS" > /dev/null; then
+    echo "Freivalds e comparador: OK"
+else
+    echo "Freivalds e comparador: FALHOU"
+fi
+
+echo "Comparando --pipeline com a execução normal..."
+# O último resultado sequencial normal é a referência; cada programa usa outro tamanho de bloco
+cp "$ARQUIVO_SEQ" referencia_pipeline.txt
+./multiplicacao_sequencial $TAMANHO --pipeline > /dev/null
+./multiplicacao_threads $TAMANHO $NUM_THREADS --pipeline=7 > /dev/null
+./multiplicacao_processos $TAMANHO $NUM_PROCESSOS --pipeline=64 --verify > /dev/null
+if cmp -s referencia_pipeline.txt "$ARQUIVO_SEQ" && cmp -s referencia_pipeline.txt "$ARQUIVO_THREADS" &&
+   cmp -s referencia_pipeline.txt "$ARQUIVO_PROCESSOS"; then
+    echo "Pipeline: IDÊNTICOS"
+else
+    echo "Pipeline: DIFERENTES"
+fi
+rm -f referencia_pipeline.txt
+
+echo "Conferindo o cache de --autotune (P omitido)..."
+# Sem P, threads e processos usam o P e os blocos do cache; o nome do resultado leva o P escolhido
+rm -f resultado_threads_${TAMANHO}_*.txt resultado_processos_${TAMANHO}_*.txt
+./benchmark_multiplicacao --autotune --tamanhos=$TAMANHO --p=1,2 --aquecimento=0 --repeticoes=1 \
+    --ajuste=ajuste_teste.cache > /dev/null
+# Os blocos do cache mudam a ordem das somas: os três programas são comparados
+# entre si, e a referência com os blocos padrão ($ARQUIVO_SEQ) é preservada
+mv "$ARQUIVO_SEQ" referencia_padrao.txt
+./multiplicacao_sequencial $TAMANHO --ajuste=ajuste_teste.cache > /dev/null
+mv "$ARQUIVO_SEQ" resultado_ajuste_sequencial.txt
+mv referencia_padrao.txt "$ARQUIVO_SEQ"
+./multiplicacao_threads $TAMANHO --ajuste=ajuste_teste.cache > /dev/null
+./multiplicacao_processos $TAMANHO --ajuste=ajuste_teste.cache > /dev/null
+if [ "$(grep -c "	sim$" ajuste_teste.cache)" = 1 ] &&
+   cmp -s resultado_ajuste_sequencial.txt resultado_threads_${TAMANHO}_*.txt &&
+   cmp -s resultado_ajuste_sequencial.txt resultado_processos_${TAMANHO}_*.txt; then
+    echo "Autotune: IDÊNTICOS"
+else
+    echo "Autotune: DIFERENTES"
+fi
+rm -f ajuste_teste.cache resultado_ajuste_sequencial.txt
+
+echo "Conferindo o servidor residente (socket Unix)..."
+./servidor_multiplicacao $NUM_PROCESSOS --backend=processos --socket=servidor_teste.sock > /dev/null &
+PID_SERVIDOR=$!
+for i in $(seq 50); do
+    [ -S servidor_teste.sock ] && break
+    sleep 0.1
+done
+# O segundo pedido reaproveita as entradas e recebe C sem cópia
+./cliente_multiplicacao "matriz_a_${TAMANHO}.txt" "matriz_b_${TAMANHO}.txt" --socket=servidor_teste.sock \
+    --saida=resultado_servidor.txt --verify > /dev/null
+OK_CLIENTE=$?
+./cliente_multiplicacao "matriz_a_${TAMANHO}.txt" "matriz_b_${TAMANHO}.txt" --socket=servidor_teste.sock \
+    --repeticoes=3 > /dev/null || OK_CLIENTE=1
+# Entradas .bin são mapeadas pelos filhos pelo caminho: depois de um pedido
+# com B = A, B é substituído (novo arquivo no mesmo caminho) e o produto
+# precisa refletir o B novo, não o mapeamento antigo dos filhos
+./conversor_matrizes "matriz_a_${TAMANHO}.txt" servidor_a.bin > /dev/null
+./conversor_matrizes "matriz_a_${TAMANHO}.txt" servidor_b.bin > /dev/null
+./cliente_multiplicacao servidor_a.bin servidor_b.bin --socket=servidor_teste.sock > /dev/null || OK_CLIENTE=1
+./conversor_matrizes "matriz_b_${TAMANHO}.txt" servidor_b_novo.bin > /dev/null
+mv servidor_b_novo.bin servidor_b.bin
+./cliente_multiplicacao servidor_a.bin servidor_b.bin --socket=servidor_teste.sock \
+    --saida=resultado_servidor_bin.txt --verify > /dev/null || OK_CLIENTE=1
+cmp -s "$ARQUIVO_SEQ" resultado_servidor_bin.txt || OK_CLIENTE=1
+# Um cliente parado no meio de um pedido não pode travar os outros
+if command -v python3 > /dev/null; then
+    python3 -c 'import socket, time
+s = socket.socket(socket.AF_UNIX)
+s.connect("servidor_teste.sock")
+s.send(b"MULT")
+time.sleep(10)' &
+    PID_PARADO=$!
+    sleep 0.2
+    timeout 5 ./cliente_multiplicacao "matriz_a_${TAMANHO}.txt" "matriz_b_${TAMANHO}.txt" \
+        --socket=servidor_teste.sock > /dev/null || OK_CLIENTE=1
+    kill $PID_PARADO
+    wait $PID_PARADO 2> /dev/null
+fi
+./cliente_multiplicacao --encerrar --socket=servidor_teste.sock > /dev/null
+wait $PID_SERVIDOR
+if [ $OK_CLIENTE = 0 ] && cmp -s "$ARQUIVO_SEQ" resultado_servidor.txt; then
+    echo "Servidor: IDÊNTICOS"
+else
+    echo "Servidor: DIFERENTES"
+fi
+rm -f resultado_servidor.txt resultado_servidor_bin.txt servidor_a.bin servidor_b.bin
+
+echo "Conferindo o algoritmo de Cannon (--cannon, grades 2x2 e 3x3)..."
+# A ordem das somas muda com a grade e o texto tem duas casas decimais: o último
+# dígito pode mudar, então a comparação é com tolerância
+OK_CANNON=0
+for p in 4 9; do
+    ./multiplicacao_processos $TAMANHO $p --cannon --verify > /dev/null &&
+        ./comparador_matrizes "$ARQUIVO_SEQ" "resultado_processos_${TAMANHO}_${p}.txt" --tolerancia=1e-6 > /dev/null || OK_CANNON=1
+done
+./multiplicacao_processos $TAMANHO 4 --cannon=sincrono > /dev/null &&
+    ./comparador_matrizes "$ARQUIVO_SEQ" "resultado_processos_${TAMANHO}_4.txt" --tolerancia=1e-6 > /dev/null || OK_CANNON=1
+if [ $OK_CANNON = 0 ]; then
+    echo "Cannon: IGUAIS dentro da tolerância"
+else
+    echo "Cannon: DIFERENTES"
+fi
+rm -f resultado_processos_${TAMANHO}_4.txt resultado_processos_${TAMANHO}_9.txt
+
+echo "Conferindo --paginas-grandes e a arena de temporários..."
+# Sem páginas grandes reservadas, hugetlb cai para THP; Strassen repetido não deve alocar
+./multiplicacao_threads $TAMANHO 3 --paginas-grandes=nao > /dev/null
+cmp -s "$ARQUIVO_SEQ" "resultado_threads_${TAMANHO}_3.txt"
+OK_PAGINAS=$?
+./multiplicacao_threads $TAMANHO 3 --paginas-grandes=hugetlb > /dev/null 2>&1
+cmp -s "$ARQUIVO_SEQ" "resultado_threads_${TAMANHO}_3.txt" || OK_PAGINAS=1
+./multiplicacao_threads $TAMANHO 1 --algo=strassen --crossover=16 --repeticoes=3 |
+    grep -q "na última repetição: 0$" || OK_PAGINAS=1
+# No pool de processos as temporárias ficam em memória compartilhada, também reaproveitada
+./multiplicacao_processos $TAMANHO $NUM_PROCESSOS --algo=strassen --crossover=16 --repeticoes=3 |
+    grep -q "na última repetição: 0$" || OK_PAGINAS=1
+if [ $OK_PAGINAS = 0 ]; then
+    echo "Páginas grandes e arena: OK"
+else
+    echo "Páginas grandes e arena: FALHOU"
+fi
+rm -f "resultado_threads_${TAMANHO}_3.txt"
+
+echo "Conferindo o modo em cadeia (--cadeia)..."
+# Cadeia clássica de 6 matrizes, cuja ordem ótima é ((A1 (A2 A3)) ((A4 A5) A6)),
+# e o produto retangular A * B como cadeia de duas matrizes
+./gerador_matrizes --cadeia=30,35,15,5,10,20,25 --seed=7 > /dev/null
+CADEIA=cadeia_1_30x35.txt,cadeia_2_35x15.txt,cadeia_3_15x5.txt,cadeia_4_5x10.txt,cadeia_5_10x20.txt,cadeia_6_20x25.txt
+# A saída é guardada antes do grep: com grep -q no pipe, o programa podia
+# morrer por SIGPIPE antes de salvar o resultado
+SAIDA_CADEIA=$(./multiplicacao_sequencial --cadeia=$CADEIA --verify)
+echo "$SAIDA_CADEIA" | grep -q "^Parentização ótima: ((A1 (A2 A3)) ((A4 A5) A6))$"
+OK_CADEIA=$?
+./multiplicacao_threads --cadeia=$CADEIA 3 --verify > /dev/null || OK_CADEIA=1
+./multiplicacao_processos --cadeia=$CADEIA 3 --verify > /dev/null || OK_CADEIA=1
+cmp -s resultado_sequencial_cadeia_6.txt resultado_threads_cadeia_6_3.txt || OK_CADEIA=1
+cmp -s resultado_sequencial_cadeia_6.txt resultado_processos_cadeia_6_3.txt || OK_CADEIA=1
+./multiplicacao_threads --cadeia="matriz_a_${TAMANHO}.txt,matriz_b_${TAMANHO}.txt" 2 > /dev/null || OK_CADEIA=1
+cmp -s "$ARQUIVO_SEQ" resultado_threads_cadeia_2_2.txt || OK_CADEIA=1
+if [ $OK_CADEIA = 0 ]; then
+    echo "Cadeia: IDÊNTICOS"
+else
+    echo "Cadeia: DIFERENTES"
+fi
+rm -f cadeia_*_*x*.txt resultado_*_cadeia_*.txt
+
 echo
 echo "=== VERIFICAÇÃO CONCLUÍDA ==="